@@ -36,6 +36,8 @@
 #if MICROPY_PY_URE
 
 #define re1_5_stack_chk() MP_STACK_CHECK()
+#define re1_5_alloc(size) m_malloc(size, false)
+#define re1_5_free(ptr, size) m_del(char, ptr, size)
 
 #include "re1.5/re1.5.h"
 
@@ -43,6 +45,9 @@
 
 typedef struct _mp_obj_re_t {
     mp_obj_base_t base;
+    #if MICROPY_PY_URE_PIKEVM
+    void *work;
+    #endif
     ByteProg re;
 } mp_obj_re_t;
 
@@ -96,6 +101,21 @@ STATIC void re_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t
     mp_printf(print, "<re %p>", self);
 }
 
+#if MICROPY_PY_URE_PIKEVM
+// The Pike VM work area depends only on the program, so it is allocated on
+// first use and then kept with the compiled pattern.
+STATIC int re_exec_prog(mp_obj_re_t *self, Subject *subj, const char **caps, int caps_num, bool is_anchored) {
+    if (self->work == NULL) {
+        self->work = m_new(char, re1_5_pikevm_worksize(&self->re, caps_num));
+    }
+    return re1_5_pikevmwork(&self->re, subj, caps, caps_num, is_anchored, self->work);
+}
+#else
+STATIC int re_exec_prog(mp_obj_re_t *self, Subject *subj, const char **caps, int caps_num, bool is_anchored) {
+    return re1_5_recursiveloopprog(&self->re, subj, caps, caps_num, is_anchored);
+}
+#endif
+
 STATIC mp_obj_t ure_exec(bool is_anchored, uint n_args, const mp_obj_t *args) {
     (void)n_args;
     mp_obj_re_t *self = MP_OBJ_TO_PTR(args[0]);
@@ -107,7 +127,7 @@ STATIC mp_obj_t ure_exec(bool is_anchored, uint n_args, const mp_obj_t *args) {
     mp_obj_match_t *match = m_new_obj_var(mp_obj_match_t, char*, caps_num);
     // cast is a workaround for a bug in msvc: it treats const char** as a const pointer instead of a pointer to pointer to const char
     memset((char*)match->caps, 0, caps_num * sizeof(char*));
-    int res = re1_5_recursiveloopprog(&self->re, &subj, match->caps, caps_num, is_anchored);
+    int res = re_exec_prog(self, &subj, match->caps, caps_num, is_anchored);
     if (res == 0) {
         m_del_var(mp_obj_match_t, char*, caps_num, match);
         return mp_const_none;
@@ -148,7 +168,7 @@ STATIC mp_obj_t re_split(size_t n_args, const mp_obj_t *args) {
     while (true) {
         // cast is a workaround for a bug in msvc: it treats const char** as a const pointer instead of a pointer to pointer to const char
         memset((char**)caps, 0, caps_num * sizeof(char*));
-        int res = re1_5_recursiveloopprog(&self->re, &subj, caps, caps_num, false);
+        int res = re_exec_prog(self, &subj, caps, caps_num, false);
 
         // if we didn't have a match, or had an empty match, it's time to stop
         if (!res || caps[0] == caps[1]) {
@@ -189,18 +209,60 @@ STATIC const mp_obj_type_t re_type = {
     .locals_dict = (void*)&re_locals_dict,
 };
 
+#if MICROPY_PY_URE_CACHE_SIZE
+// The cache holds (pattern, compiled re) pairs, most recently used first.
+// Compiled programs are immutable so a cached one can be handed out again.
+STATIC mp_obj_t re_cache_lookup(mp_obj_t pattern) {
+    mp_obj_t *cache = MP_STATE_VM(ure_cache);
+    for (size_t i = 0; i < MICROPY_PY_URE_CACHE_SIZE; i++) {
+        if (cache[i * 2] == MP_OBJ_NULL) {
+            break;
+        }
+        if (mp_obj_str_equal(cache[i * 2], pattern)) {
+            mp_obj_t re = cache[i * 2 + 1];
+            // move the hit to the front
+            memmove(&cache[2], &cache[0], i * 2 * sizeof(mp_obj_t));
+            cache[0] = pattern;
+            cache[1] = re;
+            return re;
+        }
+    }
+    return MP_OBJ_NULL;
+}
+
+STATIC void re_cache_insert(mp_obj_t pattern, mp_obj_t re) {
+    mp_obj_t *cache = MP_STATE_VM(ure_cache);
+    // the least recently used entry drops off the end
+    memmove(&cache[2], &cache[0], (MICROPY_PY_URE_CACHE_SIZE - 1) * 2 * sizeof(mp_obj_t));
+    cache[0] = pattern;
+    cache[1] = re;
+}
+#endif
+
 STATIC mp_obj_t mod_re_compile(size_t n_args, const mp_obj_t *args) {
     const char *re_str = mp_obj_str_get_str(args[0]);
+    int flags = 0;
+    if (n_args > 1) {
+        flags = mp_obj_get_int(args[1]);
+    }
+    #if MICROPY_PY_URE_CACHE_SIZE
+    // debug compiles always go through the compiler so the code gets dumped
+    if (!(flags & FLAG_DEBUG)) {
+        mp_obj_t cached = re_cache_lookup(args[0]);
+        if (cached != MP_OBJ_NULL) {
+            return cached;
+        }
+    }
+    #endif
     int size = re1_5_sizecode(re_str);
     if (size == -1) {
         goto error;
     }
     mp_obj_re_t *o = m_new_obj_var(mp_obj_re_t, char, size);
     o->base.type = &re_type;
-    int flags = 0;
-    if (n_args > 1) {
-        flags = mp_obj_get_int(args[1]);
-    }
+    #if MICROPY_PY_URE_PIKEVM
+    o->work = NULL;
+    #endif
     int error = re1_5_compilecode(&o->re, re_str);
     if (error != 0) {
 error:
@@ -209,6 +271,9 @@ error:
     if (flags & FLAG_DEBUG) {
         re1_5_dumpcode(&o->re);
     }
+    #if MICROPY_PY_URE_CACHE_SIZE
+    re_cache_insert(args[0], MP_OBJ_FROM_PTR(o));
+    #endif
     return MP_OBJ_FROM_PTR(o);
 }
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_re_compile_obj, 1, 2, mod_re_compile);
@@ -253,7 +318,11 @@ const mp_obj_module_t mp_module_ure = {
 #define re1_5_fatal(x) assert(!x)
 #include "re1.5/compilecode.c"
 #include "re1.5/dumpcode.c"
+#if MICROPY_PY_URE_PIKEVM
+#include "re1.5/pikevm.c"
+#else
 #include "re1.5/recursiveloop.c"
+#endif
 #include "re1.5/charclass.c"
 
 #endif //MICROPY_PY_URE
@@ -35,7 +35,9 @@
 
 #if MICROPY_PY_UZLIB
 
+#define TINF_FAST_BITS MICROPY_PY_UZLIB_FAST_BITS
 #include "../../lib/uzlib/src/tinf.h"
+#include "../../lib/uzlib/src/defl_static.h"
 
 #if 0 // print debugging info
 #define DEBUG_printf DEBUG_printf
@@ -48,6 +50,9 @@ typedef struct _mp_obj_decompio_t {
     mp_obj_t src_stream;
     TINF_DATA decomp;
     bool eof;
+    // If set, source data is read ahead into this buffer in chunks
+    byte *src_buf;
+    mp_uint_t src_buf_size;
 } mp_obj_decompio_t;
 
 STATIC unsigned char read_src_stream(TINF_DATA *data) {
@@ -55,21 +60,31 @@ STATIC unsigned char read_src_stream(TINF_DATA *data) {
     p -= offsetof(mp_obj_decompio_t, decomp);
     mp_obj_decompio_t *self = (mp_obj_decompio_t*)p;
 
-    const mp_stream_p_t *stream = mp_get_stream(self->src_stream);
     int err;
     byte c;
-    mp_uint_t out_sz = stream->read(self->src_stream, &c, 1, &err);
-    if (out_sz == MP_STREAM_ERROR) {
+    byte *buf = self->src_buf;
+    mp_uint_t size = self->src_buf_size;
+    if (buf == NULL) {
+        // unbuffered: take exactly the bytes needed from the source
+        buf = &c;
+        size = 1;
+    }
+    mp_uint_t out_sz = mp_stream_rw(self->src_stream, buf, size, &err, MP_STREAM_RW_READ | MP_STREAM_RW_ONCE);
+    if (err != 0) {
         mp_raise_OSError(err);
     }
     if (out_sz == 0) {
         nlr_raise(mp_obj_new_exception(&mp_type_EOFError));
     }
-    return c;
+    if (self->src_buf != NULL) {
+        data->source = buf + 1;
+        data->source_limit = buf + out_sz;
+    }
+    return buf[0];
 }
 
 STATIC mp_obj_t decompio_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
-    mp_arg_check_num(n_args, n_kw, 1, 2, false);
+    mp_arg_check_num(n_args, n_kw, 1, 3, false);
     mp_get_stream_raise(args[0], MP_STREAM_OP_READ);
     mp_obj_decompio_t *o = m_new_obj(mp_obj_decompio_t);
     o->base.type = type;
@@ -77,6 +92,15 @@ STATIC mp_obj_t decompio_make_new(const mp_obj_type_t *type, size_t n_args, size
     o->decomp.readSource = read_src_stream;
     o->src_stream = args[0];
     o->eof = false;
+    o->src_buf = NULL;
+    o->src_buf_size = 0;
+    if (n_args > 2) {
+        mp_int_t bufsize = mp_obj_get_int(args[2]);
+        if (bufsize > 1) {
+            o->src_buf_size = bufsize;
+            o->src_buf = m_new(byte, bufsize);
+        }
+    }
 
     mp_int_t dict_opt = 0;
     int dict_sz;
@@ -144,6 +168,198 @@ STATIC const mp_obj_type_t decompio_type = {
     .locals_dict = (void*)&decompio_locals_dict,
 };
 
+// Compressed output is staged here before being written to the stream
+#define COMPIO_BUF_SIZE (64)
+
+typedef struct _mp_obj_compio_t {
+    mp_obj_base_t base;
+    // Destination stream, or MP_OBJ_NULL when compressing into vstr
+    mp_obj_t dest_stream;
+    vstr_t *vstr;
+    struct uzlib_lz77 comp;
+    int8_t wbits;
+    bool closed;
+    uint32_t checksum;
+    uint32_t in_len;
+    uint16_t buf_len;
+    byte buf[COMPIO_BUF_SIZE];
+} mp_obj_compio_t;
+
+STATIC void compio_flush_buf(mp_obj_compio_t *self) {
+    if (self->dest_stream == MP_OBJ_NULL) {
+        vstr_add_strn(self->vstr, (const char*)self->buf, self->buf_len);
+    } else {
+        int err;
+        mp_uint_t out_sz = mp_stream_write_exactly(self->dest_stream, self->buf, self->buf_len, &err);
+        if (err != 0) {
+            mp_raise_OSError(err);
+        }
+        (void)out_sz;
+    }
+    self->buf_len = 0;
+}
+
+STATIC void compio_write_byte(mp_obj_compio_t *self, byte b) {
+    self->buf[self->buf_len++] = b;
+    if (self->buf_len == COMPIO_BUF_SIZE) {
+        compio_flush_buf(self);
+    }
+}
+
+STATIC void compio_write_out(struct Outbuf *out, uint8_t b) {
+    byte *p = (void*)out;
+    p -= offsetof(mp_obj_compio_t, comp.out);
+    compio_write_byte((mp_obj_compio_t*)p, b);
+}
+
+// wbits follows decompress: 8..15 for a zlib stream, 24..31 for gzip and
+// -8..-15 for raw deflate. The history window is 2**(wbits & 15) bytes and
+// the hash table a quarter of that in entries, so memory use is about 1.5
+// times the window.
+STATIC void compio_init(mp_obj_compio_t *self, mp_int_t wbits) {
+    int window_bits = wbits < 0 ? -wbits : wbits & 15;
+    if (window_bits < 8 || window_bits > 15 || (wbits > 15 && wbits < 24) || wbits > 31) {
+        mp_raise_ValueError(NULL);
+    }
+    self->wbits = wbits;
+    self->closed = false;
+    self->in_len = 0;
+    self->buf_len = 0;
+    memset(&self->comp.out, 0, sizeof(self->comp.out));
+    self->comp.out.dest_write_cb = compio_write_out;
+    size_t hist_size = 1 << window_bits;
+    int hash_bits = window_bits - 2;
+    uzlib_lz77_init(&self->comp, m_new(byte, hist_size), hist_size,
+        m_new(uint16_t, 1 << hash_bits), hash_bits);
+
+    if (wbits > 15) {
+        // gzip header: no flags, no mtime, unknown OS
+        static const byte gzip_header[] = {0x1f, 0x8b, 0x08, 0x00, 0, 0, 0, 0, 0x00, 0xff};
+        for (size_t i = 0; i < sizeof(gzip_header); i++) {
+            compio_write_byte(self, gzip_header[i]);
+        }
+        self->checksum = ~0;
+    } else if (wbits > 0) {
+        // zlib header: deflate with the window size, check bits for FLG
+        byte cmf = ((window_bits - 8) << 4) | 8;
+        compio_write_byte(self, cmf);
+        compio_write_byte(self, 31 - (cmf << 8) % 31);
+        self->checksum = 1;
+    }
+    zlib_start_block(&self->comp.out);
+}
+
+STATIC void compio_compress(mp_obj_compio_t *self, const byte *buf, size_t len) {
+    uzlib_lz77_compress(&self->comp, buf, len);
+    if (self->wbits > 15) {
+        self->checksum = uzlib_crc32(buf, len, self->checksum);
+    } else if (self->wbits > 0) {
+        self->checksum = uzlib_adler32(buf, len, self->checksum);
+    }
+    self->in_len += len;
+}
+
+STATIC void compio_finish(mp_obj_compio_t *self) {
+    zlib_finish_block(&self->comp.out);
+    if (self->wbits > 15) {
+        uint32_t crc = ~self->checksum;
+        for (int i = 0; i < 4; i++) {
+            compio_write_byte(self, crc >> (i * 8));
+        }
+        for (int i = 0; i < 4; i++) {
+            compio_write_byte(self, self->in_len >> (i * 8));
+        }
+    } else if (self->wbits > 0) {
+        for (int i = 3; i >= 0; i--) {
+            compio_write_byte(self, self->checksum >> (i * 8));
+        }
+    }
+    compio_flush_buf(self);
+    self->closed = true;
+}
+
+STATIC mp_obj_t compio_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 1, 2, false);
+    mp_get_stream_raise(args[0], MP_STREAM_OP_WRITE);
+    mp_obj_compio_t *o = m_new_obj(mp_obj_compio_t);
+    o->base.type = type;
+    o->dest_stream = args[0];
+    o->vstr = NULL;
+    mp_int_t wbits = 10;
+    if (n_args > 1) {
+        wbits = mp_obj_get_int(args[1]);
+    }
+    compio_init(o, wbits);
+    return MP_OBJ_FROM_PTR(o);
+}
+
+STATIC mp_uint_t compio_write(mp_obj_t o_in, const void *buf, mp_uint_t size, int *errcode) {
+    mp_obj_compio_t *o = MP_OBJ_TO_PTR(o_in);
+    if (o->closed) {
+        *errcode = MP_EINVAL;
+        return MP_STREAM_ERROR;
+    }
+    compio_compress(o, buf, size);
+    return size;
+}
+
+STATIC mp_uint_t compio_ioctl(mp_obj_t o_in, mp_uint_t request, uintptr_t arg, int *errcode) {
+    (void)arg;
+    mp_obj_compio_t *o = MP_OBJ_TO_PTR(o_in);
+    if (request == MP_STREAM_CLOSE) {
+        // terminates the compressed stream; the destination stays open
+        if (!o->closed) {
+            compio_finish(o);
+        }
+        return 0;
+    }
+    *errcode = MP_EINVAL;
+    return MP_STREAM_ERROR;
+}
+
+STATIC const mp_rom_map_elem_t compio_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_write), MP_ROM_PTR(&mp_stream_write_obj) },
+    { MP_ROM_QSTR(MP_QSTR_close), MP_ROM_PTR(&mp_stream_close_obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(compio_locals_dict, compio_locals_dict_table);
+
+STATIC const mp_stream_p_t compio_stream_p = {
+    .write = compio_write,
+    .ioctl = compio_ioctl,
+};
+
+STATIC const mp_obj_type_t compio_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_CompIO,
+    .make_new = compio_make_new,
+    .protocol = &compio_stream_p,
+    .locals_dict = (void*)&compio_locals_dict,
+};
+
+STATIC mp_obj_t mod_uzlib_compress(size_t n_args, const mp_obj_t *args) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[0], &bufinfo, MP_BUFFER_READ);
+    mp_int_t wbits = 10;
+    if (n_args > 1) {
+        wbits = mp_obj_get_int(args[1]);
+    }
+
+    vstr_t vstr;
+    vstr_init(&vstr, bufinfo.len / 2 + 16);
+    mp_obj_compio_t *comp = m_new_obj(mp_obj_compio_t);
+    comp->dest_stream = MP_OBJ_NULL;
+    comp->vstr = &vstr;
+    compio_init(comp, wbits);
+    compio_compress(comp, bufinfo.buf, bufinfo.len);
+    compio_finish(comp);
+    m_del(byte, comp->comp.hist, comp->comp.hist_mask + 1);
+    m_del(uint16_t, comp->comp.hash, 1 << comp->comp.hash_bits);
+    m_del_obj(mp_obj_compio_t, comp);
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_uzlib_compress_obj, 1, 2, mod_uzlib_compress);
+
 STATIC mp_obj_t mod_uzlib_decompress(size_t n_args, const mp_obj_t *args) {
     mp_obj_t data = args[0];
     mp_buffer_info_t bufinfo;
@@ -160,6 +376,7 @@ STATIC mp_obj_t mod_uzlib_decompress(size_t n_args, const mp_obj_t *args) {
     decomp->destSize = dest_buf_size;
     DEBUG_printf("uzlib: Initial out buffer: " UINT_FMT " bytes\n", decomp->destSize);
     decomp->source = bufinfo.buf;
+    decomp->source_limit = (byte*)bufinfo.buf + bufinfo.len;
 
     int st;
     bool is_zlib = true;
@@ -206,6 +423,8 @@ STATIC const mp_rom_map_elem_t mp_module_uzlib_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_uzlib) },
     { MP_ROM_QSTR(MP_QSTR_decompress), MP_ROM_PTR(&mod_uzlib_decompress_obj) },
     { MP_ROM_QSTR(MP_QSTR_DecompIO), MP_ROM_PTR(&decompio_type) },
+    { MP_ROM_QSTR(MP_QSTR_compress), MP_ROM_PTR(&mod_uzlib_compress_obj) },
+    { MP_ROM_QSTR(MP_QSTR_CompIO), MP_ROM_PTR(&compio_type) },
 };
 
 STATIC MP_DEFINE_CONST_DICT(mp_module_uzlib_globals, mp_module_uzlib_globals_table);
@@ -223,5 +442,7 @@ const mp_obj_module_t mp_module_uzlib = {
 #include "../../lib/uzlib/src/tinfgzip.c"
 #include "../../lib/uzlib/src/adler32.c"
 #include "../../lib/uzlib/src/crc32.c"
+#include "../../lib/uzlib/src/defl_static.c"
+#include "../../lib/uzlib/src/genlz77.c"
 
 #endif // MICROPY_PY_UZLIB
@@ -0,0 +1,177 @@
+// Copyright 2007-2009 Russ Cox.  All Rights Reserved.
+// Copyright 2014 Paul Sokolovsky.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#include "re1.5.h"
+
+// Pike VM: runs all threads of the program in lock step over the subject,
+// so matching is O(len(prog) * len(subject)) regardless of the pattern,
+// with no recursion on the subject length.
+
+typedef struct Pike Pike;
+typedef struct ThreadList ThreadList;
+
+struct ThreadList
+{
+	int n;
+	int *pc;
+	const char **sub;	// n * nsub capture slots
+};
+
+struct Pike
+{
+	const char *insts;
+	Subject *input;
+	int nsub;
+	int gen;
+	int *mark;	// per-pc generation the pc was last added in
+};
+
+static void
+addthread(Pike *p, ThreadList *l, int pc, const char *sp, const char **sub)
+{
+	const char *old;
+	int off;
+
+	re1_5_stack_chk();
+
+	if(p->mark[pc] == p->gen)
+		return;
+	p->mark[pc] = p->gen;
+
+	switch(p->insts[pc]) {
+	case Jmp:
+		off = (signed char)p->insts[pc + 1];
+		addthread(p, l, pc + 2 + off, sp, sub);
+		return;
+	case Split:
+		off = (signed char)p->insts[pc + 1];
+		addthread(p, l, pc + 2, sp, sub);
+		addthread(p, l, pc + 2 + off, sp, sub);
+		return;
+	case RSplit:
+		off = (signed char)p->insts[pc + 1];
+		addthread(p, l, pc + 2 + off, sp, sub);
+		addthread(p, l, pc + 2, sp, sub);
+		return;
+	case Save:
+		off = (unsigned char)p->insts[pc + 1];
+		if(off >= p->nsub) {
+			addthread(p, l, pc + 2, sp, sub);
+			return;
+		}
+		old = sub[off];
+		sub[off] = sp;
+		addthread(p, l, pc + 2, sp, sub);
+		sub[off] = old;
+		return;
+	case Bol:
+		if(sp == p->input->begin)
+			addthread(p, l, pc + 1, sp, sub);
+		return;
+	case Eol:
+		if(sp == p->input->end)
+			addthread(p, l, pc + 1, sp, sub);
+		return;
+	}
+
+	// Consumer or Match: becomes a thread for the next step
+	l->pc[l->n] = pc;
+	memcpy((char**)&l->sub[l->n * p->nsub], (char**)sub, p->nsub * sizeof(char*));
+	l->n++;
+}
+
+int
+re1_5_pikevm_worksize(ByteProg *prog, int nsubp)
+{
+	// two thread lists plus the mark array; a list never holds more threads
+	// than there are instructions because each pc is added at most once
+	return prog->bytelen * sizeof(int)
+		+ 2 * prog->len * (sizeof(int) + nsubp * sizeof(char*));
+}
+
+int
+re1_5_pikevmwork(ByteProg *prog, Subject *input, const char **subp, int nsubp, int is_anchored, void *work)
+{
+	Pike p;
+	ThreadList lists[2], *clist, *nlist, *tmp;
+	const char *sp, *pc;
+	const char **sub;
+	int i, matched;
+	char *mem = work;
+
+	p.insts = prog->insts;
+	p.input = input;
+	p.nsub = nsubp;
+	p.gen = 1;
+	for(i = 0; i < 2; i++) {
+		lists[i].n = 0;
+		lists[i].sub = (const char**)mem;
+		mem += prog->len * nsubp * sizeof(char*);
+	}
+	for(i = 0; i < 2; i++) {
+		lists[i].pc = (int*)mem;
+		mem += prog->len * sizeof(int);
+	}
+	p.mark = (int*)mem;
+	memset(p.mark, 0, prog->bytelen * sizeof(int));
+	clist = &lists[0];
+	nlist = &lists[1];
+
+	matched = 0;
+	addthread(&p, clist, HANDLE_ANCHORED(prog->insts, is_anchored) - prog->insts, input->begin, subp);
+
+	for(sp = input->begin; clist->n > 0; sp++) {
+		p.gen++;
+		nlist->n = 0;
+		for(i = 0; i < clist->n; i++) {
+			pc = prog->insts + clist->pc[i];
+			sub = &clist->sub[i * nsubp];
+			if(inst_is_consumer(*pc) && sp >= input->end)
+				continue;
+			switch(*pc) {
+			case Char:
+				if(*sp == pc[1])
+					addthread(&p, nlist, pc + 2 - prog->insts, sp + 1, sub);
+				continue;
+			case Any:
+				addthread(&p, nlist, pc + 1 - prog->insts, sp + 1, sub);
+				continue;
+			case Class:
+			case ClassNot:
+				if(_re1_5_classmatch(pc + 1, sp))
+					addthread(&p, nlist, pc + 2 + *(unsigned char*)(pc + 1) * 2 - prog->insts, sp + 1, sub);
+				continue;
+			case NamedClass:
+				if(_re1_5_namedclassmatch(pc + 1, sp))
+					addthread(&p, nlist, pc + 2 - prog->insts, sp + 1, sub);
+				continue;
+			case Match:
+				// Threads after this one have lower priority: cut them off
+				memcpy((char**)subp, (char**)sub, nsubp * sizeof(char*));
+				matched = 1;
+				break;
+			default:
+				re1_5_fatal("pikevm");
+			}
+			break;
+		}
+		tmp = clist;
+		clist = nlist;
+		nlist = tmp;
+		if(sp >= input->end)
+			break;
+	}
+	return matched;
+}
+
+int
+re1_5_pikevm(ByteProg *prog, Subject *input, const char **subp, int nsubp, int is_anchored)
+{
+	int size = re1_5_pikevm_worksize(prog, nsubp);
+	void *work = re1_5_alloc(size);
+	int res = re1_5_pikevmwork(prog, input, subp, nsubp, is_anchored, work);
+	re1_5_free(work, size);
+	return res;
+}
@@ -51,6 +51,10 @@ void re1_5_fatal(char*);
 #ifndef re1_5_stack_chk
 #define re1_5_stack_chk()
 #endif
+#ifndef re1_5_alloc
+#define re1_5_alloc(size) malloc(size)
+#define re1_5_free(ptr, size) free(ptr)
+#endif
 void *mal(int);
 
 struct Prog
@@ -140,6 +144,8 @@ struct Subject {
 
 int re1_5_backtrack(ByteProg*, Subject*, const char**, int, int);
 int re1_5_pikevm(ByteProg*, Subject*, const char**, int, int);
+int re1_5_pikevm_worksize(ByteProg*, int);
+int re1_5_pikevmwork(ByteProg*, Subject*, const char**, int, int, void*);
 int re1_5_recursiveloopprog(ByteProg*, Subject*, const char**, int, int);
 int re1_5_recursiveprog(ByteProg*, Subject*, const char**, int, int);
 int re1_5_thompsonvm(ByteProg*, Subject*, const char**, int, int);
@@ -30,6 +30,7 @@
 #include "py/runtime.h"
 #include "py/objstr.h"
 #include "py/mperrno.h"
+#include "py/builtin.h"
 #include "extmod/vfs.h"
 
 #if MICROPY_VFS
@@ -100,6 +101,20 @@ STATIC mp_vfs_mount_t *lookup_path(mp_obj_t path_in, mp_obj_t *path_out) {
     return vfs;
 }
 
+#if MICROPY_MODULE_IMPORT_CACHE
+void mp_vfs_import_cache_check(qstr meth_name, const mp_obj_t *args) {
+    // Anything but a query or opening a file for reading may change what
+    // import would find.
+    if (meth_name != MP_QSTR_stat && meth_name != MP_QSTR_statvfs
+        && meth_name != MP_QSTR_ilistdir && meth_name != MP_QSTR_getcwd) {
+        const char *mode = meth_name == MP_QSTR_open ? mp_obj_str_get_str(args[1]) : "w";
+        if (strpbrk(mode, "wax+") != NULL) {
+            mp_import_cache_clear();
+        }
+    }
+}
+#endif
+
 STATIC mp_obj_t mp_vfs_proxy_call(mp_vfs_mount_t *vfs, qstr meth_name, size_t n_args, const mp_obj_t *args) {
     assert(n_args <= PROXY_MAX_ARGS);
     if (vfs == MP_VFS_NONE) {
@@ -110,6 +125,9 @@ STATIC mp_obj_t mp_vfs_proxy_call(mp_vfs_mount_t *vfs, qstr meth_name, size_t n_
         // can't do operation on root dir
         mp_raise_OSError(MP_EPERM);
     }
+    #if MICROPY_MODULE_IMPORT_CACHE
+    mp_vfs_import_cache_check(meth_name, args);
+    #endif
     mp_obj_t meth[2 + PROXY_MAX_ARGS];
     mp_load_method(vfs->obj, meth_name, meth);
     if (args != NULL) {
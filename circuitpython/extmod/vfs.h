@@ -72,6 +72,12 @@ mp_obj_t mp_vfs_ilistdir_it_iternext(mp_obj_t self_in);
 
 mp_vfs_mount_t *mp_vfs_lookup_path(const char *path, const char **path_out);
 mp_import_stat_t mp_vfs_import_stat(const char *path);
+#if MICROPY_MODULE_IMPORT_CACHE
+// Clears the import cache if calling meth_name on a VFS may change what import
+// finds. args[1] is the mode when meth_name is open. Every caller of VFS
+// methods calls this first, including the ones outside this file.
+void mp_vfs_import_cache_check(qstr meth_name, const mp_obj_t *args);
+#endif
 mp_obj_t mp_vfs_mount(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args);
 mp_obj_t mp_vfs_umount(mp_obj_t mnt_in);
 mp_obj_t mp_vfs_open(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args);
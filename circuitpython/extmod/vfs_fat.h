@@ -58,6 +58,12 @@ typedef struct _fs_user_mount_t {
 typedef struct _pyb_file_obj_t {
     mp_obj_base_t base;
     FIL fp;
+    #if _USE_FASTSEEK
+    // Set when the file was opened with the 'f' mode flag.
+    byte *readahead;
+    FSIZE_t readahead_pos;
+    UINT readahead_len;
+    #endif
 } pyb_file_obj_t;
 
 extern const byte fresult_to_errno_table[20];
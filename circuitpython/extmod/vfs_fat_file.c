@@ -28,6 +28,7 @@
 #if MICROPY_VFS && MICROPY_VFS_FAT
 
 #include <stdio.h>
+#include <string.h>
 
 #include "py/runtime.h"
 #include "py/stream.h"
@@ -64,8 +65,71 @@ STATIC void file_obj_print(const mp_print_t *print, mp_obj_t self_in, mp_print_k
     mp_printf(print, "<io.%s %p>", mp_obj_get_type_str(self_in), MP_OBJ_TO_PTR(self_in));
 }
 
+#if _USE_FASTSEEK
+// Serve small reads from a chunk-aligned read-ahead buffer. The FatFs file
+// pointer always tracks the logical position; moving it is cheap because
+// f_lseek only consults the cluster link map.
+STATIC mp_uint_t file_obj_read_ahead(pyb_file_obj_t *self, byte *buf, mp_uint_t size, int *errcode) {
+    FIL *fp = &self->fp;
+    mp_uint_t total = 0;
+    while (size > 0) {
+        FSIZE_t pos = f_tell(fp);
+        FRESULT res;
+        if (pos < self->readahead_pos || pos >= self->readahead_pos + self->readahead_len) {
+            UINT sz_out;
+            if (size >= MICROPY_FATFS_READAHEAD_SIZE) {
+                // Large reads go straight into the caller's buffer.
+                res = f_read(fp, buf, size, &sz_out);
+                if (res != FR_OK) {
+                    *errcode = fresult_to_errno_table[res];
+                    return MP_STREAM_ERROR;
+                }
+                return total + sz_out;
+            }
+            FSIZE_t start = pos - pos % MICROPY_FATFS_READAHEAD_SIZE;
+            self->readahead_len = 0;
+            res = f_lseek(fp, start);
+            if (res == FR_OK) {
+                res = f_read(fp, self->readahead, MICROPY_FATFS_READAHEAD_SIZE, &sz_out);
+            }
+            if (res != FR_OK) {
+                *errcode = fresult_to_errno_table[res];
+                return MP_STREAM_ERROR;
+            }
+            self->readahead_pos = start;
+            self->readahead_len = sz_out;
+            if (pos >= start + sz_out) {
+                // At end of file.
+                f_lseek(fp, pos);
+                break;
+            }
+        }
+        UINT offset = pos - self->readahead_pos;
+        UINT n = self->readahead_len - offset;
+        if (n > size) {
+            n = size;
+        }
+        memcpy(buf, self->readahead + offset, n);
+        res = f_lseek(fp, pos + n);
+        if (res != FR_OK) {
+            *errcode = fresult_to_errno_table[res];
+            return MP_STREAM_ERROR;
+        }
+        buf += n;
+        size -= n;
+        total += n;
+    }
+    return total;
+}
+#endif
+
 STATIC mp_uint_t file_obj_read(mp_obj_t self_in, void *buf, mp_uint_t size, int *errcode) {
     pyb_file_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    #if _USE_FASTSEEK
+    if (self->readahead != NULL) {
+        return file_obj_read_ahead(self, buf, size, errcode);
+    }
+    #endif
     UINT sz_out;
     FRESULT res = f_read(&self->fp, buf, size, &sz_out);
     if (res != FR_OK) {
@@ -132,6 +196,16 @@ STATIC mp_uint_t file_obj_ioctl(mp_obj_t o_in, mp_uint_t request, uintptr_t arg,
     } else if (request == MP_STREAM_CLOSE) {
         // if fs==NULL then the file is closed and in that case this method is a no-op
         if (self->fp.obj.fs != NULL) {
+            #if _USE_FASTSEEK
+            if (self->fp.cltbl != NULL) {
+                m_del(DWORD, self->fp.cltbl, self->fp.cltbl[0]);
+                self->fp.cltbl = NULL;
+            }
+            if (self->readahead != NULL) {
+                m_del(byte, self->readahead, MICROPY_FATFS_READAHEAD_SIZE);
+                self->readahead = NULL;
+            }
+            #endif
             FRESULT res = f_close(&self->fp);
             if (res != FR_OK) {
                 *errcode = fresult_to_errno_table[res];
@@ -155,8 +229,34 @@ STATIC const mp_arg_t file_open_args[] = {
 };
 #define FILE_OPEN_NUM_ARGS MP_ARRAY_SIZE(file_open_args)
 
+#if _USE_FASTSEEK
+// Build the cluster link map of a file opened for reading so that seeks no
+// longer walk the FAT, and give it a read-ahead buffer. Files too fragmented
+// for the map are left in normal mode.
+STATIC void file_enable_fastseek(pyb_file_obj_t *o) {
+    DWORD *cltbl = m_new_maybe(DWORD, MICROPY_FATFS_FASTSEEK_TABLE_SIZE);
+    if (cltbl == NULL) {
+        return;
+    }
+    cltbl[0] = MICROPY_FATFS_FASTSEEK_TABLE_SIZE;
+    o->fp.cltbl = cltbl;
+    FRESULT res = f_lseek(&o->fp, CREATE_LINKMAP);
+    if (res != FR_OK) {
+        o->fp.cltbl = NULL;
+        m_del(DWORD, cltbl, MICROPY_FATFS_FASTSEEK_TABLE_SIZE);
+        return;
+    }
+    // cltbl[0] now holds the number of entries actually used.
+    o->fp.cltbl = m_renew(DWORD, cltbl, MICROPY_FATFS_FASTSEEK_TABLE_SIZE, cltbl[0]);
+    o->readahead = m_new_maybe(byte, MICROPY_FATFS_READAHEAD_SIZE);
+}
+#endif
+
 STATIC mp_obj_t file_open(fs_user_mount_t *vfs, const mp_obj_type_t *type, mp_arg_val_t *args) {
     int mode = 0;
+    #if _USE_FASTSEEK
+    bool fastseek = false;
+    #endif
     const char *mode_s = mp_obj_str_get_str(args[1].u_obj);
     // TODO make sure only one of r, w, x, a, and b, t are specified
     while (*mode_s) {
@@ -184,11 +284,21 @@ STATIC mp_obj_t file_open(fs_user_mount_t *vfs, const mp_obj_type_t *type, mp_ar
             case 't':
                 type = &mp_type_vfs_fat_textio;
                 break;
+            #if _USE_FASTSEEK
+            case 'f':
+                fastseek = true;
+                break;
+            #endif
         }
     }
 
     pyb_file_obj_t *o = m_new_obj_with_finaliser(pyb_file_obj_t);
     o->base.type = type;
+    #if _USE_FASTSEEK
+    o->readahead = NULL;
+    o->readahead_pos = 0;
+    o->readahead_len = 0;
+    #endif
 
     const char *fname = mp_obj_str_get_str(args[0].u_obj);
     assert(vfs != NULL);
@@ -203,6 +313,13 @@ STATIC mp_obj_t file_open(fs_user_mount_t *vfs, const mp_obj_type_t *type, mp_ar
         f_lseek(&o->fp, f_size(&o->fp));
     }
 
+    #if _USE_FASTSEEK
+    // A link map can't grow with the file so only read-only files use it.
+    if (fastseek && mode == FA_READ) {
+        file_enable_fastseek(o);
+    }
+    #endif
+
     return MP_OBJ_FROM_PTR(o);
 }
 
@@ -2136,12 +2136,127 @@ FRESULT dir_read (
 
 
 
+#if _FS_DCACHE
+/*-----------------------------------------------------------------------*/
+/* Directory handling - Directory entry cache                            */
+/*-----------------------------------------------------------------------*/
+
+void f_dcache_clear (
+    FATFS* fs
+)
+{
+    UINT i;
+
+    for (i = 0; i < _FS_DCACHE; i++) fs->dcache[i].dir = 0xFFFFFFFF;
+    fs->dc_next = 0;
+}
+
+
+/* Make the cache key of the name in the directory object. Returns 0 if the
+   name can't be cached (too long, not ASCII or a special lookup). */
+static
+int dcache_key (
+    DIR* dp,
+    char* key,
+    WORD* hash
+)
+{
+    UINT i;
+    WORD h = 0;
+    WCHAR c;
+
+    if (dp->fn[NSFLAG] & (NS_NOLFN | NS_DOT)) return 0;    /* SFN collision checks and dot entries bypass the cache */
+    for (i = 0; i < _DCACHE_NAME; i++) {
+#if _USE_LFN != 0
+        c = dp->obj.fs->lfnbuf[i];
+#else
+        c = (i < 11) ? dp->fn[i] : 0;
+#endif
+        if (c >= 0x80) return 0;
+        if (IsLower(c)) c -= 0x20;
+        key[i] = (char)c;
+        if (c == 0) break;
+        h = (WORD)(h * 31 + c);
+    }
+    if (i == _DCACHE_NAME) return 0;
+    while (i < _DCACHE_NAME) key[i++] = 0;
+    *hash = h;
+    return 1;
+}
+
+
+/* Look the name up in the cache. Returns FR_OK and points dp at the entry on
+   a positive hit, FR_NO_FILE on a negative hit and FR_INT_ERR on a miss. */
+static
+FRESULT dcache_find (
+    DIR* dp,
+    const char* key,
+    WORD hash
+)
+{
+    FATFS *fs = dp->obj.fs;
+    _FDCENT *e;
+    UINT i;
+
+    for (i = 0; i < _FS_DCACHE; i++) {
+        e = &fs->dcache[i];
+        if (e->dir != dp->obj.sclust || e->hash != hash || mem_cmp(e->name, key, _DCACHE_NAME)) continue;
+        if (e->dptr == 0xFFFFFFFF) return FR_NO_FILE;
+        if (move_window(fs, e->sect) != FR_OK) break;
+        dp->dptr = e->dptr; dp->clust = e->clust; dp->sect = e->sect;
+        dp->dir = fs->win + e->dptr % SS(fs);
+#if _USE_LFN != 0
+        dp->blk_ofs = e->blk_ofs;
+#endif
+        if (dp->dir[DIR_Name] == 0 || dp->dir[DIR_Name] == DDEM || (dp->dir[DIR_Attr] & AM_VOL)) break;  /* Stale item */
+        dp->obj.attr = dp->dir[DIR_Attr] & AM_MASK;
+        return FR_OK;
+    }
+    if (i < _FS_DCACHE) e->dir = 0xFFFFFFFF;
+    return FR_INT_ERR;
+}
+
+
+/* Remember the result of a directory scan */
+static
+void dcache_store (
+    DIR* dp,
+    const char* key,
+    WORD hash,
+    FRESULT res
+)
+{
+    FATFS *fs = dp->obj.fs;
+    _FDCENT *e;
+
+    if (res != FR_OK && res != FR_NO_FILE) return;
+    e = &fs->dcache[fs->dc_next];
+    fs->dc_next = (BYTE)((fs->dc_next + 1) % _FS_DCACHE);
+    e->dir = dp->obj.sclust;
+    e->hash = hash;
+    mem_cpy(e->name, key, _DCACHE_NAME);
+    if (res == FR_OK) {
+        e->dptr = dp->dptr; e->clust = dp->clust; e->sect = dp->sect;
+#if _USE_LFN != 0
+        e->blk_ofs = dp->blk_ofs;
+#else
+        e->blk_ofs = 0xFFFFFFFF;
+#endif
+    } else {
+        e->dptr = 0xFFFFFFFF;
+    }
+}
+#endif  /* _FS_DCACHE */
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Directory handling - Find an object in the directory                  */
 /*-----------------------------------------------------------------------*/
 
 static
-FRESULT dir_find (  /* FR_OK(0):succeeded, !=0:error */
+FRESULT dir_scan (  /* FR_OK(0):succeeded, !=0:error */
     DIR* dp         /* Pointer to the directory object with the file name */
 )
 {
@@ -2212,6 +2327,28 @@ FRESULT dir_find (  /* FR_OK(0):succeeded, !=0:error */
 }
 
 
+static
+FRESULT dir_find (  /* FR_OK(0):succeeded, !=0:error */
+    DIR* dp         /* Pointer to the directory object with the file name */
+)
+{
+#if _FS_DCACHE
+    FRESULT res;
+    char key[_DCACHE_NAME];
+    WORD hash;
+
+    if (dp->obj.fs->fs_type == FS_EXFAT || !dcache_key(dp, key, &hash)) return dir_scan(dp);
+    res = dcache_find(dp, key, hash);
+    if (res != FR_INT_ERR) return res;
+    res = dir_scan(dp);
+    dcache_store(dp, key, hash, res);
+    return res;
+#else
+    return dir_scan(dp);
+#endif
+}
+
+
 
 
 #if !_FS_READONLY
@@ -2310,6 +2447,9 @@ FRESULT dir_register (  /* FR_OK:succeeded, FR_DENIED:no free entry or too many
         }
     }
 
+#if _FS_DCACHE
+    f_dcache_clear(fs);     /* Cached lookups in this directory are stale now */
+#endif
     return res;
 }
 
@@ -2358,6 +2498,9 @@ FRESULT dir_remove (    /* FR_OK:Succeeded, FR_DISK_ERR:A disk error */
     }
 #endif
 
+#if _FS_DCACHE
+    f_dcache_clear(fs);     /* Cached lookups in this directory are stale now */
+#endif
     return res;
 }
 
@@ -3040,6 +3183,9 @@ FRESULT find_volume (   /* FR_OK(0): successful, !=0: any error occurred */
 
     fs->fs_type = fmt;  /* FAT sub-type */
     fs->id = ++Fsid;    /* File system mount ID */
+#if _FS_DCACHE
+    f_dcache_clear(fs);
+#endif
 #if _USE_LFN == 1
     fs->lfnbuf = LfnBuf;    /* Static LFN working buffer */
 #if _FS_EXFAT
@@ -3384,7 +3530,21 @@ FRESULT f_read (
             cc = btr / SS(fs);                  /* When remaining bytes >= sector size, */
             if (cc) {                           /* Read maximum contiguous sectors directly */
                 if (csect + cc > fs->csize) {   /* Clip at cluster boundary */
+                    UINT want = cc;
                     cc = fs->csize - csect;
+                    while (cc < want) {         /* Continue into clusters that follow on the disk */
+#if _USE_FASTSEEK
+                        if (fp->cltbl) {
+                            clst = clmt_clust(fp, fp->fptr + (FSIZE_t)cc * SS(fs));
+                        } else
+#endif
+                        {
+                            clst = get_fat(&fp->obj, fp->clust);
+                        }
+                        if (clst != fp->clust + 1) break;   /* Fragmented or error (handled on the next turn) */
+                        fp->clust = clst;
+                        cc += (want - cc < fs->csize) ? want - cc : fs->csize;
+                    }
                 }
                 if (disk_read(fs->drv, rbuff, sect, cc) != RES_OK) ABORT(fs, FR_DISK_ERR);
 #if !_FS_READONLY && _FS_MINIMIZE <= 2          /* Replace one of the read sectors with cached data if it contains a dirty sector */
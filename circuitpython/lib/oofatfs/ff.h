@@ -102,6 +102,24 @@ typedef DWORD FSIZE_t;
 
 
 
+#if _FS_DCACHE
+/* Directory entry cache item (_FDCENT) */
+
+#define _DCACHE_NAME    24      /* Longest name (with terminator) that is cached */
+
+typedef struct {
+    DWORD   dir;        /* Start cluster of the directory holding the name (0xFFFFFFFF:unused) */
+    DWORD   dptr;       /* Offset of the SFN entry in the directory (0xFFFFFFFF:no such name) */
+    DWORD   clust;      /* Cluster holding the SFN entry */
+    DWORD   sect;       /* Sector holding the SFN entry */
+    DWORD   blk_ofs;    /* Offset of the entry block (0xFFFFFFFF:no LFN) */
+    WORD    hash;       /* Hash of name[] */
+    char    name[_DCACHE_NAME]; /* Up-cased name */
+} _FDCENT;
+#endif
+
+
+
 /* File system object structure (FATFS) */
 
 typedef struct {
@@ -147,6 +165,10 @@ typedef struct {
     DWORD   dirbase;        /* Root directory base sector/cluster */
     DWORD   database;       /* Data base sector */
     DWORD   winsect;        /* Current sector appearing in the win[] */
+#if _FS_DCACHE
+    BYTE    dc_next;        /* Next directory cache item to replace */
+    _FDCENT dcache[_FS_DCACHE]; /* Directory entry cache */
+#endif
     BYTE    win[_MAX_SS];   /* Disk access window for Directory, FAT (and file data at tiny cfg) */
 } FATFS;
 
@@ -292,6 +314,9 @@ FRESULT f_mount (FATFS* fs);                                        /* Mount/Unm
 FRESULT f_umount (FATFS* fs);                                       /* Unmount a logical drive */
 FRESULT f_mkfs (FATFS *fs, BYTE opt, DWORD au, void* work, UINT len); /* Create a FAT volume */
 FRESULT f_fdisk (void *pdrv, const DWORD* szt, void* work);         /* Divide a physical drive into some partitions */
+#if _FS_DCACHE
+void f_dcache_clear (FATFS* fs);                                    /* Forget cached directory lookups */
+#endif
 
 #define f_eof(fp) ((int)((fp)->fptr == (fp)->obj.objsize))
 #define f_error(fp) ((fp)->err)
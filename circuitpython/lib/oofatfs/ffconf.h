@@ -74,7 +74,11 @@
 /* This option switches f_mkfs() function. (0:Disable or 1:Enable) */
 
 
+#ifdef MICROPY_FATFS_USE_FASTSEEK
+#define _USE_FASTSEEK   (MICROPY_FATFS_USE_FASTSEEK)
+#else
 #define _USE_FASTSEEK   0
+#endif
 /* This option switches fast seek function. (0:Disable or 1:Enable) */
 
 
@@ -296,6 +300,22 @@
 /  These options have no effect at read-only configuration (_FS_READONLY = 1). */
 
 
+#ifdef MICROPY_FATFS_DCACHE
+#define _FS_DCACHE  (MICROPY_FATFS_DCACHE)
+#else
+#define _FS_DCACHE  0
+#endif
+/* The option _FS_DCACHE sets the number of name lookups remembered per volume.
+/  Each entry maps a directory and a short ASCII name to the position of its
+/  directory entry, or records that the name does not exist, so repeated opens
+/  and stats of the same path skip the directory scan. The cache is cleared
+/  whenever a directory is modified. When the volume is changed underneath
+/  FatFs (e.g. by USB mass storage), f_dcache_clear() must be called.
+/
+/  0:  Disable directory entry cache.
+/  >0: Number of cache entries, each about 48 bytes in the FATFS object. */
+
+
 #define _FS_LOCK    0
 /* The option _FS_LOCK switches file lock function to control duplicated file open
 /  and illegal operation to open objects. This option must be 0 when _FS_READONLY
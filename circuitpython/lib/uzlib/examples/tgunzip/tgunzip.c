@@ -104,6 +104,8 @@ int main(int argc, char *argv[])
 
     TINF_DATA d;
     d.source = source;
+    d.source_limit = source + len;
+    d.readSource = NULL;
 
     res = uzlib_gzip_parse_header(&d);
     if (res != TINF_OK) {
@@ -65,11 +65,15 @@ void outbits(struct Outbuf *out, unsigned long bits, int nbits)
     out->outbits |= bits << out->noutbits;
     out->noutbits += nbits;
     while (out->noutbits >= 8) {
-        if (out->outlen >= out->outsize) {
-            out->outsize = out->outlen + 64;
-            out->outbuf = sresize(out->outbuf, out->outsize, unsigned char);
+        if (out->dest_write_cb) {
+            out->dest_write_cb(out, out->outbits & 0xFF);
+        } else {
+            if (out->outlen >= out->outsize) {
+                out->outsize = out->outlen + 64;
+                out->outbuf = sresize(out->outbuf, out->outsize, unsigned char);
+            }
+            out->outbuf[out->outlen++] = (unsigned char) (out->outbits & 0xFF);
         }
-        out->outbuf[out->outlen++] = (unsigned char) (out->outbits & 0xFF);
         out->outbits >>= 8;
         out->noutbits -= 8;
     }
@@ -1,9 +1,17 @@
+#ifndef DEFL_STATIC_H_INCLUDED
+#define DEFL_STATIC_H_INCLUDED
+
+#include <stdint.h>
+
 struct Outbuf {
     unsigned char *outbuf;
     int outlen, outsize;
     unsigned long outbits;
     int noutbits;
     int comp_disabled;
+    /* If set, completed output bytes are passed to this function instead
+       of being accumulated in outbuf */
+    void (*dest_write_cb)(struct Outbuf *out, uint8_t byte);
 };
 
 void outbits(struct Outbuf *out, unsigned long bits, int nbits);
@@ -11,3 +19,22 @@ void zlib_start_block(struct Outbuf *ctx);
 void zlib_finish_block(struct Outbuf *ctx);
 void zlib_literal(struct Outbuf *ectx, unsigned char c);
 void zlib_match(struct Outbuf *ectx, int distance, int len);
+
+/* Streaming LZ77 compressor. Matches are looked for in a history ring
+   buffer of hist_size bytes (a power of 2, at most 32768), located through
+   a hash table of (1 << hash_bits) entries. Both are supplied by the caller,
+   so memory use is bounded by the window chosen. */
+struct uzlib_lz77 {
+    struct Outbuf out;
+    uint8_t *hist;
+    unsigned int hist_mask;
+    unsigned int hist_idx;  /* ring position of the next input byte */
+    unsigned int hist_len;  /* number of valid bytes in the ring */
+    uint16_t *hash;
+    unsigned int hash_bits;
+};
+
+void uzlib_lz77_init(struct uzlib_lz77 *s, uint8_t *hist, unsigned int hist_size, uint16_t *hash, unsigned int hash_bits);
+void uzlib_lz77_compress(struct uzlib_lz77 *s, const uint8_t *src, unsigned slen);
+
+#endif /* DEFL_STATIC_H_INCLUDED */
@@ -114,3 +114,67 @@ void uzlib_compress(void *data, const uint8_t *src, unsigned slen)
         literal(data, *src++);
     }
 }
+
+/* Hash of 3 bytes for the streaming compressor, sized by hash_bits */
+static inline int hash_n(const uint8_t *p, unsigned int bits) {
+    int v = (p[0] << 16) | (p[1] << 8) | p[2];
+    return ((v >> (3*8 - bits)) - v) & ((1 << bits) - 1);
+}
+
+void uzlib_lz77_init(struct uzlib_lz77 *s, uint8_t *hist, unsigned int hist_size, uint16_t *hash, unsigned int hash_bits)
+{
+    s->hist = hist;
+    s->hist_mask = hist_size - 1;
+    s->hist_idx = 0;
+    s->hist_len = 0;
+    s->hash = hash;
+    s->hash_bits = hash_bits;
+    memset(hash, 0, sizeof(uint16_t) << hash_bits);
+}
+
+/* Compress a chunk of a stream. Matches may reach back into the history of
+   previous chunks, but do not extend past the end of this one. */
+void uzlib_lz77_compress(struct uzlib_lz77 *s, const uint8_t *src, unsigned slen)
+{
+    const uint8_t *end = src + slen;
+    while (src < end) {
+        unsigned int len = 0;
+        unsigned int dist = 0;
+        if (end - src >= MIN_MATCH) {
+            int h = hash_n(src, s->hash_bits);
+            unsigned int cand = s->hash[h];
+            dist = (s->hist_idx - cand) & s->hist_mask;
+            /* Hash entries may be stale or collide, so the bytes are always
+               compared; bytes of the match beyond the history come from
+               the input itself (overlapping copy) */
+            if (dist != 0 && dist <= s->hist_len) {
+                unsigned int max = end - src;
+                if (max > MAX_MATCH) {
+                    max = MAX_MATCH;
+                }
+                while (len < max
+                    && (len < dist ? s->hist[(cand + len) & s->hist_mask] : src[len - dist]) == src[len]) {
+                    len++;
+                }
+            }
+        }
+        if (len >= MIN_MATCH) {
+            copy(&s->out, dist, len);
+        } else {
+            len = 1;
+            literal(&s->out, *src);
+        }
+        /* Append the consumed bytes to the history, hashing each position */
+        for (unsigned int i = 0; i < len; i++, src++) {
+            if (end - src >= MIN_MATCH) {
+                s->hash[hash_n(src, s->hash_bits)] = s->hist_idx;
+            }
+            s->hist[s->hist_idx] = *src;
+            s->hist_idx = (s->hist_idx + 1) & s->hist_mask;
+        }
+        s->hist_len += len;
+        if (s->hist_len > s->hist_mask) {
+            s->hist_len = s->hist_mask;
+        }
+    }
+}
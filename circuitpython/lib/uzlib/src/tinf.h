@@ -39,19 +39,35 @@ extern "C" {
 #define TINF_CHKSUM_ADLER 1
 #define TINF_CHKSUM_CRC   2
 
+/* Number of bits resolved by a single lookup when decoding a Huffman
+   symbol; longer codes fall back to walking the tree bit by bit. Each
+   tree carries a table of (1 << TINF_FAST_BITS) entries, 0 disables it. */
+#ifndef TINF_FAST_BITS
+#define TINF_FAST_BITS 9
+#endif
+
 /* data structures */
 
 typedef struct {
    unsigned short table[16];  /* table of code length counts */
    unsigned short trans[288]; /* code -> symbol translation table */
+#if TINF_FAST_BITS
+   /* next TINF_FAST_BITS input bits -> code length << 9 | symbol,
+      0 if the code is longer than TINF_FAST_BITS */
+   unsigned short fast[1 << TINF_FAST_BITS];
+#endif
 } TINF_TREE;
 
 struct TINF_DATA;
 typedef struct TINF_DATA {
    const unsigned char *source;
-   /* If source above is NULL, this function will be used to read
-      next byte from source stream */
+   /* Bytes are taken from source until it reaches source_limit. After
+      that, this function is used to read next byte from source stream; it
+      may also refill source and source_limit. If it is NULL, reading past
+      source_limit sets eof and yields zero bytes. */
+   const unsigned char *source_limit;
    unsigned char (*readSource)(struct TINF_DATA *data);
+   char eof;
 
    unsigned int tag;
    unsigned int bitcount;
@@ -112,6 +112,29 @@ static void tinf_build_bits_base(unsigned char *bits, unsigned short *base, int
 }
 #endif
 
+#if TINF_FAST_BITS
+/* build the lookup table for codes up to TINF_FAST_BITS long from the
+   canonical code described by table and trans */
+static void tinf_build_fast(TINF_TREE *t)
+{
+   unsigned int len, i, k, code, rev, j;
+
+   for (i = 0; i < (1 << TINF_FAST_BITS); ++i) t->fast[i] = 0;
+
+   for (k = 0, code = 0, len = 1; len <= TINF_FAST_BITS; ++len, code <<= 1)
+   {
+      for (i = 0; i < t->table[len]; ++i, ++k, ++code)
+      {
+         /* codes are sent most significant bit first, so the table is
+            indexed by the bit-reversed code */
+         for (rev = 0, j = 0; j < len; ++j) rev |= ((code >> j) & 1) << (len - 1 - j);
+         for (j = rev & ((1 << TINF_FAST_BITS) - 1); j < (1 << TINF_FAST_BITS); j += 1 << len)
+            t->fast[j] = len << 9 | t->trans[k];
+      }
+   }
+}
+#endif
+
 /* build the fixed huffman trees */
 static void tinf_build_fixed_trees(TINF_TREE *lt, TINF_TREE *dt)
 {
@@ -135,6 +158,11 @@ static void tinf_build_fixed_trees(TINF_TREE *lt, TINF_TREE *dt)
    dt->table[5] = 32;
 
    for (i = 0; i < 32; ++i) dt->trans[i] = i;
+
+#if TINF_FAST_BITS
+   tinf_build_fast(lt);
+   tinf_build_fast(dt);
+#endif
 }
 
 /* given an array of code lengths, build a tree */
@@ -163,6 +191,10 @@ static void tinf_build_tree(TINF_TREE *t, const unsigned char *lengths, unsigned
    {
       if (lengths[i]) t->trans[offs[lengths[i]]++] = i;
    }
+
+#if TINF_FAST_BITS
+   tinf_build_fast(t);
+#endif
 }
 
 /* ---------------------- *
@@ -171,10 +203,14 @@ static void tinf_build_tree(TINF_TREE *t, const unsigned char *lengths, unsigned
 
 unsigned char uzlib_get_byte(TINF_DATA *d)
 {
-    if (d->source) {
+    if (d->source < d->source_limit) {
         return *d->source++;
     }
-    return d->readSource(d);
+    if (d->readSource) {
+        return d->readSource(d);
+    }
+    d->eof = 1;
+    return 0;
 }
 
 uint32_t tinf_get_le_uint32(TINF_DATA *d)
@@ -197,22 +233,28 @@ uint32_t tinf_get_be_uint32(TINF_DATA *d)
     return val;
 }
 
+/* The bit buffer: tag holds bitcount not yet used bits, least significant
+   first, with the bits above them clear. Bytes are only loaded when the
+   bits they carry are needed, so after each read fewer than 8 bits are left
+   and nothing past the end of the deflate stream is consumed. */
+
 /* get one bit from source stream */
 static int tinf_getbit(TINF_DATA *d)
 {
    unsigned int bit;
 
    /* check if tag is empty */
-   if (!d->bitcount--)
+   if (!d->bitcount)
    {
       /* load next tag */
       d->tag = uzlib_get_byte(d);
-      d->bitcount = 7;
+      d->bitcount = 8;
    }
 
    /* shift bit out of tag */
    bit = d->tag & 0x01;
    d->tag >>= 1;
+   d->bitcount--;
 
    return bit;
 }
@@ -225,11 +267,15 @@ static unsigned int tinf_read_bits(TINF_DATA *d, int num, int base)
    /* read num bits */
    if (num)
    {
-      unsigned int limit = 1 << (num);
-      unsigned int mask;
+      while (d->bitcount < (unsigned int)num)
+      {
+         d->tag |= (unsigned int)uzlib_get_byte(d) << d->bitcount;
+         d->bitcount += 8;
+      }
 
-      for (mask = 1; mask < limit; mask *= 2)
-         if (tinf_getbit(d)) val += mask;
+      val = d->tag & ((1 << num) - 1);
+      d->tag >>= num;
+      d->bitcount -= num;
    }
 
    return val + base;
@@ -240,6 +286,29 @@ static int tinf_decode_symbol(TINF_DATA *d, TINF_TREE *t)
 {
    int sum = 0, cur = 0, len = 0;
 
+#if TINF_FAST_BITS
+   /* The bits above bitcount are clear, so a lookup with too few bits
+      loaded can only give a code longer than what is loaded (or a long
+      code entry); in either case the next byte is needed anyway. */
+   for (;;)
+   {
+      unsigned int e = t->fast[d->tag & ((1 << TINF_FAST_BITS) - 1)];
+      unsigned int elen = e >> 9;
+
+      if (elen && elen <= d->bitcount)
+      {
+         d->tag >>= elen;
+         d->bitcount -= elen;
+         return e & 0x1ff;
+      }
+      if (d->bitcount >= TINF_FAST_BITS)
+         break;
+
+      d->tag |= (unsigned int)uzlib_get_byte(d) << d->bitcount;
+      d->bitcount += 8;
+   }
+#endif
+
    /* get more bits while code value is above sum */
    do {
 
@@ -405,6 +474,7 @@ static int tinf_inflate_uncompressed_block(TINF_DATA *d)
         d->curlen = length + 1;
 
         /* make sure we start next block on a byte boundary */
+        d->tag = 0;
         d->bitcount = 0;
     }
 
@@ -438,7 +508,9 @@ void uzlib_init(void)
 /* initialize decompression structure */
 void uzlib_uncompress_init(TINF_DATA *d, void *dict, unsigned int dictLen)
 {
+   d->tag = 0;
    d->bitcount = 0;
+   d->eof = 0;
    d->bfinal = 0;
    d->btype = -1;
    d->dict_size = dictLen;
@@ -499,6 +571,11 @@ next_blk:
             return res;
         }
 
+        /* ran off the end of an in-memory source */
+        if (d->eof) {
+            return TINF_DATA_ERROR;
+        }
+
     } while (--d->destSize);
 
     return TINF_OK;
@@ -0,0 +1,2 @@
+const uint8_t lengths[] = { 0, 0, 1, 8, 6, 5, 7, 4, 10, 12, 12, 5, 5, 1, 0, 0, 0, 0, 0, 0, 76, 104 };
+const uint8_t values[256] = { 32, 97, 101, 105, 110, 111, 114, 115, 116, 95, 99, 100, 108, 112, 117, 39, 98, 102, 103, 109, 37, 69, 104, 118, 119, 120, 121, 78, 106, 107, 113, 40, 41, 44, 45, 65, 73, 79, 82, 83, 84, 42, 47, 48, 58, 60, 62, 67, 68, 70, 80, 85, 122, 10, 35, 49, 50, 51, 61, 66, 71, 72, 76, 77, 86, 13, 34, 75, 123, 125, 46, 56, 88, 89, 90, 54, 0, 2, 3, 5, 9, 12, 14, 16, 18, 19, 20, 21, 22, 24, 25, 26, 27, 28, 29, 30, 31, 38, 43, 52, 59, 126, 145, 146, 149, 150, 153, 157, 160, 164, 166, 167, 170, 171, 172, 174, 175, 176, 177, 181, 182, 183, 185, 186, 187, 188, 189, 192, 193, 197, 198, 199, 200, 201, 204, 205, 206, 207, 208, 209, 212, 217, 218, 219, 220, 221, 222, 223, 229, 252, 253, 254, 1, 4, 6, 7, 8, 11, 15, 17, 23, 33, 36, 53, 55, 57, 63, 64, 74, 81, 87, 91, 92, 93, 94, 96, 124, 127, 128, 129, 130, 131, 132, 133, 134, 135, 136, 137, 138, 139, 140, 141, 142, 143, 144, 147, 148, 151, 152, 154, 155, 156, 158, 159, 161, 162, 163, 165, 168, 169, 173, 178, 179, 180, 184, 190, 191, 194, 195, 196, 202, 203, 210, 211, 213, 214, 215, 216, 224, 225, 226, 227, 228, 230, 231, 232, 233, 234, 235, 236, 237, 238, 239, 240, 241, 242, 243, 244, 245, 246, 247, 248, 249, 250, 251, 255 };
@@ -29,8 +29,8 @@
 #include "samd/events.h"
 #include "samd/dma.h"
 
-#include "shared-bindings/audioio/RawSample.h"
-#include "shared-bindings/audioio/WaveFile.h"
+#include "shared-module/audioio/__init__.h"
+#include "shared-module/audioio/convert.h"
 
 #include "py/mpstate.h"
 #include "py/runtime.h"
@@ -40,82 +40,6 @@ static audio_dma_t* audio_dma_state[AUDIO_DMA_CHANNEL_COUNT];
 // This cannot be in audio_dma_state because it's volatile.
 static volatile bool audio_dma_pending[AUDIO_DMA_CHANNEL_COUNT];
 
-uint32_t audiosample_sample_rate(mp_obj_t sample_obj) {
-    if (MP_OBJ_IS_TYPE(sample_obj, &audioio_rawsample_type)) {
-        audioio_rawsample_obj_t* sample = MP_OBJ_TO_PTR(sample_obj);
-        return sample->sample_rate;
-    }
-    if (MP_OBJ_IS_TYPE(sample_obj, &audioio_wavefile_type)) {
-        audioio_wavefile_obj_t* file = MP_OBJ_TO_PTR(sample_obj);
-        return file->sample_rate;
-    }
-    return 16000;
-}
-
-uint8_t audiosample_bits_per_sample(mp_obj_t sample_obj) {
-    if (MP_OBJ_IS_TYPE(sample_obj, &audioio_rawsample_type)) {
-        audioio_rawsample_obj_t* sample = MP_OBJ_TO_PTR(sample_obj);
-        return sample->bits_per_sample;
-    }
-    if (MP_OBJ_IS_TYPE(sample_obj, &audioio_wavefile_type)) {
-        audioio_wavefile_obj_t* file = MP_OBJ_TO_PTR(sample_obj);
-        return file->bits_per_sample;
-    }
-    return 8;
-}
-
-uint8_t audiosample_channel_count(mp_obj_t sample_obj) {
-    if (MP_OBJ_IS_TYPE(sample_obj, &audioio_rawsample_type)) {
-        audioio_rawsample_obj_t* sample = MP_OBJ_TO_PTR(sample_obj);
-        return sample->channel_count;
-    }
-    if (MP_OBJ_IS_TYPE(sample_obj, &audioio_wavefile_type)) {
-        audioio_wavefile_obj_t* file = MP_OBJ_TO_PTR(sample_obj);
-        return file->channel_count;
-    }
-    return 1;
-}
-
-static void audiosample_reset_buffer(mp_obj_t sample_obj, bool single_channel, uint8_t audio_channel) {
-    if (MP_OBJ_IS_TYPE(sample_obj, &audioio_rawsample_type)) {
-        audioio_rawsample_obj_t* sample = MP_OBJ_TO_PTR(sample_obj);
-        audioio_rawsample_reset_buffer(sample, single_channel, audio_channel);
-    }
-    if (MP_OBJ_IS_TYPE(sample_obj, &audioio_wavefile_type)) {
-        audioio_wavefile_obj_t* file = MP_OBJ_TO_PTR(sample_obj);
-        audioio_wavefile_reset_buffer(file, single_channel, audio_channel);
-    }
-}
-
-static audioio_get_buffer_result_t audiosample_get_buffer(mp_obj_t sample_obj,
-                                                          bool single_channel,
-                                                          uint8_t channel,
-                                                          uint8_t** buffer, uint32_t* buffer_length) {
-    if (MP_OBJ_IS_TYPE(sample_obj, &audioio_rawsample_type)) {
-        audioio_rawsample_obj_t* sample = MP_OBJ_TO_PTR(sample_obj);
-        return audioio_rawsample_get_buffer(sample, single_channel, channel, buffer, buffer_length);
-    }
-    if (MP_OBJ_IS_TYPE(sample_obj, &audioio_wavefile_type)) {
-        audioio_wavefile_obj_t* file = MP_OBJ_TO_PTR(sample_obj);
-        return audioio_wavefile_get_buffer(file, single_channel, channel, buffer, buffer_length);
-    }
-    return GET_BUFFER_DONE;
-}
-
-static void audiosample_get_buffer_structure(mp_obj_t sample_obj, bool single_channel,
-                                             bool* single_buffer, bool* samples_signed,
-                                             uint32_t* max_buffer_length, uint8_t* spacing) {
-    if (MP_OBJ_IS_TYPE(sample_obj, &audioio_rawsample_type)) {
-        audioio_rawsample_obj_t* sample = MP_OBJ_TO_PTR(sample_obj);
-        audioio_rawsample_get_buffer_structure(sample, single_channel, single_buffer,
-                                               samples_signed, max_buffer_length, spacing);
-    } else if (MP_OBJ_IS_TYPE(sample_obj, &audioio_wavefile_type)) {
-        audioio_wavefile_obj_t* file = MP_OBJ_TO_PTR(sample_obj);
-        audioio_wavefile_get_buffer_structure(file, single_channel, single_buffer, samples_signed,
-                                              max_buffer_length, spacing);
-    }
-}
-
 uint8_t find_free_audio_dma_channel(void) {
     uint8_t channel;
     for (channel = 0; channel < AUDIO_DMA_CHANNEL_COUNT; channel++) {
@@ -139,25 +63,11 @@ void audio_dma_convert_signed(audio_dma_t* dma, uint8_t* buffer, uint32_t buffer
     if (dma->signed_to_unsigned || dma->unsigned_to_signed) {
         *output_buffer_length = buffer_length / dma->spacing;
         *output_spacing = 1;
-        uint32_t out_i = 0;
         if (dma->bytes_per_sample == 1) {
-            for (uint32_t i = 0; i < buffer_length; i += dma->spacing) {
-                if (dma->signed_to_unsigned) {
-                    ((uint8_t*) *output_buffer)[out_i] = ((int8_t*) buffer)[i] + 0x80;
-                } else {
-                    ((int8_t*) *output_buffer)[out_i] = ((uint8_t*) buffer)[i] - 0x80;
-                }
-                out_i += 1;
-            }
+            audioio_convert_signed_8(*output_buffer, buffer, *output_buffer_length, dma->spacing);
         } else if (dma->bytes_per_sample == 2) {
-            for (uint32_t i = 0; i < buffer_length / 2; i += dma->spacing) {
-                if (dma->signed_to_unsigned) {
-                    ((uint16_t*) *output_buffer)[out_i] = ((int16_t*) buffer)[i] + 0x8000;
-                } else {
-                    ((int16_t*) *output_buffer)[out_i] = ((uint16_t*) buffer)[i] - 0x8000;
-                }
-                out_i += 1;
-            }
+            audioio_convert_signed_16((uint16_t*) *output_buffer, (uint16_t*) buffer,
+                                      *output_buffer_length / 2, dma->spacing);
         }
     } else {
         *output_buffer = buffer;
@@ -334,6 +244,10 @@ audio_dma_result audio_dma_setup_playback(audio_dma_t* dma,
 }
 
 void audio_dma_stop(audio_dma_t* dma) {
+    // The sample is no longer a root pointer so stop background work on it.
+    if (dma->dma_channel < AUDIO_DMA_CHANNEL_COUNT) {
+        audio_dma_state[dma->dma_channel] = NULL;
+    }
     dma_disable_channel(dma->dma_channel);
     disable_event_channel(dma->event_channel);
     MP_STATE_PORT(playing_audio)[dma->dma_channel] = NULL;
@@ -397,15 +311,17 @@ void audio_dma_background(void) {
             continue;
         }
 
-        bool block_done = event_interrupt_active(dma->event_channel);
-        if (!block_done) {
-            continue;
-        }
-
         // audio_dma_load_next_block() can call Python code, which can call audio_dma_background()
         // recursively at the next background processing time. So disallow recursive calls to here.
         audio_dma_pending[i] = true;
-        audio_dma_load_next_block(dma);
+        bool block_done = event_interrupt_active(dma->event_channel);
+        if (block_done) {
+            audio_dma_load_next_block(dma);
+        }
+        // Read ahead while the DMA plays so that the next refill doesn't wait on the file.
+        if (audio_dma_state[i] != NULL) {
+            audiosample_prefetch(dma->sample);
+        }
         audio_dma_pending[i] = false;
     }
 }
@@ -26,6 +26,8 @@
 #include "background.h"
 
 #include "audio_dma.h"
+#include "common-hal/audiobusio/PDMIn.h"
+#include "flash_api.h"
 #include "tick.h"
 #include "usb.h"
 #include "usb_mass_storage.h"
@@ -36,8 +38,12 @@ void run_background_tasks(void) {
     #if (defined(SAMD21) && defined(PIN_PA02)) || defined(SAMD51)
     audio_dma_background();
     #endif
+    #if !defined(__SAMR21G18A__) && !defined(__SAMD51G19A__) && !defined(__SAMD51G18A__)
+    pdmin_background();
+    #endif
     usb_msc_background();
     usb_cdc_background();
+    flash_background();
     last_finished_tick = ticks_ms;
 }
 
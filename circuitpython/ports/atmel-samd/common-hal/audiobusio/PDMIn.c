@@ -36,6 +36,7 @@
 #include "shared-bindings/analogio/AnalogOut.h"
 #include "shared-bindings/audiobusio/PDMIn.h"
 #include "shared-bindings/microcontroller/Pin.h"
+#include "shared-module/audiobusio/pdm.h"
 #include "supervisor/shared/translate.h"
 
 #include "atmel_start_pins.h"
@@ -53,6 +54,11 @@
 
 #define OVERSAMPLING 64
 #define SAMPLES_PER_BUFFER 32
+// Background recording uses bigger buffers so that background tasks can run
+// less often. DMA fills one buffer while the other waits, so a block is lost
+// when background tasks don't run within one buffer's worth of samples. The
+// ring doesn't change that, it only buffers samples for readinto().
+#define RECORDING_SAMPLES_PER_BUFFER 64
 
 // MEMS microphones must be clocked at at least 1MHz.
 #define MIN_MIC_CLOCK 1000000
@@ -65,6 +71,10 @@
 #define SERCTRL(name) I2S_RXCTRL_ ## name
 #endif
 
+// The PDMIn that is recording in the background, if any. It is also a root pointer so that
+// the buffers DMA writes to stay alive.
+static audiobusio_pdmin_obj_t* active_recording = NULL;
+
 void pdmin_reset(void) {
     while (I2S->SYNCBUSY.reg & I2S_SYNCBUSY_ENABLE) {}
     I2S->INTENCLR.reg = I2S_INTENCLR_MASK;
@@ -216,6 +226,7 @@ void common_hal_audiobusio_pdmin_construct(audiobusio_pdmin_obj_t* self,
 
     self->bytes_per_sample = oversample >> 3;
     self->bit_depth = bit_depth;
+    self->recording = false;
 }
 
 bool common_hal_audiobusio_pdmin_deinited(audiobusio_pdmin_obj_t* self) {
@@ -227,6 +238,7 @@ void common_hal_audiobusio_pdmin_deinit(audiobusio_pdmin_obj_t* self) {
         return;
     }
 
+    common_hal_audiobusio_pdmin_stop_recording(self);
     i2s_set_serializer_enable(self->serializer, false);
     i2s_set_clock_unit_enable(self->clock_unit, false);
 
@@ -308,53 +320,13 @@ static void setup_dma(audiobusio_pdmin_obj_t* self, uint32_t length,
     }
 }
 
-// a windowed sinc filter for 44 khz, 64 samples
-//
-// This filter is good enough to use for lower sample rates as
-// well. It does not increase the noise enough to be a problem.
-//
-// In the long run we could use a fast filter like this to do the
-// decimation and initial filtering in real time, filtering to a
-// higher sample rate than specified.  Then after the audio is
-// recorded, a more expensive filter non-real-time filter could be
-// used to down-sample and low-pass.
-uint16_t sinc_filter [OVERSAMPLING] = {
-    0, 2, 9, 21, 39, 63, 94, 132,
-    179, 236, 302, 379, 467, 565, 674, 792,
-    920, 1055, 1196, 1341, 1487, 1633, 1776, 1913,
-    2042, 2159, 2263, 2352, 2422, 2474, 2506, 2516,
-    2506, 2474, 2422, 2352, 2263, 2159, 2042, 1913,
-    1776, 1633, 1487, 1341, 1196, 1055, 920, 792,
-    674, 565, 467, 379, 302, 236, 179, 132,
-    94, 63, 39, 21, 9, 2, 0, 0
-};
-
-#define REPEAT_16_TIMES(X) X X X X X X X X X X X X X X X X
-
-static uint16_t filter_sample(uint32_t pdm_samples[4]) {
-    uint16_t running_sum = 0;
-    const uint16_t *filter_ptr = sinc_filter;
-    for (uint8_t i = 0; i < OVERSAMPLING/16; i++) {
-        // The sample is 16-bits right channel in the upper two bytes and 16-bits left channel
-        // in the lower two bytes.
-        // We just ignore the upper bits
-        uint32_t pdm_sample = pdm_samples[i];
-        REPEAT_16_TIMES( {
-                if (pdm_sample & 0x8000) {
-                    running_sum += *filter_ptr;
-                }
-                filter_ptr++;
-                pdm_sample <<= 1;
-            }
-            )
-    }
-    return running_sum;
-}
-
 // output_buffer may be a byte buffer or a halfword buffer.
 // output_buffer_length is the number of slots, not the number of bytes.
 uint32_t common_hal_audiobusio_pdmin_record_to_buffer(audiobusio_pdmin_obj_t* self,
         uint16_t* output_buffer, uint32_t output_buffer_length) {
+    if (self->recording) {
+        mp_raise_RuntimeError(translate("Serializer in use"));
+    }
     uint8_t dma_channel = find_free_audio_dma_channel();
     uint8_t event_channel = find_sync_event_channel();
     if (event_channel >= EVSYS_SYNCH_NUM) {
@@ -427,17 +399,13 @@ uint32_t common_hal_audiobusio_pdmin_record_to_buffer(audiobusio_pdmin_obj_t* se
         uint32_t samples_gathered = descriptor->BTCNT.reg / words_per_sample;
         // Don't run off the end of output buffer. Process only as many as needed.
         uint32_t samples_to_process = min(remaining_samples_needed, samples_gathered);
-        for (uint32_t i = 0; i < samples_to_process; i++) {
-            // Call filter_sample just one place so it can be inlined.
-            uint16_t value = filter_sample(buffer + i * words_per_sample);
-            if (self->bit_depth == 8) {
-                // Truncate to 8 bits.
-                ((uint8_t*) output_buffer)[values_output] = value >> 8;
-            } else {
-                output_buffer[values_output] = value;
-            }
-            values_output++;
+        if (self->bit_depth == 8) {
+            audiobusio_pdm_filter_8(buffer, samples_to_process,
+                                    ((uint8_t*) output_buffer) + values_output);
+        } else {
+            audiobusio_pdm_filter_16(buffer, samples_to_process, output_buffer + values_output);
         }
+        values_output += samples_to_process;
 
         buffers_processed++;
 
@@ -473,6 +441,156 @@ uint32_t common_hal_audiobusio_pdmin_record_to_buffer(audiobusio_pdmin_obj_t* se
     return values_output;
 }
 
+// Points DMA back at the first buffer and starts it. Used to start recording and to get back in
+// step after a block was missed, when we can't tell which buffer DMA is filling.
+static void start_recording_dma(audiobusio_pdmin_obj_t* self) {
+    uint8_t words_per_sample = self->bytes_per_sample / 2;
+    dma_disable_channel(self->dma_channel);
+    // Asking for exactly two buffers worth chains the descriptors into a loop.
+    setup_dma(self, 2 * RECORDING_SAMPLES_PER_BUFFER, dma_descriptor(self->dma_channel),
+              self->second_descriptor, RECORDING_SAMPLES_PER_BUFFER * words_per_sample,
+              words_per_sample, self->first_buffer, self->second_buffer);
+    self->first_buffer_next = true;
+    // Clear any block done and overflow flags left from before.
+    event_interrupt_active(self->event_channel);
+    dma_enable_channel(self->dma_channel);
+}
+
+void common_hal_audiobusio_pdmin_start_recording(audiobusio_pdmin_obj_t* self,
+        mp_obj_t ring_obj, uint8_t* ring_buffer, uint32_t ring_length) {
+    if (self->recording || active_recording != NULL) {
+        mp_raise_RuntimeError(translate("Serializer in use"));
+    }
+    uint8_t bytes_per_sample = self->bit_depth / 8;
+    // Keep whole samples in the ring and leave room for at least two blocks.
+    ring_length -= ring_length % bytes_per_sample;
+    if (ring_length < 2 * RECORDING_SAMPLES_PER_BUFFER * bytes_per_sample) {
+        mp_raise_ValueError(translate("buffer too small"));
+    }
+    uint8_t dma_channel = find_free_audio_dma_channel();
+    if (dma_channel >= AUDIO_DMA_CHANNEL_COUNT) {
+        mp_raise_RuntimeError(translate("No DMA channel found"));
+    }
+
+    uint32_t words_per_buffer = RECORDING_SAMPLES_PER_BUFFER * (self->bytes_per_sample / 2);
+    self->first_buffer = (uint32_t*) m_malloc(words_per_buffer * sizeof(uint32_t), false);
+    self->second_buffer = (uint32_t*) m_malloc(words_per_buffer * sizeof(uint32_t), false);
+    self->second_descriptor = (DmacDescriptor*) m_malloc(sizeof(DmacDescriptor), false);
+
+    turn_on_event_system();
+    uint8_t event_channel = find_sync_event_channel();
+    if (event_channel >= EVSYS_SYNCH_NUM) {
+        mp_raise_RuntimeError(translate("All sync event channels in use"));
+    }
+
+    audiobusio_ring_init(&self->ring, ring_buffer, ring_length);
+    self->ring_obj = ring_obj;
+    self->overruns = 0;
+    self->dma_channel = dma_channel;
+    self->event_channel = event_channel;
+
+    uint8_t trigger_source = I2S_DMAC_ID_RX_0;
+    #ifdef SAMD21
+    trigger_source += self->serializer;
+    #endif
+    dma_configure(dma_channel, trigger_source, true);
+    init_event_channel_interrupt(event_channel, CORE_GCLK, EVSYS_ID_GEN_DMAC_CH_0 + dma_channel);
+
+    self->recording = true;
+    active_recording = self;
+    MP_STATE_PORT(recording_pdmin) = self;
+
+    // Turn on serializer now to get it in sync with DMA.
+    i2s_set_serializer_enable(self->serializer, true);
+    start_recording_dma(self);
+}
+
+void common_hal_audiobusio_pdmin_stop_recording(audiobusio_pdmin_obj_t* self) {
+    if (!self->recording) {
+        return;
+    }
+    active_recording = NULL;
+    MP_STATE_PORT(recording_pdmin) = NULL;
+    self->recording = false;
+
+    disable_event_channel(self->event_channel);
+    dma_disable_channel(self->dma_channel);
+    // Turn off serializer, but leave clock on, to avoid mic startup delay.
+    i2s_set_serializer_enable(self->serializer, false);
+
+    self->ring_obj = mp_const_none;
+    self->first_buffer = NULL;
+    self->second_buffer = NULL;
+    self->second_descriptor = NULL;
+}
+
+bool common_hal_audiobusio_pdmin_get_recording(audiobusio_pdmin_obj_t* self) {
+    return self->recording;
+}
+
+uint32_t common_hal_audiobusio_pdmin_get_overruns(audiobusio_pdmin_obj_t* self) {
+    return self->overruns;
+}
+
+// output_buffer_length is the number of samples, not the number of bytes.
+uint32_t common_hal_audiobusio_pdmin_readinto(audiobusio_pdmin_obj_t* self,
+        uint8_t* output_buffer, uint32_t output_buffer_length) {
+    // Pick up a block that finished since the last background run.
+    pdmin_background();
+    uint8_t bytes_per_sample = self->bit_depth / 8;
+    return audiobusio_ring_get(&self->ring, output_buffer,
+                               output_buffer_length * bytes_per_sample) / bytes_per_sample;
+}
+
+// WARN(tannewt): DO NOT print from here. Printing calls background tasks such as this and causes a
+// stack overflow.
+
+// Decimates the block DMA just finished into the recording's ring. This is the only producer
+// for the ring so readinto() can drain it at any time.
+void pdmin_background(void) {
+    audiobusio_pdmin_obj_t* self = active_recording;
+    if (self == NULL) {
+        return;
+    }
+    if (event_interrupt_overflow(self->event_channel)) {
+        // A block finished before we took the previous one so at least one is lost.
+        self->overruns++;
+        start_recording_dma(self);
+        return;
+    }
+    if (!event_interrupt_active(self->event_channel)) {
+        return;
+    }
+    uint32_t* buffer = self->first_buffer;
+    if (!self->first_buffer_next) {
+        buffer = self->second_buffer;
+    }
+    self->first_buffer_next = !self->first_buffer_next;
+
+    uint16_t samples[RECORDING_SAMPLES_PER_BUFFER];
+    uint32_t length = RECORDING_SAMPLES_PER_BUFFER;
+    if (self->bit_depth == 8) {
+        audiobusio_pdm_filter_8(buffer, RECORDING_SAMPLES_PER_BUFFER, (uint8_t*) samples);
+    } else {
+        audiobusio_pdm_filter_16(buffer, RECORDING_SAMPLES_PER_BUFFER, samples);
+        length *= sizeof(uint16_t);
+    }
+    // Python isn't reading fast enough. Drop the new block rather than tear one already queued.
+    if (!audiobusio_ring_put(&self->ring, (uint8_t*) samples, length)) {
+        self->overruns++;
+    }
+}
+
+void pdmin_recording_reset(void) {
+    if (active_recording != NULL) {
+        disable_event_channel(active_recording->event_channel);
+        dma_disable_channel(active_recording->dma_channel);
+        i2s_set_serializer_enable(active_recording->serializer, false);
+    }
+    active_recording = NULL;
+    MP_STATE_PORT(recording_pdmin) = NULL;
+}
+
 void common_hal_audiobusio_pdmin_record_to_file(audiobusio_pdmin_obj_t* self, uint8_t* buffer, uint32_t length) {
 
 }
@@ -31,6 +31,9 @@
 
 #include "extmod/vfs_fat.h"
 #include "py/obj.h"
+#include "shared-module/audiobusio/ring.h"
+
+#include "include/sam.h"
 
 typedef struct {
     mp_obj_base_t base;
@@ -42,9 +45,21 @@ typedef struct {
     uint8_t bytes_per_sample;
     uint8_t bit_depth;
     uint8_t gclk;
+    // Background recording state.
+    bool recording;
+    bool first_buffer_next;
+    uint8_t dma_channel;
+    uint8_t event_channel;
+    uint32_t overruns;
+    audiobusio_ring_t ring;
+    mp_obj_t ring_obj;
+    uint32_t* first_buffer;
+    uint32_t* second_buffer;
+    DmacDescriptor* second_descriptor;
 } audiobusio_pdmin_obj_t;
 
 void pdmin_reset(void);
+void pdmin_recording_reset(void);
 
 void pdmin_background(void);
 
@@ -38,30 +38,44 @@
 #include "lib/oofatfs/ff.h"
 #include "shared-bindings/microcontroller/__init__.h"
 #include "supervisor/memory.h"
+#include "supervisor/shared/flash_cache.h"
+#include "supervisor/shared/flash_ftl.h"
+#include "supervisor/shared/flash_journal.h"
 #include "supervisor/shared/rgb_led_status.h"
+#include "tick.h"
 
 #include "hal_gpio.h"
 #include "hal_spi_m_sync.h"
 
 #define SPI_FLASH_PART1_START_BLOCK (0x1)
 
-#define NO_SECTOR_LOADED 0xFFFFFFFF
+#define PAGES_PER_SECTOR (SPI_FLASH_ERASE_SIZE / SPI_FLASH_PAGE_SIZE)
 
 struct spi_m_sync_descriptor spi_flash_desc;
 
-// The currently cached sector in the cache, ram or flash based.
-static uint32_t current_sector;
-
 const external_flash_device possible_devices[EXTERNAL_FLASH_DEVICE_COUNT] = {EXTERNAL_FLASH_DEVICES};
 
 static const external_flash_device* flash_device = NULL;
 
-// Track which blocks (up to 32) in the current sector currently live in the
-// cache.
-static uint32_t dirty_mask;
+// The write-back cache of the filesystem's blocks, unless the FTL is used.
+static flash_cache_t cache;
+
+// Time of the last write into the cache, used to flush it once writes stop.
+static uint64_t last_write_tick;
 
 static supervisor_allocation* supervisor_cache = NULL;
 
+// The filesystem on the flash. Its FAT tells us which sectors are free.
+static fs_user_mount_t* flash_vfs = NULL;
+
+#if SPI_FLASH_FTL
+static flash_ftl_t ftl;
+#endif
+
+#if SPI_FLASH_JOURNAL
+static flash_journal_t journal;
+#endif
+
 // Wait until both the write enable and write in progress bits have cleared.
 static bool wait_for_flash_ready(void) {
     uint8_t read_status_response[1] = {0x00};
@@ -73,6 +87,15 @@ static bool wait_for_flash_ready(void) {
     return ok;
 }
 
+// Returns true while the flash is still programming or erasing.
+static bool flash_busy(void) {
+    uint8_t read_status_response[1] = {0x00};
+    if (!spi_flash_read_command(CMD_READ_STATUS, read_status_response, 1)) {
+        return true;
+    }
+    return (read_status_response[0] & 0x1) != 0;
+}
+
 // Turn on the write enable bit so we can program and erase the flash.
 static bool write_enable(void) {
     return spi_flash_command(CMD_ENABLE_WRITE);
@@ -89,71 +112,31 @@ static bool read_flash(uint32_t address, uint8_t* data, uint32_t data_length) {
     return spi_flash_read_data(address, data, data_length);
 }
 
-// Writes data_length's worth of bytes starting at address from data. Assumes
-// that the sector that address resides in has already been erased. So make sure
-// to run erase_sector.
-static bool write_flash(uint32_t address, const uint8_t* data, uint32_t data_length) {
+// Programs data_length bytes starting at address. Assumes that no bit needs
+// to go from 0 to 1, such as when the sector has been erased. The data
+// doesn't need to be page aligned, it is split at page boundaries.
+static bool program_flash(uint32_t address, const uint8_t* data, uint32_t data_length) {
     if (flash_device == NULL) {
         return false;
     }
-    // Don't bother writing if the data is all 1s. Thats equivalent to the flash
-    // state after an erase.
-    bool all_ones = true;
-    for (uint16_t i = 0; i < data_length; i++) {
-        if (data[i] != 0xff) {
-            all_ones = false;
-            break;
+    while (data_length > 0) {
+        uint32_t length = SPI_FLASH_PAGE_SIZE - address % SPI_FLASH_PAGE_SIZE;
+        if (length > data_length) {
+            length = data_length;
         }
-    }
-    if (all_ones) {
-        return true;
-    }
-
-    for (uint32_t bytes_written = 0;
-        bytes_written < data_length;
-        bytes_written += SPI_FLASH_PAGE_SIZE) {
-        if (!wait_for_flash_ready() || !write_enable()) {
+        if (!wait_for_flash_ready() || !write_enable() ||
+            !spi_flash_write_data(address, (uint8_t*) data, length)) {
             return false;
         }
-
-        if (!spi_flash_write_data(address + bytes_written, (uint8_t*) data + bytes_written,
-                                  SPI_FLASH_PAGE_SIZE)) {
-            return false;
-        }
-    }
-    return true;
-}
-
-static bool page_erased(uint32_t sector_address) {
-    // Check the first few bytes to catch the common case where there is data
-    // without using a bunch of memory.
-    uint8_t short_buffer[4];
-    if (read_flash(sector_address, short_buffer, 4)) {
-        for (uint16_t i = 0; i < 4; i++) {
-            if (short_buffer[i] != 0xff) {
-                return false;
-            }
-        }
-    } else {
-        return false;
-    }
-
-    // Now check the full length.
-    uint8_t full_buffer[FILESYSTEM_BLOCK_SIZE];
-    if (read_flash(sector_address, full_buffer, FILESYSTEM_BLOCK_SIZE)) {
-        for (uint16_t i = 0; i < FILESYSTEM_BLOCK_SIZE; i++) {
-            if (short_buffer[i] != 0xff) {
-                return false;
-            }
-        }
-    } else {
-        return false;
+        address += length;
+        data += length;
+        data_length -= length;
     }
     return true;
 }
 
-// Erases the given sector. Make sure you copied all of the data out of it you
-// need! Also note, sector_address is really 24 bits.
+// Starts erasing the given sector. Make sure you copied all of the data out of
+// it you need! Also note, sector_address is really 24 bits.
 static bool erase_sector(uint32_t sector_address) {
     // Before we erase the sector we need to wait for any writes to finish and
     // and then enable the write again.
@@ -161,26 +144,102 @@ static bool erase_sector(uint32_t sector_address) {
         return false;
     }
 
-    spi_flash_sector_command(CMD_SECTOR_ERASE, sector_address);
-    return true;
+    return spi_flash_sector_command(CMD_SECTOR_ERASE, sector_address);
 }
 
-// Sector is really 24 bits.
-static bool copy_block(uint32_t src_address, uint32_t dest_address) {
-    // Copy page by page to minimize RAM buffer.
-    uint16_t page_size = SPI_FLASH_PAGE_SIZE;
-    uint8_t buffer[page_size];
-    for (uint32_t i = 0; i < FILESYSTEM_BLOCK_SIZE / page_size; i++) {
-        if (!read_flash(src_address + i * page_size, buffer, page_size)) {
-            return false;
+// Finds ram for the cache. Outside the heap we take as many sectors as will
+// fit, backing off a sector at a time until the allocation fits. On the heap
+// we only cache one sector and allocate each page separately so that the GC
+// doesn't need to provide one huge block.
+static uint8_t** allocate_ram_cache(uint8_t max_sectors, uint8_t* sectors) {
+    for (uint8_t count = max_sectors; count > 0; count--) {
+        uint32_t table_size = count * PAGES_PER_SECTOR * sizeof(uint8_t*);
+        supervisor_cache = allocate_memory(table_size + count * SPI_FLASH_ERASE_SIZE, false);
+        if (supervisor_cache == NULL) {
+            continue;
         }
-        if (!write_flash(dest_address + i * page_size, buffer, page_size)) {
-            return false;
+        MP_STATE_VM(flash_ram_cache) = (uint8_t **) supervisor_cache->ptr;
+        uint8_t* page_start = (uint8_t *) supervisor_cache->ptr + table_size;
+        for (uint32_t i = 0; i < count * PAGES_PER_SECTOR; i++) {
+            MP_STATE_VM(flash_ram_cache)[i] = page_start + i * SPI_FLASH_PAGE_SIZE;
         }
+        *sectors = count;
+        return MP_STATE_VM(flash_ram_cache);
     }
-    return true;
+
+    MP_STATE_VM(flash_ram_cache) = m_malloc_maybe(PAGES_PER_SECTOR * sizeof(uint8_t*), false);
+    if (MP_STATE_VM(flash_ram_cache) == NULL) {
+        return NULL;
+    }
+    uint8_t i;
+    for (i = 0; i < PAGES_PER_SECTOR; i++) {
+        uint8_t *page_cache = m_malloc_maybe(SPI_FLASH_PAGE_SIZE, false);
+        if (page_cache == NULL) {
+            break;
+        }
+        MP_STATE_VM(flash_ram_cache)[i] = page_cache;
+    }
+    // We couldn't allocate enough so give back what we got.
+    if (i < PAGES_PER_SECTOR) {
+        while (i > 0) {
+            i--;
+            m_free(MP_STATE_VM(flash_ram_cache)[i]);
+        }
+        m_free(MP_STATE_VM(flash_ram_cache));
+        MP_STATE_VM(flash_ram_cache) = NULL;
+        return NULL;
+    }
+    *sectors = 1;
+    return MP_STATE_VM(flash_ram_cache);
+}
+
+// Gives back the ram used by the cache.
+static void free_ram_cache(uint8_t** pages) {
+    if (supervisor_cache != NULL) {
+        free_memory(supervisor_cache);
+        supervisor_cache = NULL;
+    } else {
+        for (uint8_t i = 0; i < PAGES_PER_SECTOR; i++) {
+            m_free(pages[i]);
+        }
+        m_free(pages);
+    }
+    MP_STATE_VM(flash_ram_cache) = NULL;
 }
 
+static const flash_cache_flash_t cache_flash = {
+    .read = read_flash,
+    .program = program_flash,
+    .erase = erase_sector,
+    .busy = flash_busy,
+    .allocate = allocate_ram_cache,
+    .free = free_ram_cache,
+};
+
+#if SPI_FLASH_FTL
+static const flash_ftl_flash_t ftl_flash = {
+    .read = read_flash,
+    .program = program_flash,
+    .erase = erase_sector,
+    .erase_size = SPI_FLASH_ERASE_SIZE,
+};
+#endif
+
+#if SPI_FLASH_JOURNAL
+static const flash_journal_flash_t journal_flash = {
+    .read = read_flash,
+    .program = program_flash,
+    .erase = erase_sector,
+    .erase_size = SPI_FLASH_ERASE_SIZE,
+};
+
+static bool replay_block(uint32_t address, uint32_t journal_address) {
+    return flash_cache_replay_block(&cache, address, journal_address);
+}
+#endif
+
+static void spi_flash_flush_keep_cache(bool keep_cache);
+
 void external_flash_init(void) {
     if (flash_device != NULL) {
         return;
@@ -259,9 +318,33 @@ void external_flash_init(void) {
 
     wait_for_flash_ready();
 
-    current_sector = NO_SECTOR_LOADED;
-    dirty_mask = 0;
     MP_STATE_VM(flash_ram_cache) = NULL;
+
+    #if SPI_FLASH_FTL
+    // The mapping table lives outside the heap for as long as we run.
+    supervisor_allocation* ftl_ram = allocate_memory(flash_ftl_ram_size(flash_device->total_size), false);
+    if (ftl_ram == NULL || !flash_ftl_init(&ftl, &ftl_flash, flash_device->total_size, ftl_ram->ptr)) {
+        flash_device = NULL;
+    }
+    #else
+    // We keep one erase sector at the end because we may use it as a staging
+    // area for writes. The journal sits just before it.
+    uint32_t scratch_address = flash_device->total_size - SPI_FLASH_ERASE_SIZE;
+    #if SPI_FLASH_JOURNAL
+    uint32_t journal_size = SPI_FLASH_JOURNAL_SECTORS * SPI_FLASH_ERASE_SIZE;
+    flash_cache_init(&cache, &cache_flash, scratch_address - journal_size, scratch_address, &journal);
+    // Put back whatever didn't make it in place before the last reset and
+    // then write it all out so that we start from a clean cache.
+    if (!flash_journal_init(&journal, &journal_flash, scratch_address - journal_size, journal_size)) {
+        flash_device = NULL;
+        return;
+    }
+    flash_journal_replay(&journal, replay_block);
+    spi_flash_flush_keep_cache(false);
+    #else
+    flash_cache_init(&cache, &cache_flash, scratch_address, scratch_address, NULL);
+    #endif
+    #endif
 }
 
 // The size of each individual block.
@@ -271,186 +354,69 @@ uint32_t external_flash_get_block_size(void) {
 
 // The total number of available blocks.
 uint32_t external_flash_get_block_count(void) {
-    // We subtract one erase sector size because we may use it as a staging area
-    // for writes.
-    return SPI_FLASH_PART1_START_BLOCK + (flash_device->total_size - SPI_FLASH_ERASE_SIZE) / FILESYSTEM_BLOCK_SIZE;
+    #if SPI_FLASH_FTL
+    return SPI_FLASH_PART1_START_BLOCK + ftl.block_count;
+    #else
+    return SPI_FLASH_PART1_START_BLOCK + cache.size / FILESYSTEM_BLOCK_SIZE;
+    #endif
 }
 
-// Flush the cache that was written to the scratch portion of flash. Only used
-// when ram is tight.
-static bool flush_scratch_flash(void) {
-    // First, copy out any blocks that we haven't touched from the sector we've
-    // cached.
-    bool copy_to_scratch_ok = true;
-    uint32_t scratch_sector = flash_device->total_size - SPI_FLASH_ERASE_SIZE;
-    for (uint8_t i = 0; i < SPI_FLASH_ERASE_SIZE / FILESYSTEM_BLOCK_SIZE; i++) {
-        if ((dirty_mask & (1 << i)) == 0) {
-            copy_to_scratch_ok = copy_to_scratch_ok &&
-                copy_block(current_sector + i * FILESYSTEM_BLOCK_SIZE,
-                           scratch_sector + i * FILESYSTEM_BLOCK_SIZE);
-        }
-    }
-    if (!copy_to_scratch_ok) {
-        // TODO(tannewt): Do more here. We opted to not erase and copy bad data
-        // in. We still risk losing the data written to the scratch sector.
-        return false;
-    }
-    // Second, erase the current sector.
-    erase_sector(current_sector);
-    // Finally, copy the new version into it.
-    for (uint8_t i = 0; i < SPI_FLASH_ERASE_SIZE / FILESYSTEM_BLOCK_SIZE; i++) {
-        copy_block(scratch_sector + i * FILESYSTEM_BLOCK_SIZE,
-                   current_sector + i * FILESYSTEM_BLOCK_SIZE);
+// Flushes every cached sector. We'll free the cache unless keep_cache is true.
+static void spi_flash_flush_keep_cache(bool keep_cache) {
+    if (flash_cache_loaded(&cache)) {
+        #ifdef MICROPY_HW_LED_MSC
+            port_pin_set_output_level(MICROPY_HW_LED_MSC, true);
+        #endif
+        temp_status_color(ACTIVE_WRITE);
+        flash_cache_flush(&cache, keep_cache);
+        clear_temp_status();
+        #ifdef MICROPY_HW_LED_MSC
+            port_pin_set_output_level(MICROPY_HW_LED_MSC, false);
+        #endif
+    } else if (!keep_cache) {
+        // We're done with the cache for now so give it back.
+        flash_cache_flush(&cache, false);
     }
-    return true;
 }
 
-// Attempts to allocate a new set of page buffers for caching a full sector in
-// ram. Each page is allocated separately so that the GC doesn't need to provide
-// one huge block. We can free it as we write if we want to also.
-static bool allocate_ram_cache(void) {
-    uint8_t blocks_per_sector = SPI_FLASH_ERASE_SIZE / FILESYSTEM_BLOCK_SIZE;
-    uint8_t pages_per_block = FILESYSTEM_BLOCK_SIZE / SPI_FLASH_PAGE_SIZE;
-
-    uint32_t table_size = blocks_per_sector * pages_per_block * sizeof(uint32_t);
-    // Attempt to allocate outside the heap first.
-    supervisor_cache = allocate_memory(table_size + SPI_FLASH_ERASE_SIZE, false);
-    if (supervisor_cache != NULL) {
-        MP_STATE_VM(flash_ram_cache) = (uint8_t **) supervisor_cache->ptr;
-        uint8_t* page_start = (uint8_t *) supervisor_cache->ptr + table_size;
-
-        for (uint8_t i = 0; i < blocks_per_sector; i++) {
-            for (uint8_t j = 0; j < pages_per_block; j++) {
-                uint32_t offset = i * pages_per_block + j;
-                MP_STATE_VM(flash_ram_cache)[offset] = page_start + offset * SPI_FLASH_PAGE_SIZE;
-            }
-        }
-        return true;
-    }
-
-    MP_STATE_VM(flash_ram_cache) = m_malloc_maybe(blocks_per_sector * pages_per_block * sizeof(uint32_t), false);
-    if (MP_STATE_VM(flash_ram_cache) == NULL) {
-        return false;
-    }
-    // Declare i and j outside the loops in case we fail to allocate everything
-    // we need. In that case we'll give it back.
-    uint8_t i = 0;
-    uint8_t j = 0;
-    bool success = true;
-    for (i = 0; i < blocks_per_sector; i++) {
-        for (j = 0; j < pages_per_block; j++) {
-            uint8_t *page_cache = m_malloc_maybe(SPI_FLASH_PAGE_SIZE, false);
-            if (page_cache == NULL) {
-                success = false;
-                break;
-            }
-            MP_STATE_VM(flash_ram_cache)[i * pages_per_block + j] = page_cache;
-        }
-        if (!success) {
-            break;
-        }
-    }
-    // We couldn't allocate enough so give back what we got.
-    if (!success) {
-        // We add 1 so that we delete 0 when i is 1. Going to zero (i >= 0)
-        // would never stop because i is unsigned.
-        i++;
-        for (; i > 0; i--) {
-            for (; j > 0; j--) {
-                m_free(MP_STATE_VM(flash_ram_cache)[(i - 1) * pages_per_block + (j - 1)]);
-            }
-            j = pages_per_block;
-        }
-        m_free(MP_STATE_VM(flash_ram_cache));
-        MP_STATE_VM(flash_ram_cache) = NULL;
-    }
-    return success;
+// External flash function used. If called externally we assume we won't need
+// the cache after.
+void external_flash_flush(void) {
+    spi_flash_flush_keep_cache(false);
 }
 
-// Flush the cached sector from ram onto the flash. We'll free the cache unless
-// keep_cache is true.
-static bool flush_ram_cache(bool keep_cache) {
-    // First, copy out any blocks that we haven't touched from the sector
-    // we've cached. If we don't do this we'll erase the data during the sector
-    // erase below.
-    bool copy_to_ram_ok = true;
-    uint8_t pages_per_block = FILESYSTEM_BLOCK_SIZE / SPI_FLASH_PAGE_SIZE;
-    for (uint8_t i = 0; i < SPI_FLASH_ERASE_SIZE / FILESYSTEM_BLOCK_SIZE; i++) {
-        if ((dirty_mask & (1 << i)) == 0) {
-            for (uint8_t j = 0; j < pages_per_block; j++) {
-                copy_to_ram_ok = read_flash(
-                    current_sector + (i * pages_per_block + j) * SPI_FLASH_PAGE_SIZE,
-                    MP_STATE_VM(flash_ram_cache)[i * pages_per_block + j],
-                    SPI_FLASH_PAGE_SIZE);
-                if (!copy_to_ram_ok) {
-                    break;
-                }
-            }
-        }
-        if (!copy_to_ram_ok) {
-            break;
-        }
-    }
+void flash_flush(void) {
+    external_flash_flush();
+}
 
-    if (!copy_to_ram_ok) {
+// Only pre-erase while we own the filesystem. A USB host may write file data
+// before it writes the FAT entries that claim it.
+static bool pre_erase_allowed(void) {
+    // The FTL manages erases itself.
+    if (SPI_FLASH_FTL) {
         return false;
     }
-    // Second, erase the current sector.
-    erase_sector(current_sector);
-    // Lastly, write all the data in ram that we've cached.
-    for (uint8_t i = 0; i < SPI_FLASH_ERASE_SIZE / FILESYSTEM_BLOCK_SIZE; i++) {
-        for (uint8_t j = 0; j < pages_per_block; j++) {
-            write_flash(current_sector + (i * pages_per_block + j) * SPI_FLASH_PAGE_SIZE,
-                        MP_STATE_VM(flash_ram_cache)[i * pages_per_block + j],
-                        SPI_FLASH_PAGE_SIZE);
-            if (!keep_cache && supervisor_cache == NULL) {
-                m_free(MP_STATE_VM(flash_ram_cache)[i * pages_per_block + j]);
-            }
-        }
-    }
-    // We're done with the cache for now so give it back.
-    if (!keep_cache) {
-        if (supervisor_cache != NULL) {
-            free_memory(supervisor_cache);
-            supervisor_cache = NULL;
-        } else {
-            m_free(MP_STATE_VM(flash_ram_cache));
-        }
-        MP_STATE_VM(flash_ram_cache) = NULL;
-    }
-    return true;
+    return flash_vfs != NULL && (flash_vfs->flags & FSUSER_USB_WRITABLE) == 0;
 }
 
-// Delegates to the correct flash flush method depending on the existing cache.
-static void spi_flash_flush_keep_cache(bool keep_cache) {
-    if (current_sector == NO_SECTOR_LOADED) {
+// Once writes have stopped for a while, write back the cache so that little
+// is lost if power goes away. The ram is kept for the next burst of writes.
+// With the journal it's enough to commit, the cache is written back when it
+// needs the room. After that, pre-erase free sectors one at a time.
+void external_flash_background(void) {
+    if (flash_device == NULL || ticks_ms - last_write_tick < SPI_FLASH_IDLE_FLUSH_MS) {
         return;
     }
-    #ifdef MICROPY_HW_LED_MSC
-        port_pin_set_output_level(MICROPY_HW_LED_MSC, true);
-    #endif
-    temp_status_color(ACTIVE_WRITE);
-    // If we've cached to the flash itself flush from there.
-    if (MP_STATE_VM(flash_ram_cache) == NULL) {
-        flush_scratch_flash();
-    } else {
-        flush_ram_cache(keep_cache);
+    if (flash_cache_loaded(&cache) && !flash_cache_commit(&cache)) {
+        spi_flash_flush_keep_cache(true);
+    }
+    if (flash_cache_pre_erase_pending(&cache) && pre_erase_allowed()) {
+        flash_cache_pre_erase_next(&cache, &flash_vfs->fatfs, SPI_FLASH_PART1_START_BLOCK);
     }
-    current_sector = NO_SECTOR_LOADED;
-    clear_temp_status();
-    #ifdef MICROPY_HW_LED_MSC
-        port_pin_set_output_level(MICROPY_HW_LED_MSC, false);
-    #endif
 }
 
-// External flash function used. If called externally we assume we won't need
-// the cache after.
-void external_flash_flush(void) {
-    spi_flash_flush_keep_cache(false);
-}
-
-void flash_flush(void) {
-    external_flash_flush();
+void flash_background(void) {
+    external_flash_background();
 }
 
 // Builds a partition entry for the MBR.
@@ -491,136 +457,99 @@ static void build_partition(uint8_t *buf, int boot, int type,
     buf[15] = num_blocks >> 24;
 }
 
-static int32_t convert_block_to_flash_addr(uint32_t block) {
-    if (SPI_FLASH_PART1_START_BLOCK <= block && block < external_flash_get_block_count()) {
-        // a block in partition 1
-        block -= SPI_FLASH_PART1_START_BLOCK;
-        return block * FILESYSTEM_BLOCK_SIZE;
-    }
-    // bad block
-    return -1;
-}
-
 bool external_flash_read_block(uint8_t *dest, uint32_t block) {
-    if (block == 0) {
-        // Fake the MBR so we can decide on our own partition table
-        for (int i = 0; i < 446; i++) {
-            dest[i] = 0;
-        }
+    return external_flash_read_blocks(dest, block, 1) == 0;
+}
 
-        build_partition(dest + 446, 0, 0x01 /* FAT12 */,
-                        SPI_FLASH_PART1_START_BLOCK,
-                        external_flash_get_block_count() - SPI_FLASH_PART1_START_BLOCK);
-        build_partition(dest + 462, 0, 0, 0, 0);
-        build_partition(dest + 478, 0, 0, 0, 0);
-        build_partition(dest + 494, 0, 0, 0, 0);
+bool external_flash_write_block(const uint8_t *data, uint32_t block) {
+    return external_flash_write_blocks(data, block, 1) == 0;
+}
 
-        dest[510] = 0x55;
-        dest[511] = 0xaa;
+// Fakes the MBR so we can decide on our own partition table.
+static void read_mbr(uint8_t *dest) {
+    for (int i = 0; i < 446; i++) {
+        dest[i] = 0;
+    }
 
-        return true;
-    } else if (block < SPI_FLASH_PART1_START_BLOCK) {
-        memset(dest, 0, FILESYSTEM_BLOCK_SIZE);
-        return true;
-    } else {
-        // Non-MBR block, get data from flash memory.
-        int32_t address = convert_block_to_flash_addr(block);
-        if (address == -1) {
-            // bad block number
-            return false;
-        }
+    build_partition(dest + 446, 0, 0x01 /* FAT12 */,
+                    SPI_FLASH_PART1_START_BLOCK,
+                    external_flash_get_block_count() - SPI_FLASH_PART1_START_BLOCK);
+    build_partition(dest + 462, 0, 0, 0, 0);
+    build_partition(dest + 478, 0, 0, 0, 0);
+    build_partition(dest + 494, 0, 0, 0, 0);
 
-        // Mask out the lower bits that designate the address within the sector.
-        uint32_t this_sector = address & (~(SPI_FLASH_ERASE_SIZE - 1));
-        uint8_t block_index = (address / FILESYSTEM_BLOCK_SIZE) % (SPI_FLASH_ERASE_SIZE / FILESYSTEM_BLOCK_SIZE);
-        uint8_t mask = 1 << (block_index);
-        // We're reading from the currently cached sector.
-        if (current_sector == this_sector && (mask & dirty_mask) > 0) {
-            if (MP_STATE_VM(flash_ram_cache) != NULL) {
-                uint8_t pages_per_block = FILESYSTEM_BLOCK_SIZE / SPI_FLASH_PAGE_SIZE;
-                for (int i = 0; i < pages_per_block; i++) {
-                    memcpy(dest + i * SPI_FLASH_PAGE_SIZE,
-                           MP_STATE_VM(flash_ram_cache)[block_index * pages_per_block + i],
-                           SPI_FLASH_PAGE_SIZE);
-                }
-                return true;
-            } else {
-                uint32_t scratch_address = flash_device->total_size - SPI_FLASH_ERASE_SIZE + block_index * FILESYSTEM_BLOCK_SIZE;
-                return read_flash(scratch_address, dest, FILESYSTEM_BLOCK_SIZE);
-            }
-        }
-        return read_flash(address, dest, FILESYSTEM_BLOCK_SIZE);
-    }
+    dest[510] = 0x55;
+    dest[511] = 0xaa;
 }
 
-bool external_flash_write_block(const uint8_t *data, uint32_t block) {
-    if (block < SPI_FLASH_PART1_START_BLOCK) {
-        // Fake writing below the flash partition.
-        return true;
-    } else {
-        // Non-MBR block, copy to cache
-        int32_t address = convert_block_to_flash_addr(block);
-        if (address == -1) {
-            // bad block number
-            return false;
-        }
-        // Wait for any previous writes to finish.
-        wait_for_flash_ready();
-        // Mask out the lower bits that designate the address within the sector.
-        uint32_t this_sector = address & (~(SPI_FLASH_ERASE_SIZE - 1));
-        uint8_t block_index = (address / FILESYSTEM_BLOCK_SIZE) % (SPI_FLASH_ERASE_SIZE / FILESYSTEM_BLOCK_SIZE);
-        uint8_t mask = 1 << (block_index);
-        // Flush the cache if we're moving onto a sector or we're writing the
-        // same block again.
-        if (current_sector != this_sector || (mask & dirty_mask) > 0) {
-            // Check to see if we'd write to an erased page. In that case we
-            // can write directly.
-            if (page_erased(address)) {
-                return write_flash(address, data, FILESYSTEM_BLOCK_SIZE);
-            }
-            if (current_sector != NO_SECTOR_LOADED) {
-                spi_flash_flush_keep_cache(true);
-            }
-            if (MP_STATE_VM(flash_ram_cache) == NULL && !allocate_ram_cache()) {
-                erase_sector(flash_device->total_size - SPI_FLASH_ERASE_SIZE);
-                wait_for_flash_ready();
-            }
-            current_sector = this_sector;
-            dirty_mask = 0;
-        }
-        dirty_mask |= mask;
-        // Copy the block to the appropriate cache.
-        if (MP_STATE_VM(flash_ram_cache) != NULL) {
-            uint8_t pages_per_block = FILESYSTEM_BLOCK_SIZE / SPI_FLASH_PAGE_SIZE;
-            for (int i = 0; i < pages_per_block; i++) {
-                memcpy(MP_STATE_VM(flash_ram_cache)[block_index * pages_per_block + i],
-                       data + i * SPI_FLASH_PAGE_SIZE,
-                       SPI_FLASH_PAGE_SIZE);
-            }
-            return true;
+mp_uint_t external_flash_read_blocks(uint8_t *dest, uint32_t block_num, uint32_t num_blocks) {
+    if (flash_device == NULL || block_num + num_blocks > external_flash_get_block_count()) {
+        return 1; // error
+    }
+    for (; num_blocks > 0 && block_num < SPI_FLASH_PART1_START_BLOCK; num_blocks--, block_num++) {
+        if (block_num == 0) {
+            read_mbr(dest);
         } else {
-            uint32_t scratch_address = flash_device->total_size - SPI_FLASH_ERASE_SIZE + block_index * FILESYSTEM_BLOCK_SIZE;
-            return write_flash(scratch_address, data, FILESYSTEM_BLOCK_SIZE);
+            memset(dest, 0, FILESYSTEM_BLOCK_SIZE);
         }
+        dest += FILESYSTEM_BLOCK_SIZE;
     }
-}
-
-mp_uint_t external_flash_read_blocks(uint8_t *dest, uint32_t block_num, uint32_t num_blocks) {
-    for (size_t i = 0; i < num_blocks; i++) {
-        if (!external_flash_read_block(dest + i * FILESYSTEM_BLOCK_SIZE, block_num + i)) {
+    if (num_blocks == 0) {
+        return 0; // success
+    }
+    #if SPI_FLASH_FTL
+    for (; num_blocks > 0; num_blocks--, block_num++) {
+        if (!flash_ftl_read_block(&ftl, dest, block_num - SPI_FLASH_PART1_START_BLOCK)) {
             return 1; // error
         }
+        dest += FILESYSTEM_BLOCK_SIZE;
     }
     return 0; // success
+    #else
+    // Blocks that come straight from the flash are read in runs with a single
+    // read command and DMA transfer.
+    if (!flash_cache_read_blocks(&cache, dest, block_num - SPI_FLASH_PART1_START_BLOCK, num_blocks)) {
+        return 1; // error
+    }
+    return 0; // success
+    #endif
 }
 
 mp_uint_t external_flash_write_blocks(const uint8_t *src, uint32_t block_num, uint32_t num_blocks) {
-    for (size_t i = 0; i < num_blocks; i++) {
-        if (!external_flash_write_block(src + i * FILESYSTEM_BLOCK_SIZE, block_num + i)) {
+    if (flash_device == NULL || block_num + num_blocks > external_flash_get_block_count()) {
+        return 1; // error
+    }
+    // Fake writing below the flash partition.
+    for (; num_blocks > 0 && block_num < SPI_FLASH_PART1_START_BLOCK; num_blocks--, block_num++) {
+        src += FILESYSTEM_BLOCK_SIZE;
+    }
+    if (num_blocks == 0) {
+        return 0; // success
+    }
+    #if SPI_FLASH_FTL
+    for (; num_blocks > 0; num_blocks--, block_num++) {
+        if (!flash_ftl_write_block(&ftl, src, block_num - SPI_FLASH_PART1_START_BLOCK)) {
             return 1; // error
         }
+        src += FILESYSTEM_BLOCK_SIZE;
+    }
+    return 0; // success
+    #else
+    // Writes delay the idle flush.
+    last_write_tick = ticks_ms;
+    if (!flash_cache_write_blocks(&cache, src, block_num - SPI_FLASH_PART1_START_BLOCK, num_blocks)) {
+        return 1; // error
     }
     return 0; // success
+    #endif
+}
+
+// Makes everything written so far survive a reset. With the journal the cache
+// is kept and written back in place later.
+static void external_flash_sync(void) {
+    if (!flash_cache_commit(&cache)) {
+        external_flash_flush();
+    }
 }
 
 /******************************************************************************/
@@ -660,7 +589,7 @@ STATIC mp_obj_t external_flash_obj_ioctl(mp_obj_t self, mp_obj_t cmd_in, mp_obj_
     switch (cmd) {
         case BP_IOCTL_INIT: external_flash_init(); return MP_OBJ_NEW_SMALL_INT(0);
         case BP_IOCTL_DEINIT: external_flash_flush(); return MP_OBJ_NEW_SMALL_INT(0); // TODO properly
-        case BP_IOCTL_SYNC: external_flash_flush(); return MP_OBJ_NEW_SMALL_INT(0);
+        case BP_IOCTL_SYNC: external_flash_sync(); return MP_OBJ_NEW_SMALL_INT(0);
         case BP_IOCTL_SEC_COUNT: return MP_OBJ_NEW_SMALL_INT(external_flash_get_block_count());
         case BP_IOCTL_SEC_SIZE: return MP_OBJ_NEW_SMALL_INT(external_flash_get_block_size());
         default: return mp_const_none;
@@ -684,6 +613,7 @@ const mp_obj_type_t external_flash_type = {
 };
 
 void flash_init_vfs(fs_user_mount_t *vfs) {
+    flash_vfs = vfs;
     vfs->base.type = &mp_fat_vfs_type;
     vfs->flags |= FSUSER_NATIVE | FSUSER_HAVE_IOCTL;
     vfs->fatfs.drv = vfs;
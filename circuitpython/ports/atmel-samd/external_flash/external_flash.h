@@ -41,6 +41,40 @@
 #define SPI_FLASH_ERASE_SIZE (1 << 12)
 #define SPI_FLASH_PAGE_SIZE (256)
 
+// Store the filesystem through the log-structured flash translation layer in
+// supervisor/shared/flash_ftl.c instead of rewriting blocks in place. This
+// changes the on-flash layout so switching it reformats the filesystem. Turn
+// it on with `make SPI_FLASH_FTL=1`.
+#ifndef SPI_FLASH_FTL
+#define SPI_FLASH_FTL (0)
+#endif
+
+// Put every group of blocks that is about to be rewritten in place into the
+// write-ahead journal in supervisor/shared/flash_journal.c first, so that a
+// reset part way through a sector erase can't leave the filesystem half
+// updated. A sync then only appends to the journal and the cache is written
+// back in place later, which saves erases when syncs come in bursts. The
+// journal takes SPI_FLASH_JOURNAL_SECTORS erase sectors off the end of the
+// filesystem. Turning it on reformats CIRCUITPY because the old filesystem no
+// longer fits, see filesystem_init. Turning it off keeps CIRCUITPY but loses
+// whatever was only in the journal. Turn it on with `make SPI_FLASH_JOURNAL=1`.
+#ifndef SPI_FLASH_JOURNAL
+#define SPI_FLASH_JOURNAL (0)
+#endif
+
+// Each half of the journal must hold a snapshot of the whole cache, which
+// holds up to FLASH_CACHE_MAX_SECTORS from supervisor/shared/flash_cache.h.
+#ifndef SPI_FLASH_JOURNAL_SECTORS
+#define SPI_FLASH_JOURNAL_SECTORS (2 * (FLASH_CACHE_MAX_SECTORS + 2))
+#endif
+
+#if SPI_FLASH_JOURNAL && SPI_FLASH_FTL
+#error "The FTL never rewrites blocks in place so it doesn't need SPI_FLASH_JOURNAL."
+#endif
+
+// Dirty sectors are written back once there have been no writes for this long.
+#define SPI_FLASH_IDLE_FLUSH_MS (500)
+
 #define SPI_FLASH_SYSTICK_MASK    (0x1ff) // 512ms
 #define SPI_FLASH_IDLE_TICK(tick) (((tick) & SPI_FLASH_SYSTICK_MASK) == 2)
 
@@ -49,6 +83,7 @@ uint32_t external_flash_get_block_size(void);
 uint32_t external_flash_get_block_count(void);
 void external_flash_irq_handler(void);
 void external_flash_flush(void);
+void external_flash_background(void);
 bool external_flash_read_block(uint8_t *dest, uint32_t block);
 bool external_flash_write_block(const uint8_t *src, uint32_t block);
 
@@ -30,6 +30,7 @@
 
 extern void flash_init_vfs(fs_user_mount_t *vfs);
 extern void flash_flush(void);
+extern void flash_background(void);
 
 void flash_set_usb_writable(bool usb_writable);
 
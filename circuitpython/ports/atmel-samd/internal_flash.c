@@ -79,6 +79,9 @@ void flash_flush(void) {
     internal_flash_flush();
 }
 
+void flash_background(void) {
+}
+
 static void build_partition(uint8_t *buf, int boot, int type, uint32_t start_block, uint32_t num_blocks) {
     buf[0] = boot;
 
@@ -75,6 +75,7 @@
 #define MICROPY_FATFS_VOLUMES          (4)
 #define MICROPY_FATFS_MULTI_PARTITION  (1)
 #define MICROPY_FATFS_NUM_PERSISTENT   (1)
+#define MICROPY_FATFS_USE_FASTSEEK     (1)
 // Only enable this if you really need it. It allocates a byte cache of this
 // size.
 // #define MICROPY_FATFS_MAX_SS           (4096)
@@ -143,12 +144,19 @@ typedef long mp_off_t;
 #define CIRCUITPY_MCU_FAMILY samd21
 #define MICROPY_PY_SYS_PLATFORM                     "Atmel SAMD21"
 #define PORT_HEAP_SIZE (16384 + 4096)
+#define MICROPY_FATFS_DCACHE                        (8)
+// Blocks in each of the two USB mass storage transfer buffers.
+#define CIRCUITPY_MSC_BUFFER_BLOCKS                 (1)
 #endif
 
 #ifdef SAMD51
 #define CIRCUITPY_MCU_FAMILY samd51
 #define MICROPY_PY_SYS_PLATFORM                     "MicroChip SAMD51"
 #define PORT_HEAP_SIZE (0x20000) // 128KiB
+#define MICROPY_FATFS_DCACHE                        (32)
+#define MICROPY_MODULE_IMPORT_CACHE                 (1)
+// One external flash erase sector.
+#define CIRCUITPY_MSC_BUFFER_BLOCKS                 (8)
 #endif
 
 #ifdef LONGINT_IMPL_NONE
@@ -267,6 +275,11 @@ extern const struct _mp_obj_module_t wakey_module;
 #define TOUCHIO_MODULE
 #endif
 
+// audioio's Mixer, Resampler, Synth, Volume and Filter only fit in a SAMD51's flash.
+#ifdef SAMD51
+#define CIRCUITPY_AUDIOIO_PROCESSING
+#endif
+
 // A pIRKey has minimal I/O needs. Remove unneeded modules to make room
 // for frozen modules. math is very large and is also removed.
 #ifdef PIRKEY_M0
@@ -343,6 +356,7 @@ extern const struct _mp_obj_module_t wakey_module;
     const char *readline_hist[8]; \
     vstr_t *repl_line; \
     mp_obj_t playing_audio[AUDIO_DMA_CHANNEL_COUNT]; \
+    mp_obj_t recording_pdmin; \
     mp_obj_t rtc_time_source; \
     FLASH_ROOT_POINTERS \
     mp_obj_t gamepad_singleton; \
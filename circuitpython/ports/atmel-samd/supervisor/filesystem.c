@@ -41,6 +41,17 @@ static void make_empty_file(FATFS *fatfs, const char *path) {
     f_close(&fp);
 }
 
+// Returns true if every cluster of the mounted filesystem is on the flash. One
+// made before the end of the flash was set aside, such as for the external
+// flash journal, has clusters that are now used for something else.
+static bool filesystem_fits(FATFS *fatfs) {
+    DWORD sectors;
+    if (disk_ioctl(fatfs->drv, GET_SECTOR_COUNT, &sectors) != RES_OK) {
+        return false;
+    }
+    return fatfs->database + (fatfs->n_fatent - 2) * fatfs->csize <= sectors;
+}
+
 // we don't make this function static because it needs a lot of stack and we
 // want it to be executed without using stack within main() function
 void filesystem_init(bool create_allowed, bool force_create) {
@@ -51,6 +62,10 @@ void filesystem_init(bool create_allowed, bool force_create) {
 
     // try to mount the flash
     FRESULT res = f_mount(&vfs_fat->fatfs);
+    if (res == FR_OK && !filesystem_fits(&vfs_fat->fatfs)) {
+        // Mounting it would let it write over what's past the end.
+        res = FR_NO_FILESYSTEM;
+    }
 
     if ((res == FR_NO_FILESYSTEM && create_allowed) || force_create) {
         // No filesystem so create a fresh one, or reformat has been requested.
@@ -247,6 +247,9 @@ void reset_port(void) {
     audio_dma_reset();
     //pdmin_reset();
 #endif
+#if !defined(__SAMR21G18A__) && !defined(__SAMD51G19A__) && !defined(__SAMD51G18A__)
+    pdmin_recording_reset();
+#endif
 #ifdef SAMD21
     touchin_reset();
 #endif
@@ -28,6 +28,7 @@
 
 #include "usb_mass_storage.h"
 #include "supervisor/shared/autoreload.h"
+#include "supervisor/shared/usb_msc_transfer.h"
 
 #include "hal/utils/include/err_codes.h"
 #include "hal/utils/include/utils.h"
@@ -38,6 +39,7 @@
 #include "lib/oofatfs/ff.h"
 #include "lib/oofatfs/diskio.h"
 #include "lib/oofatfs/ffconf.h"
+#include "py/builtin.h"
 #include "py/mpconfig.h"
 #include "py/mphal.h"
 #include "py/mpstate.h"
@@ -181,15 +183,69 @@ uint8_t *usb_msc_get_capacity(uint8_t lun) {
     }
 }
 
-// USB transfer state.
-volatile bool usb_busy;
-volatile bool active_read;
-volatile bool active_write;
-volatile uint8_t active_lun;
-volatile uint32_t active_addr;
-volatile uint32_t active_nblocks;
-volatile bool sector_loaded;
-COMPILER_ALIGNED(4) uint8_t sector_buffer[512];
+// Both flash block devices put the first block of the partition at block 1 so
+// their erase sectors start one block past a multiple of the sector size.
+#define MSC_FIRST_FLASH_BLOCK (1)
+
+COMPILER_ALIGNED(4) static uint8_t msc_buffers[2 * CIRCUITPY_MSC_BUFFER_BLOCKS * FILESYSTEM_BLOCK_SIZE];
+// Hands a buffer to the USB peripheral.
+static bool msc_start(bool rd, uint8_t* buffer, uint32_t count) {
+    return mscdf_xfer_blocks(rd, buffer, count) == ERR_NONE;
+}
+
+static void msc_finish_write(void) {
+    mscdf_xfer_blocks(false, NULL, 0);
+    #if MICROPY_MODULE_IMPORT_CACHE
+    // The host may have changed what import finds, even if autoreload is off.
+    mp_import_cache_clear();
+    #endif
+    // This write is complete, start the autoreload clock.
+    autoreload_start();
+}
+
+static void msc_read_blocks(uint8_t lun, uint8_t* dest, uint32_t block, uint32_t count) {
+    disk_read(get_vfs(lun), dest, block, count);
+}
+
+static void msc_write_blocks(uint8_t lun, const uint8_t* src, uint32_t block, uint32_t count) {
+    fs_user_mount_t* vfs = get_vfs(lun);
+    disk_write(vfs, src, block, count);
+    // Since by getting here we assume the mount is read-only to
+    // MicroPython let's update the cached FatFs sector if it's one
+    // we just wrote.
+    #if _MAX_SS != _MIN_SS
+    if (vfs->fatfs.ssize == FILESYSTEM_BLOCK_SIZE) {
+    #else
+    // The compiler can optimize this away.
+    if (_MAX_SS == FILESYSTEM_BLOCK_SIZE) {
+    #endif
+        uint32_t winsect = vfs->fatfs.winsect;
+        if (winsect >= block && winsect < block + count && winsect > 0) {
+            memcpy(vfs->fatfs.win,
+                   src + (winsect - block) * FILESYSTEM_BLOCK_SIZE,
+                   FILESYSTEM_BLOCK_SIZE);
+        }
+    }
+    #if _FS_DCACHE
+    // The host may have changed any directory.
+    f_dcache_clear(&vfs->fatfs);
+    #endif
+}
+
+static const usb_msc_transfer_io_t msc_io = {
+    .start = msc_start,
+    .finish_write = msc_finish_write,
+    .read_blocks = msc_read_blocks,
+    .write_blocks = msc_write_blocks,
+};
+
+static usb_msc_transfer_t msc_transfer = {
+    .io = &msc_io,
+    .buffers = msc_buffers,
+    .buffer_blocks = CIRCUITPY_MSC_BUFFER_BLOCKS,
+    .first_block = MSC_FIRST_FLASH_BLOCK,
+    .ready_buffer = -1,
+};
 
 /**
  * \brief Callback invoked when a new read blocks command received
@@ -204,10 +260,7 @@ int32_t usb_msc_new_read(uint8_t lun, uint32_t addr, uint32_t nblocks) {
     }
 
     // Store transfer info so we can service it in the "background".
-    active_lun = lun;
-    active_addr = addr;
-    active_nblocks = nblocks;
-    active_read = true;
+    usb_msc_transfer_new_read(&msc_transfer, lun, addr, nblocks);
 
     return ERR_NONE;
 }
@@ -235,11 +288,7 @@ int32_t usb_msc_new_write(uint8_t lun, uint32_t addr, uint32_t nblocks) {
     }
 
     // Store transfer info so we can service it in the "background".
-    active_lun = lun;
-    active_addr = addr;
-    active_nblocks = nblocks;
-    active_write = true;
-    sector_loaded = false;
+    usb_msc_transfer_new_write(&msc_transfer, lun, addr, nblocks);
 
     // Return ERR_DENIED when the file system is read-only to the USB host.
 
@@ -256,83 +305,19 @@ int32_t usb_msc_xfer_done(uint8_t lun) {
         return ERR_DENIED;
     }
 
-    CRITICAL_SECTION_ENTER();
-    if (active_read) {
-        active_addr += 1;
-        active_nblocks--;
-        if (active_nblocks == 0) {
-            active_read = false;
-        }
-    }
-
-    if (active_write) {
-        sector_loaded = true;
-    }
-    usb_busy = false;
-    CRITICAL_SECTION_LEAVE();
+    usb_msc_transfer_done(&msc_transfer);
 
     return ERR_NONE;
 }
 
 // The start_read callback begins a read transaction which we accept
 // but delay our response until the "main thread" calls
-// usb_msc_background. Once it does, we read immediately from the
-// drive into our cache and trigger the USB DMA to output the
-// sector. Once the sector is transmitted, xfer_done will be called.
+// usb_msc_background. Once it does, we read from the drive into one
+// buffer and trigger the USB DMA to output it, then read ahead into the
+// other buffer while it is sent. Writes work the other way around: the
+// next buffer is received from the host while the previous one is
+// written to the drive. Each time a buffer is transferred xfer_done is
+// called.
 void usb_msc_background(void) {
-    // Check USB busy first because we never want to queue another transfer if it is. Checking
-    // active_read or active_write first leaves the possibility that they are true, an xfer done
-    // interrupt occurs (setting them false), turning off usb_busy and causing us to queue a
-    // spurious transfer.
-    if (usb_busy) {
-        return;
-    }
-    if (active_read) {
-        fs_user_mount_t * vfs = get_vfs(active_lun);
-        disk_read(vfs, sector_buffer, active_addr, 1);
-        CRITICAL_SECTION_ENTER();
-        int32_t result = mscdf_xfer_blocks(true, sector_buffer, 1);
-        usb_busy = result == ERR_NONE;
-        CRITICAL_SECTION_LEAVE();
-    }
-    if (active_write) {
-        if (sector_loaded) {
-            fs_user_mount_t * vfs = get_vfs(active_lun);
-            disk_write(vfs, sector_buffer, active_addr, 1);
-            // Since by getting here we assume the mount is read-only to
-            // MicroPython let's update the cached FatFs sector if it's the one
-            // we just wrote.
-            #if _MAX_SS != _MIN_SS
-            if (vfs->ssize == FILESYSTEM_BLOCK_SIZE) {
-            #else
-            // The compiler can optimize this away.
-            if (_MAX_SS == FILESYSTEM_BLOCK_SIZE) {
-            #endif
-                if (active_addr == vfs->fatfs.winsect && active_addr > 0) {
-                    memcpy(vfs->fatfs.win,
-                           sector_buffer,
-                           FILESYSTEM_BLOCK_SIZE);
-                }
-            }
-            sector_loaded = false;
-            active_addr += 1;
-            active_nblocks--;
-        }
-        // Load more blocks from USB if they are needed.
-        if (active_nblocks > 0) {
-            // Turn off interrupts because with them on,
-            // usb_msc_xfer_done could be called before we update
-            // usb_busy. If that happened, we'd overwrite the fact that
-            // the transfer actually already finished.
-            CRITICAL_SECTION_ENTER();
-            int32_t result = mscdf_xfer_blocks(false, sector_buffer, 1);
-            usb_busy = result == ERR_NONE;
-            CRITICAL_SECTION_LEAVE();
-        } else {
-            mscdf_xfer_blocks(false, NULL, 0);
-            active_write = false;
-            // This write is complete, start the autoreload clock.
-            autoreload_start();
-        }
-    }
+    usb_msc_transfer_background(&msc_transfer);
 }
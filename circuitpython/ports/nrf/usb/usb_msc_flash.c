@@ -134,6 +134,10 @@ int32_t tud_msc_write10_cb (uint8_t lun, uint32_t lba, uint32_t offset, void* bu
     if ( (lba <= vfs->fatfs.winsect) && (vfs->fatfs.winsect <= (lba + bufsize / MSC_FLASH_BLOCK_SIZE)) ) {
         memcpy(vfs->fatfs.win, buffer + MSC_FLASH_BLOCK_SIZE * (vfs->fatfs.winsect - lba), MSC_FLASH_BLOCK_SIZE);
     }
+    #if _FS_DCACHE
+    // The host may have changed any directory.
+    f_dcache_clear(&vfs->fatfs);
+    #endif
 
     return block_count * MSC_FLASH_BLOCK_SIZE;
 }
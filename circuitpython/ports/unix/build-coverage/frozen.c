@@ -0,0 +1,7 @@
+#include <stdint.h>
+const char mp_frozen_str_names[] = {
+"\0"};
+const uint32_t mp_frozen_str_sizes[] = {
+};
+const char mp_frozen_str_content[] = {
+};
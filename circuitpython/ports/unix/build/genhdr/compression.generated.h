@@ -0,0 +1,2 @@
+const uint8_t lengths[] = { 0, 0, 1, 7, 8, 4, 7, 8, 11, 11, 9, 5, 7, 5, 1, 0, 0, 0, 0, 0, 0, 84, 88 };
+const uint8_t values[256] = { 101, 32, 97, 105, 110, 111, 114, 116, 95, 99, 100, 108, 109, 112, 115, 117, 39, 98, 102, 103, 37, 69, 104, 107, 118, 120, 121, 73, 78, 79, 83, 84, 106, 113, 119, 40, 41, 45, 65, 66, 67, 68, 70, 76, 82, 85, 44, 47, 48, 49, 50, 51, 54, 58, 71, 80, 122, 42, 46, 52, 56, 60, 62, 75, 77, 86, 35, 53, 61, 72, 87, 10, 13, 34, 88, 89, 123, 125, 55, 74, 90, 91, 93, 57, 1, 2, 3, 4, 5, 6, 7, 8, 9, 11, 12, 14, 15, 16, 20, 24, 27, 33, 94, 96, 129, 130, 133, 134, 135, 136, 137, 138, 141, 142, 145, 146, 149, 150, 151, 152, 155, 156, 157, 158, 159, 160, 161, 162, 163, 164, 165, 166, 167, 168, 170, 171, 172, 173, 174, 175, 176, 177, 180, 181, 182, 183, 184, 185, 188, 189, 190, 191, 192, 193, 196, 197, 198, 199, 205, 213, 220, 222, 223, 226, 227, 229, 248, 249, 0, 17, 18, 19, 21, 22, 23, 25, 26, 28, 29, 30, 31, 36, 38, 43, 59, 63, 64, 81, 92, 124, 126, 127, 128, 131, 132, 139, 140, 143, 144, 147, 148, 153, 154, 169, 178, 179, 186, 187, 194, 195, 200, 201, 202, 203, 204, 206, 207, 208, 209, 210, 211, 212, 214, 215, 216, 217, 218, 219, 221, 224, 225, 228, 230, 231, 232, 233, 234, 235, 236, 237, 238, 239, 240, 241, 242, 243, 244, 245, 246, 247, 250, 251, 252, 253, 254, 255 };
@@ -13,6 +13,9 @@
 #include "py/stream.h"
 #include "py/binary.h"
 #include "py/bc.h"
+#include "shared-bindings/os/__init__.h"
+#include "shared-bindings/storage/__init__.h"
+#include "coverage.h"
 
 #if defined(MICROPY_UNIX_COVERAGE)
 
@@ -134,6 +137,61 @@ STATIC const mp_obj_type_t mp_type_stest_textio2 = {
     .locals_dict = (mp_obj_dict_t*)&rawfile_locals_dict2,
 };
 
+// CircuitPython's os and storage call VFS methods without going through extmod's uos, so
+// these let a script check that they still clear the import cache
+STATIC mp_obj_t cpy_os_chdir(mp_obj_t path) {
+    common_hal_os_chdir(mp_obj_str_get_str(path));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(cpy_os_chdir_obj, cpy_os_chdir);
+
+STATIC mp_obj_t cpy_os_mkdir(mp_obj_t path) {
+    common_hal_os_mkdir(mp_obj_str_get_str(path));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(cpy_os_mkdir_obj, cpy_os_mkdir);
+
+STATIC mp_obj_t cpy_os_remove(mp_obj_t path) {
+    common_hal_os_remove(mp_obj_str_get_str(path));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(cpy_os_remove_obj, cpy_os_remove);
+
+STATIC mp_obj_t cpy_os_rename(mp_obj_t old_path, mp_obj_t new_path) {
+    common_hal_os_rename(mp_obj_str_get_str(old_path), mp_obj_str_get_str(new_path));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(cpy_os_rename_obj, cpy_os_rename);
+
+STATIC mp_obj_t cpy_os_rmdir(mp_obj_t path) {
+    common_hal_os_rmdir(mp_obj_str_get_str(path));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(cpy_os_rmdir_obj, cpy_os_rmdir);
+
+STATIC mp_obj_t cpy_storage_mount(mp_obj_t vfs, mp_obj_t path) {
+    common_hal_storage_mount(vfs, mp_obj_str_get_str(path), false);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(cpy_storage_mount_obj, cpy_storage_mount);
+
+STATIC mp_obj_t cpy_storage_umount(mp_obj_t path) {
+    common_hal_storage_umount_path(mp_obj_str_get_str(path));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(cpy_storage_umount_obj, cpy_storage_umount);
+
+STATIC const mp_rom_map_elem_t cpy_vfs_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_chdir), MP_ROM_PTR(&cpy_os_chdir_obj) },
+    { MP_ROM_QSTR(MP_QSTR_mkdir), MP_ROM_PTR(&cpy_os_mkdir_obj) },
+    { MP_ROM_QSTR(MP_QSTR_remove), MP_ROM_PTR(&cpy_os_remove_obj) },
+    { MP_ROM_QSTR(MP_QSTR_rename), MP_ROM_PTR(&cpy_os_rename_obj) },
+    { MP_ROM_QSTR(MP_QSTR_rmdir), MP_ROM_PTR(&cpy_os_rmdir_obj) },
+    { MP_ROM_QSTR(MP_QSTR_mount), MP_ROM_PTR(&cpy_storage_mount_obj) },
+    { MP_ROM_QSTR(MP_QSTR_umount), MP_ROM_PTR(&cpy_storage_umount_obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(cpy_vfs_dict, cpy_vfs_table);
+
 // str/bytes objects without a valid hash
 STATIC const mp_obj_str_t str_no_hash_obj = {{&mp_type_str}, 0, 10, (const byte*)"0123456789"};
 STATIC const mp_obj_str_t bytes_no_hash_obj = {{&mp_type_bytes}, 0, 10, (const byte*)"0123456789"};
@@ -418,6 +476,10 @@ STATIC mp_obj_t extra_coverage(void) {
         }
     }
 
+    coverage_audio();
+    coverage_flash();
+    coverage_msc();
+
     mp_obj_streamtest_t *s = m_new_obj(mp_obj_streamtest_t);
     s->base.type = &mp_type_stest_fileio;
     s->buf = NULL;
@@ -428,7 +490,8 @@ STATIC mp_obj_t extra_coverage(void) {
     s2->base.type = &mp_type_stest_textio2;
 
     // return a tuple of data for testing on the Python side
-    mp_obj_t items[] = {(mp_obj_t)&str_no_hash_obj, (mp_obj_t)&bytes_no_hash_obj, MP_OBJ_FROM_PTR(s), MP_OBJ_FROM_PTR(s2)};
+    mp_obj_t items[] = {(mp_obj_t)&str_no_hash_obj, (mp_obj_t)&bytes_no_hash_obj, MP_OBJ_FROM_PTR(s), MP_OBJ_FROM_PTR(s2),
+        MP_OBJ_FROM_PTR(&cpy_vfs_dict)};
     return mp_obj_new_tuple(MP_ARRAY_SIZE(items), items);
 }
 MP_DEFINE_CONST_FUN_OBJ_0(extra_coverage_obj, extra_coverage);
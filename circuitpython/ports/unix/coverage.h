@@ -0,0 +1,15 @@
+#ifndef MICROPY_INCLUDED_UNIX_COVERAGE_H
+#define MICROPY_INCLUDED_UNIX_COVERAGE_H
+
+#include "extmod/vfs_fat.h"
+
+// a FAT filesystem on the simulated NOR flash, which the audio tests play files from
+extern fs_user_mount_t nor_vfs;
+void nor_mkfs(uint8_t ram_sectors, uint8_t fill, uint32_t au);
+
+// the parts of extra_coverage that test CircuitPython's shared modules
+void coverage_audio(void);
+void coverage_flash(void);
+void coverage_msc(void);
+
+#endif // MICROPY_INCLUDED_UNIX_COVERAGE_H
@@ -0,0 +1,769 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "py/runtime.h"
+#include "shared-module/audiobusio/pdm.h"
+#include "shared-module/audiobusio/ring.h"
+#include "shared-bindings/audioio/__init__.h"
+#include "shared-bindings/audioio/WaveFile.h"
+#include "shared-module/audioio/adpcm.h"
+#include "shared-module/audioio/convert.h"
+#include "shared-module/audioio/effects.h"
+#include "shared-module/audioio/mix.h"
+#include "shared-module/audioio/resample.h"
+#include "shared-module/audioio/wavetable.h"
+#include "lib/oofatfs/ff.h"
+#include "coverage.h"
+
+#if defined(MICROPY_UNIX_COVERAGE)
+
+
+// a sample type that only exists in C, to check the audio sample protocol
+STATIC uint32_t atest_sample_rate(mp_obj_t self_in) {
+    (void)self_in;
+    return 8000;
+}
+
+STATIC uint8_t atest_bits_per_sample(mp_obj_t self_in) {
+    (void)self_in;
+    return 8;
+}
+
+STATIC uint8_t atest_channel_count(mp_obj_t self_in) {
+    (void)self_in;
+    return 1;
+}
+
+STATIC void atest_reset_buffer(mp_obj_t self_in, bool single_channel, uint8_t channel) {
+    (void)self_in;
+    (void)single_channel;
+    (void)channel;
+}
+
+STATIC audioio_get_buffer_result_t atest_get_buffer(mp_obj_t self_in, bool single_channel,
+    uint8_t channel, uint8_t **buffer, uint32_t *buffer_length) {
+    (void)self_in;
+    (void)single_channel;
+    (void)channel;
+    static uint8_t data[] = {0x80, 0xff, 0x00};
+    *buffer = data;
+    *buffer_length = sizeof(data);
+    return GET_BUFFER_DONE;
+}
+
+STATIC void atest_get_buffer_structure(mp_obj_t self_in, bool single_channel,
+    bool *single_buffer, bool *samples_signed, uint32_t *max_buffer_length, uint8_t *spacing) {
+    (void)self_in;
+    (void)single_channel;
+    *single_buffer = true;
+    *samples_signed = false;
+    *max_buffer_length = 3;
+    *spacing = 1;
+}
+
+STATIC const audiosample_p_t atest_sample_p = {
+    .id = &audiosample_protocol_id,
+    .sample_rate = atest_sample_rate,
+    .bits_per_sample = atest_bits_per_sample,
+    .channel_count = atest_channel_count,
+    .reset_buffer = atest_reset_buffer,
+    .get_buffer = atest_get_buffer,
+    .get_buffer_structure = atest_get_buffer_structure,
+};
+
+STATIC const mp_obj_type_t mp_type_atest_sample = {
+    { &mp_type_type },
+    .protocol = &atest_sample_p,
+};
+
+// a stereo wave file on the simulated flash played the way the DMA plays it. Frame i
+// holds i on the left and ~i on the right so that every sample names its place.
+STATIC void wave_write_file(const char *path, uint32_t frames) {
+    uint32_t data_length = frames * 4;
+    uint8_t header[44] = "RIFF....WAVEfmt \x10\0\0\0\x01\0\x02\0\x40\x1f\0\0\0\x7d\0\0\x04\0\x10\0data";
+    uint32_t riff_length = data_length + 36;
+    memcpy(header + 4, &riff_length, 4);
+    memcpy(header + 40, &data_length, 4);
+    FIL fp;
+    UINT n;
+    f_open(&nor_vfs.fatfs, &fp, path, FA_WRITE | FA_CREATE_ALWAYS);
+    f_write(&fp, header, sizeof(header), &n);
+    for (uint32_t i = 0; i < frames; i++) {
+        uint16_t frame[2] = {i, ~i};
+        f_write(&fp, frame, sizeof(frame), &n);
+    }
+    f_close(&fp);
+}
+
+STATIC struct {
+    uint32_t frames; // in the file
+    // frames each channel has played, which carry on from the end to the start when it loops
+    uint32_t played[2];
+    // the last two buffers each channel was given, which the DMA may still be reading
+    uint8_t *buffers[2][2];
+    uint32_t checksums[2][2];
+    uint32_t lengths[2][2];
+    uint32_t buffer_count;
+    uint32_t mismatches;
+    uint32_t overwritten;
+    uint32_t loops;
+} wave_player;
+
+STATIC uint32_t wave_checksum(const uint8_t *buffer, uint32_t length) {
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < length; i++) {
+        sum = sum * 31 + buffer[i];
+    }
+    return sum;
+}
+
+// gets the next buffer for a channel, checks its frames and starts over at the end. A
+// channel that is a buffer behind when the other starts over goes on from the end to
+// the start without being told it's done.
+STATIC void wave_play_buffer(audioio_wavefile_obj_t *wave, bool single_channel, uint8_t channel) {
+    uint8_t *buffer;
+    uint32_t length;
+    audioio_get_buffer_result_t result = audioio_wavefile_get_buffer(wave, single_channel, channel,
+        &buffer, &length);
+    if (result == GET_BUFFER_ERROR) {
+        wave_player.mismatches++;
+        return;
+    }
+    wave_player.buffer_count++;
+    // the right channel on its own is handed the buffer one sample in
+    if (single_channel && channel == 1) {
+        buffer -= 2;
+    }
+    for (uint32_t f = 0; f < length / 4; f++) {
+        uint16_t frame = wave_player.played[channel]++ % wave_player.frames;
+        uint16_t inverted = ~frame;
+        uint16_t left;
+        uint16_t right;
+        memcpy(&left, buffer + f * 4, 2);
+        memcpy(&right, buffer + f * 4 + 2, 2);
+        if ((!(single_channel && channel == 1) && left != frame) ||
+            (!(single_channel && channel == 0) && right != inverted)) {
+            wave_player.mismatches++;
+        }
+    }
+    wave_player.buffers[channel][0] = wave_player.buffers[channel][1];
+    wave_player.checksums[channel][0] = wave_player.checksums[channel][1];
+    wave_player.lengths[channel][0] = wave_player.lengths[channel][1];
+    wave_player.buffers[channel][1] = buffer;
+    wave_player.checksums[channel][1] = wave_checksum(buffer, length);
+    wave_player.lengths[channel][1] = length;
+    if (result == GET_BUFFER_DONE) {
+        wave_player.loops++;
+        audioio_wavefile_reset_buffer(wave, single_channel, channel);
+    }
+}
+
+// prefetches and counts any buffer a channel may still be playing that changed
+STATIC void wave_prefetch(audioio_wavefile_obj_t *wave) {
+    audioio_wavefile_prefetch(wave);
+    for (uint8_t c = 0; c < 2; c++) {
+        for (uint8_t i = 0; i < 2; i++) {
+            uint8_t *buffer = wave_player.buffers[c][i];
+            if (buffer != NULL &&
+                wave_checksum(buffer, wave_player.lengths[c][i]) != wave_player.checksums[c][i]) {
+                wave_player.overwritten++;
+            }
+        }
+    }
+}
+
+// audioio and audiobusio, called by extra_coverage
+void coverage_audio(void) {
+    // audioio IMA ADPCM decoder
+    {
+        mp_printf(&mp_plat_print, "# audioio adpcm\n");
+
+        mp_printf(&mp_plat_print, "%u %u %u %u\n", (unsigned)audioio_adpcm_samples_per_block(256, 1),
+            (unsigned)audioio_adpcm_samples_per_block(2048, 2), (unsigned)audioio_adpcm_samples_per_block(4, 1),
+            (unsigned)audioio_adpcm_samples_per_block(14, 2));
+
+        // climbs into the positive clamp and top step, then down to the negative clamp
+        static const uint8_t mono[] = {
+            0x00, 0x7d, 0x50, 0x00, 0x77, 0x77, 0x77, 0x07,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+        };
+        // the right channel's step index of 95 is out of range and gets clamped
+        static const uint8_t stereo[] = {
+            0x2e, 0xfb, 0x03, 0x00, 0x37, 0x02, 0x5f, 0x00,
+            0xa5, 0x4d, 0xca, 0x18, 0x6d, 0x13, 0x2c, 0xde,
+            0x25, 0x30, 0xbb, 0x1d, 0xd6, 0x23, 0x7b, 0x2e,
+        };
+        static const struct {
+            const uint8_t *block;
+            uint32_t len;
+            uint8_t channel_count;
+        } blocks[] = {
+            {mono, sizeof(mono), 1},
+            {stereo, sizeof(stereo), 2},
+            {stereo, 12, 2}, // short block holding only the headers
+            {stereo, 7, 2}, // too short for the headers
+        };
+        int16_t out[34];
+        for (size_t i = 0; i < MP_ARRAY_SIZE(blocks); i++) {
+            uint32_t n = audioio_adpcm_decode_block(blocks[i].block, blocks[i].len, blocks[i].channel_count, out);
+            mp_printf(&mp_plat_print, "%u", (unsigned)n);
+            for (uint32_t j = 0; j < n * blocks[i].channel_count; j++) {
+                mp_printf(&mp_plat_print, " %d", out[j]);
+            }
+            mp_printf(&mp_plat_print, "\n");
+        }
+    }
+
+    // audioio fixed point resampler
+    {
+        mp_printf(&mp_plat_print, "# audioio resample\n");
+
+        static const int16_t in[] = {0, 1000, -1000, 32767, -32768, 32767, -32768, 500,
+            0, 1000, -1000, 32767, -32768, 32767, -32768, 500,
+            0, 1000, -1000, 32767, -32768, 32767, -32768, 500};
+        static const struct {
+            uint8_t taps;
+            uint8_t channel_count;
+            uint32_t step;
+            uint32_t in_frames;
+            uint32_t out_frames;
+        } runs[] = {
+            {AUDIOIO_RESAMPLE_LINEAR_TAPS, 1, AUDIOIO_RESAMPLE_ONE / 2, 8, 16}, // upsample, runs out of input
+            {AUDIOIO_RESAMPLE_LINEAR_TAPS, 1, AUDIOIO_RESAMPLE_ONE / 2, 8, 3}, // runs out of output
+            {AUDIOIO_RESAMPLE_FIR_TAPS, 1, AUDIOIO_RESAMPLE_ONE / 3, 8, 16}, // overshoot is clipped
+            {AUDIOIO_RESAMPLE_FIR_TAPS, 2, AUDIOIO_RESAMPLE_ONE * 3 / 2, 12, 16}, // stereo downsample
+        };
+        int16_t out[32];
+        for (size_t i = 0; i < MP_ARRAY_SIZE(runs); i++) {
+            audioio_resample_state_t state;
+            audioio_resample_reset(&state, runs[i].channel_count, runs[i].taps, runs[i].step);
+            uint32_t used = runs[i].in_frames;
+            uint32_t n = audioio_resample(&state, in, &used, out, runs[i].out_frames);
+            mp_printf(&mp_plat_print, "%u %u", (unsigned)used, (unsigned)n);
+            for (uint32_t j = 0; j < n * runs[i].channel_count; j++) {
+                mp_printf(&mp_plat_print, " %d", out[j]);
+            }
+            mp_printf(&mp_plat_print, "\n");
+        }
+        audioio_resample_state_t state;
+        audioio_resample_reset(&state, 1, AUDIOIO_RESAMPLE_FIR_TAPS, AUDIOIO_RESAMPLE_ONE);
+        mp_printf(&mp_plat_print, "%u", (unsigned)audioio_resample_tail_frames(&state));
+        audioio_resample_reset(&state, 1, AUDIOIO_RESAMPLE_FIR_TAPS, AUDIOIO_RESAMPLE_ONE * 3 / 2);
+        mp_printf(&mp_plat_print, " %u\n", (unsigned)audioio_resample_tail_frames(&state));
+        // lowering the pitch after the reset uses the FIR in the middle of the longer history
+        audioio_resample_reset(&state, 1, AUDIOIO_RESAMPLE_FIR_TAPS, AUDIOIO_RESAMPLE_ONE * 2);
+        state.step = AUDIOIO_RESAMPLE_ONE;
+        uint32_t used = 16;
+        uint32_t n = audioio_resample(&state, in, &used, out, 8);
+        mp_printf(&mp_plat_print, "%u %u", (unsigned)used, (unsigned)n);
+        for (uint32_t j = 0; j < n; j++) {
+            mp_printf(&mp_plat_print, " %d", out[j]);
+        }
+        mp_printf(&mp_plat_print, "\n");
+    }
+
+    // audioio resample aliasing: the peak output of a tone in the pass band and of one between
+    // the output and input Nyquist rates when downsampling, and the frames of history used
+    {
+        mp_printf(&mp_plat_print, "# audioio resample aliasing\n");
+
+        static const uint32_t steps[] = {
+            AUDIOIO_RESAMPLE_ONE * 3 / 2, AUDIOIO_RESAMPLE_ONE * 2, AUDIOIO_RESAMPLE_ONE * 3,
+            AUDIOIO_RESAMPLE_ONE * 6,
+        };
+        // fractions of the output rate
+        static const double tones[] = {0.1, 0.7};
+        static int16_t in[1024];
+        int16_t out[128];
+        for (size_t i = 0; i < MP_ARRAY_SIZE(steps); i++) {
+            audioio_resample_state_t state;
+            int peaks[MP_ARRAY_SIZE(tones)];
+            for (size_t t = 0; t < MP_ARRAY_SIZE(tones); t++) {
+                double cycles = tones[t] * AUDIOIO_RESAMPLE_ONE / steps[i];
+                for (size_t j = 0; j < MP_ARRAY_SIZE(in); j++) {
+                    in[j] = 10000 * sin(2 * M_PI * cycles * j);
+                }
+                audioio_resample_reset(&state, 1, AUDIOIO_RESAMPLE_FIR_TAPS, steps[i]);
+                uint32_t used = MP_ARRAY_SIZE(in);
+                uint32_t n = audioio_resample(&state, in, &used, out, MP_ARRAY_SIZE(out));
+                // skip the start while the history fills
+                peaks[t] = 0;
+                for (uint32_t j = 32; j < n; j++) {
+                    peaks[t] = MAX(peaks[t], abs(out[j]));
+                }
+            }
+            uint32_t step = steps[i] * 10 / AUDIOIO_RESAMPLE_ONE;
+            mp_printf(&mp_plat_print, "%u.%u: pass %d alias %d, %u frames\n", (unsigned)(step / 10),
+                (unsigned)(step % 10), peaks[0], peaks[1], (unsigned)state.length);
+        }
+    }
+
+    // audioio signed/unsigned conversion
+    {
+        mp_printf(&mp_plat_print, "# audioio convert\n");
+
+        static const uint8_t in8[] = {0x00, 0x7f, 0x80, 0xff, 0x01, 0xfe, 0x40, 0xc0, 0x12};
+        static const uint16_t in16[] = {0x0000, 0x7fff, 0x8000, 0xffff, 0x1234, 0xedcb, 0x0001};
+        uint32_t words[8];
+        uint8_t *out8 = (uint8_t *)words;
+        audioio_convert_signed_8(out8, in8, 9, 1);
+        for (size_t i = 0; i < 9; i++) {
+            mp_printf(&mp_plat_print, "%02x ", out8[i]);
+        }
+        audioio_convert_signed_8(out8 + 1, in8 + 1, 4, 2); // unaligned, right channel
+        mp_printf(&mp_plat_print, "%02x %02x %02x %02x\n", out8[1], out8[2], out8[3], out8[4]);
+        uint16_t *out16 = (uint16_t *)words;
+        audioio_convert_signed_16(out16, in16, 7, 1);
+        for (size_t i = 0; i < 7; i++) {
+            mp_printf(&mp_plat_print, "%04x ", out16[i]);
+        }
+        audioio_convert_signed_16(out16 + 1, in16 + 1, 3, 2); // unaligned, right channel
+        mp_printf(&mp_plat_print, "%04x %04x %04x\n", out16[1], out16[2], out16[3]);
+
+        // every alignment, spacing and length against one sample at a time
+        uint32_t in_words[16];
+        uint8_t *in_bytes = (uint8_t *)in_words;
+        for (size_t i = 0; i < sizeof(in_words); i++) {
+            in_bytes[i] = i * 37;
+        }
+        unsigned mismatches = 0;
+        for (uint8_t width = 1; width <= 2; width++) {
+            for (uint8_t spacing = 1; spacing <= 3; spacing++) {
+                for (uint8_t in_offset = 0; in_offset < 4; in_offset += width) {
+                    for (uint8_t out_offset = 0; out_offset < 4; out_offset += width) {
+                        for (uint32_t count = 0; count < 9; count++) {
+                            memset(words, 0, sizeof(words));
+                            uint8_t *in = in_bytes + in_offset;
+                            uint8_t *out = out8 + out_offset;
+                            if (width == 1) {
+                                audioio_convert_signed_8(out, in, count, spacing);
+                            } else {
+                                audioio_convert_signed_16((uint16_t *)out, (uint16_t *)in, count, spacing);
+                            }
+                            for (uint32_t i = 0; i < sizeof(words); i++) {
+                                uint8_t expected = 0;
+                                if (i >= out_offset && i < out_offset + count * width) {
+                                    uint32_t sample = (i - out_offset) / width;
+                                    uint32_t part = (i - out_offset) % width;
+                                    expected = in[sample * spacing * width + part];
+                                    if (part + 1 == width) {
+                                        expected ^= 0x80;
+                                    }
+                                }
+                                if (out8[i] != expected) {
+                                    mismatches++;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        mp_printf(&mp_plat_print, "%u\n", mismatches);
+    }
+
+    // audioio fixed point effects
+    {
+        mp_printf(&mp_plat_print, "# audioio effects\n");
+
+        // a stereo ramp up over four frames split across two calls, then a constant gain
+        int16_t frames[16];
+        for (size_t i = 0; i < 16; i++) {
+            frames[i] = i % 2 == 0 ? 20000 : -20000;
+        }
+        audioio_gain_t gain;
+        audioio_gain_set(&gain, 0);
+        audioio_gain_ramp(&gain, AUDIOIO_GAIN_UNITY, 4);
+        audioio_gain_apply(&gain, frames, 3, 2);
+        audioio_gain_apply(&gain, frames + 6, 3, 2);
+        audioio_gain_set(&gain, AUDIOIO_GAIN_UNITY / 4);
+        audioio_gain_apply(&gain, frames + 12, 2, 2);
+        for (size_t i = 0; i < 16; i++) {
+            mp_printf(&mp_plat_print, "%d ", frames[i]);
+        }
+        mp_printf(&mp_plat_print, "%u\n", audioio_gain_target(&gain));
+
+        // step responses of each filter; the low pass passes the step, the high pass and DC
+        // blocker return to zero and the second channel is independent
+        int16_t step[128];
+        audioio_biquad_t biquad;
+        audioio_biquad_low_pass(&biquad, 22050, 1000, 0.7071f);
+        audioio_biquad_clear(&biquad);
+        for (size_t i = 0; i < 128; i++) {
+            step[i] = i % 2 == 0 ? 10000 : -10000;
+        }
+        audioio_biquad_apply(&biquad, step, 64, 2);
+        mp_printf(&mp_plat_print, "%d %d %d %d %d\n", step[0], step[2], step[8], step[126], step[127]);
+        audioio_biquad_high_pass(&biquad, 22050, 1000, 0.7071f);
+        audioio_biquad_clear(&biquad);
+        for (size_t i = 0; i < 128; i++) {
+            step[i] = 10000;
+        }
+        audioio_biquad_apply(&biquad, step, 128, 1);
+        mp_printf(&mp_plat_print, "%d %d %d %d\n", step[0], step[1], step[8], step[127]);
+        audioio_dc_block_t dc_block;
+        audioio_dc_block_clear(&dc_block);
+        int16_t first = 0;
+        for (size_t round = 0; round < 40; round++) {
+            for (size_t i = 0; i < 128; i++) {
+                step[i] = 10000;
+            }
+            audioio_dc_block_apply(&dc_block, step, 128, 1);
+            if (round == 0) {
+                first = step[0];
+            }
+        }
+        mp_printf(&mp_plat_print, "%d %d\n", first, step[127]);
+
+        // a full scale square wave through a resonant low pass clips instead of wrapping
+        int16_t square[64];
+        for (size_t i = 0; i < 64; i++) {
+            square[i] = (i / 16) % 2 == 0 ? INT16_MAX : INT16_MIN;
+        }
+        audioio_biquad_low_pass(&biquad, 22050, 2000, 4.0f);
+        audioio_biquad_clear(&biquad);
+        audioio_biquad_apply(&biquad, square, 64, 1);
+        int16_t lowest = 0;
+        int16_t highest = 0;
+        for (size_t i = 0; i < 64; i++) {
+            lowest = MIN(lowest, square[i]);
+            highest = MAX(highest, square[i]);
+        }
+        mp_printf(&mp_plat_print, "%d %d\n", lowest, highest);
+    }
+
+    // audioio mixer voices summed with gain and saturation
+    {
+        mp_printf(&mp_plat_print, "# audioio mix\n");
+
+        // the first voice overwrites, the second adds and saturates both ways
+        static const int16_t first[] = {1000, -1000, 32767, -32768, 20000, -20001};
+        static const int16_t second[] = {500, 32767, 1, -1, -20000, 20001};
+        int16_t out16[6];
+        audioio_mix_16(out16, (const uint16_t *)first, 6, 0, AUDIOIO_MIXER_UNITY_GAIN, false);
+        audioio_mix_16(out16, (const uint16_t *)second, 6, 0, AUDIOIO_MIXER_UNITY_GAIN, true);
+        mp_printf(&mp_plat_print, "16 unity:");
+        for (size_t i = 0; i < MP_ARRAY_SIZE(out16); i++) {
+            mp_printf(&mp_plat_print, " %d", out16[i]);
+        }
+        mp_printf(&mp_plat_print, "\n");
+
+        // half gain rounds down, and unsigned samples are flipped to signed first
+        audioio_mix_16(out16, (const uint16_t *)first, 6, 0, AUDIOIO_MIXER_UNITY_GAIN / 2, false);
+        static const uint16_t unsigned16[] = {0x8000, 0xffff, 0x0000, 0x8000, 0xffff, 0x0000};
+        audioio_mix_16(out16 + 4, unsigned16, 2, 0x8000, AUDIOIO_MIXER_UNITY_GAIN, true);
+        mp_printf(&mp_plat_print, "16 half:");
+        for (size_t i = 0; i < MP_ARRAY_SIZE(out16); i++) {
+            mp_printf(&mp_plat_print, " %d", out16[i]);
+        }
+        mp_printf(&mp_plat_print, "\n");
+
+        // the same for 8 bit samples, with zero gain silencing a voice
+        static const int8_t first8[] = {10, -10, 127, -128, 100, -101};
+        static const int8_t second8[] = {5, 127, 1, -1, -100, 101};
+        static const uint8_t unsigned8[] = {0x80, 0xff, 0x00, 0x80, 0xff, 0x00};
+        int8_t out8[6];
+        audioio_mix_8(out8, (const uint8_t *)first8, 6, 0, AUDIOIO_MIXER_UNITY_GAIN, false);
+        audioio_mix_8(out8, (const uint8_t *)second8, 6, 0, AUDIOIO_MIXER_UNITY_GAIN, true);
+        audioio_mix_8(out8, unsigned8, 6, 0x80, 0, true);
+        mp_printf(&mp_plat_print, "8 unity:");
+        for (size_t i = 0; i < MP_ARRAY_SIZE(out8); i++) {
+            mp_printf(&mp_plat_print, " %d", out8[i]);
+        }
+        mp_printf(&mp_plat_print, "\n");
+        audioio_mix_8(out8, (const uint8_t *)first8, 6, 0, AUDIOIO_MIXER_UNITY_GAIN / 2, false);
+        audioio_mix_8(out8 + 3, unsigned8, 3, 0x80, AUDIOIO_MIXER_UNITY_GAIN, true);
+        mp_printf(&mp_plat_print, "8 half:");
+        for (size_t i = 0; i < MP_ARRAY_SIZE(out8); i++) {
+            mp_printf(&mp_plat_print, " %d", out8[i]);
+        }
+        mp_printf(&mp_plat_print, "\n");
+    }
+
+    // audioio wavetable synthesis
+    {
+        mp_printf(&mp_plat_print, "# audioio wavetable\n");
+
+        // with no envelope a voice stepping a whole number of entries plays the table exactly
+        audioio_synth_t synth = {audioio_synth_sine, AUDIOIO_SYNTH_SINE_BITS, 0, 0, 1 << 15, 0};
+        audioio_synth_voice_t voices[3];
+        int16_t out[100];
+        audioio_synth_voice_clear(&voices[0]);
+        audioio_synth_press(&synth, &voices[0], 3 << 24, 1 << 15);
+        audioio_synth_render(&synth, voices, 1, out, 100);
+        size_t mismatches = 0;
+        for (size_t i = 0; i < 100; i++) {
+            if (out[i] != audioio_synth_sine[(i * 3) % 256]) {
+                mismatches++;
+            }
+        }
+        mp_printf(&mp_plat_print, "%u %d %d\n", (uint)mismatches, out[1], out[86]);
+
+        // a flat table shows the envelope: attack, decay to half, sustain, then release to off
+        static const int16_t flat[2] = {20000, 20000};
+        audioio_synth_t adsr = {flat, 1, 4, 4, 1 << 14, 4};
+        audioio_synth_voice_clear(&voices[0]);
+        audioio_synth_press(&adsr, &voices[0], 1 << 20, 1 << 15);
+        audioio_synth_render(&adsr, voices, 1, out, 10);
+        audioio_synth_release(&adsr, &voices[0]);
+        audioio_synth_render(&adsr, voices, 1, out + 10, 6);
+        for (size_t i = 0; i < 16; i++) {
+            mp_printf(&mp_plat_print, "%d ", out[i]);
+        }
+        mp_printf(&mp_plat_print, "%d\n", voices[0].stage);
+
+        // voices add and clip, and a chord renders the same every time
+        audioio_synth_voice_clear(&voices[0]);
+        audioio_synth_voice_clear(&voices[1]);
+        audioio_synth_voice_clear(&voices[2]);
+        audioio_synth_press(&synth, &voices[0], 2 << 24, 1 << 15);
+        audioio_synth_press(&synth, &voices[1], 2 << 24, 1 << 15);
+        audioio_synth_render(&synth, voices, 2, out, 100);
+        mp_printf(&mp_plat_print, "%d %d %d\n", out[8], out[32], out[96]);
+        synth.attack = 50;
+        synth.decay = 50;
+        synth.sustain = 1 << 14;
+        audioio_synth_voice_clear(&voices[0]);
+        audioio_synth_voice_clear(&voices[1]);
+        // 440Hz, 550Hz and 660Hz at 22050Hz
+        audioio_synth_press(&synth, &voices[0], 85704563, 1 << 14);
+        audioio_synth_press(&synth, &voices[1], 107130704, 1 << 14);
+        audioio_synth_press(&synth, &voices[2], 128556844, 1 << 14);
+        uint32_t checksum = 0;
+        for (size_t block = 0; block < 10; block++) {
+            audioio_synth_render(&synth, voices, 3, out, 100);
+            for (size_t i = 0; i < 100; i++) {
+                checksum = checksum * 31 + (uint16_t)out[i];
+            }
+        }
+        mp_printf(&mp_plat_print, "%d %d %08x %u\n", out[0], out[99], (uint)checksum,
+            (uint)audioio_synth_phase_step(2756.25f, 22050));
+    }
+
+    // audioio sample protocol
+    {
+        mp_printf(&mp_plat_print, "# audioio sample protocol\n");
+
+        // a type from outside audioio plays through the same calls as the built in samples
+        mp_obj_base_t sample = {&mp_type_atest_sample};
+        mp_obj_t sample_obj = audiosample_check(MP_OBJ_FROM_PTR(&sample));
+        mp_printf(&mp_plat_print, "%d %u %u %u\n", sample_obj == MP_OBJ_FROM_PTR(&sample),
+            (uint)audiosample_sample_rate(sample_obj), audiosample_bits_per_sample(sample_obj),
+            audiosample_channel_count(sample_obj));
+        bool single_buffer;
+        bool samples_signed;
+        uint32_t max_buffer_length;
+        uint8_t spacing;
+        audiosample_get_buffer_structure(sample_obj, false, &single_buffer, &samples_signed,
+            &max_buffer_length, &spacing);
+        audiosample_reset_buffer(sample_obj, false, 0);
+        uint8_t *buffer;
+        uint32_t buffer_length;
+        audioio_get_buffer_result_t result = audiosample_get_buffer(sample_obj, false, 0, &buffer,
+            &buffer_length);
+        // prefetch is optional
+        audiosample_prefetch(sample_obj);
+        mp_printf(&mp_plat_print, "%d %d %u %u %d %u %u\n", single_buffer, samples_signed,
+            (uint)max_buffer_length, spacing, result == GET_BUFFER_DONE, (uint)buffer_length,
+            buffer[1]);
+
+        // streams have a protocol too but aren't samples
+        mp_obj_base_t stream = {&mp_type_bytesio};
+        mp_obj_t not_samples[] = {MP_OBJ_FROM_PTR(&stream), MP_OBJ_NEW_SMALL_INT(1), mp_const_none};
+        for (size_t i = 0; i < MP_ARRAY_SIZE(not_samples); i++) {
+            nlr_buf_t nlr;
+            if (nlr_push(&nlr) == 0) {
+                audiosample_check(not_samples[i]);
+                nlr_pop();
+            } else {
+                mp_obj_print_exception(&mp_plat_print, MP_OBJ_FROM_PTR(nlr.ret_val));
+            }
+        }
+    }
+
+    // audioio WaveFile prefetching into three buffers while two may be playing
+    {
+        mp_printf(&mp_plat_print, "# audioio wavefile\n");
+
+        const uint32_t frames = 3000;
+        nor_mkfs(4, 0xff, 0);
+        wave_write_file("wave.wav", frames);
+        static pyb_file_obj_t file;
+        f_open(&nor_vfs.fatfs, &file.fp, "wave.wav", FA_READ);
+        audioio_wavefile_obj_t wave;
+        common_hal_audioio_wavefile_construct(&wave, &file, 512);
+
+        // both channels from one buffer, and then each channel with its own DMA where
+        // one of them is a buffer behind and gets the end after the other has restarted
+        for (int single_channel = 0; single_channel <= 1; single_channel++) {
+            memset(&wave_player, 0, sizeof(wave_player));
+            wave_player.frames = frames;
+            wave.underruns = 0;
+            audioio_wavefile_reset_buffer(&wave, single_channel, 0);
+            audioio_wavefile_reset_buffer(&wave, single_channel, 1);
+            uint32_t seed = 1;
+            uint32_t reads[2] = {0, 0};
+            while (wave_player.played[0] < 3 * frames ||
+                   (single_channel && wave_player.played[1] < 3 * frames)) {
+                uint8_t channel = 0;
+                if (single_channel) {
+                    seed = seed * 1664525 + 1013904223;
+                    channel = (seed >> 16) % 2;
+                    if (reads[channel] > reads[1 - channel]) {
+                        channel = 1 - channel;
+                    }
+                }
+                reads[channel]++;
+                wave_play_buffer(&wave, single_channel, channel);
+                wave_prefetch(&wave);
+            }
+            mp_printf(&mp_plat_print, "single channel %d: %u buffers, %u loops, %u underruns, %u mismatches, %u overwritten\n",
+                single_channel, (unsigned)wave_player.buffer_count, (unsigned)wave_player.loops,
+                (unsigned)common_hal_audioio_wavefile_get_underruns(&wave),
+                (unsigned)wave_player.mismatches, (unsigned)wave_player.overwritten);
+        }
+
+        // both channels finish before either starts over, and then the left one has a buffer of
+        // the start before the right one starts over. They must both get the same start.
+        audioio_wavefile_reset_buffer(&wave, true, 0);
+        audioio_wavefile_reset_buffer(&wave, true, 1);
+        uint8_t *buffer;
+        uint32_t length;
+        audioio_get_buffer_result_t results[2];
+        do {
+            results[0] = audioio_wavefile_get_buffer(&wave, true, 0, &buffer, &length);
+            results[1] = audioio_wavefile_get_buffer(&wave, true, 1, &buffer, &length);
+        } while (results[0] == GET_BUFFER_MORE_DATA);
+        mp_printf(&mp_plat_print, "%d %d", results[0] == GET_BUFFER_DONE, results[1] == GET_BUFFER_DONE);
+        static const uint8_t order[] = {0, 1, 0, 1};
+        for (size_t i = 0; i < MP_ARRAY_SIZE(order); i++) {
+            uint8_t channel = order[i];
+            if (i < 2) {
+                audioio_wavefile_reset_buffer(&wave, true, channel);
+            }
+            audioio_wavefile_get_buffer(&wave, true, channel, &buffer, &length);
+            uint16_t sample;
+            memcpy(&sample, buffer, 2);
+            mp_printf(&mp_plat_print, " %u", channel == 0 ? sample : (uint16_t)~sample);
+        }
+        mp_printf(&mp_plat_print, "\n");
+
+        // without prefetching every load after the first two is an underrun
+        memset(&wave_player, 0, sizeof(wave_player));
+        wave_player.frames = frames;
+        wave.underruns = 0;
+        audioio_wavefile_reset_buffer(&wave, false, 0);
+        while (wave_player.loops < 1) {
+            wave_play_buffer(&wave, false, 0);
+        }
+        mp_printf(&mp_plat_print, "no prefetch: %u buffers, %u underruns, %u mismatches\n",
+            (unsigned)wave_player.buffer_count, (unsigned)common_hal_audioio_wavefile_get_underruns(&wave),
+            (unsigned)wave_player.mismatches);
+        f_close(&file.fp);
+    }
+
+    // audiobusio PDM decimation
+    {
+        mp_printf(&mp_plat_print, "# audiobusio pdm\n");
+
+        // silence, all ones, alternating bits, and a single bit at the peak tap; the
+        // high halves are another channel and must be ignored
+        static const uint32_t pdm[] = {
+            0xffff0000, 0x00000000, 0x00000000, 0x12340000,
+            0x0000ffff, 0x0000ffff, 0x0000ffff, 0xabcdffff,
+            0x0000aaaa, 0x0000aaaa, 0x0000aaaa, 0x0000aaaa,
+            0x00000000, 0x00000001, 0x00000000, 0x00000000,
+        };
+        uint16_t out16[4];
+        uint8_t out8[4];
+        audiobusio_pdm_filter_16(pdm, 4, out16);
+        audiobusio_pdm_filter_8(pdm, 4, out8);
+        mp_printf(&mp_plat_print, "%u %u %u %u %u %u %u %u\n", out16[0], out8[0], out16[1], out8[1],
+            out16[2], out8[2], out16[3], out8[3]);
+
+        // pseudo-random PDM against the filter applied one bit at a time
+        uint32_t random_pdm[AUDIOBUSIO_PDM_WORDS_PER_SAMPLE * 8];
+        uint32_t seed = 1;
+        unsigned mismatches = 0;
+        for (size_t round = 0; round < 64; round++) {
+            for (size_t i = 0; i < MP_ARRAY_SIZE(random_pdm); i++) {
+                seed = seed * 1664525 + 1013904223;
+                random_pdm[i] = seed;
+            }
+            uint16_t filtered[8];
+            audiobusio_pdm_filter_16(random_pdm, 8, filtered);
+            for (size_t i = 0; i < 8; i++) {
+                uint16_t expected = 0;
+                for (size_t bit = 0; bit < AUDIOBUSIO_PDM_OVERSAMPLING; bit++) {
+                    uint32_t word = random_pdm[i * AUDIOBUSIO_PDM_WORDS_PER_SAMPLE + bit / 16];
+                    if ((word & (0x8000 >> (bit % 16))) != 0) {
+                        expected += audiobusio_pdm_sinc_filter[bit];
+                    }
+                }
+                if (filtered[i] != expected) {
+                    mismatches++;
+                }
+            }
+        }
+        mp_printf(&mp_plat_print, "%u\n", mismatches);
+    }
+
+    // audiobusio single producer, single consumer ring
+    {
+        mp_printf(&mp_plat_print, "# audiobusio ring\n");
+
+        uint8_t storage[7];
+        audiobusio_ring_t ring;
+        audiobusio_ring_init(&ring, storage, sizeof(storage));
+        uint8_t out[8];
+        bool fit = audiobusio_ring_put(&ring, (const uint8_t*) "abcde", 5);
+        bool overfull = audiobusio_ring_put(&ring, (const uint8_t*) "xyz", 3);
+        uint32_t got = audiobusio_ring_get(&ring, out, 3);
+        mp_printf(&mp_plat_print, "%d %d %.*s %u\n", fit, overfull, (int) got, out,
+            (unsigned) audiobusio_ring_count(&ring));
+        // this one wraps around the end of the storage
+        fit = audiobusio_ring_put(&ring, (const uint8_t*) "fghij", 5);
+        mp_printf(&mp_plat_print, "%d %u %u\n", fit, (unsigned) audiobusio_ring_count(&ring),
+            (unsigned) audiobusio_ring_space(&ring));
+        got = audiobusio_ring_get(&ring, out, sizeof(out));
+        mp_printf(&mp_plat_print, "%.*s %u\n", (int) got, out, (unsigned) audiobusio_ring_count(&ring));
+
+        // random sized puts and gets against a counter that names every byte
+        uint32_t seed = 1;
+        uint8_t next_put = 0;
+        uint8_t next_get = 0;
+        unsigned mismatches = 0;
+        for (size_t round = 0; round < 1000; round++) {
+            seed = seed * 1664525 + 1013904223;
+            uint32_t length = (seed >> 24) % (sizeof(storage) + 2);
+            if ((seed & 0x10000) != 0) {
+                uint8_t data[sizeof(storage) + 2];
+                for (size_t i = 0; i < length; i++) {
+                    data[i] = next_put + i;
+                }
+                bool room = audiobusio_ring_space(&ring) >= length;
+                if (audiobusio_ring_put(&ring, data, length) != room) {
+                    mismatches++;
+                }
+                if (room) {
+                    next_put += length;
+                }
+            } else {
+                uint8_t data[sizeof(storage) + 2];
+                got = audiobusio_ring_get(&ring, data, length);
+                for (size_t i = 0; i < got; i++) {
+                    if (data[i] != next_get++) {
+                        mismatches++;
+                    }
+                }
+            }
+            if (audiobusio_ring_count(&ring) != (uint8_t) (next_put - next_get)) {
+                mismatches++;
+            }
+        }
+        mp_printf(&mp_plat_print, "%u\n", mismatches);
+    }
+}
+
+#endif
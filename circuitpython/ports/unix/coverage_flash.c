@@ -0,0 +1,734 @@
+#include <string.h>
+
+#include "py/runtime.h"
+#include "supervisor/shared/flash_cache.h"
+#include "supervisor/shared/flash_ftl.h"
+#include "supervisor/shared/flash_journal.h"
+#include "lib/oofatfs/ff.h"
+#include "coverage.h"
+
+#if defined(MICROPY_UNIX_COVERAGE)
+
+
+// a simulated NOR flash for the supervisor flash code that counts what it is asked to do
+#define NOR_SIZE (256 * 1024)
+#define NOR_SECTORS (NOR_SIZE / FLASH_CACHE_ERASE_SIZE)
+
+STATIC uint8_t nor_data[NOR_SIZE];
+
+STATIC struct {
+    uint32_t reads;
+    uint32_t read_bytes;
+    uint32_t programs; // one per page program command
+    uint32_t program_bytes;
+    uint32_t erases;
+    uint32_t bad_programs; // programs that needed a bit to go from 0 to 1
+    uint16_t sector_erases[NOR_SECTORS];
+    // time taken by a W25Q16JV with typical program and erase times on a 24MHz SPI bus
+    uint32_t time_us;
+} nor_stats;
+
+// programs and erases left before the power goes, or -1 to keep it on
+STATIC int32_t nor_power_left = -1;
+
+// when set, the first program or erase after the power goes half happens
+STATIC bool nor_tear;
+
+STATIC bool nor_powered(void) {
+    if (nor_power_left == 0) {
+        return false;
+    }
+    if (nor_power_left > 0) {
+        nor_power_left--;
+    }
+    return true;
+}
+
+STATIC bool nor_read(uint32_t address, uint8_t *data, uint32_t length) {
+    if (address + length > NOR_SIZE) {
+        return false;
+    }
+    nor_stats.reads++;
+    nor_stats.read_bytes += length;
+    nor_stats.time_us += 2 + length / 3;
+    memcpy(data, nor_data + address, length);
+    return true;
+}
+
+STATIC bool nor_program(uint32_t address, const uint8_t *data, uint32_t length) {
+    if (address + length > NOR_SIZE) {
+        return false;
+    }
+    if (!nor_powered()) {
+        for (uint32_t i = 0; nor_tear && i < length / 2; i++) {
+            nor_data[address + i] &= data[i];
+        }
+        nor_tear = false;
+        return false;
+    }
+    for (uint32_t i = 0; i < length; i++) {
+        if (i == 0 || (address + i) % FLASH_CACHE_PAGE_SIZE == 0) {
+            nor_stats.programs++;
+            nor_stats.time_us += 400;
+        }
+        if ((nor_data[address + i] & data[i]) != data[i]) {
+            nor_stats.bad_programs++;
+        }
+        nor_data[address + i] &= data[i];
+    }
+    nor_stats.program_bytes += length;
+    nor_stats.time_us += 2 + length / 3;
+    return true;
+}
+
+STATIC bool nor_erase(uint32_t address) {
+    if (address % FLASH_CACHE_ERASE_SIZE != 0 || address >= NOR_SIZE) {
+        return false;
+    }
+    if (!nor_powered()) {
+        if (nor_tear) {
+            memset(nor_data + address, 0xff, FLASH_CACHE_ERASE_SIZE / 2);
+        }
+        nor_tear = false;
+        return false;
+    }
+    nor_stats.erases++;
+    nor_stats.time_us += 45000;
+    nor_stats.sector_erases[address / FLASH_CACHE_ERASE_SIZE]++;
+    memset(nor_data + address, 0xff, FLASH_CACHE_ERASE_SIZE);
+    return true;
+}
+
+STATIC bool nor_busy(void) {
+    return false;
+}
+
+// ram for the flash cache, limited to nor_ram_sectors sectors
+STATIC uint8_t nor_ram[FLASH_CACHE_MAX_SECTORS * FLASH_CACHE_ERASE_SIZE];
+STATIC uint8_t *nor_ram_pages[FLASH_CACHE_MAX_SECTORS * FLASH_CACHE_PAGES_PER_SECTOR];
+STATIC uint8_t nor_ram_sectors;
+
+STATIC uint8_t **nor_allocate(uint8_t max_sectors, uint8_t *sectors) {
+    if (nor_ram_sectors == 0) {
+        return NULL;
+    }
+    for (size_t i = 0; i < MP_ARRAY_SIZE(nor_ram_pages); i++) {
+        nor_ram_pages[i] = nor_ram + i * FLASH_CACHE_PAGE_SIZE;
+    }
+    *sectors = MIN(max_sectors, nor_ram_sectors);
+    return nor_ram_pages;
+}
+
+STATIC void nor_free(uint8_t **pages) {
+    (void)pages;
+}
+
+STATIC const flash_cache_flash_t nor_cache_flash = {
+    .read = nor_read,
+    .program = nor_program,
+    .erase = nor_erase,
+    .busy = nor_busy,
+    .allocate = nor_allocate,
+    .free = nor_free,
+};
+
+// a FAT filesystem on the simulated flash, with the last sector as scratch
+STATIC flash_cache_t nor_cache;
+fs_user_mount_t nor_vfs;
+
+// reads one block at a time when set, as the SPI flash did before reads were coalesced
+STATIC bool nor_split_reads;
+
+STATIC mp_uint_t nor_readblocks(uint8_t *dest, uint32_t block, uint32_t num_blocks) {
+    if (nor_split_reads) {
+        for (uint32_t i = 0; i < num_blocks; i++) {
+            if (!flash_cache_read_blocks(&nor_cache, dest + i * FLASH_CACHE_BLOCK_SIZE, block + i, 1)) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+    return flash_cache_read_blocks(&nor_cache, dest, block, num_blocks) ? 0 : 1;
+}
+
+STATIC mp_uint_t nor_writeblocks(const uint8_t *src, uint32_t block, uint32_t num_blocks) {
+    return flash_cache_write_blocks(&nor_cache, src, block, num_blocks) ? 0 : 1;
+}
+
+STATIC mp_obj_t nor_ioctl(mp_obj_t self, mp_obj_t cmd_in, mp_obj_t arg_in) {
+    (void)self;
+    (void)arg_in;
+    switch (mp_obj_get_int(cmd_in)) {
+        case BP_IOCTL_SYNC:
+            // the same as a sync of the SPI flash
+            if (!flash_cache_commit(&nor_cache)) {
+                flash_cache_flush(&nor_cache, false);
+            }
+            return MP_OBJ_NEW_SMALL_INT(0);
+        case BP_IOCTL_SEC_COUNT: return MP_OBJ_NEW_SMALL_INT(nor_cache.size / FLASH_CACHE_BLOCK_SIZE);
+        case BP_IOCTL_SEC_SIZE: return MP_OBJ_NEW_SMALL_INT(FLASH_CACHE_BLOCK_SIZE);
+        default: return mp_const_none;
+    }
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(nor_ioctl_obj, nor_ioctl);
+
+// fills the flash, 0xff for erased and 0x00 for used, and sets up an empty cache
+STATIC void nor_reset(uint8_t ram_sectors, uint8_t fill) {
+    memset(nor_data, fill, sizeof(nor_data));
+    nor_power_left = -1;
+    nor_ram_sectors = ram_sectors;
+    flash_cache_init(&nor_cache, &nor_cache_flash, NOR_SIZE - FLASH_CACHE_ERASE_SIZE,
+        NOR_SIZE - FLASH_CACHE_ERASE_SIZE, NULL);
+    memset(&nor_stats, 0, sizeof(nor_stats));
+}
+
+// makes a fresh filesystem with clusters of au bytes, or FatFs' choice when 0, and clears the counters
+void nor_mkfs(uint8_t ram_sectors, uint8_t fill, uint32_t au) {
+    nor_reset(ram_sectors, fill);
+    memset(&nor_vfs, 0, sizeof(nor_vfs));
+    nor_vfs.flags = FSUSER_NATIVE | FSUSER_HAVE_IOCTL;
+    nor_vfs.fatfs.drv = &nor_vfs;
+    nor_vfs.readblocks[2] = (mp_obj_t)nor_readblocks;
+    nor_vfs.writeblocks[0] = (mp_obj_t)&nor_ioctl_obj; // anything but NULL so it's writable
+    nor_vfs.writeblocks[2] = (mp_obj_t)nor_writeblocks;
+    nor_vfs.u.ioctl[0] = (mp_obj_t)&nor_ioctl_obj;
+    nor_vfs.u.ioctl[1] = mp_const_none;
+    uint8_t working_buf[_MAX_SS];
+    f_mkfs(&nor_vfs.fatfs, FM_FAT | FM_SFD, au, working_buf, sizeof(working_buf));
+    f_mount(&nor_vfs.fatfs);
+    memset(&nor_stats, 0, sizeof(nor_stats));
+}
+
+// the flash translation layer on the whole simulated flash
+STATIC const flash_ftl_flash_t nor_ftl_flash = {
+    .read = nor_read,
+    .program = nor_program,
+    .erase = nor_erase,
+    .erase_size = FLASH_CACHE_ERASE_SIZE,
+};
+
+STATIC uint32_t nor_ftl_ram[512];
+
+// prints the erases per KB, the spread of erases over the sectors and the modelled throughput
+STATIC void nor_print_wear(uint32_t kb_written) {
+    uint32_t min_erases = 0xffff;
+    uint32_t max_erases = 0;
+    for (size_t i = 0; i < NOR_SECTORS; i++) {
+        min_erases = MIN(min_erases, nor_stats.sector_erases[i]);
+        max_erases = MAX(max_erases, nor_stats.sector_erases[i]);
+    }
+    uint32_t per_kb = nor_stats.erases * 100 / kb_written;
+    mp_printf(&mp_plat_print, "%u.%02u erases/KB, %u-%u per sector, %u KB/s", (unsigned)(per_kb / 100),
+        (unsigned)(per_kb % 100), (unsigned)min_erases, (unsigned)max_erases,
+        (unsigned)((uint64_t)kb_written * 1000000 / nor_stats.time_us));
+}
+
+// the block written next by a filesystem in use: FAT and directory blocks are rewritten
+// often and file data is rewritten sequentially over most of the volume
+STATIC uint32_t nor_next_block(uint32_t *seed, uint32_t *sequential, uint32_t block_count) {
+    *seed = *seed * 1664525 + 1013904223;
+    uint32_t r = (*seed >> 16) % 10;
+    if (r < 4) {
+        return (*seed >> 8) % 8;
+    } else if (r < 5) {
+        return 8 + (*seed >> 8) % 24;
+    }
+    *sequential = (*sequential + 1) % (block_count * 6 / 10);
+    return 32 + *sequential;
+}
+
+// sums the erases of the sectors holding file data, past the FAT and root directory
+STATIC uint32_t nor_data_erases(void) {
+    uint32_t erases = 0;
+    for (uint32_t i = nor_vfs.fatfs.database / FLASH_CACHE_BLOCKS_PER_SECTOR; i < NOR_SECTORS - 1; i++) {
+        erases += nor_stats.sector_erases[i];
+    }
+    return erases;
+}
+
+// writes total bytes to a new file in chunks of the given size, syncing every sync_every chunks
+STATIC void nor_write_file(const char *path, uint32_t total, uint32_t chunk, uint32_t sync_every) {
+    FIL fp;
+    uint8_t buf[FLASH_CACHE_ERASE_SIZE];
+    f_open(&nor_vfs.fatfs, &fp, path, FA_WRITE | FA_CREATE_ALWAYS);
+    for (uint32_t i = 0; i * chunk < total; i++) {
+        memset(buf, 'a' + i % 26, chunk);
+        UINT n;
+        f_write(&fp, buf, chunk, &n);
+        if ((i + 1) % sync_every == 0) {
+            f_sync(&fp);
+        }
+    }
+    f_close(&fp);
+}
+
+// the cache with a write-ahead journal between the blocks and the scratch sector, as the SPI flash lays it out
+#define NOR_JOURNAL_SIZE (2 * (FLASH_CACHE_MAX_SECTORS + 2) * FLASH_CACHE_ERASE_SIZE)
+#define NOR_JOURNAL_BLOCKS ((NOR_SIZE - FLASH_CACHE_ERASE_SIZE - NOR_JOURNAL_SIZE) / FLASH_CACHE_BLOCK_SIZE)
+
+STATIC flash_journal_t nor_journal;
+
+// how many programs of the journal fail next while the rest of the flash still works
+STATIC uint32_t nor_journal_failures;
+
+STATIC bool nor_journal_program(uint32_t address, const uint8_t *data, uint32_t length) {
+    if (nor_journal_failures > 0) {
+        nor_journal_failures--;
+        // the power can still go meanwhile
+        nor_powered();
+        return false;
+    }
+    return nor_program(address, data, length);
+}
+
+STATIC const flash_journal_flash_t nor_journal_flash = {
+    .read = nor_read,
+    .program = nor_journal_program,
+    .erase = nor_erase,
+    .erase_size = FLASH_CACHE_ERASE_SIZE,
+};
+
+STATIC bool nor_replay_block(uint32_t address, uint32_t journal_address) {
+    return flash_cache_replay_block(&nor_cache, address, journal_address);
+}
+
+// starts up after a reset: replays the journal and writes everything back in place
+STATIC void nor_journal_boot(void) {
+    uint32_t journal_address = NOR_SIZE - FLASH_CACHE_ERASE_SIZE - NOR_JOURNAL_SIZE;
+    nor_ram_sectors = FLASH_CACHE_MAX_SECTORS;
+    flash_cache_init(&nor_cache, &nor_cache_flash, journal_address, NOR_SIZE - FLASH_CACHE_ERASE_SIZE, &nor_journal);
+    if (flash_journal_init(&nor_journal, &nor_journal_flash, journal_address, NOR_JOURNAL_SIZE)) {
+        flash_journal_replay(&nor_journal, nor_replay_block);
+        flash_cache_flush(&nor_cache, false);
+    }
+}
+
+// the contents of a block named by its number and version. Each version
+// fills in more of the block than the one before, so three writes in four
+// only clear bits, and every fourth starts again from erased.
+STATIC void nor_versioned_block(uint8_t *data, uint32_t block, uint32_t version) {
+    static const uint16_t filled[] = {0, 128, 256, FLASH_CACHE_BLOCK_SIZE};
+    uint32_t seed = block * 2654435761u + version / 4;
+    memset(data, 0xff, FLASH_CACHE_BLOCK_SIZE);
+    for (uint32_t i = 0; i < filled[version % 4]; i++) {
+        seed = seed * 1664525 + 1013904223;
+        data[i] = seed >> 24;
+    }
+}
+
+// the version each block should have and an undo log of versions back to the last sync
+STATIC uint32_t nor_versions[NOR_JOURNAL_BLOCKS];
+STATIC struct {
+    uint16_t block;
+    uint32_t version;
+} nor_undo[4096];
+STATIC uint32_t nor_undo_count;
+STATIC uint32_t nor_seed;
+
+STATIC uint32_t nor_random(void) {
+    nor_seed = nor_seed * 1664525 + 1013904223;
+    return nor_seed >> 8;
+}
+
+STATIC void nor_write_version(uint32_t block) {
+    uint8_t data[FLASH_CACHE_BLOCK_SIZE];
+    bool logged = nor_undo_count < MP_ARRAY_SIZE(nor_undo);
+    if (logged) {
+        nor_undo[nor_undo_count].block = block;
+        nor_undo[nor_undo_count].version = nor_versions[block];
+        nor_undo_count++;
+    }
+    nor_versions[block]++;
+    nor_versioned_block(data, block, nor_versions[block]);
+    if (!flash_cache_write_blocks(&nor_cache, data, block, 1) && nor_power_left != 0) {
+        // the block couldn't be made room for, so it still has the old version
+        nor_undo_count -= logged;
+        nor_versions[block]--;
+    }
+}
+
+// one step of a random workload of writes, syncs and idle write backs. The
+// undo log is only cleared by a sync or flush that finished before the power went.
+STATIC void nor_journal_step(void) {
+    uint32_t r = nor_random() % 100;
+    if (r < 60) {
+        // mostly a few hot blocks, like the FAT and a directory
+        uint32_t block = nor_random() % 2 != 0 ? nor_random() % 40 : nor_random() % NOR_JOURNAL_BLOCKS;
+        nor_write_version(block);
+    } else if (r < 75) {
+        // a run of blocks, sometimes a whole sector
+        uint32_t count = 1 + nor_random() % 16;
+        uint32_t block = nor_random() % (NOR_JOURNAL_BLOCKS - count);
+        if (nor_random() % 2 != 0) {
+            block -= block % FLASH_CACHE_BLOCKS_PER_SECTOR;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            nor_write_version(block + i);
+        }
+    } else if (r < 92) {
+        if ((flash_cache_commit(&nor_cache) || flash_cache_flush(&nor_cache, false)) && nor_power_left != 0) {
+            nor_undo_count = 0;
+        }
+    } else if (r < 97) {
+        if (flash_cache_loaded(&nor_cache) && !flash_cache_commit(&nor_cache)) {
+            flash_cache_flush(&nor_cache, true);
+        }
+    } else {
+        if (flash_cache_flush(&nor_cache, false) && nor_power_left != 0) {
+            nor_undo_count = 0;
+        }
+    }
+}
+
+// reads back every block and walks the undo log back until they match. Returns how
+// many writes since the last sync were lost, or -1 if nothing since then matches.
+STATIC int32_t nor_journal_check(void) {
+    static uint8_t disk[NOR_JOURNAL_BLOCKS * FLASH_CACHE_BLOCK_SIZE];
+    uint8_t expected[FLASH_CACHE_BLOCK_SIZE];
+    flash_cache_read_blocks(&nor_cache, disk, 0, NOR_JOURNAL_BLOCKS);
+    uint32_t mismatched = 0;
+    for (uint32_t b = 0; b < NOR_JOURNAL_BLOCKS; b++) {
+        nor_versioned_block(expected, b, nor_versions[b]);
+        mismatched += memcmp(disk + b * FLASH_CACHE_BLOCK_SIZE, expected, FLASH_CACHE_BLOCK_SIZE) != 0;
+    }
+    uint32_t lost = 0;
+    while (mismatched > 0 && lost < nor_undo_count) {
+        lost++;
+        uint32_t b = nor_undo[nor_undo_count - lost].block;
+        uint8_t *actual = disk + b * FLASH_CACHE_BLOCK_SIZE;
+        nor_versioned_block(expected, b, nor_versions[b]);
+        mismatched -= memcmp(actual, expected, FLASH_CACHE_BLOCK_SIZE) != 0;
+        nor_versions[b] = nor_undo[nor_undo_count - lost].version;
+        nor_versioned_block(expected, b, nor_versions[b]);
+        mismatched += memcmp(actual, expected, FLASH_CACHE_BLOCK_SIZE) != 0;
+    }
+    return mismatched == 0 ? (int32_t)lost : -1;
+}
+
+// the supervisor flash cache, journal and translation layer, called by extra_coverage
+void coverage_flash(void) {
+    // flash cache, reporting erases per KB written
+    {
+        mp_printf(&mp_plat_print, "# flash cache\n");
+
+        // on used flash, a host appends each block of a file and then rewrites the FAT and
+        // directory blocks, which are in other sectors, without a sync
+        static const uint8_t ram_sectors[] = {0, 1, 2, 4};
+        for (size_t i = 0; i < MP_ARRAY_SIZE(ram_sectors); i++) {
+            nor_reset(ram_sectors[i], 0x00);
+            uint8_t block[FLASH_CACHE_BLOCK_SIZE];
+            for (uint32_t j = 0; j < 32; j++) {
+                memset(block, j, sizeof(block));
+                flash_cache_write_blocks(&nor_cache, block, 16 + j, 1);
+                flash_cache_write_blocks(&nor_cache, block, 1, 1);
+                flash_cache_write_blocks(&nor_cache, block, 9, 1);
+            }
+            flash_cache_flush(&nor_cache, false);
+            uint32_t per_kb = nor_stats.erases * 100 / 16;
+            mp_printf(&mp_plat_print, "trace %u: %u erases %u.%02u/KB %u bad\n", (unsigned)ram_sectors[i],
+                (unsigned)nor_stats.erases, (unsigned)(per_kb / 100), (unsigned)(per_kb % 100),
+                (unsigned)nor_stats.bad_programs);
+        }
+
+        // files written through FatFs on erased and on used flash
+        static const struct {
+            uint32_t total;
+            uint32_t chunk;
+            uint32_t sync_every;
+        } workloads[] = {
+            {16384, 4096, 4}, // copying a file
+            {8192, 64, 8}, // a data logger syncing every 512 bytes
+        };
+        for (size_t i = 0; i < MP_ARRAY_SIZE(workloads); i++) {
+            for (uint8_t fill = 0; fill < 2; fill++) {
+                for (size_t j = 0; j < MP_ARRAY_SIZE(ram_sectors); j += 3) {
+                    nor_mkfs(ram_sectors[j], fill == 0 ? 0xff : 0x00, 0);
+                    nor_write_file("log.txt", workloads[i].total, workloads[i].chunk, workloads[i].sync_every);
+                    flash_cache_flush(&nor_cache, false);
+                    uint32_t per_kb = nor_stats.erases * 100 * 1024 / workloads[i].total;
+                    mp_printf(&mp_plat_print, "%u %s %u: %u erases %u.%02u/KB %u bad\n",
+                        (unsigned)workloads[i].chunk, fill == 0 ? "erased" : "used", (unsigned)ram_sectors[j],
+                        (unsigned)nor_stats.erases, (unsigned)(per_kb / 100), (unsigned)(per_kb % 100),
+                        (unsigned)nor_stats.bad_programs);
+                }
+            }
+        }
+
+        // the data reads back after a remount
+        FIL fp;
+        uint8_t buf[64];
+        UINT n = 0;
+        f_mount(&nor_vfs.fatfs);
+        f_open(&nor_vfs.fatfs, &fp, "log.txt", FA_READ);
+        f_lseek(&fp, 8192 - 64);
+        f_read(&fp, buf, sizeof(buf), &n);
+        f_close(&fp);
+        mp_printf(&mp_plat_print, "%u %c %c\n", (unsigned)n, buf[0], buf[63]);
+    }
+
+    // flash cache writes that only clear bits and pre-erased free sectors
+    {
+        mp_printf(&mp_plat_print, "# flash cache in place\n");
+
+        // appending to a file on erased flash only programs its sectors
+        nor_mkfs(4, 0xff, 0);
+        nor_write_file("log.txt", 8192, 64, 8);
+        flash_cache_flush(&nor_cache, false);
+        mp_printf(&mp_plat_print, "append: %u data erases %u other erases %u bad\n", (unsigned)nor_data_erases(),
+            (unsigned)(nor_stats.erases - nor_data_erases()), (unsigned)nor_stats.bad_programs);
+
+        // the sectors of a deleted file are erased in the background before it's written again
+        for (int pre_erase = 0; pre_erase < 2; pre_erase++) {
+            nor_mkfs(4, 0x00, 0);
+            nor_write_file("a.bin", 16384, 4096, 4);
+            f_unlink(&nor_vfs.fatfs, "a.bin");
+            flash_cache_flush(&nor_cache, false);
+            memset(&nor_stats, 0, sizeof(nor_stats));
+            while (pre_erase && flash_cache_pre_erase_pending(&nor_cache)) {
+                flash_cache_pre_erase_next(&nor_cache, &nor_vfs.fatfs, 0);
+            }
+            uint32_t pre_erases = nor_stats.erases;
+            nor_write_file("b.bin", 16384, 512, 8);
+            flash_cache_flush(&nor_cache, false);
+            mp_printf(&mp_plat_print, "pre-erase %d: %u pre-erases then %u data erases %u other erases %u bad\n",
+                pre_erase, (unsigned)pre_erases, (unsigned)(nor_data_erases() - pre_erases),
+                (unsigned)(nor_stats.erases - nor_data_erases()), (unsigned)nor_stats.bad_programs);
+        }
+
+        // a failed program is reported when a cached sector is programmed over in place
+        nor_reset(1, 0xff);
+        uint8_t block[FLASH_CACHE_BLOCK_SIZE];
+        static const uint8_t values[] = {0x0f, 0xf0, 0x00};
+        for (size_t i = 0; i < MP_ARRAY_SIZE(values); i++) {
+            // in place, then cached since it sets bits, then cached again
+            memset(block, values[i], sizeof(block));
+            flash_cache_write_blocks(&nor_cache, block, 0, 1);
+        }
+        uint32_t erases = nor_stats.erases;
+        nor_power_left = 0;
+        bool ok = flash_cache_flush(&nor_cache, false);
+        mp_printf(&mp_plat_print, "%u %u %d\n", (unsigned)nor_stats.programs, (unsigned)(nor_stats.erases - erases), ok);
+    }
+
+    // power cuts part way through writes to the cache with a journal
+    {
+        mp_printf(&mp_plat_print, "# flash journal\n");
+
+        nor_seed = 1;
+        uint32_t failures = 0;
+        uint32_t lost = 0;
+        uint32_t second_cuts = 0;
+        const uint32_t trials = 200;
+        for (uint32_t t = 0; t < trials; t++) {
+            memset(nor_data, 0xff, sizeof(nor_data));
+            nor_power_left = -1;
+            nor_journal_boot();
+            for (uint32_t b = 0; b < NOR_JOURNAL_BLOCKS; b++) {
+                nor_versions[b] = nor_random() % 4;
+                uint8_t data[FLASH_CACHE_BLOCK_SIZE];
+                nor_versioned_block(data, b, nor_versions[b]);
+                flash_cache_write_blocks(&nor_cache, data, b, 1);
+            }
+            flash_cache_flush(&nor_cache, false);
+            // run a while first so that the journal has wrapped
+            for (uint32_t i = nor_random() % 400; i > 0; i--) {
+                nor_journal_step();
+            }
+            if (!flash_cache_commit(&nor_cache)) {
+                flash_cache_flush(&nor_cache, false);
+            }
+            nor_undo_count = 0;
+            nor_power_left = 1 + nor_random() % 300;
+            nor_tear = true;
+            while (nor_power_left != 0) {
+                nor_journal_step();
+            }
+            // sometimes the power goes again while the journal is replayed
+            if (nor_random() % 3 == 0) {
+                second_cuts++;
+                nor_power_left = 1 + nor_random() % 40;
+                nor_tear = true;
+                nor_journal_boot();
+            }
+            nor_power_left = -1;
+            nor_tear = false;
+            nor_journal_boot();
+            int32_t back = nor_journal_check();
+            if (back < 0) {
+                failures++;
+            } else {
+                lost += back;
+            }
+        }
+        mp_printf(&mp_plat_print, "%u power cuts, %u during replay: %u unrecoverable, %u writes since the last sync lost\n",
+            (unsigned)trials, (unsigned)second_cuts, (unsigned)failures, (unsigned)lost);
+    }
+
+    // commits that fail part way through and then a power cut
+    {
+        mp_printf(&mp_plat_print, "# flash journal failing\n");
+
+        nor_seed = 2;
+        uint32_t failures = 0;
+        uint32_t lost = 0;
+        uint32_t cleared = 0;
+        const uint32_t trials = 200;
+        for (uint32_t t = 0; t < trials; t++) {
+            memset(nor_data, 0xff, sizeof(nor_data));
+            nor_power_left = -1;
+            nor_journal_boot();
+            for (uint32_t b = 0; b < NOR_JOURNAL_BLOCKS; b++) {
+                nor_versions[b] = nor_random() % 4;
+                uint8_t data[FLASH_CACHE_BLOCK_SIZE];
+                nor_versioned_block(data, b, nor_versions[b]);
+                flash_cache_write_blocks(&nor_cache, data, b, 1);
+            }
+            flash_cache_flush(&nor_cache, false);
+            for (uint32_t i = nor_random() % 400; i > 0; i--) {
+                nor_journal_step();
+            }
+            // sometimes the snapshot in the other half fails too, and then a flush that
+            // gives back the ram empties the journal
+            nor_journal_failures = 1 + nor_random() % 12;
+            while (nor_journal_failures > 0) {
+                nor_journal_step();
+            }
+            cleared += nor_journal.clears > 0;
+            nor_power_left = 1 + nor_random() % 300;
+            nor_tear = true;
+            while (nor_power_left != 0) {
+                nor_journal_step();
+            }
+            nor_power_left = -1;
+            nor_tear = false;
+            nor_journal_boot();
+            int32_t back = nor_journal_check();
+            if (back < 0) {
+                failures++;
+            } else {
+                lost += back;
+            }
+        }
+        mp_printf(&mp_plat_print, "%u power cuts, %u with the journal emptied: %u unrecoverable, %u writes since the last sync lost\n",
+            (unsigned)trials, (unsigned)cleared, (unsigned)failures, (unsigned)lost);
+    }
+
+    // flash translation layer wear and throughput against the cache, on the same writes
+    {
+        mp_printf(&mp_plat_print, "# flash ftl\n");
+
+        static flash_ftl_t ftl;
+        nor_reset(4, 0xff);
+        mp_printf(&mp_plat_print, "%d\n", flash_ftl_ram_size(NOR_SIZE) <= sizeof(nor_ftl_ram));
+        flash_ftl_init(&ftl, &nor_ftl_flash, NOR_SIZE, nor_ftl_ram);
+        uint32_t block_count = ftl.block_count;
+        // the version last written to each block, which names its contents
+        static uint16_t versions[NOR_SIZE / FLASH_FTL_BLOCK_SIZE];
+        memset(versions, 0, sizeof(versions));
+        uint8_t block[FLASH_FTL_BLOCK_SIZE];
+        uint32_t seed = 1;
+        uint32_t sequential = 0;
+        const uint32_t writes = 8000;
+        for (uint32_t i = 0; i < writes; i++) {
+            uint32_t b = nor_next_block(&seed, &sequential, block_count);
+            versions[b]++;
+            memset(block, versions[b], sizeof(block));
+            block[0] = b;
+            flash_ftl_write_block(&ftl, block, b);
+            if (i == writes / 2) {
+                // a reset rebuilds the map from the flash
+                flash_ftl_init(&ftl, &nor_ftl_flash, NOR_SIZE, nor_ftl_ram);
+            }
+        }
+        unsigned mismatches = 0;
+        for (uint32_t b = 0; b < block_count; b++) {
+            flash_ftl_read_block(&ftl, block, b);
+            bool written = versions[b] != 0;
+            if (block[0] != (written ? (uint8_t)b : 0xff) || block[1] != (written ? (uint8_t)versions[b] : 0xff)) {
+                mismatches++;
+            }
+        }
+        uint32_t amplification = (uint64_t)nor_stats.program_bytes * 100 / (writes * FLASH_FTL_BLOCK_SIZE);
+        mp_printf(&mp_plat_print, "ftl %u blocks: %u mismatches, write amplification %u.%02u, ", (unsigned)block_count,
+            mismatches, (unsigned)(amplification / 100), (unsigned)(amplification % 100));
+        nor_print_wear(writes / 2);
+        mp_printf(&mp_plat_print, "\n");
+
+        // the cache writes back every 64 writes, as it would once writes pause
+        nor_reset(4, 0xff);
+        seed = 1;
+        sequential = 0;
+        for (uint32_t i = 0; i < writes; i++) {
+            uint32_t b = nor_next_block(&seed, &sequential, block_count);
+            memset(block, i, sizeof(block));
+            flash_cache_write_blocks(&nor_cache, block, b, 1);
+            if (i % 64 == 63) {
+                flash_cache_flush(&nor_cache, true);
+            }
+        }
+        flash_cache_flush(&nor_cache, false);
+        mp_printf(&mp_plat_print, "cache: ");
+        nor_print_wear(writes / 2);
+        mp_printf(&mp_plat_print, "\n");
+    }
+
+    // flash reads coalesced into one command per run of blocks on the flash
+    {
+        mp_printf(&mp_plat_print, "# flash reads\n");
+
+        // FatFs carries a read on into clusters that follow on the disk, whatever their size
+        static const uint32_t cluster_sizes[] = {512, 1024, 4096};
+        for (size_t i = 0; i < MP_ARRAY_SIZE(cluster_sizes); i++) {
+            nor_mkfs(4, 0xff, cluster_sizes[i]);
+            nor_write_file("read.bin", 32768, 4096, 8);
+            flash_cache_flush(&nor_cache, false);
+            static const uint32_t chunk_sizes[] = {512, 4096, 16384};
+            for (size_t j = 0; j < MP_ARRAY_SIZE(chunk_sizes); j++) {
+                mp_printf(&mp_plat_print, "cluster %u read %u:", (unsigned)cluster_sizes[i], (unsigned)chunk_sizes[j]);
+                for (int split = 1; split >= 0; split--) {
+                    nor_split_reads = split;
+                    FIL fp;
+                    static uint8_t buf[16384];
+                    UINT n;
+                    f_open(&nor_vfs.fatfs, &fp, "read.bin", FA_READ);
+                    memset(&nor_stats, 0, sizeof(nor_stats));
+                    uint32_t total = 0;
+                    while (f_read(&fp, buf, chunk_sizes[j], &n) == FR_OK && n > 0) {
+                        total += n;
+                    }
+                    f_close(&fp);
+                    mp_printf(&mp_plat_print, " %u %u", (unsigned)total, (unsigned)nor_stats.reads);
+                }
+                mp_printf(&mp_plat_print, "\n");
+            }
+        }
+        nor_split_reads = false;
+
+        // a run is broken by blocks whose newest copy is in the cache, which come from ram
+        nor_reset(4, 0xff);
+        for (uint32_t b = 0; b < 64; b++) {
+            memset(nor_data + b * FLASH_CACHE_BLOCK_SIZE, b, FLASH_CACHE_BLOCK_SIZE);
+        }
+        uint8_t block[FLASH_CACHE_BLOCK_SIZE];
+        memset(block, 0xff, sizeof(block));
+        static const uint8_t cached[] = {10, 11, 40};
+        for (size_t i = 0; i < MP_ARRAY_SIZE(cached); i++) {
+            flash_cache_write_blocks(&nor_cache, block, cached[i], 1);
+        }
+        static uint8_t blocks[64 * FLASH_CACHE_BLOCK_SIZE];
+        memset(&nor_stats, 0, sizeof(nor_stats));
+        bool ok = flash_cache_read_blocks(&nor_cache, blocks, 0, 64);
+        unsigned mismatches = 0;
+        for (uint32_t b = 0; b < 64; b++) {
+            uint8_t expected = (b == 10 || b == 11 || b == 40) ? 0xff : b;
+            for (uint32_t k = 0; k < FLASH_CACHE_BLOCK_SIZE; k++) {
+                if (blocks[b * FLASH_CACHE_BLOCK_SIZE + k] != expected) {
+                    mismatches++;
+                }
+            }
+        }
+        mp_printf(&mp_plat_print, "%d %u reads %u mismatches\n", ok, (unsigned)nor_stats.reads, mismatches);
+    }
+}
+
+#endif
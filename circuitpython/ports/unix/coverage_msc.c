@@ -0,0 +1,191 @@
+#include <string.h>
+
+#include "py/runtime.h"
+#include "supervisor/shared/usb_msc_transfer.h"
+#include "coverage.h"
+
+#if defined(MICROPY_UNIX_COVERAGE)
+
+
+// a ram disk behind usb mass storage transfers and a USB peripheral that is
+// sometimes busy and finishes transfers whenever the test says so
+#define MSC_DISK_BLOCKS (300)
+#define MSC_MAX_COMMAND (64)
+
+STATIC uint8_t msc_disk[MSC_DISK_BLOCKS * USB_MSC_TRANSFER_BLOCK_SIZE];
+STATIC uint8_t msc_expected[MSC_DISK_BLOCKS * USB_MSC_TRANSFER_BLOCK_SIZE];
+STATIC uint8_t msc_host[MSC_MAX_COMMAND * USB_MSC_TRANSFER_BLOCK_SIZE];
+STATIC uint8_t msc_buffers[2 * 8 * USB_MSC_TRANSFER_BLOCK_SIZE];
+STATIC usb_msc_transfer_t msc_transfer;
+STATIC uint32_t msc_seed;
+
+STATIC struct {
+    bool read;
+    bool busy;
+    bool done;
+    uint8_t *buffer;
+    uint32_t count;
+    uint32_t nblocks;
+    uint32_t moved;
+    uint32_t errors;
+} msc_usb;
+
+STATIC struct {
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t blocks_written;
+    uint32_t misaligned;
+} msc_stats;
+
+STATIC uint32_t msc_random(void) {
+    msc_seed = msc_seed * 1664525 + 1013904223;
+    return msc_seed >> 8;
+}
+
+STATIC bool msc_start(bool read, uint8_t *buffer, uint32_t count) {
+    // starting while busy, in the wrong direction or past the end of the command is an error
+    if (msc_usb.busy || read != msc_usb.read || msc_usb.moved + count > msc_usb.nblocks) {
+        msc_usb.errors++;
+        return false;
+    }
+    if (msc_random() % 5 == 0) {
+        return false;
+    }
+    msc_usb.busy = true;
+    msc_usb.buffer = buffer;
+    msc_usb.count = count;
+    return true;
+}
+
+STATIC void msc_finish_write(void) {
+    // the status may only be sent once every block has been received
+    if (msc_usb.read || msc_usb.moved != msc_usb.nblocks) {
+        msc_usb.errors++;
+    }
+    msc_usb.done = true;
+}
+
+STATIC void msc_read_blocks(uint8_t lun, uint8_t *dest, uint32_t block, uint32_t count) {
+    (void)lun;
+    msc_stats.reads++;
+    memcpy(dest, msc_disk + block * USB_MSC_TRANSFER_BLOCK_SIZE, count * USB_MSC_TRANSFER_BLOCK_SIZE);
+}
+
+STATIC void msc_write_blocks(uint8_t lun, const uint8_t *src, uint32_t block, uint32_t count) {
+    (void)lun;
+    msc_stats.writes++;
+    msc_stats.blocks_written += count;
+    uint32_t buffer_blocks = msc_transfer.buffer_blocks;
+    if (count == buffer_blocks && (block - msc_transfer.first_block) % buffer_blocks != 0) {
+        msc_stats.misaligned++;
+    }
+    memcpy(msc_disk + block * USB_MSC_TRANSFER_BLOCK_SIZE, src, count * USB_MSC_TRANSFER_BLOCK_SIZE);
+}
+
+STATIC const usb_msc_transfer_io_t msc_io = {
+    .start = msc_start,
+    .finish_write = msc_finish_write,
+    .read_blocks = msc_read_blocks,
+    .write_blocks = msc_write_blocks,
+};
+
+// moves the data of the transfer in progress to or from the host
+STATIC void msc_complete(void) {
+    uint8_t *host = msc_host + msc_usb.moved * USB_MSC_TRANSFER_BLOCK_SIZE;
+    if (msc_usb.read) {
+        memcpy(host, msc_usb.buffer, msc_usb.count * USB_MSC_TRANSFER_BLOCK_SIZE);
+    } else {
+        memcpy(msc_usb.buffer, host, msc_usb.count * USB_MSC_TRANSFER_BLOCK_SIZE);
+    }
+    msc_usb.moved += msc_usb.count;
+    msc_usb.busy = false;
+    if (msc_usb.read && msc_usb.moved == msc_usb.nblocks) {
+        msc_usb.done = true;
+    }
+    usb_msc_transfer_done(&msc_transfer);
+}
+
+// runs random reads and writes against the ram disk and returns how many
+// commands got stuck or moved the wrong data
+STATIC uint32_t msc_run_commands(uint32_t commands) {
+    uint32_t failures = 0;
+    for (uint32_t c = 0; c < commands; c++) {
+        msc_usb.read = msc_random() % 2;
+        uint32_t addr = msc_random() % MSC_DISK_BLOCKS;
+        uint32_t nblocks = 1 + msc_random() % (msc_random() % 4 == 0 ? MSC_MAX_COMMAND : 9);
+        if (addr + nblocks > MSC_DISK_BLOCKS) {
+            nblocks = MSC_DISK_BLOCKS - addr;
+        }
+        msc_usb.nblocks = nblocks;
+        msc_usb.moved = 0;
+        msc_usb.done = false;
+        if (msc_usb.read) {
+            usb_msc_transfer_new_read(&msc_transfer, 0, addr, nblocks);
+        } else {
+            for (uint32_t i = 0; i < nblocks * USB_MSC_TRANSFER_BLOCK_SIZE; i++) {
+                msc_host[i] = msc_random();
+            }
+            usb_msc_transfer_new_write(&msc_transfer, 0, addr, nblocks);
+        }
+        uint32_t spins = 0;
+        while (!msc_usb.done && spins++ < 10000) {
+            if (msc_random() % 3 != 0) {
+                usb_msc_transfer_background(&msc_transfer);
+            }
+            if (msc_usb.busy && msc_random() % 2 != 0) {
+                msc_complete();
+            }
+        }
+        // the background task keeps running between commands
+        for (uint32_t i = msc_random() % 3; i > 0; i--) {
+            usb_msc_transfer_background(&msc_transfer);
+        }
+        uint8_t *expected = msc_expected + addr * USB_MSC_TRANSFER_BLOCK_SIZE;
+        uint32_t length = nblocks * USB_MSC_TRANSFER_BLOCK_SIZE;
+        if (msc_usb.read) {
+            if (!msc_usb.done || memcmp(msc_host, expected, length) != 0) {
+                failures++;
+            }
+        } else {
+            memcpy(expected, msc_host, length);
+            if (!msc_usb.done || memcmp(msc_disk, msc_expected, sizeof(msc_disk)) != 0) {
+                failures++;
+            }
+        }
+    }
+    return failures;
+}
+
+// usb mass storage transfers, called by extra_coverage
+void coverage_msc(void) {
+    // usb mass storage transfers double buffered over a ram disk
+    {
+        mp_printf(&mp_plat_print, "# usb msc transfer\n");
+
+        // buffers line up with erase sectors that start at block 1
+        usb_msc_transfer_init(&msc_transfer, &msc_io, msc_buffers, 8, 1);
+        mp_printf(&mp_plat_print, "%u %u %u %u\n",
+            (unsigned)usb_msc_transfer_chunk_blocks(&msc_transfer, 0, 20),
+            (unsigned)usb_msc_transfer_chunk_blocks(&msc_transfer, 1, 20),
+            (unsigned)usb_msc_transfer_chunk_blocks(&msc_transfer, 5, 20),
+            (unsigned)usb_msc_transfer_chunk_blocks(&msc_transfer, 9, 3));
+
+        static const uint8_t buffer_blocks[] = {1, 8};
+        for (size_t i = 0; i < MP_ARRAY_SIZE(buffer_blocks); i++) {
+            msc_seed = 1;
+            for (size_t k = 0; k < sizeof(msc_disk); k++) {
+                msc_disk[k] = msc_expected[k] = msc_random();
+            }
+            memset(&msc_usb, 0, sizeof(msc_usb));
+            memset(&msc_stats, 0, sizeof(msc_stats));
+            usb_msc_transfer_init(&msc_transfer, &msc_io, msc_buffers, buffer_blocks[i], 1);
+            uint32_t failures = msc_run_commands(2000);
+            mp_printf(&mp_plat_print, "%u block buffers: %u failures %u errors, %u reads %u writes of %u blocks, %u misaligned\n",
+                (unsigned)buffer_blocks[i], (unsigned)failures, (unsigned)msc_usb.errors,
+                (unsigned)msc_stats.reads, (unsigned)msc_stats.writes,
+                (unsigned)msc_stats.blocks_written, (unsigned)msc_stats.misaligned);
+        }
+    }
+}
+
+#endif
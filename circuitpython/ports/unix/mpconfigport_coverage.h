@@ -29,6 +29,7 @@
 
 #define MICROPY_VFS                    (1)
 #define MICROPY_PY_UOS_VFS             (1)
+#define MICROPY_PY_SHARED_STRUCT       (1)
 
 #include <mpconfigport.h>
 
@@ -48,6 +49,8 @@
 #undef MICROPY_VFS_FAT
 #define MICROPY_VFS_FAT                (1)
 #define MICROPY_FATFS_USE_LABEL        (1)
+#define MICROPY_FATFS_DCACHE           (8)
+#define MICROPY_MODULE_IMPORT_CACHE    (1)
 #define MICROPY_PY_FRAMEBUF            (1)
 #define MICROPY_PY_COLLECTIONS_NAMEDTUPLE__ASDICT (1)
 
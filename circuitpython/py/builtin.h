@@ -29,6 +29,9 @@
 #include "py/obj.h"
 
 mp_obj_t mp_builtin___import__(size_t n_args, const mp_obj_t *args);
+#if MICROPY_MODULE_IMPORT_CACHE
+void mp_import_cache_clear(void);
+#endif
 mp_obj_t mp_builtin_open(size_t n_args, const mp_obj_t *args, mp_map_t *kwargs);
 mp_obj_t mp_micropython_mem_info(size_t n_args, const mp_obj_t *args);
 
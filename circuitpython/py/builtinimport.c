@@ -40,6 +40,11 @@
 
 #include "supervisor/shared/translate.h"
 
+#if MICROPY_MODULE_IMPORT_CACHE
+#include "py/objstr.h"
+#include "extmod/vfs.h"
+#endif
+
 #if MICROPY_DEBUG_VERBOSE // print debugging info
 #define DEBUG_PRINT (1)
 #define DEBUG_printf DEBUG_printf
@@ -74,7 +79,219 @@ STATIC mp_import_stat_t mp_import_stat_any(const char *path) {
     return mp_import_stat(path);
 }
 
+#if MICROPY_MODULE_IMPORT_CACHE
+// The import cache maps each directory that import has searched to a dict of
+// the names in it that could be imported: subdirectories and the stems of .py
+// and .mpy files. A directory is listed the first time a module is looked for
+// in it, so a module that lives in the last sys.path entry costs one dict
+// lookup per entry instead of three stats. Only lowercase names are answered
+// from the cache. A name with a differently cased sibling, which includes
+// CODE.PY or Other.Py for code and other, is looked up with stat so that
+// case-insensitive filesystems behave as before.
+
+#define IMPORT_CACHE_DIR (1)
+#define IMPORT_CACHE_PY (2)
+#define IMPORT_CACHE_MPY (4)
+#define IMPORT_CACHE_CASE_VARIANT (8)
+
+void mp_import_cache_clear(void) {
+    MP_STATE_VM(import_cache) = MP_OBJ_NULL;
+}
+
+// Looks up a string without allocating a str object for it.
+STATIC mp_map_elem_t *import_cache_lookup_str(mp_obj_t dict, const char *str, size_t len) {
+    mp_obj_str_t key = {{&mp_type_str}, qstr_compute_hash((const byte*)str, len), len, (const byte*)str};
+    return mp_map_lookup(mp_obj_dict_get_map(dict), MP_OBJ_FROM_PTR(&key), MP_MAP_LOOKUP);
+}
+
+// Returns true if name ends with the lowercase suffix in any case, since FAT
+// finds CODE.PY when asked for code.py. Sets *case_variant if the case
+// differs.
+STATIC bool import_cache_has_suffix(const char *name, size_t len, const char *suffix, size_t suffix_len,
+                                    bool *case_variant) {
+    if (len <= suffix_len) {
+        return false;
+    }
+    name += len - suffix_len;
+    bool differs = false;
+    for (size_t i = 0; i < suffix_len; i++) {
+        char c = name[i];
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+            differs = true;
+        }
+        if (c != suffix[i]) {
+            return false;
+        }
+    }
+    *case_variant = differs;
+    return true;
+}
+
+STATIC void import_cache_add(void *arg, const char *name, size_t len, bool is_dir) {
+    mp_int_t flag = IMPORT_CACHE_DIR;
+    bool case_variant = false;
+    if (!is_dir) {
+        if (import_cache_has_suffix(name, len, ".py", 3, &case_variant)) {
+            flag = IMPORT_CACHE_PY;
+            len -= 3;
+        } else if (import_cache_has_suffix(name, len, ".mpy", 4, &case_variant)) {
+            flag = IMPORT_CACHE_MPY;
+            len -= 4;
+        } else {
+            return;
+        }
+    }
+    vstr_t folded;
+    vstr_init(&folded, len);
+    for (size_t i = 0; i < len; i++) {
+        char c = name[i];
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+            case_variant = true;
+        }
+        vstr_add_byte(&folded, c);
+    }
+    if (case_variant) {
+        flag = IMPORT_CACHE_CASE_VARIANT;
+    }
+    mp_obj_t key = mp_obj_new_str_from_vstr(&mp_type_str, &folded);
+    mp_map_elem_t *elem = mp_map_lookup(mp_obj_dict_get_map(MP_OBJ_FROM_PTR(arg)), key, MP_MAP_LOOKUP_ADD_IF_NOT_FOUND);
+    mp_int_t flags = elem->value == MP_OBJ_NULL ? 0 : MP_OBJ_SMALL_INT_VALUE(elem->value);
+    elem->value = MP_OBJ_NEW_SMALL_INT(flags | flag);
+}
+
+// Returns the names in the directory, or MP_OBJ_NULL if it couldn't be listed
+// for a reason other than not existing.
+STATIC mp_obj_t import_cache_list_dir(const char *dir, size_t dir_len) {
+    mp_obj_t path = mp_obj_new_str(dir, dir_len);
+    const char *path_out;
+    mp_vfs_mount_t *vfs = mp_vfs_lookup_path(mp_obj_str_get_str(path), &path_out);
+    if (vfs == MP_VFS_NONE || vfs == MP_VFS_ROOT) {
+        // Not on a mounted filesystem, so the port's mp_import_stat may see
+        // something that ilistdir can't.
+        return MP_OBJ_NULL;
+    }
+    mp_obj_t entries = mp_obj_new_dict(0);
+    #if MICROPY_MODULE_FROZEN
+    if (strncmp(dir, MP_FROZEN_FAKE_DIR, MP_FROZEN_FAKE_DIR_LENGTH) == 0) {
+        if (dir_len == MP_FROZEN_FAKE_DIR_LENGTH) {
+            mp_frozen_list_dir("", 0, import_cache_add, MP_OBJ_TO_PTR(entries));
+        } else if (dir[MP_FROZEN_FAKE_DIR_LENGTH] == '/') {
+            mp_frozen_list_dir(dir + MP_FROZEN_FAKE_DIR_SLASH_LENGTH, dir_len - MP_FROZEN_FAKE_DIR_SLASH_LENGTH,
+                import_cache_add, MP_OBJ_TO_PTR(entries));
+        }
+    }
+    #endif
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        if (dir_len == 0) {
+            // Not every filesystem takes "" to mean the current directory.
+            path = mp_vfs_getcwd();
+        }
+        mp_obj_t iter = mp_getiter(mp_vfs_ilistdir(1, &path), NULL);
+        mp_obj_t item;
+        while ((item = mp_iternext(iter)) != MP_OBJ_STOP_ITERATION) {
+            // Each entry is (name, type, inode[, size]).
+            size_t n;
+            mp_obj_t *info;
+            mp_obj_get_array(item, &n, &info);
+            mp_int_t type = mp_obj_get_int(info[1]);
+            if (type != MP_S_IFDIR && type != MP_S_IFREG) {
+                // A symlink or similar; only stat can tell what it leads to.
+                nlr_pop();
+                return MP_OBJ_NULL;
+            }
+            size_t len;
+            const char *name = mp_obj_str_get_data(info[0], &len);
+            import_cache_add(MP_OBJ_TO_PTR(entries), name, len, type == MP_S_IFDIR);
+        }
+        nlr_pop();
+    } else {
+        mp_obj_t exc_type = MP_OBJ_FROM_PTR(((mp_obj_base_t*)nlr.ret_val)->type);
+        if (mp_obj_is_subclass_fast(exc_type, MP_OBJ_FROM_PTR(&mp_type_MemoryError))) {
+            // Not enough memory to cache the directory; fall back to stat.
+            return MP_OBJ_NULL;
+        }
+        if (!mp_obj_is_subclass_fast(exc_type, MP_OBJ_FROM_PTR(&mp_type_OSError))) {
+            // KeyboardInterrupt, or an error from a VFS written in Python,
+            // belongs to whoever called import.
+            nlr_jump(nlr.ret_val);
+        }
+    }
+    // An OSError means there's no such directory (or it isn't one), which
+    // stat would also report for every name in it.
+    return entries;
+}
+
+// Answers whether path (a directory, a slash and a module name) names a
+// package, a .py or a .mpy file. Returns -1 if stat has to decide.
+STATIC mp_int_t import_cache_lookup(vstr_t *path) {
+    const char *str = vstr_str(path);
+    size_t len = vstr_len(path);
+    size_t dir_len = len;
+    while (dir_len > 0 && str[dir_len - 1] != PATH_SEP_CHAR) {
+        dir_len--;
+    }
+    const char *stem = str + dir_len;
+    size_t stem_len = len - dir_len;
+    if (dir_len > 0) {
+        // Drop the separator from the directory name.
+        dir_len--;
+    }
+    for (size_t i = 0; i < stem_len; i++) {
+        if ((stem[i] >= 'A' && stem[i] <= 'Z') || (stem[i] & 0x80)) {
+            return -1;
+        }
+    }
+
+    if (MP_STATE_VM(import_cache) == MP_OBJ_NULL) {
+        MP_STATE_VM(import_cache) = mp_obj_new_dict(0);
+    }
+    mp_obj_t cache = MP_STATE_VM(import_cache);
+    mp_map_elem_t *elem = import_cache_lookup_str(cache, str, dir_len);
+    mp_obj_t entries;
+    if (elem != NULL) {
+        entries = elem->value;
+    } else {
+        entries = import_cache_list_dir(str, dir_len);
+        if (entries == MP_OBJ_NULL) {
+            return -1;
+        }
+        mp_obj_dict_store(cache, mp_obj_new_str(str, dir_len), entries);
+    }
+
+    elem = import_cache_lookup_str(entries, stem, stem_len);
+    if (elem == NULL) {
+        return 0;
+    }
+    mp_int_t flags = MP_OBJ_SMALL_INT_VALUE(elem->value);
+    if (flags & IMPORT_CACHE_CASE_VARIANT) {
+        return -1;
+    }
+    return flags;
+}
+#endif
+
 STATIC mp_import_stat_t stat_file_py_or_mpy(vstr_t *path) {
+    #if MICROPY_MODULE_IMPORT_CACHE
+    path->len -= 3;
+    mp_int_t flags = import_cache_lookup(path);
+    path->len += 3;
+    if (flags >= 0) {
+        if (flags & IMPORT_CACHE_PY) {
+            return MP_IMPORT_STAT_FILE;
+        }
+        #if MICROPY_PERSISTENT_CODE_LOAD
+        if (flags & IMPORT_CACHE_MPY) {
+            vstr_ins_byte(path, path->len - 2, 'm');
+            return MP_IMPORT_STAT_FILE;
+        }
+        #endif
+        return MP_IMPORT_STAT_NO_EXIST;
+    }
+    #endif
+
     mp_import_stat_t stat = mp_import_stat_any(vstr_null_terminated_str(path));
     if (stat == MP_IMPORT_STAT_FILE) {
         return stat;
@@ -92,6 +309,26 @@ STATIC mp_import_stat_t stat_file_py_or_mpy(vstr_t *path) {
 }
 
 STATIC mp_import_stat_t stat_dir_or_file(vstr_t *path) {
+    #if MICROPY_MODULE_IMPORT_CACHE
+    mp_int_t flags = import_cache_lookup(path);
+    if (flags >= 0) {
+        if (flags & IMPORT_CACHE_DIR) {
+            return MP_IMPORT_STAT_DIR;
+        }
+        vstr_add_str(path, ".py");
+        if (flags & IMPORT_CACHE_PY) {
+            return MP_IMPORT_STAT_FILE;
+        }
+        #if MICROPY_PERSISTENT_CODE_LOAD
+        if (flags & IMPORT_CACHE_MPY) {
+            vstr_ins_byte(path, path->len - 2, 'm');
+            return MP_IMPORT_STAT_FILE;
+        }
+        #endif
+        return MP_IMPORT_STAT_NO_EXIST;
+    }
+    #endif
+
     mp_import_stat_t stat = mp_import_stat_any(vstr_null_terminated_str(path));
     DEBUG_printf("stat %s: %d\n", vstr_str(path), stat);
     if (stat == MP_IMPORT_STAT_DIR) {
@@ -120,6 +120,33 @@ STATIC mp_import_stat_t mp_frozen_stat_helper(const char *name, const char *str)
     return MP_IMPORT_STAT_NO_EXIST;
 }
 
+STATIC void mp_frozen_list_dir_helper(const char *name, const char *dir, size_t dir_len,
+    void (*f)(void *arg, const char *name, size_t len, bool is_dir), void *arg) {
+    while (*name != 0) {
+        size_t l = strlen(name);
+        if (dir_len == 0 || (l > dir_len && !memcmp(name, dir, dir_len) && name[dir_len] == '/')) {
+            const char *entry = dir_len == 0 ? name : name + dir_len + 1;
+            const char *slash = strchr(entry, '/');
+            if (slash == NULL) {
+                f(arg, entry, name + l - entry, false);
+            } else {
+                f(arg, entry, slash - entry, true);
+            }
+        }
+        name += l + 1;
+    }
+}
+
+void mp_frozen_list_dir(const char *dir, size_t dir_len,
+    void (*f)(void *arg, const char *name, size_t len, bool is_dir), void *arg) {
+    #if MICROPY_MODULE_FROZEN_STR
+    mp_frozen_list_dir_helper(mp_frozen_str_names, dir, dir_len, f, arg);
+    #endif
+    #if MICROPY_MODULE_FROZEN_MPY
+    mp_frozen_list_dir_helper(mp_frozen_mpy_names, dir, dir_len, f, arg);
+    #endif
+}
+
 mp_import_stat_t mp_frozen_stat(const char *str) {
     mp_import_stat_t stat;
 
@@ -47,5 +47,9 @@ enum {
 int mp_find_frozen_module(const char *str, size_t len, void **data);
 const char *mp_find_frozen_str(const char *str, size_t str_len, size_t *len);
 mp_import_stat_t mp_frozen_stat(const char *str);
+// Calls f for each entry of the frozen pseudo directory dir ("" for the top).
+// A subdirectory is reported once for every module in it.
+void mp_frozen_list_dir(const char *dir, size_t dir_len,
+    void (*f)(void *arg, const char *name, size_t len, bool is_dir), void *arg);
 
 #endif // MICROPY_INCLUDED_PY_FROZENMOD_H
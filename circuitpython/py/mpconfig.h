@@ -408,6 +408,18 @@
 #define MICROPY_OPT_MPZ_BITWISE (0)
 #endif
 
+// Whether to multiply mpz with at least MPZ_KARATSUBA_THRESHOLD digits using
+// Karatsuba's method, which needs temporary heap memory.
+#ifndef MICROPY_OPT_MPZ_KARATSUBA
+#define MICROPY_OPT_MPZ_KARATSUBA (0)
+#endif
+
+// Whether 3-arg pow() with an odd, positive modulus uses Montgomery reduction
+// instead of a long division after each multiply.
+#ifndef MICROPY_OPT_MPZ_MONTGOMERY
+#define MICROPY_OPT_MPZ_MONTGOMERY (0)
+#endif
+
 /*****************************************************************************/
 /* Python internal features                                                  */
 
@@ -433,6 +445,18 @@
 #define MICROPY_FATFS_NUM_PERSISTENT (0)
 #endif
 
+// Number of DWORDs in the cluster link map allocated for a file opened with
+// the 'f' (fast seek) mode flag. A file needs two entries per fragment plus one.
+#ifndef MICROPY_FATFS_FASTSEEK_TABLE_SIZE
+#define MICROPY_FATFS_FASTSEEK_TABLE_SIZE (32)
+#endif
+
+// Size of the read-ahead buffer of a file opened with the 'f' mode flag.
+// Should be a multiple of the sector size.
+#ifndef MICROPY_FATFS_READAHEAD_SIZE
+#define MICROPY_FATFS_READAHEAD_SIZE (2048)
+#endif
+
 // Hook for the VM at the start of the opcode loop (can contain variable
 // definitions usable by the other hook functions)
 #ifndef MICROPY_VM_HOOK_INIT
@@ -658,6 +682,13 @@ typedef double mp_float_t;
 #define MICROPY_MODULE_FROZEN (MICROPY_MODULE_FROZEN_STR || MICROPY_MODULE_FROZEN_MPY)
 #endif
 
+// Whether import remembers the contents of each directory it searches, so
+// that later lookups there don't stat every candidate filename. Needs
+// MICROPY_VFS to list directories.
+#ifndef MICROPY_MODULE_IMPORT_CACHE
+#define MICROPY_MODULE_IMPORT_CACHE (0)
+#endif
+
 // Whether you can override builtins in the builtins module
 #ifndef MICROPY_CAN_OVERRIDE_BUILTINS
 #define MICROPY_CAN_OVERRIDE_BUILTINS (0)
@@ -1156,6 +1187,13 @@ typedef double mp_float_t;
 #define MICROPY_PY_UZLIB (0)
 #endif
 
+// Number of bits uzlib decodes with one table lookup per Huffman symbol.
+// Each decompressor then holds two tables of (2 << bits) bytes, about 2KB at
+// 9 bits. 0 decodes a bit at a time with no tables.
+#ifndef MICROPY_PY_UZLIB_FAST_BITS
+#define MICROPY_PY_UZLIB_FAST_BITS (0)
+#endif
+
 #ifndef MICROPY_PY_UJSON
 #define MICROPY_PY_UJSON (0)
 #endif
@@ -1164,6 +1202,18 @@ typedef double mp_float_t;
 #define MICROPY_PY_URE (0)
 #endif
 
+// Whether ure matches with the Pike VM, which runs in time linear in the
+// subject length and needs no recursion per character, instead of the
+// recursive backtracker
+#ifndef MICROPY_PY_URE_PIKEVM
+#define MICROPY_PY_URE_PIKEVM (1)
+#endif
+
+// Number of compiled patterns that ure keeps for reuse, 0 to disable
+#ifndef MICROPY_PY_URE_CACHE_SIZE
+#define MICROPY_PY_URE_CACHE_SIZE (4)
+#endif
+
 #ifndef MICROPY_PY_UHEAPQ
 #define MICROPY_PY_UHEAPQ (0)
 #endif
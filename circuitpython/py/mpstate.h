@@ -184,11 +184,19 @@ typedef struct _mp_state_vm_t {
     mp_obj_t lwip_slip_stream;
     #endif
 
+    #if MICROPY_PY_URE && MICROPY_PY_URE_CACHE_SIZE
+    mp_obj_t ure_cache[MICROPY_PY_URE_CACHE_SIZE * 2];
+    #endif
+
     #if MICROPY_VFS
     struct _mp_vfs_mount_t *vfs_cur;
     struct _mp_vfs_mount_t *vfs_mount_table;
     #endif
 
+    #if MICROPY_MODULE_IMPORT_CACHE
+    mp_obj_t import_cache;
+    #endif
+
     //
     // END ROOT POINTER SECTION
     ////////////////////////////////////////////////////////////
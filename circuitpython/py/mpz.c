@@ -449,6 +449,147 @@ STATIC size_t mpn_mul(mpz_dig_t *idig, mpz_dig_t *jdig, size_t jlen, mpz_dig_t *
     return ilen;
 }
 
+#if MICROPY_OPT_MPZ_KARATSUBA || MICROPY_OPT_MPZ_MONTGOMERY
+
+/* computes i = i + j over ilen digits
+   returns the carry out of the top digit of i
+   assumes ilen >= jlen; i, j need not be normalised
+*/
+STATIC mpz_dig_t mpn_add_fixed(mpz_dig_t *idig, size_t ilen, const mpz_dig_t *jdig, size_t jlen) {
+    mpz_dbl_dig_t carry = 0;
+
+    ilen -= jlen;
+
+    for (; jlen > 0; --jlen, ++idig, ++jdig) {
+        carry += (mpz_dbl_dig_t)*idig + (mpz_dbl_dig_t)*jdig;
+        *idig = carry & DIG_MASK;
+        carry >>= DIG_SIZE;
+    }
+
+    for (; ilen > 0 && carry != 0; --ilen, ++idig) {
+        carry += *idig;
+        *idig = carry & DIG_MASK;
+        carry >>= DIG_SIZE;
+    }
+
+    return carry;
+}
+
+/* computes i = i - j over ilen digits
+   returns the borrow out of the top digit of i
+   assumes ilen >= jlen; i, j need not be normalised
+*/
+STATIC mpz_dig_t mpn_sub_fixed(mpz_dig_t *idig, size_t ilen, const mpz_dig_t *jdig, size_t jlen) {
+    mpz_dbl_dig_signed_t borrow = 0;
+
+    ilen -= jlen;
+
+    for (; jlen > 0; --jlen, ++idig, ++jdig) {
+        borrow += (mpz_dbl_dig_t)*idig - (mpz_dbl_dig_t)*jdig;
+        *idig = borrow & DIG_MASK;
+        borrow >>= DIG_SIZE;
+    }
+
+    for (; ilen > 0 && borrow != 0; --ilen, ++idig) {
+        borrow += *idig;
+        *idig = borrow & DIG_MASK;
+        borrow >>= DIG_SIZE;
+    }
+
+    return -borrow;
+}
+
+#endif
+
+#if MICROPY_OPT_MPZ_KARATSUBA
+
+/* returns the number of digits of scratch space mpn_mul_karatsuba needs
+   for operands of n digits
+*/
+STATIC size_t mpn_mul_karatsuba_scratch(size_t n) {
+    size_t len = 0;
+    while (n >= MPZ_KARATSUBA_THRESHOLD) {
+        n -= n / 2;
+        len += 4 * n + 1;
+    }
+    return len;
+}
+
+/* computes i = j * k for j, k of n digits using Karatsuba's method
+   writes all 2 * n digits of i; j, k need not be normalised
+   t is scratch space of mpn_mul_karatsuba_scratch(n) digits
+   can have j, k point to same memory; i, t must not overlap anything
+*/
+STATIC void mpn_mul_karatsuba(mpz_dig_t *idig, const mpz_dig_t *jdig, const mpz_dig_t *kdig, size_t n, mpz_dig_t *t) {
+    if (n < MPZ_KARATSUBA_THRESHOLD) {
+        memset(idig, 0, 2 * n * sizeof(mpz_dig_t));
+        mpn_mul(idig, (mpz_dig_t*)jdig, n, (mpz_dig_t*)kdig, n);
+        return;
+    }
+
+    // split j = j1 * B^h + j0 and k = k1 * B^h + k0, with j0, k0 of h digits
+    size_t h = n / 2;
+    size_t hn = n - h;
+
+    // i = j1 * k1 * B^2h + j0 * k0
+    mpn_mul_karatsuba(idig, jdig, kdig, h, t);
+    mpn_mul_karatsuba(idig + 2 * h, jdig + h, kdig + h, hn, t);
+
+    // p = (j0 + j1) * (k0 + k1); each sum is hn digits plus a carry digit,
+    // and the product is less than 4 * B^2hn so it fits in 2 * hn + 1 digits
+    mpz_dig_t *js = t;
+    mpz_dig_t *ks = t + hn;
+    mpz_dig_t *p = t + 2 * hn;
+    memcpy(js, jdig + h, hn * sizeof(mpz_dig_t));
+    mpz_dig_t jc = mpn_add_fixed(js, hn, jdig, h);
+    memcpy(ks, kdig + h, hn * sizeof(mpz_dig_t));
+    mpz_dig_t kc = mpn_add_fixed(ks, hn, kdig, h);
+    mpn_mul_karatsuba(p, js, ks, hn, p + 2 * hn + 1);
+    p[2 * hn] = jc & kc;
+    if (jc != 0) {
+        mpn_add_fixed(p + hn, hn + 1, ks, hn);
+    }
+    if (kc != 0) {
+        mpn_add_fixed(p + hn, hn + 1, js, hn);
+    }
+
+    // i += (p - j0 * k0 - j1 * k1) * B^h
+    mpn_sub_fixed(p, 2 * hn + 1, idig, 2 * h);
+    mpn_sub_fixed(p, 2 * hn + 1, idig + 2 * h, 2 * hn);
+    mpn_add_fixed(idig + h, 2 * n - h, p, 2 * hn + 1);
+}
+
+/* computes i = j * k like mpn_mul, multiplying k by klen digit pieces of j
+   using Karatsuba's method
+   returns number of digits in i
+   assumes enough memory in i; assumes i is zeroed; assumes normalised j, k
+   assumes jlen >= klen >= MPZ_KARATSUBA_THRESHOLD
+   can have j, k point to same memory
+*/
+STATIC size_t mpn_mul_large(mpz_dig_t *idig, const mpz_dig_t *jdig, size_t jlen, const mpz_dig_t *kdig, size_t klen) {
+    size_t t_len = 3 * klen + mpn_mul_karatsuba_scratch(klen);
+    mpz_dig_t *prod = m_new(mpz_dig_t, t_len);
+    mpz_dig_t *piece = prod + 2 * klen;
+
+    for (size_t off = 0; off < jlen; off += klen) {
+        const mpz_dig_t *jd = jdig + off;
+        if (jlen - off < klen) {
+            // zero-extend the last piece of j
+            memcpy(piece, jd, (jlen - off) * sizeof(mpz_dig_t));
+            memset(piece + jlen - off, 0, (klen - jlen + off) * sizeof(mpz_dig_t));
+            jd = piece;
+        }
+        mpn_mul_karatsuba(prod, jd, kdig, klen, piece + klen);
+        size_t ilen = jlen + klen - off;
+        mpn_add_fixed(idig + off, ilen, prod, MIN(ilen, 2 * klen));
+    }
+
+    m_del(mpz_dig_t, prod, t_len);
+    return mpn_remove_trailing_zeros(idig, idig + jlen + klen);
+}
+
+#endif
+
 /* natural_div - quo * den + new_num = old_num (ie num is replaced with rem)
    assumes den != 0
    assumes num_dig has enough memory to be extended by 1 digit
@@ -519,8 +660,13 @@ STATIC void mpn_div(mpz_dig_t *num_dig, size_t *num_len, const mpz_dig_t *den_di
     while (*num_len > den_len) {
         mpz_dbl_dig_t quo = ((mpz_dbl_dig_t)*num_dig << DIG_SIZE) | num_dig[-1];
 
-        // get approximate quotient
+        // get approximate quotient; it is never too small, and once limited
+        // to a single digit it is at most 2 too large because the
+        // denominator is normalised
         quo /= lead_den_digit;
+        if (quo > DIG_MASK) {
+            quo = DIG_MASK;
+        }
 
         // Multiply quo by den and subtract from num to get remainder.
         // We have different code here to handle different compile-time
@@ -1314,7 +1460,18 @@ void mpz_mul_inpl(mpz_t *dest, const mpz_t *lhs, const mpz_t *rhs) {
 
     mpz_need_dig(dest, lhs->len + rhs->len); // min mem l+r-1, max mem l+r
     memset(dest->dig, 0, dest->alloc * sizeof(mpz_dig_t));
-    dest->len = mpn_mul(dest->dig, lhs->dig, lhs->len, rhs->dig, rhs->len);
+    #if MICROPY_OPT_MPZ_KARATSUBA
+    if (lhs->len >= MPZ_KARATSUBA_THRESHOLD && rhs->len >= MPZ_KARATSUBA_THRESHOLD) {
+        if (lhs->len >= rhs->len) {
+            dest->len = mpn_mul_large(dest->dig, lhs->dig, lhs->len, rhs->dig, rhs->len);
+        } else {
+            dest->len = mpn_mul_large(dest->dig, rhs->dig, rhs->len, lhs->dig, lhs->len);
+        }
+    } else
+    #endif
+    {
+        dest->len = mpn_mul(dest->dig, lhs->dig, lhs->len, rhs->dig, rhs->len);
+    }
 
     if (lhs->neg == rhs->neg) {
         dest->neg = 0;
@@ -1359,6 +1516,162 @@ void mpz_pow_inpl(mpz_t *dest, const mpz_t *lhs, const mpz_t *rhs) {
     mpz_free(n);
 }
 
+#if MICROPY_OPT_MPZ_MONTGOMERY
+
+/* computes i = j * k / B^n mod m, for j, k < m of n digits, using Montgomery
+   reduction; m must be odd and minv = -1 / m mod B
+   t is scratch space of 2 * n + 1 digits, plus mpn_mul_karatsuba_scratch(n)
+   digits if Karatsuba multiplication is enabled
+   can have i, j, k point to same memory
+*/
+STATIC void mpn_mul_montgomery(mpz_dig_t *idig, const mpz_dig_t *jdig, const mpz_dig_t *kdig,
+    const mpz_dig_t *mdig, size_t n, mpz_dig_t minv, mpz_dig_t *t) {
+    #if MICROPY_OPT_MPZ_KARATSUBA
+    mpn_mul_karatsuba(t, jdig, kdig, n, t + 2 * n + 1);
+    #else
+    memset(t, 0, 2 * n * sizeof(mpz_dig_t));
+    mpn_mul(t, (mpz_dig_t*)jdig, n, (mpz_dig_t*)kdig, n);
+    #endif
+    t[2 * n] = 0;
+
+    // add multiples of m to clear the low n digits of t, one digit at a time
+    for (size_t i = 0; i < n; ++i) {
+        mpz_dig_t u = ((mpz_dbl_dig_t)t[i] * minv) & DIG_MASK;
+        mpz_dig_t *td = t + i;
+        mpz_dbl_dig_t carry = 0;
+        for (size_t j = 0; j < n; ++j, ++td) {
+            carry += (mpz_dbl_dig_t)*td + (mpz_dbl_dig_t)u * mdig[j]; // will never overflow so long as DIG_SIZE <= 8*sizeof(mpz_dbl_dig_t)/2
+            *td = carry & DIG_MASK;
+            carry >>= DIG_SIZE;
+        }
+        for (; carry != 0; ++td) {
+            carry += *td;
+            *td = carry & DIG_MASK;
+            carry >>= DIG_SIZE;
+        }
+    }
+
+    // the high n + 1 digits of t are now less than 2 * m
+    t += n;
+    int cmp = t[n] != 0;
+    for (size_t i = n; cmp == 0 && i > 0; --i) {
+        cmp = (t[i - 1] > mdig[i - 1]) - (t[i - 1] < mdig[i - 1]);
+    }
+    if (cmp >= 0) {
+        mpn_sub_fixed(t, n + 1, mdig, n);
+    }
+    memcpy(idig, t, n * sizeof(mpz_dig_t));
+}
+
+STATIC inline mp_uint_t mpz_get_bit(const mpz_t *z, size_t bit) {
+    return (z->dig[bit / DIG_SIZE] >> (bit % DIG_SIZE)) & 1;
+}
+
+/* computes dest = (lhs ** rhs) % mod for odd, positive mod and positive rhs,
+   working on Montgomery representatives x * B^n mod m where mod has n digits
+   and using a sliding window over the bits of rhs
+*/
+STATIC void mpz_pow3_montgomery(mpz_t *dest, const mpz_t *lhs, const mpz_t *rhs, const mpz_t *mod) {
+    size_t n = mod->len;
+    mpz_t x; mpz_init_zero(&x);
+    mpz_t one; mpz_init_zero(&one);
+    mpz_t quo; mpz_init_zero(&quo);
+
+    mpz_divmod_inpl(&quo, &x, lhs, mod);
+    if (x.len == 0) {
+        mpz_set_from_int(dest, 0);
+        goto done;
+    }
+    mpz_shl_inpl(&x, &x, n * DIG_SIZE);
+    mpz_divmod_inpl(&quo, &x, &x, mod);
+    mpz_set_from_int(&one, 1);
+    mpz_shl_inpl(&one, &one, n * DIG_SIZE);
+    mpz_divmod_inpl(&quo, &one, &one, mod);
+
+    // -1 / m mod B by Newton's iteration, starting correct to 3 bits
+    mpz_dbl_dig_t inv = mod->dig[0];
+    for (size_t bits = 3; bits < DIG_SIZE; bits *= 2) {
+        inv = (inv * (2 - mod->dig[0] * inv)) & DIG_MASK;
+    }
+    mpz_dig_t minv = (0 - inv) & DIG_MASK;
+
+    size_t nbits = (rhs->len - 1) * DIG_SIZE;
+    for (mpz_dig_t d = rhs->dig[rhs->len - 1]; d != 0; d >>= 1) {
+        ++nbits;
+    }
+    size_t window = nbits > 256 ? 5 : nbits > 64 ? 4 : nbits > 16 ? 3 : 1;
+
+    // table holds the odd powers x, x^3, ..., x^(2^window - 1)
+    size_t table_len = (size_t)1 << (window - 1);
+    size_t t_len = 2 * n + 1;
+    #if MICROPY_OPT_MPZ_KARATSUBA
+    t_len += mpn_mul_karatsuba_scratch(n);
+    #endif
+    size_t buf_len = (1 + table_len) * n + t_len;
+    mpz_dig_t *acc = m_new(mpz_dig_t, buf_len);
+    mpz_dig_t *table = acc + n;
+    mpz_dig_t *t = table + table_len * n;
+
+    memset(table, 0, n * sizeof(mpz_dig_t));
+    memcpy(table, x.dig, x.len * sizeof(mpz_dig_t));
+    if (table_len > 1) {
+        mpn_mul_montgomery(acc, table, table, mod->dig, n, minv, t);
+        for (size_t i = 1; i < table_len; ++i) {
+            mpn_mul_montgomery(table + i * n, table + (i - 1) * n, acc, mod->dig, n, minv, t);
+        }
+    }
+
+    memset(acc, 0, n * sizeof(mpz_dig_t));
+    memcpy(acc, one.dig, one.len * sizeof(mpz_dig_t));
+    bool acc_is_one = true;
+    for (size_t bit = nbits; bit > 0;) {
+        if (!mpz_get_bit(rhs, bit - 1)) {
+            if (!acc_is_one) {
+                mpn_mul_montgomery(acc, acc, acc, mod->dig, n, minv, t);
+            }
+            --bit;
+            continue;
+        }
+        // longest run of at most window bits that ends in a set bit
+        size_t len = MIN(window, bit);
+        while (!mpz_get_bit(rhs, bit - len)) {
+            --len;
+        }
+        size_t val = 0;
+        for (size_t i = 1; i <= len; ++i) {
+            val = (val << 1) | mpz_get_bit(rhs, bit - i);
+            if (!acc_is_one) {
+                mpn_mul_montgomery(acc, acc, acc, mod->dig, n, minv, t);
+            }
+        }
+        if (acc_is_one) {
+            memcpy(acc, table + (val >> 1) * n, n * sizeof(mpz_dig_t));
+            acc_is_one = false;
+        } else {
+            mpn_mul_montgomery(acc, acc, table + (val >> 1) * n, mod->dig, n, minv, t);
+        }
+        bit -= len;
+    }
+
+    // convert back from the Montgomery representative by multiplying by 1
+    memset(table, 0, n * sizeof(mpz_dig_t));
+    table[0] = 1;
+    mpn_mul_montgomery(acc, acc, table, mod->dig, n, minv, t);
+
+    mpz_need_dig(dest, n);
+    memcpy(dest->dig, acc, n * sizeof(mpz_dig_t));
+    dest->len = mpn_remove_trailing_zeros(dest->dig, dest->dig + n);
+    dest->neg = 0;
+    m_del(mpz_dig_t, acc, buf_len);
+
+done:
+    mpz_deinit(&x);
+    mpz_deinit(&one);
+    mpz_deinit(&quo);
+}
+
+#endif
+
 /* computes dest = (lhs ** rhs) % mod
    can have dest, lhs, rhs the same; mod can't be the same as dest
 */
@@ -1374,6 +1687,13 @@ void mpz_pow3_inpl(mpz_t *dest, const mpz_t *lhs, const mpz_t *rhs, const mpz_t
         return;
     }
 
+    #if MICROPY_OPT_MPZ_MONTGOMERY
+    if (mod->neg == 0 && (mod->dig[0] & 1) != 0) {
+        mpz_pow3_montgomery(dest, lhs, rhs, mod);
+        return;
+    }
+    #endif
+
     mpz_t *x = mpz_clone(lhs);
     mpz_t *n = mpz_clone(rhs);
     mpz_t quo; mpz_init_zero(&quo);
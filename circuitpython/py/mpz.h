@@ -45,7 +45,7 @@
 // changed so long as the constraints mentioned above are met).
 
 #ifndef MPZ_DIG_SIZE
-  #if defined(__x86_64__) || defined(_WIN64)
+  #if defined(__x86_64__) || defined(_WIN64) || (defined(__SIZEOF_POINTER__) && __SIZEOF_POINTER__ == 8)
     // 64-bit machine, using 32-bit storage for digits
     #define MPZ_DIG_SIZE (32)
   #else
@@ -76,6 +76,12 @@ typedef uint8_t mpz_dbl_dig_t;
 typedef int8_t mpz_dbl_dig_signed_t;
 #endif
 
+// Operands of at least this many digits are multiplied using Karatsuba's method,
+// if MICROPY_OPT_MPZ_KARATSUBA is enabled.  Must be at least 2.
+#ifndef MPZ_KARATSUBA_THRESHOLD
+#define MPZ_KARATSUBA_THRESHOLD (32)
+#endif
+
 #ifdef _WIN64
   #ifdef __MINGW32__
     #define MPZ_LONG_1 1LL
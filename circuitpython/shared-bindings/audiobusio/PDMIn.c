@@ -87,6 +87,20 @@
 //|     with audiobusio.PDMIn(board.MICROPHONE_CLOCK, board.MICROPHONE_DATA, sample_rate=16000, bit_depth=16) as mic:
 //|         mic.record(b, len(b))
 //|
+//|   Record continuously in the background and process blocks as they arrive::
+//|
+//|     import array
+//|     import audiobusio
+//|     import board
+//|
+//|     ring = array.array("H", [0] * 4096)
+//|     block = array.array("H", [0] * 256)
+//|     with audiobusio.PDMIn(board.MICROPHONE_CLOCK, board.MICROPHONE_DATA, sample_rate=16000, bit_depth=16) as mic:
+//|         mic.start_recording(ring)
+//|         while True:
+//|             count = mic.readinto(block)
+//|             # Work on block[:count] here.
+//|
 STATIC mp_obj_t audiobusio_pdmin_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *pos_args) {
     enum { ARG_sample_rate, ARG_bit_depth, ARG_mono, ARG_oversample, ARG_startup_delay };
     mp_map_t kw_args;
@@ -216,6 +230,74 @@ STATIC mp_obj_t audiobusio_pdmin_obj_record(mp_obj_t self_obj, mp_obj_t destinat
 }
 MP_DEFINE_CONST_FUN_OBJ_3(audiobusio_pdmin_record_obj, audiobusio_pdmin_obj_record);
 
+// Returns the buffer of obj after checking that it can hold samples of the PDMIn's bit depth.
+STATIC void get_sample_buffer(audiobusio_pdmin_obj_t *self, mp_obj_t obj, mp_buffer_info_t *bufinfo) {
+    mp_get_buffer_raise(obj, bufinfo, MP_BUFFER_WRITE);
+    uint8_t bit_depth = common_hal_audiobusio_pdmin_get_bit_depth(self);
+    if (bufinfo->typecode != 'H' && bit_depth == 16) {
+        mp_raise_ValueError(translate("destination buffer must be an array of type 'H' for bit_depth = 16"));
+    } else if (bufinfo->typecode != 'B' && bufinfo->typecode != BYTEARRAY_TYPECODE && bit_depth == 8) {
+        mp_raise_ValueError(translate("destination buffer must be a bytearray or array of type 'B' for bit_depth = 8"));
+    }
+}
+
+//|   .. method:: start_recording(ring)
+//|
+//|     Starts recording in the background into ``ring``, a buffer of the same type
+//|     `record` takes that is used as a circular queue of samples. Recording runs
+//|     while Python does other work until `stop_recording` or `deinit` is called.
+//|     Use `readinto` to take samples out of the ring. ``ring`` must hold at least
+//|     128 samples. A larger ring allows longer gaps between calls to `readinto`.
+//|     It doesn't allow longer gaps between background tasks, such as during a
+//|     long running native call. Those must run at least every 64 samples (4ms
+//|     at 16kHz) whatever the ring size, or the samples are lost and counted in
+//|     `overruns`.
+//|
+//|     Only one PDMIn can record in the background at a time.
+//|
+STATIC mp_obj_t audiobusio_pdmin_obj_start_recording(mp_obj_t self_obj, mp_obj_t ring) {
+    audiobusio_pdmin_obj_t *self = MP_OBJ_TO_PTR(self_obj);
+    raise_error_if_deinited(common_hal_audiobusio_pdmin_deinited(self));
+    mp_buffer_info_t bufinfo;
+    get_sample_buffer(self, ring, &bufinfo);
+    common_hal_audiobusio_pdmin_start_recording(self, ring, bufinfo.buf, bufinfo.len);
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_2(audiobusio_pdmin_start_recording_obj, audiobusio_pdmin_obj_start_recording);
+
+//|   .. method:: stop_recording()
+//|
+//|     Stops background recording. Samples still in the ring are discarded.
+//|
+STATIC mp_obj_t audiobusio_pdmin_obj_stop_recording(mp_obj_t self_obj) {
+    audiobusio_pdmin_obj_t *self = MP_OBJ_TO_PTR(self_obj);
+    raise_error_if_deinited(common_hal_audiobusio_pdmin_deinited(self));
+    common_hal_audiobusio_pdmin_stop_recording(self);
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_1(audiobusio_pdmin_stop_recording_obj, audiobusio_pdmin_obj_stop_recording);
+
+//|   .. method:: readinto(destination)
+//|
+//|     Moves the samples recorded in the background since the last call into
+//|     ``destination``, oldest first, up to its length. This does not wait for
+//|     more samples to arrive.
+//|
+//|     :return: The number of samples moved, which may be 0.
+//|
+STATIC mp_obj_t audiobusio_pdmin_obj_readinto(mp_obj_t self_obj, mp_obj_t destination) {
+    audiobusio_pdmin_obj_t *self = MP_OBJ_TO_PTR(self_obj);
+    raise_error_if_deinited(common_hal_audiobusio_pdmin_deinited(self));
+    if (!common_hal_audiobusio_pdmin_get_recording(self)) {
+        mp_raise_RuntimeError(translate("Not recording"));
+    }
+    mp_buffer_info_t bufinfo;
+    get_sample_buffer(self, destination, &bufinfo);
+    uint32_t length = bufinfo.len / (common_hal_audiobusio_pdmin_get_bit_depth(self) / 8);
+    return MP_OBJ_NEW_SMALL_INT(common_hal_audiobusio_pdmin_readinto(self, bufinfo.buf, length));
+}
+MP_DEFINE_CONST_FUN_OBJ_2(audiobusio_pdmin_readinto_obj, audiobusio_pdmin_obj_readinto);
+
 //|   .. attribute:: sample_rate
 //|
 //|     The actual sample_rate of the recording. This may not match the constructed
@@ -235,13 +317,58 @@ const mp_obj_property_t audiobusio_pdmin_sample_rate_obj = {
               (mp_obj_t)&mp_const_none_obj},
 };
 
+//|   .. attribute:: recording
+//|
+//|     True when recording in the background. (read-only)
+//|
+STATIC mp_obj_t audiobusio_pdmin_obj_get_recording(mp_obj_t self_in) {
+    audiobusio_pdmin_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    raise_error_if_deinited(common_hal_audiobusio_pdmin_deinited(self));
+    return mp_obj_new_bool(common_hal_audiobusio_pdmin_get_recording(self));
+}
+MP_DEFINE_CONST_FUN_OBJ_1(audiobusio_pdmin_get_recording_obj, audiobusio_pdmin_obj_get_recording);
+
+const mp_obj_property_t audiobusio_pdmin_recording_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&audiobusio_pdmin_get_recording_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+//|   .. attribute:: overruns
+//|
+//|     The number of times samples were lost since `start_recording`, either
+//|     because the ring was full or because background tasks didn't run soon
+//|     enough. (read-only)
+//|
+STATIC mp_obj_t audiobusio_pdmin_obj_get_overruns(mp_obj_t self_in) {
+    audiobusio_pdmin_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    raise_error_if_deinited(common_hal_audiobusio_pdmin_deinited(self));
+    return mp_obj_new_int_from_uint(common_hal_audiobusio_pdmin_get_overruns(self));
+}
+MP_DEFINE_CONST_FUN_OBJ_1(audiobusio_pdmin_get_overruns_obj, audiobusio_pdmin_obj_get_overruns);
+
+const mp_obj_property_t audiobusio_pdmin_overruns_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&audiobusio_pdmin_get_overruns_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
 STATIC const mp_rom_map_elem_t audiobusio_pdmin_locals_dict_table[] = {
     // Methods
     { MP_ROM_QSTR(MP_QSTR_deinit), MP_ROM_PTR(&audiobusio_pdmin_deinit_obj) },
     { MP_ROM_QSTR(MP_QSTR___enter__), MP_ROM_PTR(&default___enter___obj) },
     { MP_ROM_QSTR(MP_QSTR___exit__), MP_ROM_PTR(&audiobusio_pdmin___exit___obj) },
     { MP_ROM_QSTR(MP_QSTR_record), MP_ROM_PTR(&audiobusio_pdmin_record_obj) },
-    { MP_ROM_QSTR(MP_QSTR_sample_rate), MP_ROM_PTR(&audiobusio_pdmin_sample_rate_obj) }
+    { MP_ROM_QSTR(MP_QSTR_start_recording), MP_ROM_PTR(&audiobusio_pdmin_start_recording_obj) },
+    { MP_ROM_QSTR(MP_QSTR_stop_recording), MP_ROM_PTR(&audiobusio_pdmin_stop_recording_obj) },
+    { MP_ROM_QSTR(MP_QSTR_readinto), MP_ROM_PTR(&audiobusio_pdmin_readinto_obj) },
+
+    // Properties
+    { MP_ROM_QSTR(MP_QSTR_sample_rate), MP_ROM_PTR(&audiobusio_pdmin_sample_rate_obj) },
+    { MP_ROM_QSTR(MP_QSTR_recording), MP_ROM_PTR(&audiobusio_pdmin_recording_obj) },
+    { MP_ROM_QSTR(MP_QSTR_overruns), MP_ROM_PTR(&audiobusio_pdmin_overruns_obj) },
 };
 STATIC MP_DEFINE_CONST_DICT(audiobusio_pdmin_locals_dict, audiobusio_pdmin_locals_dict_table);
 
@@ -40,6 +40,13 @@ void common_hal_audiobusio_pdmin_deinit(audiobusio_pdmin_obj_t* self);
 bool common_hal_audiobusio_pdmin_deinited(audiobusio_pdmin_obj_t* self);
 uint32_t common_hal_audiobusio_pdmin_record_to_buffer(audiobusio_pdmin_obj_t* self,
     uint16_t* buffer, uint32_t length);
+void common_hal_audiobusio_pdmin_start_recording(audiobusio_pdmin_obj_t* self,
+    mp_obj_t ring_obj, uint8_t* ring_buffer, uint32_t ring_length);
+void common_hal_audiobusio_pdmin_stop_recording(audiobusio_pdmin_obj_t* self);
+bool common_hal_audiobusio_pdmin_get_recording(audiobusio_pdmin_obj_t* self);
+uint32_t common_hal_audiobusio_pdmin_readinto(audiobusio_pdmin_obj_t* self,
+    uint8_t* buffer, uint32_t length);
+uint32_t common_hal_audiobusio_pdmin_get_overruns(audiobusio_pdmin_obj_t* self);
 uint8_t common_hal_audiobusio_pdmin_get_bit_depth(audiobusio_pdmin_obj_t* self);
 uint32_t common_hal_audiobusio_pdmin_get_sample_rate(audiobusio_pdmin_obj_t* self);
 // TODO(tannewt): Add record to file
@@ -31,6 +31,7 @@
 #include "py/objproperty.h"
 #include "py/runtime.h"
 #include "shared-bindings/microcontroller/Pin.h"
+#include "shared-bindings/audioio/__init__.h"
 #include "shared-bindings/audioio/AudioOut.h"
 #include "shared-bindings/audioio/RawSample.h"
 #include "shared-bindings/util.h"
@@ -157,7 +158,8 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(audioio_audioout___exit___obj, 4, 4,
 //|     Plays the sample once when loop=False and continuously when loop=True.
 //|     Does not block. Use `playing` to block.
 //|
-//|     Sample must be an `audioio.WaveFile` or `audioio.RawSample`.
+//|     Sample must be an audio sample such as an `audioio.WaveFile`, `audioio.RawSample` or
+//|     `audioio.Mixer`.
 //|
 //|     The sample itself should consist of 16 bit samples. Microcontrollers with a lower output
 //|     resolution will use the highest order bits to output. For example, the SAMD21 has a 10 bit
@@ -174,7 +176,7 @@ STATIC mp_obj_t audioio_audioout_obj_play(size_t n_args, const mp_obj_t *pos_arg
     mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
     mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
 
-    mp_obj_t sample = args[ARG_sample].u_obj;
+    mp_obj_t sample = audiosample_check(args[ARG_sample].u_obj);
     common_hal_audioio_audioout_play(self, sample, args[ARG_loop].u_bool);
 
     return mp_const_none;
@@ -0,0 +1,283 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+
+#include "lib/utils/context_manager_helpers.h"
+#include "py/objproperty.h"
+#include "py/runtime.h"
+#include "shared-bindings/audioio/__init__.h"
+#include "shared-bindings/audioio/Filter.h"
+#include "shared-bindings/util.h"
+#include "shared-module/audioio/__init__.h"
+#include "supervisor/shared/translate.h"
+
+//| .. currentmodule:: audioio
+//|
+//| :class:`Filter` -- Filters a sample
+//| ===================================
+//|
+//| Filter runs another sample through low pass, high pass and DC blocking filters as it plays.
+//| Its output is 16 bit signed with the same sample rate and channel count as the sample, and it
+//| can itself be played, mixed or wrapped in another effect such as `Volume`.
+//|
+//| .. class:: Filter(sample, *, low_pass=None, high_pass=None, q=0.7071, dc_block=False, buffer_size=1024)
+//|
+//|   Create a Filter that plays sample through the filters given. Each filter that is on is a
+//|   second order (12dB per octave) biquad.
+//|
+//|   :param sample: The sample to filter
+//|   :param float low_pass: Cutoff frequency in Hertz above which sound is removed, or None for no low pass
+//|   :param float high_pass: Cutoff frequency in Hertz below which sound is removed, or None for no high pass
+//|   :param float q: How resonant the filters are at their cutoff. 0.7071 is flat.
+//|   :param bool dc_block: Remove any constant offset in the sample, such as from a microphone
+//|   :param int buffer_size: The total size in bytes of each of the two output buffers to use
+//|
+//|   Taking the hiss off a recording and fading it in::
+//|
+//|     import board
+//|     import audioio
+//|
+//|     voice = audioio.WaveFile(open("voice.wav", "rb"))
+//|     clean = audioio.Filter(voice, low_pass=3000, dc_block=True)
+//|     a = audioio.AudioOut(board.A0)
+//|     a.play(audioio.Volume(clean, fade_in=0.5))
+//|
+
+// Converts a cutoff frequency to Hertz or 0 for None.
+STATIC float frequency_from_obj(uint32_t sample_rate, mp_obj_t frequency_obj) {
+    if (frequency_obj == mp_const_none) {
+        return 0;
+    }
+    mp_float_t frequency = mp_obj_get_float(frequency_obj);
+    if (frequency <= 0 || frequency >= sample_rate / 2) {
+        mp_raise_ValueError(translate("cutoff must be between 0 and half the sample rate"));
+    }
+    return frequency;
+}
+
+STATIC mp_obj_t audioio_filter_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *pos_args) {
+    mp_arg_check_num(n_args, n_kw, 1, 1, true);
+    mp_map_t kw_args;
+    mp_map_init_fixed_table(&kw_args, n_kw, pos_args + n_args);
+    enum { ARG_sample, ARG_low_pass, ARG_high_pass, ARG_q, ARG_dc_block, ARG_buffer_size };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_sample, MP_ARG_OBJ | MP_ARG_REQUIRED },
+        { MP_QSTR_low_pass, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_obj = mp_const_none} },
+        { MP_QSTR_high_pass, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_obj = mp_const_none} },
+        { MP_QSTR_q, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_dc_block, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false} },
+        { MP_QSTR_buffer_size, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 1024} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, &kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    mp_obj_t sample = audiosample_check(args[ARG_sample].u_obj);
+    uint8_t channel_count = audiosample_channel_count(sample);
+    mp_int_t buffer_size = args[ARG_buffer_size].u_int;
+    if (buffer_size <= 0 || buffer_size % (channel_count * 2) != 0) {
+        mp_raise_ValueError(translate("buffer_size must be a positive multiple of the frame size"));
+    }
+    uint32_t sample_rate = audiosample_sample_rate(sample);
+    float low_pass = frequency_from_obj(sample_rate, args[ARG_low_pass].u_obj);
+    float high_pass = frequency_from_obj(sample_rate, args[ARG_high_pass].u_obj);
+    mp_float_t q = 0.7071;
+    if (args[ARG_q].u_obj != MP_OBJ_NULL) {
+        q = mp_obj_get_float(args[ARG_q].u_obj);
+        if (q <= 0 || q > 20) {
+            mp_raise_ValueError(translate("q must be between 0 and 20"));
+        }
+    }
+
+    audioio_filter_obj_t *self = m_new_obj(audioio_filter_obj_t);
+    self->base.type = &audioio_filter_type;
+    common_hal_audioio_filter_construct(self, sample, low_pass, high_pass, q,
+                                        args[ARG_dc_block].u_bool, buffer_size);
+
+    return MP_OBJ_FROM_PTR(self);
+}
+
+//|   .. method:: deinit()
+//|
+//|      Deinitialises the Filter and releases any hardware resources for reuse.
+//|
+STATIC mp_obj_t audioio_filter_deinit(mp_obj_t self_in) {
+    audioio_filter_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    common_hal_audioio_filter_deinit(self);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(audioio_filter_deinit_obj, audioio_filter_deinit);
+
+//|   .. method:: __enter__()
+//|
+//|      No-op used by Context Managers.
+//|
+//  Provided by context manager helper.
+
+//|   .. method:: __exit__()
+//|
+//|      Automatically deinitializes the hardware when exiting a context. See
+//|      :ref:`lifetime-and-contextmanagers` for more info.
+//|
+STATIC mp_obj_t audioio_filter_obj___exit__(size_t n_args, const mp_obj_t *args) {
+    (void)n_args;
+    common_hal_audioio_filter_deinit(args[0]);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(audioio_filter___exit___obj, 4, 4, audioio_filter_obj___exit__);
+
+//|   .. attribute:: sample_rate
+//|
+//|     32 bit value that dictates how quickly samples are played in Hertz (cycles per second).
+//|     (read-only)
+//|
+STATIC mp_obj_t audioio_filter_obj_get_sample_rate(mp_obj_t self_in) {
+    audioio_filter_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    raise_error_if_deinited(common_hal_audioio_filter_deinited(self));
+    return MP_OBJ_NEW_SMALL_INT(common_hal_audioio_filter_get_sample_rate(self));
+}
+MP_DEFINE_CONST_FUN_OBJ_1(audioio_filter_get_sample_rate_obj, audioio_filter_obj_get_sample_rate);
+
+const mp_obj_property_t audioio_filter_sample_rate_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&audioio_filter_get_sample_rate_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+// Returns a cutoff in Hertz or None when that filter is off.
+STATIC mp_obj_t frequency_to_obj(float frequency) {
+    if (frequency <= 0) {
+        return mp_const_none;
+    }
+    return mp_obj_new_float(frequency);
+}
+
+//|   .. attribute:: low_pass
+//|
+//|     The low pass cutoff in Hertz, or None when off. Changes take effect from the next buffer
+//|     so the cutoff can be swept while playing.
+//|
+STATIC mp_obj_t audioio_filter_obj_get_low_pass(mp_obj_t self_in) {
+    audioio_filter_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    raise_error_if_deinited(common_hal_audioio_filter_deinited(self));
+    return frequency_to_obj(common_hal_audioio_filter_get_low_pass(self));
+}
+MP_DEFINE_CONST_FUN_OBJ_1(audioio_filter_get_low_pass_obj, audioio_filter_obj_get_low_pass);
+
+STATIC mp_obj_t audioio_filter_obj_set_low_pass(mp_obj_t self_in, mp_obj_t frequency) {
+    audioio_filter_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    raise_error_if_deinited(common_hal_audioio_filter_deinited(self));
+    common_hal_audioio_filter_set_low_pass(self,
+        frequency_from_obj(common_hal_audioio_filter_get_sample_rate(self), frequency));
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_2(audioio_filter_set_low_pass_obj, audioio_filter_obj_set_low_pass);
+
+const mp_obj_property_t audioio_filter_low_pass_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&audioio_filter_get_low_pass_obj,
+              (mp_obj_t)&audioio_filter_set_low_pass_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+//|   .. attribute:: high_pass
+//|
+//|     The high pass cutoff in Hertz, or None when off. Changes take effect from the next buffer.
+//|
+STATIC mp_obj_t audioio_filter_obj_get_high_pass(mp_obj_t self_in) {
+    audioio_filter_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    raise_error_if_deinited(common_hal_audioio_filter_deinited(self));
+    return frequency_to_obj(common_hal_audioio_filter_get_high_pass(self));
+}
+MP_DEFINE_CONST_FUN_OBJ_1(audioio_filter_get_high_pass_obj, audioio_filter_obj_get_high_pass);
+
+STATIC mp_obj_t audioio_filter_obj_set_high_pass(mp_obj_t self_in, mp_obj_t frequency) {
+    audioio_filter_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    raise_error_if_deinited(common_hal_audioio_filter_deinited(self));
+    common_hal_audioio_filter_set_high_pass(self,
+        frequency_from_obj(common_hal_audioio_filter_get_sample_rate(self), frequency));
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_2(audioio_filter_set_high_pass_obj, audioio_filter_obj_set_high_pass);
+
+const mp_obj_property_t audioio_filter_high_pass_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&audioio_filter_get_high_pass_obj,
+              (mp_obj_t)&audioio_filter_set_high_pass_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+//|   .. attribute:: dc_block
+//|
+//|     True when any constant offset is removed. (read-only)
+//|
+STATIC mp_obj_t audioio_filter_obj_get_dc_block(mp_obj_t self_in) {
+    audioio_filter_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    raise_error_if_deinited(common_hal_audioio_filter_deinited(self));
+    return mp_obj_new_bool(common_hal_audioio_filter_get_dc_block(self));
+}
+MP_DEFINE_CONST_FUN_OBJ_1(audioio_filter_get_dc_block_obj, audioio_filter_obj_get_dc_block);
+
+const mp_obj_property_t audioio_filter_dc_block_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&audioio_filter_get_dc_block_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+STATIC const mp_rom_map_elem_t audioio_filter_locals_dict_table[] = {
+    // Methods
+    { MP_ROM_QSTR(MP_QSTR_deinit), MP_ROM_PTR(&audioio_filter_deinit_obj) },
+    { MP_ROM_QSTR(MP_QSTR___enter__), MP_ROM_PTR(&default___enter___obj) },
+    { MP_ROM_QSTR(MP_QSTR___exit__), MP_ROM_PTR(&audioio_filter___exit___obj) },
+
+    // Properties
+    { MP_ROM_QSTR(MP_QSTR_sample_rate), MP_ROM_PTR(&audioio_filter_sample_rate_obj) },
+    { MP_ROM_QSTR(MP_QSTR_low_pass), MP_ROM_PTR(&audioio_filter_low_pass_obj) },
+    { MP_ROM_QSTR(MP_QSTR_high_pass), MP_ROM_PTR(&audioio_filter_high_pass_obj) },
+    { MP_ROM_QSTR(MP_QSTR_dc_block), MP_ROM_PTR(&audioio_filter_dc_block_obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(audioio_filter_locals_dict, audioio_filter_locals_dict_table);
+
+STATIC const audiosample_p_t audioio_filter_proto = {
+    .id = &audiosample_protocol_id,
+    .sample_rate = (audiosample_sample_rate_fun)common_hal_audioio_filter_get_sample_rate,
+    .bits_per_sample = (audiosample_bits_per_sample_fun)common_hal_audioio_filter_get_bits_per_sample,
+    .channel_count = (audiosample_channel_count_fun)common_hal_audioio_filter_get_channel_count,
+    .reset_buffer = (audiosample_reset_buffer_fun)audioio_filter_reset_buffer,
+    .get_buffer = (audiosample_get_buffer_fun)audioio_filter_get_buffer,
+    .get_buffer_structure = (audiosample_get_buffer_structure_fun)audioio_filter_get_buffer_structure,
+    .prefetch = (audiosample_prefetch_fun)audioio_filter_prefetch,
+};
+
+const mp_obj_type_t audioio_filter_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_Filter,
+    .make_new = audioio_filter_make_new,
+    .locals_dict = (mp_obj_dict_t*)&audioio_filter_locals_dict,
+    .protocol = &audioio_filter_proto,
+};
@@ -0,0 +1,49 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_BINDINGS_AUDIOIO_FILTER_H
+#define MICROPY_INCLUDED_SHARED_BINDINGS_AUDIOIO_FILTER_H
+
+#include "shared-module/audioio/Filter.h"
+
+extern const mp_obj_type_t audioio_filter_type;
+
+// Cutoffs are in Hertz. 0 turns that filter off.
+void common_hal_audioio_filter_construct(audioio_filter_obj_t* self, mp_obj_t sample,
+    float low_pass, float high_pass, float q, bool dc_block, uint32_t buffer_size);
+
+void common_hal_audioio_filter_deinit(audioio_filter_obj_t* self);
+bool common_hal_audioio_filter_deinited(audioio_filter_obj_t* self);
+uint32_t common_hal_audioio_filter_get_sample_rate(audioio_filter_obj_t* self);
+uint8_t common_hal_audioio_filter_get_bits_per_sample(audioio_filter_obj_t* self);
+uint8_t common_hal_audioio_filter_get_channel_count(audioio_filter_obj_t* self);
+float common_hal_audioio_filter_get_low_pass(audioio_filter_obj_t* self);
+void common_hal_audioio_filter_set_low_pass(audioio_filter_obj_t* self, float frequency);
+float common_hal_audioio_filter_get_high_pass(audioio_filter_obj_t* self);
+void common_hal_audioio_filter_set_high_pass(audioio_filter_obj_t* self, float frequency);
+bool common_hal_audioio_filter_get_dc_block(audioio_filter_obj_t* self);
+
+#endif // MICROPY_INCLUDED_SHARED_BINDINGS_AUDIOIO_FILTER_H
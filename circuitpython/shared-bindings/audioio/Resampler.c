@@ -0,0 +1,220 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+
+#include "lib/utils/context_manager_helpers.h"
+#include "py/objproperty.h"
+#include "py/runtime.h"
+#include "shared-bindings/audioio/__init__.h"
+#include "shared-bindings/audioio/Resampler.h"
+#include "shared-bindings/util.h"
+#include "supervisor/shared/translate.h"
+
+//| .. currentmodule:: audioio
+//|
+//| :class:`Resampler` -- Plays a sample at another sample rate
+//| ============================================================
+//|
+//| Resampler converts a sample to a different sample rate as it plays so that samples recorded
+//| at different rates can share an output or a `Mixer`. It can also shift the pitch of a sample.
+//|
+//| .. class:: Resampler(sample, *, sample_rate, buffer_size=1024, linear=False)
+//|
+//|   Create a Resampler that plays the sample at sample_rate. The output is always 16 bit
+//|   signed with the same channel count as the sample.
+//|
+//|   By default samples are interpolated with an eight tap polyphase filter. When lowering the
+//|   sample rate, or raising the pitch, the filter is widened by up to four times to remove
+//|   the frequencies the output can't hold. The widest filter is chosen when the sample starts
+//|   playing. Linear interpolation takes less time but dulls high frequencies and adds more
+//|   noise.
+//|
+//|   :param sample: The sample to play, such as a `audioio.WaveFile` or `audioio.RawSample`
+//|   :param int sample_rate: The sample rate to output in Hertz
+//|   :param int buffer_size: The total size in bytes of each of the two output buffers to use
+//|   :param bool linear: Interpolate linearly instead of with the polyphase filter
+//|
+//|   Playing an 8kHz sample alongside a 22kHz one::
+//|
+//|     import board
+//|     import audioio
+//|
+//|     music = audioio.WaveFile(open("music-22khz.wav", "rb"))
+//|     voice = audioio.WaveFile(open("voice-8khz.wav", "rb"))
+//|     mixer = audioio.Mixer(voice_count=2, sample_rate=music.sample_rate)
+//|
+//|     a = audioio.AudioOut(board.A0)
+//|     a.play(mixer)
+//|     mixer.play(music, voice=0, loop=True)
+//|     mixer.play(audioio.Resampler(voice, sample_rate=music.sample_rate), voice=1)
+//|
+STATIC mp_obj_t audioio_resampler_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *pos_args) {
+    mp_arg_check_num(n_args, n_kw, 1, 1, true);
+    mp_map_t kw_args;
+    mp_map_init_fixed_table(&kw_args, n_kw, pos_args + n_args);
+    enum { ARG_sample, ARG_sample_rate, ARG_buffer_size, ARG_linear };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_sample, MP_ARG_OBJ | MP_ARG_REQUIRED },
+        { MP_QSTR_sample_rate, MP_ARG_INT | MP_ARG_KW_ONLY | MP_ARG_REQUIRED },
+        { MP_QSTR_buffer_size, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 1024} },
+        { MP_QSTR_linear, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, &kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    mp_obj_t sample = audiosample_check(args[ARG_sample].u_obj);
+    mp_int_t sample_rate = args[ARG_sample_rate].u_int;
+    if (sample_rate < 1) {
+        mp_raise_ValueError(translate("Sample rate must be positive"));
+    }
+    uint8_t channel_count = audiosample_channel_count(sample);
+    mp_int_t buffer_size = args[ARG_buffer_size].u_int;
+    if (buffer_size <= 0 || buffer_size % (channel_count * 2) != 0) {
+        mp_raise_ValueError(translate("buffer_size must be a positive multiple of the frame size"));
+    }
+    uint8_t taps = AUDIOIO_RESAMPLE_FIR_TAPS;
+    if (args[ARG_linear].u_bool) {
+        taps = AUDIOIO_RESAMPLE_LINEAR_TAPS;
+    }
+
+    audioio_resampler_obj_t *self = m_new_obj(audioio_resampler_obj_t);
+    self->base.type = &audioio_resampler_type;
+    common_hal_audioio_resampler_construct(self, sample, sample_rate, buffer_size, taps);
+
+    return MP_OBJ_FROM_PTR(self);
+}
+
+//|   .. method:: deinit()
+//|
+//|      Deinitialises the Resampler and releases any hardware resources for reuse.
+//|
+STATIC mp_obj_t audioio_resampler_deinit(mp_obj_t self_in) {
+    audioio_resampler_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    common_hal_audioio_resampler_deinit(self);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(audioio_resampler_deinit_obj, audioio_resampler_deinit);
+
+//|   .. method:: __enter__()
+//|
+//|      No-op used by Context Managers.
+//|
+//  Provided by context manager helper.
+
+//|   .. method:: __exit__()
+//|
+//|      Automatically deinitializes the hardware when exiting a context. See
+//|      :ref:`lifetime-and-contextmanagers` for more info.
+//|
+STATIC mp_obj_t audioio_resampler_obj___exit__(size_t n_args, const mp_obj_t *args) {
+    (void)n_args;
+    common_hal_audioio_resampler_deinit(args[0]);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(audioio_resampler___exit___obj, 4, 4, audioio_resampler_obj___exit__);
+
+//|   .. attribute:: sample_rate
+//|
+//|     32 bit value that dictates how quickly samples are played in Hertz (cycles per second).
+//|     (read-only)
+//|
+STATIC mp_obj_t audioio_resampler_obj_get_sample_rate(mp_obj_t self_in) {
+    audioio_resampler_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    raise_error_if_deinited(common_hal_audioio_resampler_deinited(self));
+    return MP_OBJ_NEW_SMALL_INT(common_hal_audioio_resampler_get_sample_rate(self));
+}
+MP_DEFINE_CONST_FUN_OBJ_1(audioio_resampler_get_sample_rate_obj, audioio_resampler_obj_get_sample_rate);
+
+const mp_obj_property_t audioio_resampler_sample_rate_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&audioio_resampler_get_sample_rate_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+//|   .. attribute:: pitch
+//|
+//|     How much faster than normal the sample plays, which raises its pitch. 2.0 is an octave
+//|     higher and 0.5 an octave lower. Changes take effect from the next buffer.
+//|
+STATIC mp_obj_t audioio_resampler_obj_get_pitch(mp_obj_t self_in) {
+    audioio_resampler_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    raise_error_if_deinited(common_hal_audioio_resampler_deinited(self));
+    return mp_obj_new_float((mp_float_t) common_hal_audioio_resampler_get_pitch(self) /
+                            AUDIOIO_RESAMPLE_ONE);
+}
+MP_DEFINE_CONST_FUN_OBJ_1(audioio_resampler_get_pitch_obj, audioio_resampler_obj_get_pitch);
+
+STATIC mp_obj_t audioio_resampler_obj_set_pitch(mp_obj_t self_in, mp_obj_t pitch_in) {
+    audioio_resampler_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    raise_error_if_deinited(common_hal_audioio_resampler_deinited(self));
+    mp_float_t pitch = mp_obj_get_float(pitch_in);
+    if (pitch <= 0 || pitch > 16) {
+        mp_raise_ValueError(translate("pitch out of range"));
+    }
+    common_hal_audioio_resampler_set_pitch(self, (uint32_t) (pitch * AUDIOIO_RESAMPLE_ONE));
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_2(audioio_resampler_set_pitch_obj, audioio_resampler_obj_set_pitch);
+
+const mp_obj_property_t audioio_resampler_pitch_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&audioio_resampler_get_pitch_obj,
+              (mp_obj_t)&audioio_resampler_set_pitch_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+STATIC const mp_rom_map_elem_t audioio_resampler_locals_dict_table[] = {
+    // Methods
+    { MP_ROM_QSTR(MP_QSTR_deinit), MP_ROM_PTR(&audioio_resampler_deinit_obj) },
+    { MP_ROM_QSTR(MP_QSTR___enter__), MP_ROM_PTR(&default___enter___obj) },
+    { MP_ROM_QSTR(MP_QSTR___exit__), MP_ROM_PTR(&audioio_resampler___exit___obj) },
+
+    // Properties
+    { MP_ROM_QSTR(MP_QSTR_sample_rate), MP_ROM_PTR(&audioio_resampler_sample_rate_obj) },
+    { MP_ROM_QSTR(MP_QSTR_pitch), MP_ROM_PTR(&audioio_resampler_pitch_obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(audioio_resampler_locals_dict, audioio_resampler_locals_dict_table);
+
+STATIC const audiosample_p_t audioio_resampler_proto = {
+    .id = &audiosample_protocol_id,
+    .sample_rate = (audiosample_sample_rate_fun)common_hal_audioio_resampler_get_sample_rate,
+    .bits_per_sample = (audiosample_bits_per_sample_fun)common_hal_audioio_resampler_get_bits_per_sample,
+    .channel_count = (audiosample_channel_count_fun)common_hal_audioio_resampler_get_channel_count,
+    .reset_buffer = (audiosample_reset_buffer_fun)audioio_resampler_reset_buffer,
+    .get_buffer = (audiosample_get_buffer_fun)audioio_resampler_get_buffer,
+    .get_buffer_structure = (audiosample_get_buffer_structure_fun)audioio_resampler_get_buffer_structure,
+    .prefetch = (audiosample_prefetch_fun)audioio_resampler_prefetch,
+};
+
+const mp_obj_type_t audioio_resampler_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_Resampler,
+    .make_new = audioio_resampler_make_new,
+    .locals_dict = (mp_obj_dict_t*)&audioio_resampler_locals_dict,
+    .protocol = &audioio_resampler_proto,
+};
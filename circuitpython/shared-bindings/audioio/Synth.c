@@ -0,0 +1,330 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+
+#include "lib/utils/context_manager_helpers.h"
+#include "py/objproperty.h"
+#include "py/runtime.h"
+#include "shared-bindings/audioio/__init__.h"
+#include "shared-bindings/audioio/Synth.h"
+#include "shared-bindings/util.h"
+#include "shared-module/audioio/effects.h"
+#include "supervisor/shared/translate.h"
+
+//| .. currentmodule:: audioio
+//|
+//| :class:`Synth` -- Plays tones from a wavetable
+//| ===============================================
+//|
+//| Synth generates tones as it plays instead of storing them, so a tone of any length takes no
+//| more memory than a short one. Each voice steps through a small wavetable at the pitch it
+//| plays and is shaped by an attack, decay, sustain, release envelope. Its output is 16 bit
+//| signed mono and it can be played, mixed or wrapped in an effect like any other sample.
+//|
+//| .. class:: Synth(voice_count=4, *, sample_rate=22050, waveform=None, attack=0.01, decay=0.1, sustain=0.8, release=0.2, buffer_size=1024)
+//|
+//|   Create a Synth with voice_count voices that can sound at once. The envelope applies to
+//|   every voice.
+//|
+//|   :param int voice_count: The maximum number of voices that sound at once
+//|   :param int sample_rate: The sample rate to output in Hertz
+//|   :param waveform: One cycle of the wave as an array of type 'h' whose length is a power of two. A sine wave when None.
+//|   :param float attack: Seconds to rise from silence to the voice's level
+//|   :param float decay: Seconds to fall from the voice's level to the sustain level
+//|   :param float sustain: The level held while the voice plays, from 0.0 to 1.0 of the voice's level
+//|   :param float release: Seconds to fade out over once the voice stops
+//|   :param int buffer_size: The total size in bytes of each of the two output buffers to use
+//|
+//|   Playing a short tune with a square wave::
+//|
+//|     import array
+//|     import board
+//|     import audioio
+//|     import time
+//|
+//|     square = array.array("h", [-8000] * 8 + [8000] * 8)
+//|     synth = audioio.Synth(waveform=square, release=0.05)
+//|     a = audioio.AudioOut(board.A0)
+//|     a.play(synth)
+//|     for frequency in (262, 294, 330, 349, 392):
+//|         synth.play(frequency)
+//|         time.sleep(0.3)
+//|         synth.stop_voice()
+//|         time.sleep(0.1)
+//|     a.stop()
+//|
+
+// Converts a level between 0.0 and 1.0 to fixed point.
+STATIC uint16_t level_from_obj(mp_obj_t level_obj) {
+    mp_float_t level = mp_obj_get_float(level_obj);
+    if (level < 0 || level > 1) {
+        mp_raise_ValueError(translate("level must be between 0 and 1"));
+    }
+    return (uint16_t) (level * AUDIOIO_GAIN_UNITY);
+}
+
+// Converts a time in seconds to a number of frames.
+STATIC uint32_t frames_from_obj(uint32_t sample_rate, mp_obj_t seconds_obj) {
+    mp_float_t seconds = mp_obj_get_float(seconds_obj);
+    if (seconds < 0 || seconds > 60) {
+        mp_raise_ValueError(translate("duration must be between 0 and 60 seconds"));
+    }
+    return (uint32_t) (seconds * sample_rate);
+}
+
+STATIC mp_obj_t audioio_synth_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *pos_args) {
+    mp_arg_check_num(n_args, n_kw, 0, 1, true);
+    mp_map_t kw_args;
+    mp_map_init_fixed_table(&kw_args, n_kw, pos_args + n_args);
+    enum { ARG_voice_count, ARG_sample_rate, ARG_waveform, ARG_attack, ARG_decay, ARG_sustain,
+           ARG_release, ARG_buffer_size };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_voice_count, MP_ARG_INT, {.u_int = 4} },
+        { MP_QSTR_sample_rate, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 22050} },
+        { MP_QSTR_waveform, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_obj = mp_const_none} },
+        { MP_QSTR_attack, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_decay, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_sustain, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_release, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_buffer_size, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 1024} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, &kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    mp_int_t voice_count = args[ARG_voice_count].u_int;
+    if (voice_count < 1 || voice_count > 255) {
+        mp_raise_ValueError(translate("Invalid voice count"));
+    }
+    mp_int_t sample_rate = args[ARG_sample_rate].u_int;
+    if (sample_rate < 1) {
+        mp_raise_ValueError(translate("Sample rate must be positive"));
+    }
+    mp_int_t buffer_size = args[ARG_buffer_size].u_int;
+    if (buffer_size <= 0 || buffer_size % 2 != 0) {
+        mp_raise_ValueError(translate("buffer_size must be a positive multiple of the frame size"));
+    }
+
+    mp_obj_t waveform = args[ARG_waveform].u_obj;
+    const int16_t* table = audioio_synth_sine;
+    uint8_t table_bits = AUDIOIO_SYNTH_SINE_BITS;
+    if (waveform != mp_const_none) {
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(waveform, &bufinfo, MP_BUFFER_READ);
+        size_t length = bufinfo.len / sizeof(int16_t);
+        table_bits = 1;
+        while (table_bits < AUDIOIO_SYNTH_MAX_TABLE_BITS && (1u << table_bits) < length) {
+            table_bits++;
+        }
+        if (bufinfo.typecode != 'h' || length != (1u << table_bits)) {
+            mp_raise_ValueError(translate("waveform must be an array of type 'h' with a power of two length"));
+        }
+        table = bufinfo.buf;
+    }
+
+    uint32_t attack = sample_rate / 100;
+    if (args[ARG_attack].u_obj != MP_OBJ_NULL) {
+        attack = frames_from_obj(sample_rate, args[ARG_attack].u_obj);
+    }
+    uint32_t decay = sample_rate / 10;
+    if (args[ARG_decay].u_obj != MP_OBJ_NULL) {
+        decay = frames_from_obj(sample_rate, args[ARG_decay].u_obj);
+    }
+    uint16_t sustain = AUDIOIO_GAIN_UNITY * 4 / 5;
+    if (args[ARG_sustain].u_obj != MP_OBJ_NULL) {
+        sustain = level_from_obj(args[ARG_sustain].u_obj);
+    }
+    uint32_t release = sample_rate / 5;
+    if (args[ARG_release].u_obj != MP_OBJ_NULL) {
+        release = frames_from_obj(sample_rate, args[ARG_release].u_obj);
+    }
+
+    audioio_synth_obj_t *self = m_new_obj_var(audioio_synth_obj_t, audioio_synth_voice_t, voice_count);
+    self->base.type = &audioio_synth_type;
+    common_hal_audioio_synth_construct(self, voice_count, sample_rate, waveform, table, table_bits,
+                                       attack, decay, sustain, release, buffer_size);
+
+    return MP_OBJ_FROM_PTR(self);
+}
+
+//|   .. method:: deinit()
+//|
+//|      Deinitialises the Synth and releases any hardware resources for reuse.
+//|
+STATIC mp_obj_t audioio_synth_deinit(mp_obj_t self_in) {
+    audioio_synth_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    common_hal_audioio_synth_deinit(self);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(audioio_synth_deinit_obj, audioio_synth_deinit);
+
+//|   .. method:: __enter__()
+//|
+//|      No-op used by Context Managers.
+//|
+//  Provided by context manager helper.
+
+//|   .. method:: __exit__()
+//|
+//|      Automatically deinitializes the hardware when exiting a context. See
+//|      :ref:`lifetime-and-contextmanagers` for more info.
+//|
+STATIC mp_obj_t audioio_synth_obj___exit__(size_t n_args, const mp_obj_t *args) {
+    (void)n_args;
+    common_hal_audioio_synth_deinit(args[0]);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(audioio_synth___exit___obj, 4, 4, audioio_synth_obj___exit__);
+
+STATIC uint8_t voice_from_int(audioio_synth_obj_t *self, mp_int_t voice) {
+    if (voice < 0 || voice >= self->voice_count) {
+        mp_raise_ValueError(translate("Invalid voice"));
+    }
+    return voice;
+}
+
+//|   .. method:: play(frequency, *, voice=0, level=1.0)
+//|
+//|     Starts the voice playing a tone at frequency Hertz, which must be below half the sample
+//|     rate. level runs from 0.0 for silent to 1.0 for full volume. Voices are added together
+//|     and clipped. A voice that is still sounding changes pitch and restarts its attack from
+//|     where it is without a click.
+//|
+STATIC mp_obj_t audioio_synth_obj_play(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_frequency, ARG_voice, ARG_level };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_frequency, MP_ARG_OBJ | MP_ARG_REQUIRED },
+        { MP_QSTR_voice,     MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 0} },
+        { MP_QSTR_level,     MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_obj = MP_OBJ_NULL} },
+    };
+    audioio_synth_obj_t *self = MP_OBJ_TO_PTR(pos_args[0]);
+    raise_error_if_deinited(common_hal_audioio_synth_deinited(self));
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    uint8_t voice = voice_from_int(self, args[ARG_voice].u_int);
+    mp_float_t frequency = mp_obj_get_float(args[ARG_frequency].u_obj);
+    if (frequency <= 0 || frequency >= common_hal_audioio_synth_get_sample_rate(self) / 2) {
+        mp_raise_ValueError(translate("frequency must be between 0 and half the sample rate"));
+    }
+    uint16_t level = AUDIOIO_GAIN_UNITY;
+    if (args[ARG_level].u_obj != MP_OBJ_NULL) {
+        level = level_from_obj(args[ARG_level].u_obj);
+    }
+    common_hal_audioio_synth_play(self, voice, frequency, level);
+
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_KW(audioio_synth_play_obj, 1, audioio_synth_obj_play);
+
+//|   .. method:: stop_voice(voice=0)
+//|
+//|     Fades the voice out over the release time.
+//|
+STATIC mp_obj_t audioio_synth_obj_stop_voice(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_voice };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_voice,     MP_ARG_INT, {.u_int = 0} },
+    };
+    audioio_synth_obj_t *self = MP_OBJ_TO_PTR(pos_args[0]);
+    raise_error_if_deinited(common_hal_audioio_synth_deinited(self));
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    common_hal_audioio_synth_stop_voice(self, voice_from_int(self, args[ARG_voice].u_int));
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_KW(audioio_synth_stop_voice_obj, 1, audioio_synth_obj_stop_voice);
+
+//|   .. attribute:: playing
+//|
+//|     True when any voice is sounding, including while it fades out. (read-only)
+//|
+STATIC mp_obj_t audioio_synth_obj_get_playing(mp_obj_t self_in) {
+    audioio_synth_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    raise_error_if_deinited(common_hal_audioio_synth_deinited(self));
+    return mp_obj_new_bool(common_hal_audioio_synth_get_playing(self));
+}
+MP_DEFINE_CONST_FUN_OBJ_1(audioio_synth_get_playing_obj, audioio_synth_obj_get_playing);
+
+const mp_obj_property_t audioio_synth_playing_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&audioio_synth_get_playing_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+//|   .. attribute:: sample_rate
+//|
+//|     32 bit value that dictates how quickly samples are played in Hertz (cycles per second).
+//|     (read-only)
+//|
+STATIC mp_obj_t audioio_synth_obj_get_sample_rate(mp_obj_t self_in) {
+    audioio_synth_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    raise_error_if_deinited(common_hal_audioio_synth_deinited(self));
+    return MP_OBJ_NEW_SMALL_INT(common_hal_audioio_synth_get_sample_rate(self));
+}
+MP_DEFINE_CONST_FUN_OBJ_1(audioio_synth_get_sample_rate_obj, audioio_synth_obj_get_sample_rate);
+
+const mp_obj_property_t audioio_synth_sample_rate_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&audioio_synth_get_sample_rate_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+STATIC const mp_rom_map_elem_t audioio_synth_locals_dict_table[] = {
+    // Methods
+    { MP_ROM_QSTR(MP_QSTR_deinit), MP_ROM_PTR(&audioio_synth_deinit_obj) },
+    { MP_ROM_QSTR(MP_QSTR___enter__), MP_ROM_PTR(&default___enter___obj) },
+    { MP_ROM_QSTR(MP_QSTR___exit__), MP_ROM_PTR(&audioio_synth___exit___obj) },
+    { MP_ROM_QSTR(MP_QSTR_play), MP_ROM_PTR(&audioio_synth_play_obj) },
+    { MP_ROM_QSTR(MP_QSTR_stop_voice), MP_ROM_PTR(&audioio_synth_stop_voice_obj) },
+
+    // Properties
+    { MP_ROM_QSTR(MP_QSTR_playing), MP_ROM_PTR(&audioio_synth_playing_obj) },
+    { MP_ROM_QSTR(MP_QSTR_sample_rate), MP_ROM_PTR(&audioio_synth_sample_rate_obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(audioio_synth_locals_dict, audioio_synth_locals_dict_table);
+
+STATIC const audiosample_p_t audioio_synth_proto = {
+    .id = &audiosample_protocol_id,
+    .sample_rate = (audiosample_sample_rate_fun)common_hal_audioio_synth_get_sample_rate,
+    .bits_per_sample = (audiosample_bits_per_sample_fun)common_hal_audioio_synth_get_bits_per_sample,
+    .channel_count = (audiosample_channel_count_fun)common_hal_audioio_synth_get_channel_count,
+    .reset_buffer = (audiosample_reset_buffer_fun)audioio_synth_reset_buffer,
+    .get_buffer = (audiosample_get_buffer_fun)audioio_synth_get_buffer,
+    .get_buffer_structure = (audiosample_get_buffer_structure_fun)audioio_synth_get_buffer_structure,
+    .prefetch = NULL,
+};
+
+const mp_obj_type_t audioio_synth_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_Synth,
+    .make_new = audioio_synth_make_new,
+    .locals_dict = (mp_obj_dict_t*)&audioio_synth_locals_dict,
+    .protocol = &audioio_synth_proto,
+};
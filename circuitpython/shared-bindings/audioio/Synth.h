@@ -0,0 +1,52 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_BINDINGS_AUDIOIO_SYNTH_H
+#define MICROPY_INCLUDED_SHARED_BINDINGS_AUDIOIO_SYNTH_H
+
+#include "shared-module/audioio/Synth.h"
+
+extern const mp_obj_type_t audioio_synth_type;
+
+// table is 1 << table_bits long and must stay alive as long as waveform does. Envelope times
+// are in frames. sustain and level run from 0 to AUDIOIO_GAIN_UNITY.
+void common_hal_audioio_synth_construct(audioio_synth_obj_t* self, uint8_t voice_count,
+    uint32_t sample_rate, mp_obj_t waveform, const int16_t* table, uint8_t table_bits,
+    uint32_t attack, uint32_t decay, uint16_t sustain, uint32_t release, uint32_t buffer_size);
+
+void common_hal_audioio_synth_deinit(audioio_synth_obj_t* self);
+bool common_hal_audioio_synth_deinited(audioio_synth_obj_t* self);
+uint32_t common_hal_audioio_synth_get_sample_rate(audioio_synth_obj_t* self);
+uint8_t common_hal_audioio_synth_get_bits_per_sample(audioio_synth_obj_t* self);
+uint8_t common_hal_audioio_synth_get_channel_count(audioio_synth_obj_t* self);
+bool common_hal_audioio_synth_get_playing(audioio_synth_obj_t* self);
+
+// frequency must be below half the sample rate.
+void common_hal_audioio_synth_play(audioio_synth_obj_t* self, uint8_t voice, float frequency,
+    uint16_t level);
+void common_hal_audioio_synth_stop_voice(audioio_synth_obj_t* self, uint8_t voice);
+
+#endif // MICROPY_INCLUDED_SHARED_BINDINGS_AUDIOIO_SYNTH_H
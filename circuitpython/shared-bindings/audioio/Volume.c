@@ -0,0 +1,247 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+
+#include "lib/utils/context_manager_helpers.h"
+#include "py/objproperty.h"
+#include "py/runtime.h"
+#include "shared-bindings/audioio/__init__.h"
+#include "shared-bindings/audioio/Volume.h"
+#include "shared-bindings/util.h"
+#include "shared-module/audioio/__init__.h"
+#include "supervisor/shared/translate.h"
+
+//| .. currentmodule:: audioio
+//|
+//| :class:`Volume` -- Changes the volume of a sample
+//| =================================================
+//|
+//| Volume scales another sample as it plays. The level can jump or ramp smoothly from one value
+//| to another, which makes fades without clicks. Its output is 16 bit signed with the same
+//| sample rate and channel count as the sample, and it can itself be played, mixed or wrapped in
+//| another effect such as `Filter`.
+//|
+//| .. class:: Volume(sample, *, level=1.0, fade_in=0.0, buffer_size=1024)
+//|
+//|   Create a Volume that plays sample at level.
+//|
+//|   :param sample: The sample to change the volume of
+//|   :param float level: The starting level, from 0.0 for silent to 1.0 for unchanged
+//|   :param float fade_in: Seconds to ramp up from silence to level over, each time the sample starts
+//|   :param int buffer_size: The total size in bytes of each of the two output buffers to use
+//|
+//|   Fading music in and out::
+//|
+//|     import board
+//|     import audioio
+//|     import time
+//|
+//|     music = audioio.Volume(audioio.WaveFile(open("music.wav", "rb")), fade_in=2.0)
+//|     a = audioio.AudioOut(board.A0)
+//|     a.play(music)
+//|     time.sleep(10)
+//|     music.ramp(0.0, 3.0)
+//|     time.sleep(3)
+//|     a.stop()
+//|
+
+// Converts a level between 0.0 and 1.0 to fixed point.
+STATIC uint16_t level_from_obj(mp_obj_t level_obj) {
+    mp_float_t level = mp_obj_get_float(level_obj);
+    if (level < 0 || level > 1) {
+        mp_raise_ValueError(translate("level must be between 0 and 1"));
+    }
+    return (uint16_t) (level * AUDIOIO_GAIN_UNITY);
+}
+
+// Converts a time in seconds to a number of frames.
+STATIC uint32_t frames_from_obj(uint32_t sample_rate, mp_obj_t seconds_obj) {
+    mp_float_t seconds = mp_obj_get_float(seconds_obj);
+    if (seconds < 0 || seconds > 60) {
+        mp_raise_ValueError(translate("duration must be between 0 and 60 seconds"));
+    }
+    return (uint32_t) (seconds * sample_rate);
+}
+
+STATIC mp_obj_t audioio_volume_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *pos_args) {
+    mp_arg_check_num(n_args, n_kw, 1, 1, true);
+    mp_map_t kw_args;
+    mp_map_init_fixed_table(&kw_args, n_kw, pos_args + n_args);
+    enum { ARG_sample, ARG_level, ARG_fade_in, ARG_buffer_size };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_sample, MP_ARG_OBJ | MP_ARG_REQUIRED },
+        { MP_QSTR_level, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_fade_in, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_buffer_size, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 1024} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, &kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    mp_obj_t sample = audiosample_check(args[ARG_sample].u_obj);
+    uint8_t channel_count = audiosample_channel_count(sample);
+    mp_int_t buffer_size = args[ARG_buffer_size].u_int;
+    if (buffer_size <= 0 || buffer_size % (channel_count * 2) != 0) {
+        mp_raise_ValueError(translate("buffer_size must be a positive multiple of the frame size"));
+    }
+    uint16_t level = AUDIOIO_GAIN_UNITY;
+    if (args[ARG_level].u_obj != MP_OBJ_NULL) {
+        level = level_from_obj(args[ARG_level].u_obj);
+    }
+
+    uint32_t fade_in = 0;
+    if (args[ARG_fade_in].u_obj != MP_OBJ_NULL) {
+        fade_in = frames_from_obj(audiosample_sample_rate(sample), args[ARG_fade_in].u_obj);
+    }
+
+    audioio_volume_obj_t *self = m_new_obj(audioio_volume_obj_t);
+    self->base.type = &audioio_volume_type;
+    common_hal_audioio_volume_construct(self, sample, level, fade_in, buffer_size);
+
+    return MP_OBJ_FROM_PTR(self);
+}
+
+//|   .. method:: deinit()
+//|
+//|      Deinitialises the Volume and releases any hardware resources for reuse.
+//|
+STATIC mp_obj_t audioio_volume_deinit(mp_obj_t self_in) {
+    audioio_volume_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    common_hal_audioio_volume_deinit(self);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(audioio_volume_deinit_obj, audioio_volume_deinit);
+
+//|   .. method:: __enter__()
+//|
+//|      No-op used by Context Managers.
+//|
+//  Provided by context manager helper.
+
+//|   .. method:: __exit__()
+//|
+//|      Automatically deinitializes the hardware when exiting a context. See
+//|      :ref:`lifetime-and-contextmanagers` for more info.
+//|
+STATIC mp_obj_t audioio_volume_obj___exit__(size_t n_args, const mp_obj_t *args) {
+    (void)n_args;
+    common_hal_audioio_volume_deinit(args[0]);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(audioio_volume___exit___obj, 4, 4, audioio_volume_obj___exit__);
+
+//|   .. method:: ramp(level, duration)
+//|
+//|     Changes the level linearly from where it is now to level over duration seconds. Ramping
+//|     to 0.0 fades the sample out. The ramp starts with the next buffer filled.
+//|
+STATIC mp_obj_t audioio_volume_obj_ramp(mp_obj_t self_in, mp_obj_t level_in, mp_obj_t duration_in) {
+    audioio_volume_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    raise_error_if_deinited(common_hal_audioio_volume_deinited(self));
+    uint32_t frames = frames_from_obj(common_hal_audioio_volume_get_sample_rate(self), duration_in);
+    common_hal_audioio_volume_ramp(self, level_from_obj(level_in), frames);
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_3(audioio_volume_ramp_obj, audioio_volume_obj_ramp);
+
+//|   .. attribute:: sample_rate
+//|
+//|     32 bit value that dictates how quickly samples are played in Hertz (cycles per second).
+//|     (read-only)
+//|
+STATIC mp_obj_t audioio_volume_obj_get_sample_rate(mp_obj_t self_in) {
+    audioio_volume_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    raise_error_if_deinited(common_hal_audioio_volume_deinited(self));
+    return MP_OBJ_NEW_SMALL_INT(common_hal_audioio_volume_get_sample_rate(self));
+}
+MP_DEFINE_CONST_FUN_OBJ_1(audioio_volume_get_sample_rate_obj, audioio_volume_obj_get_sample_rate);
+
+const mp_obj_property_t audioio_volume_sample_rate_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&audioio_volume_get_sample_rate_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+//|   .. attribute:: level
+//|
+//|     The level from 0.0 for silent to 1.0 for unchanged. While ramping this is the level the
+//|     ramp ends at. Setting it stops any ramp and takes effect from the next buffer.
+//|
+STATIC mp_obj_t audioio_volume_obj_get_level(mp_obj_t self_in) {
+    audioio_volume_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    raise_error_if_deinited(common_hal_audioio_volume_deinited(self));
+    return mp_obj_new_float((mp_float_t) common_hal_audioio_volume_get_level(self) /
+                            AUDIOIO_GAIN_UNITY);
+}
+MP_DEFINE_CONST_FUN_OBJ_1(audioio_volume_get_level_obj, audioio_volume_obj_get_level);
+
+STATIC mp_obj_t audioio_volume_obj_set_level(mp_obj_t self_in, mp_obj_t level_in) {
+    audioio_volume_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    raise_error_if_deinited(common_hal_audioio_volume_deinited(self));
+    common_hal_audioio_volume_set_level(self, level_from_obj(level_in));
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_2(audioio_volume_set_level_obj, audioio_volume_obj_set_level);
+
+const mp_obj_property_t audioio_volume_level_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&audioio_volume_get_level_obj,
+              (mp_obj_t)&audioio_volume_set_level_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+STATIC const mp_rom_map_elem_t audioio_volume_locals_dict_table[] = {
+    // Methods
+    { MP_ROM_QSTR(MP_QSTR_deinit), MP_ROM_PTR(&audioio_volume_deinit_obj) },
+    { MP_ROM_QSTR(MP_QSTR___enter__), MP_ROM_PTR(&default___enter___obj) },
+    { MP_ROM_QSTR(MP_QSTR___exit__), MP_ROM_PTR(&audioio_volume___exit___obj) },
+    { MP_ROM_QSTR(MP_QSTR_ramp), MP_ROM_PTR(&audioio_volume_ramp_obj) },
+
+    // Properties
+    { MP_ROM_QSTR(MP_QSTR_sample_rate), MP_ROM_PTR(&audioio_volume_sample_rate_obj) },
+    { MP_ROM_QSTR(MP_QSTR_level), MP_ROM_PTR(&audioio_volume_level_obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(audioio_volume_locals_dict, audioio_volume_locals_dict_table);
+
+STATIC const audiosample_p_t audioio_volume_proto = {
+    .id = &audiosample_protocol_id,
+    .sample_rate = (audiosample_sample_rate_fun)common_hal_audioio_volume_get_sample_rate,
+    .bits_per_sample = (audiosample_bits_per_sample_fun)common_hal_audioio_volume_get_bits_per_sample,
+    .channel_count = (audiosample_channel_count_fun)common_hal_audioio_volume_get_channel_count,
+    .reset_buffer = (audiosample_reset_buffer_fun)audioio_volume_reset_buffer,
+    .get_buffer = (audiosample_get_buffer_fun)audioio_volume_get_buffer,
+    .get_buffer_structure = (audiosample_get_buffer_structure_fun)audioio_volume_get_buffer_structure,
+    .prefetch = (audiosample_prefetch_fun)audioio_volume_prefetch,
+};
+
+const mp_obj_type_t audioio_volume_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_Volume,
+    .make_new = audioio_volume_make_new,
+    .locals_dict = (mp_obj_dict_t*)&audioio_volume_locals_dict,
+    .protocol = &audioio_volume_proto,
+};
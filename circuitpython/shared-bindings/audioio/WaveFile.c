@@ -29,6 +29,7 @@
 #include "lib/utils/context_manager_helpers.h"
 #include "py/objproperty.h"
 #include "py/runtime.h"
+#include "shared-bindings/audioio/__init__.h"
 #include "shared-bindings/audioio/WaveFile.h"
 #include "shared-bindings/util.h"
 #include "supervisor/shared/translate.h"
@@ -39,13 +40,20 @@
 //| ========================================================
 //|
 //| A .wav file prepped for audio playback. Only mono and stereo files are supported. Samples must
-//| be 8 bit unsigned or 16 bit signed.
+//| be 8 bit unsigned or 16 bit signed, or 4 bit IMA ADPCM which is decoded to 16 bit signed as it
+//| plays and takes a quarter of the space.
 //|
-//| .. class:: WaveFile(filename)
+//| .. class:: WaveFile(filename, *, buffer_size=512)
 //|
 //|   Load a .wav file for playback with `audioio.AudioOut` or `audiobusio.I2SOut`.
 //|
+//|   The file is read in the background into one of three buffers while the
+//|   other two play. Larger buffers ride out longer stalls, such as flash
+//|   erases or garbage collection, at the cost of RAM.
+//|
 //|   :param bytes-like file: Already opened wave file
+//|   :param int buffer_size: Size in bytes of each of the three buffers. Must be a multiple of 512.
+//|     For IMA ADPCM files this is the decoded size and is rounded down to whole blocks.
 //|
 //|   Playing a wave file from flash::
 //|
@@ -67,13 +75,27 @@
 //|       pass
 //|     print("stopped")
 //|
-STATIC mp_obj_t audioio_wavefile_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+STATIC mp_obj_t audioio_wavefile_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *pos_args) {
     mp_arg_check_num(n_args, n_kw, 1, 1, true);
+    mp_map_t kw_args;
+    mp_map_init_fixed_table(&kw_args, n_kw, pos_args + n_args);
+    enum { ARG_file, ARG_buffer_size };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_file, MP_ARG_OBJ | MP_ARG_REQUIRED },
+        { MP_QSTR_buffer_size, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 512} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, &kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    mp_int_t buffer_size = args[ARG_buffer_size].u_int;
+    if (buffer_size <= 0 || buffer_size % 512 != 0) {
+        mp_raise_ValueError(translate("buffer_size must be a positive multiple of 512"));
+    }
 
     audioio_wavefile_obj_t *self = m_new_obj(audioio_wavefile_obj_t);
     self->base.type = &audioio_wavefile_type;
-    if (MP_OBJ_IS_TYPE(args[0], &mp_type_fileio)) {
-        common_hal_audioio_wavefile_construct(self, MP_OBJ_TO_PTR(args[0]));
+    if (MP_OBJ_IS_TYPE(args[ARG_file].u_obj, &mp_type_fileio)) {
+        common_hal_audioio_wavefile_construct(self, MP_OBJ_TO_PTR(args[ARG_file].u_obj), buffer_size);
     } else {
         mp_raise_TypeError(translate("file must be a file opened in byte mode"));
     }
@@ -138,6 +160,26 @@ const mp_obj_property_t audioio_wavefile_sample_rate_obj = {
               (mp_obj_t)&mp_const_none_obj},
 };
 
+//|   .. attribute:: underruns
+//|
+//|     The number of times playback needed data before it had been read ahead in the
+//|     background. Each one stalls the refill while the file is read, which can cause a
+//|     glitch. Increase ``buffer_size`` if it keeps going up. (read-only)
+//|
+STATIC mp_obj_t audioio_wavefile_obj_get_underruns(mp_obj_t self_in) {
+    audioio_wavefile_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    raise_error_if_deinited(common_hal_audioio_wavefile_deinited(self));
+    return mp_obj_new_int_from_uint(common_hal_audioio_wavefile_get_underruns(self));
+}
+MP_DEFINE_CONST_FUN_OBJ_1(audioio_wavefile_get_underruns_obj, audioio_wavefile_obj_get_underruns);
+
+const mp_obj_property_t audioio_wavefile_underruns_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&audioio_wavefile_get_underruns_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
 STATIC const mp_rom_map_elem_t audioio_wavefile_locals_dict_table[] = {
     // Methods
     { MP_ROM_QSTR(MP_QSTR_deinit), MP_ROM_PTR(&audioio_wavefile_deinit_obj) },
@@ -146,12 +188,25 @@ STATIC const mp_rom_map_elem_t audioio_wavefile_locals_dict_table[] = {
 
     // Properties
     { MP_ROM_QSTR(MP_QSTR_sample_rate), MP_ROM_PTR(&audioio_wavefile_sample_rate_obj) },
+    { MP_ROM_QSTR(MP_QSTR_underruns), MP_ROM_PTR(&audioio_wavefile_underruns_obj) },
 };
 STATIC MP_DEFINE_CONST_DICT(audioio_wavefile_locals_dict, audioio_wavefile_locals_dict_table);
 
+STATIC const audiosample_p_t audioio_wavefile_proto = {
+    .id = &audiosample_protocol_id,
+    .sample_rate = (audiosample_sample_rate_fun)common_hal_audioio_wavefile_get_sample_rate,
+    .bits_per_sample = (audiosample_bits_per_sample_fun)common_hal_audioio_wavefile_get_bits_per_sample,
+    .channel_count = (audiosample_channel_count_fun)common_hal_audioio_wavefile_get_channel_count,
+    .reset_buffer = (audiosample_reset_buffer_fun)audioio_wavefile_reset_buffer,
+    .get_buffer = (audiosample_get_buffer_fun)audioio_wavefile_get_buffer,
+    .get_buffer_structure = (audiosample_get_buffer_structure_fun)audioio_wavefile_get_buffer_structure,
+    .prefetch = (audiosample_prefetch_fun)audioio_wavefile_prefetch,
+};
+
 const mp_obj_type_t audioio_wavefile_type = {
     { &mp_type_type },
     .name = MP_QSTR_WaveFile,
     .make_new = audioio_wavefile_make_new,
     .locals_dict = (mp_obj_dict_t*)&audioio_wavefile_locals_dict,
+    .protocol = &audioio_wavefile_proto,
 };
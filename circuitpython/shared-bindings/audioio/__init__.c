@@ -33,6 +33,13 @@
 #include "shared-bindings/audioio/__init__.h"
 #include "shared-bindings/audioio/AudioOut.h"
 #include "shared-bindings/audioio/WaveFile.h"
+#ifdef CIRCUITPY_AUDIOIO_PROCESSING
+#include "shared-bindings/audioio/Filter.h"
+#include "shared-bindings/audioio/Mixer.h"
+#include "shared-bindings/audioio/Resampler.h"
+#include "shared-bindings/audioio/Synth.h"
+#include "shared-bindings/audioio/Volume.h"
+#endif
 
 //| :mod:`audioio` --- Support for audio input and output
 //| ======================================================
@@ -49,9 +56,18 @@
 //|     :maxdepth: 3
 //|
 //|     AudioOut
+//|     Filter
+//|     Mixer
 //|     RawSample
+//|     Resampler
+//|     Synth
+//|     Volume
 //|     WaveFile
 //|
+//| .. warning:: `Filter`, `Mixer`, `Resampler`, `Synth` and `Volume` are only available on
+//|   SAMD51 builds.
+//|
+
 //| All classes change hardware state and should be deinitialized when they
 //| are no longer needed if the program continues after use. To do so, either
 //| call :py:meth:`!deinit` or use a context manager. See
@@ -63,6 +79,13 @@ STATIC const mp_rom_map_elem_t audioio_module_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR_AudioOut), MP_ROM_PTR(&audioio_audioout_type) },
     { MP_ROM_QSTR(MP_QSTR_RawSample), MP_ROM_PTR(&audioio_rawsample_type) },
     { MP_ROM_QSTR(MP_QSTR_WaveFile), MP_ROM_PTR(&audioio_wavefile_type) },
+    #ifdef CIRCUITPY_AUDIOIO_PROCESSING
+    { MP_ROM_QSTR(MP_QSTR_Filter), MP_ROM_PTR(&audioio_filter_type) },
+    { MP_ROM_QSTR(MP_QSTR_Mixer), MP_ROM_PTR(&audioio_mixer_type) },
+    { MP_ROM_QSTR(MP_QSTR_Resampler), MP_ROM_PTR(&audioio_resampler_type) },
+    { MP_ROM_QSTR(MP_QSTR_Synth), MP_ROM_PTR(&audioio_synth_type) },
+    { MP_ROM_QSTR(MP_QSTR_Volume), MP_ROM_PTR(&audioio_volume_type) },
+    #endif
 };
 
 STATIC MP_DEFINE_CONST_DICT(audioio_module_globals, audioio_module_globals_table);
@@ -27,8 +27,42 @@
 #ifndef MICROPY_INCLUDED_SHARED_BINDINGS_AUDIOIO___INIT___H
 #define MICROPY_INCLUDED_SHARED_BINDINGS_AUDIOIO___INIT___H
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include "py/obj.h"
+#include "shared-module/audioio/__init__.h"
+
+typedef uint32_t (*audiosample_sample_rate_fun)(mp_obj_t);
+typedef uint8_t (*audiosample_bits_per_sample_fun)(mp_obj_t);
+typedef uint8_t (*audiosample_channel_count_fun)(mp_obj_t);
+typedef void (*audiosample_reset_buffer_fun)(mp_obj_t, bool single_channel, uint8_t channel);
+typedef audioio_get_buffer_result_t (*audiosample_get_buffer_fun)(mp_obj_t, bool single_channel,
+    uint8_t channel, uint8_t** buffer, uint32_t* buffer_length);
+typedef void (*audiosample_get_buffer_structure_fun)(mp_obj_t, bool single_channel,
+    bool* single_buffer, bool* samples_signed, uint32_t* max_buffer_length, uint8_t* spacing);
+typedef void (*audiosample_prefetch_fun)(mp_obj_t);
+
+// A type is an audio sample when its protocol points to one of these. AudioOut, I2SOut, Mixer
+// and the other samples only read samples through it so new sample types need no port changes.
+// All but prefetch are required and everything except prefetch may be called in an interrupt.
+typedef struct _audiosample_p_t {
+    // Always &audiosample_protocol_id. Other protocols, such as streams, share the same
+    // type slot and this tells them apart.
+    const void* id;
+    audiosample_sample_rate_fun sample_rate;
+    audiosample_bits_per_sample_fun bits_per_sample;
+    audiosample_channel_count_fun channel_count;
+    audiosample_reset_buffer_fun reset_buffer;
+    audiosample_get_buffer_fun get_buffer;
+    audiosample_get_buffer_structure_fun get_buffer_structure;
+    audiosample_prefetch_fun prefetch; // May be NULL
+} audiosample_p_t;
+
+extern const uint8_t audiosample_protocol_id;
 
-// Nothing now.
+// Raises TypeError unless sample_obj implements the audio sample protocol. Returns the object
+// to read samples from, which is the native base for instances of Python subclasses.
+mp_obj_t audiosample_check(mp_obj_t sample_obj);
 
 #endif  // MICROPY_INCLUDED_SHARED_BINDINGS_AUDIOIO___INIT___H
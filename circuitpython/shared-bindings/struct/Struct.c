@@ -0,0 +1,271 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013, 2014 Damien P. George
+ * Copyright (c) 2014 Paul Sokolovsky
+ * Copyright (c) 2017 Michael McWethy
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "py/runtime.h"
+#include "py/objlist.h"
+#include "py/objproperty.h"
+#include "py/objtuple.h"
+#include "shared-bindings/struct/Struct.h"
+#include "supervisor/shared/translate.h"
+
+//| .. currentmodule:: struct
+//|
+//| :class:`Struct` -- Precompiled format
+//| =====================================
+//|
+//| A `Struct` parses its format string once, when it is created, so packing
+//| and unpacking many records of the same layout does not parse the format
+//| each time.
+//|
+//| .. class:: Struct(fmt)
+//|
+//|   Create a `Struct` for the given format string, as accepted by the
+//|   module level functions.
+//|
+STATIC mp_obj_t struct_struct_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    (void)type;
+    mp_arg_check_num(n_args, n_kw, 1, 1, false);
+    size_t n_ops = shared_modules_struct_struct_count_ops(args[0]);
+    struct_struct_obj_t *self = m_new_obj_var(struct_struct_obj_t, struct_op_t, n_ops);
+    self->base.type = &struct_struct_type;
+    shared_modules_struct_struct_construct(self, args[0]);
+    return MP_OBJ_FROM_PTR(self);
+}
+
+// Returns the start of buffer plus offset, and the end of buffer in end_p.
+STATIC byte *struct_struct_get_buffer(mp_obj_t buffer, mp_int_t offset, mp_uint_t flags, byte **end_p) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buffer, &bufinfo, flags);
+    if (offset < 0) {
+        // negative offsets are relative to the end of the buffer
+        offset = (mp_int_t)bufinfo.len + offset;
+    }
+    if (offset < 0 || (mp_uint_t)offset > bufinfo.len) {
+        mp_raise_RuntimeError(translate("buffer too small"));
+    }
+    byte *p = (byte *)bufinfo.buf;
+    *end_p = p + bufinfo.len;
+    return p + offset;
+}
+
+// Returns the items array of out, or of a new tuple when out is None.
+STATIC mp_obj_t *struct_struct_get_out(struct_struct_obj_t *self, mp_obj_t *out) {
+    if (*out == mp_const_none) {
+        *out = mp_obj_new_tuple(self->n_items, NULL);
+        return ((mp_obj_tuple_t *)MP_OBJ_TO_PTR(*out))->items;
+    }
+    if (!MP_OBJ_IS_TYPE(*out, &mp_type_list)) {
+        mp_raise_TypeError(translate("out must be a list"));
+    }
+    size_t len;
+    mp_obj_t *items;
+    mp_obj_list_get(*out, &len, &items);
+    if (len != self->n_items) {
+        mp_raise_ValueError(translate("out list length must match the format"));
+    }
+    return items;
+}
+
+//|   .. method:: pack(v1, v2, ...)
+//|
+//|     Pack the values v1, v2, ... and return a bytes object encoding them.
+//|
+STATIC mp_obj_t struct_struct_pack(size_t n_args, const mp_obj_t *args) {
+    struct_struct_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    vstr_t vstr;
+    vstr_init_len(&vstr, self->size);
+    byte *p = (byte *)vstr.buf;
+    memset(p, 0, self->size);
+    shared_modules_struct_struct_pack_into(self, p, p + self->size, n_args - 1, &args[1]);
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(struct_struct_pack_obj, 1, MP_OBJ_FUN_ARGS_MAX, struct_struct_pack);
+
+//|   .. method:: pack_into(buffer, offset, v1, v2, ...)
+//|
+//|     Pack the values v1, v2, ... into buffer starting at offset. offset may
+//|     be negative to count from the end of buffer.
+//|
+STATIC mp_obj_t struct_struct_pack_into(size_t n_args, const mp_obj_t *args) {
+    struct_struct_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    byte *end_p;
+    byte *p = struct_struct_get_buffer(args[1], mp_obj_get_int(args[2]), MP_BUFFER_WRITE, &end_p);
+    shared_modules_struct_struct_pack_into(self, p, end_p, n_args - 3, &args[3]);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(struct_struct_pack_into_obj, 3, MP_OBJ_FUN_ARGS_MAX, struct_struct_pack_into);
+
+//|   .. method:: unpack(data)
+//|
+//|     Unpack data and return a tuple of the values. Like the module level
+//|     function, data only needs to be at least `size` bytes long.
+//|
+//|   .. method:: unpack_from(data, offset=0, *, out=None)
+//|
+//|     Unpack data starting at offset. offset may be negative to count from
+//|     the end of data. The values are returned in a new tuple, or stored in
+//|     the list *out*, which must have one entry per value, and *out* is
+//|     returned.
+//|
+STATIC mp_obj_t struct_struct_unpack_from(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_buffer, ARG_offset, ARG_out };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_buffer, MP_ARG_REQUIRED | MP_ARG_OBJ },
+        { MP_QSTR_offset, MP_ARG_INT, {.u_int = 0} },
+        { MP_QSTR_out, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none} },
+    };
+    struct_struct_obj_t *self = MP_OBJ_TO_PTR(pos_args[0]);
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    byte *end_p;
+    byte *p = struct_struct_get_buffer(args[ARG_buffer].u_obj, args[ARG_offset].u_int, MP_BUFFER_READ, &end_p);
+    mp_obj_t out = args[ARG_out].u_obj;
+    mp_obj_t *items = struct_struct_get_out(self, &out);
+    shared_modules_struct_struct_unpack_from(self, p, end_p, items);
+    return out;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(struct_struct_unpack_from_obj, 2, struct_struct_unpack_from);
+
+typedef struct _struct_struct_iter_t {
+    mp_obj_base_t base;
+    mp_fun_1_t iternext;
+    struct_struct_obj_t *s;
+    mp_obj_t buffer;
+    mp_obj_t out;
+    mp_uint_t offset;
+} struct_struct_iter_t;
+
+STATIC mp_obj_t struct_struct_iter_iternext(mp_obj_t self_in) {
+    struct_struct_iter_t *self = MP_OBJ_TO_PTR(self_in);
+    byte *end_p;
+    byte *p = struct_struct_get_buffer(self->buffer, 0, MP_BUFFER_READ, &end_p);
+    if (self->offset + self->s->size > (mp_uint_t)(end_p - p)) {
+        return MP_OBJ_STOP_ITERATION;
+    }
+    p += self->offset;
+    mp_obj_t out = self->out;
+    mp_obj_t *items = struct_struct_get_out(self->s, &out);
+    shared_modules_struct_struct_unpack_from(self->s, p, end_p, items);
+    self->offset += self->s->size;
+    return out;
+}
+
+//|   .. method:: iter_unpack(data, *, out=None)
+//|
+//|     Return an iterator that unpacks consecutive records of `size` bytes
+//|     from data. data must be a whole number of records long. Each record is
+//|     returned in a new tuple or, if *out* is given, stored in that list,
+//|     which is returned by every step; copy it to keep the values of a
+//|     record past the next step.
+//|
+STATIC mp_obj_t struct_struct_iter_unpack(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_buffer, ARG_out };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_buffer, MP_ARG_REQUIRED | MP_ARG_OBJ },
+        { MP_QSTR_out, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none} },
+    };
+    struct_struct_obj_t *self = MP_OBJ_TO_PTR(pos_args[0]);
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[ARG_buffer].u_obj, &bufinfo, MP_BUFFER_READ);
+    if (self->size == 0 || bufinfo.len % self->size != 0) {
+        mp_raise_ValueError(translate("buffer size must be a multiple of the struct size"));
+    }
+    mp_obj_t out = args[ARG_out].u_obj;
+    if (out != mp_const_none) {
+        // check the list up front rather than on the first step
+        struct_struct_get_out(self, &out);
+    }
+
+    struct_struct_iter_t *iter = m_new_obj(struct_struct_iter_t);
+    iter->base.type = &mp_type_polymorph_iter;
+    iter->iternext = struct_struct_iter_iternext;
+    iter->s = self;
+    iter->buffer = args[ARG_buffer].u_obj;
+    iter->out = out;
+    iter->offset = 0;
+    return MP_OBJ_FROM_PTR(iter);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(struct_struct_iter_unpack_obj, 2, struct_struct_iter_unpack);
+
+//|   .. attribute:: format
+//|
+//|     The format string used to create this `Struct`.
+//|
+STATIC mp_obj_t struct_struct_get_format(mp_obj_t self_in) {
+    struct_struct_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return self->format;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(struct_struct_get_format_obj, struct_struct_get_format);
+
+STATIC const mp_obj_property_t struct_struct_format_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&struct_struct_get_format_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+//|   .. attribute:: size
+//|
+//|     The number of bytes packed by this `Struct`, as returned by `calcsize`.
+//|
+STATIC mp_obj_t struct_struct_get_size(mp_obj_t self_in) {
+    struct_struct_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return MP_OBJ_NEW_SMALL_INT(self->size);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(struct_struct_get_size_obj, struct_struct_get_size);
+
+STATIC const mp_obj_property_t struct_struct_size_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&struct_struct_get_size_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+STATIC const mp_rom_map_elem_t struct_struct_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_pack), MP_ROM_PTR(&struct_struct_pack_obj) },
+    { MP_ROM_QSTR(MP_QSTR_pack_into), MP_ROM_PTR(&struct_struct_pack_into_obj) },
+    { MP_ROM_QSTR(MP_QSTR_unpack), MP_ROM_PTR(&struct_struct_unpack_from_obj) },
+    { MP_ROM_QSTR(MP_QSTR_unpack_from), MP_ROM_PTR(&struct_struct_unpack_from_obj) },
+    { MP_ROM_QSTR(MP_QSTR_iter_unpack), MP_ROM_PTR(&struct_struct_iter_unpack_obj) },
+    { MP_ROM_QSTR(MP_QSTR_format), MP_ROM_PTR(&struct_struct_format_obj) },
+    { MP_ROM_QSTR(MP_QSTR_size), MP_ROM_PTR(&struct_struct_size_obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(struct_struct_locals_dict, struct_struct_locals_dict_table);
+
+const mp_obj_type_t struct_struct_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_Struct,
+    .make_new = struct_struct_make_new,
+    .locals_dict = (mp_obj_dict_t*)&struct_struct_locals_dict,
+};
@@ -0,0 +1,48 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_MODULE_AUDIOBUSIO_PDM_H
+#define MICROPY_INCLUDED_SHARED_MODULE_AUDIOBUSIO_PDM_H
+
+#include <stdint.h>
+
+// Decimates 64x oversampled PDM to PCM with a 64 tap windowed sinc filter.
+// The PDM bits for one output sample arrive in four words. Each word holds
+// 16 bits, first bit most significant, in its low half. The high half belongs
+// to a second channel that isn't used.
+
+#define AUDIOBUSIO_PDM_OVERSAMPLING (64)
+#define AUDIOBUSIO_PDM_WORDS_PER_SAMPLE (AUDIOBUSIO_PDM_OVERSAMPLING / 16)
+
+// The filter taps. Their sum is under 1 << 16 so no output overflows.
+extern const uint16_t audiobusio_pdm_sinc_filter[AUDIOBUSIO_PDM_OVERSAMPLING];
+
+// Filters count samples from pdm into out, keeping the top 8 bits of each.
+void audiobusio_pdm_filter_8(const uint32_t* pdm, uint32_t count, uint8_t* out);
+// Filters count samples from pdm into out.
+void audiobusio_pdm_filter_16(const uint32_t* pdm, uint32_t count, uint16_t* out);
+
+#endif // MICROPY_INCLUDED_SHARED_MODULE_AUDIOBUSIO_PDM_H
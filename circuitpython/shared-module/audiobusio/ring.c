@@ -0,0 +1,102 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "shared-module/audiobusio/ring.h"
+
+#include <string.h>
+
+// Keeps the compiler from moving the data copy past the index update that
+// publishes it. Both sides run on the same core so no hardware barrier is
+// needed.
+#define RING_BARRIER() __asm__ volatile ("" : : : "memory")
+
+static uint32_t ring_used(uint32_t size, uint32_t read, uint32_t write) {
+    if (write < read) {
+        return write + 2 * size - read;
+    }
+    return write - read;
+}
+
+static uint32_t ring_advance(uint32_t size, uint32_t position, uint32_t length) {
+    position += length;
+    if (position >= 2 * size) {
+        position -= 2 * size;
+    }
+    return position;
+}
+
+void audiobusio_ring_init(audiobusio_ring_t* ring, uint8_t* buffer, uint32_t size) {
+    ring->buffer = buffer;
+    ring->size = size;
+    ring->read = 0;
+    ring->write = 0;
+}
+
+uint32_t audiobusio_ring_count(const audiobusio_ring_t* ring) {
+    return ring_used(ring->size, ring->read, ring->write);
+}
+
+uint32_t audiobusio_ring_space(const audiobusio_ring_t* ring) {
+    return ring->size - audiobusio_ring_count(ring);
+}
+
+bool audiobusio_ring_put(audiobusio_ring_t* ring, const uint8_t* data, uint32_t length) {
+    uint32_t size = ring->size;
+    uint32_t write = ring->write;
+    if (size - ring_used(size, ring->read, write) < length) {
+        return false;
+    }
+    uint32_t index = write < size ? write : write - size;
+    uint32_t first = size - index;
+    if (first > length) {
+        first = length;
+    }
+    memcpy(ring->buffer + index, data, first);
+    memcpy(ring->buffer, data + first, length - first);
+    RING_BARRIER();
+    ring->write = ring_advance(size, write, length);
+    return true;
+}
+
+uint32_t audiobusio_ring_get(audiobusio_ring_t* ring, uint8_t* data, uint32_t length) {
+    uint32_t size = ring->size;
+    uint32_t read = ring->read;
+    uint32_t available = ring_used(size, read, ring->write);
+    if (length > available) {
+        length = available;
+    }
+    RING_BARRIER();
+    uint32_t index = read < size ? read : read - size;
+    uint32_t first = size - index;
+    if (first > length) {
+        first = length;
+    }
+    memcpy(data, ring->buffer + index, first);
+    memcpy(data + first, ring->buffer, length - first);
+    RING_BARRIER();
+    ring->read = ring_advance(size, read, length);
+    return length;
+}
@@ -0,0 +1,53 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_MODULE_AUDIOBUSIO_RING_H
+#define MICROPY_INCLUDED_SHARED_MODULE_AUDIOBUSIO_RING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// A byte ring shared by one producer and one consumer without locks. Only the
+// producer moves write and only the consumer moves read. Both count up to
+// twice the size so a full ring can be told apart from an empty one.
+typedef struct {
+    uint8_t* buffer;
+    uint32_t size;
+    volatile uint32_t read;
+    volatile uint32_t write;
+} audiobusio_ring_t;
+
+void audiobusio_ring_init(audiobusio_ring_t* ring, uint8_t* buffer, uint32_t size);
+// Returns the number of bytes waiting to be read.
+uint32_t audiobusio_ring_count(const audiobusio_ring_t* ring);
+// Returns the number of bytes that can be written.
+uint32_t audiobusio_ring_space(const audiobusio_ring_t* ring);
+// Producer side. Writes all length bytes or, when they don't fit, none of them.
+bool audiobusio_ring_put(audiobusio_ring_t* ring, const uint8_t* data, uint32_t length);
+// Consumer side. Reads up to length bytes and returns how many were read.
+uint32_t audiobusio_ring_get(audiobusio_ring_t* ring, uint8_t* data, uint32_t length);
+
+#endif // MICROPY_INCLUDED_SHARED_MODULE_AUDIOBUSIO_RING_H
@@ -0,0 +1,145 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "shared-bindings/audioio/Filter.h"
+
+#include <stdint.h>
+
+#include "py/runtime.h"
+
+#include "shared-module/audioio/__init__.h"
+
+void common_hal_audioio_filter_construct(audioio_filter_obj_t* self, mp_obj_t sample,
+                                         float low_pass, float high_pass, float q, bool dc_block,
+                                         uint32_t buffer_size) {
+    audioio_stage_construct(&self->stage, sample, buffer_size);
+    self->sample_rate = audiosample_sample_rate(sample);
+    self->q = q;
+    self->low_pass = 0;
+    self->high_pass = 0;
+    self->dc_block = dc_block;
+    common_hal_audioio_filter_set_low_pass(self, low_pass);
+    common_hal_audioio_filter_set_high_pass(self, high_pass);
+    audioio_filter_reset_buffer(self, false, 0);
+}
+
+void common_hal_audioio_filter_deinit(audioio_filter_obj_t* self) {
+    audioio_stage_deinit(&self->stage);
+}
+
+bool common_hal_audioio_filter_deinited(audioio_filter_obj_t* self) {
+    return audioio_stage_deinited(&self->stage);
+}
+
+uint32_t common_hal_audioio_filter_get_sample_rate(audioio_filter_obj_t* self) {
+    return self->sample_rate;
+}
+
+uint8_t common_hal_audioio_filter_get_bits_per_sample(audioio_filter_obj_t* self) {
+    return 16;
+}
+
+uint8_t common_hal_audioio_filter_get_channel_count(audioio_filter_obj_t* self) {
+    return self->stage.channel_count;
+}
+
+float common_hal_audioio_filter_get_low_pass(audioio_filter_obj_t* self) {
+    return self->low_pass;
+}
+
+// A filter that is already running keeps its history so the cutoff can sweep without clicks.
+void common_hal_audioio_filter_set_low_pass(audioio_filter_obj_t* self, float frequency) {
+    if (frequency > 0) {
+        if (self->low_pass <= 0) {
+            audioio_biquad_clear(&self->low_pass_filter);
+        }
+        audioio_biquad_low_pass(&self->low_pass_filter, self->sample_rate, frequency, self->q);
+    }
+    self->low_pass = frequency;
+}
+
+float common_hal_audioio_filter_get_high_pass(audioio_filter_obj_t* self) {
+    return self->high_pass;
+}
+
+void common_hal_audioio_filter_set_high_pass(audioio_filter_obj_t* self, float frequency) {
+    if (frequency > 0) {
+        if (self->high_pass <= 0) {
+            audioio_biquad_clear(&self->high_pass_filter);
+        }
+        audioio_biquad_high_pass(&self->high_pass_filter, self->sample_rate, frequency, self->q);
+    }
+    self->high_pass = frequency;
+}
+
+bool common_hal_audioio_filter_get_dc_block(audioio_filter_obj_t* self) {
+    return self->dc_block;
+}
+
+void audioio_filter_reset_buffer(audioio_filter_obj_t* self,
+                                 bool single_channel,
+                                 uint8_t channel) {
+    if (!audioio_stage_reset_buffer(&self->stage, single_channel, channel)) {
+        return;
+    }
+    audioio_biquad_clear(&self->low_pass_filter);
+    audioio_biquad_clear(&self->high_pass_filter);
+    audioio_dc_block_clear(&self->dc_blocker);
+}
+
+static void apply_filters(void* context, int16_t* samples, uint32_t frames) {
+    audioio_filter_obj_t* self = context;
+    uint8_t channel_count = self->stage.channel_count;
+    if (self->dc_block) {
+        audioio_dc_block_apply(&self->dc_blocker, samples, frames, channel_count);
+    }
+    if (self->high_pass > 0) {
+        audioio_biquad_apply(&self->high_pass_filter, samples, frames, channel_count);
+    }
+    if (self->low_pass > 0) {
+        audioio_biquad_apply(&self->low_pass_filter, samples, frames, channel_count);
+    }
+}
+
+audioio_get_buffer_result_t audioio_filter_get_buffer(audioio_filter_obj_t* self,
+                                                      bool single_channel,
+                                                      uint8_t channel,
+                                                      uint8_t** buffer,
+                                                      uint32_t* buffer_length) {
+    return audioio_stage_get_buffer(&self->stage, single_channel, channel, buffer, buffer_length,
+                                    apply_filters, self);
+}
+
+void audioio_filter_get_buffer_structure(audioio_filter_obj_t* self, bool single_channel,
+                                         bool* single_buffer, bool* samples_signed,
+                                         uint32_t* max_buffer_length, uint8_t* spacing) {
+    audioio_stage_get_buffer_structure(&self->stage, single_channel, single_buffer,
+                                       samples_signed, max_buffer_length, spacing);
+}
+
+void audioio_filter_prefetch(audioio_filter_obj_t* self) {
+    audioio_stage_prefetch(&self->stage);
+}
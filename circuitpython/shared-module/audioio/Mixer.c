@@ -0,0 +1,298 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "shared-bindings/audioio/Mixer.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "py/runtime.h"
+
+#include "shared-module/audioio/__init__.h"
+#include "shared-module/audioio/mix.h"
+#include "supervisor/shared/translate.h"
+
+void common_hal_audioio_mixer_construct(audioio_mixer_obj_t* self, uint8_t voice_count,
+                                        uint32_t buffer_size, uint8_t bits_per_sample,
+                                        bool samples_signed, uint8_t channel_count,
+                                        uint32_t sample_rate) {
+    self->first_buffer = m_malloc(buffer_size, false);
+    if (self->first_buffer == NULL) {
+        common_hal_audioio_mixer_deinit(self);
+        mp_raise_msg(&mp_type_MemoryError, translate("Couldn't allocate first buffer"));
+    }
+
+    self->second_buffer = m_malloc(buffer_size, false);
+    if (self->second_buffer == NULL) {
+        common_hal_audioio_mixer_deinit(self);
+        mp_raise_msg(&mp_type_MemoryError, translate("Couldn't allocate second buffer"));
+    }
+
+    self->len = buffer_size;
+    self->bits_per_sample = bits_per_sample;
+    self->samples_signed = samples_signed;
+    self->channel_count = channel_count;
+    self->sample_rate = sample_rate;
+    self->voice_count = voice_count;
+    for (uint8_t i = 0; i < voice_count; i++) {
+        self->voice[i].sample = NULL;
+        self->voice[i].gain = AUDIOIO_MIXER_UNITY_GAIN;
+    }
+    audioio_mixer_reset_buffer(self, false, 0);
+}
+
+void common_hal_audioio_mixer_deinit(audioio_mixer_obj_t* self) {
+    self->first_buffer = NULL;
+    self->second_buffer = NULL;
+}
+
+bool common_hal_audioio_mixer_deinited(audioio_mixer_obj_t* self) {
+    return self->first_buffer == NULL;
+}
+
+uint32_t common_hal_audioio_mixer_get_sample_rate(audioio_mixer_obj_t* self) {
+    return self->sample_rate;
+}
+
+uint8_t common_hal_audioio_mixer_get_bits_per_sample(audioio_mixer_obj_t* self) {
+    return self->bits_per_sample;
+}
+
+uint8_t common_hal_audioio_mixer_get_channel_count(audioio_mixer_obj_t* self) {
+    return self->channel_count;
+}
+
+bool common_hal_audioio_mixer_get_playing(audioio_mixer_obj_t* self) {
+    for (uint8_t i = 0; i < self->voice_count; i++) {
+        if (self->voice[i].sample != NULL) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void common_hal_audioio_mixer_play(audioio_mixer_obj_t* self, mp_obj_t sample, uint8_t voice,
+                                   bool loop, uint16_t gain) {
+    if (audiosample_sample_rate(sample) != self->sample_rate) {
+        mp_raise_ValueError(translate("The sample's sample rate does not match the mixer's"));
+    }
+    if (audiosample_channel_count(sample) != self->channel_count) {
+        mp_raise_ValueError(translate("The sample's channel count does not match the mixer's"));
+    }
+    if (audiosample_bits_per_sample(sample) != self->bits_per_sample) {
+        mp_raise_ValueError(translate("The sample's bits_per_sample does not match the mixer's"));
+    }
+    audioio_mixer_voice_t* v = &self->voice[voice];
+    // Stop the voice while we set it up. The mixer may be asked for a buffer
+    // from a background task at any time.
+    v->sample = NULL;
+    audiosample_reset_buffer(sample, false, 0);
+    v->loop = loop;
+    v->more_data = true;
+    v->gain = gain;
+    v->remaining_buffer = NULL;
+    v->remaining_length = 0;
+    v->sample = sample;
+}
+
+void common_hal_audioio_mixer_stop_voice(audioio_mixer_obj_t* self, uint8_t voice) {
+    self->voice[voice].sample = NULL;
+}
+
+void common_hal_audioio_mixer_set_gain(audioio_mixer_obj_t* self, uint8_t voice, uint16_t gain) {
+    self->voice[voice].gain = gain;
+}
+
+void audioio_mixer_reset_buffer(audioio_mixer_obj_t* self,
+                                bool single_channel,
+                                uint8_t channel) {
+    if (single_channel && channel == 1) {
+        return;
+    }
+    // The voices carry on from where they are. Only the output is restarted.
+    self->read_count = 0;
+    self->left_read_count = 0;
+    self->right_read_count = 0;
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wcast-align"
+
+// Mixes count samples from the voice into the sample offset of out. Samples
+// before filled have been written by earlier voices and are added to, the
+// rest are overwritten.
+static void mix_voice(audioio_mixer_obj_t* self, audioio_mixer_voice_t* voice, bool voice_signed,
+                      uint8_t* out, uint32_t offset, uint32_t count, uint32_t filled) {
+    uint32_t added = 0;
+    if (offset < filled) {
+        added = filled - offset;
+        if (added > count) {
+            added = count;
+        }
+    }
+    if (self->bits_per_sample == 16) {
+        uint16_t flip = voice_signed ? 0 : 0x8000;
+        int16_t* out_samples = ((int16_t*) out) + offset;
+        const uint16_t* in_samples = (const uint16_t*) voice->remaining_buffer;
+        audioio_mix_16(out_samples, in_samples, added, flip, voice->gain, true);
+        audioio_mix_16(out_samples + added, in_samples + added, count - added, flip, voice->gain, false);
+    } else {
+        uint8_t flip = voice_signed ? 0 : 0x80;
+        int8_t* out_samples = ((int8_t*) out) + offset;
+        const uint8_t* in_samples = voice->remaining_buffer;
+        audioio_mix_8(out_samples, in_samples, added, flip, voice->gain, true);
+        audioio_mix_8(out_samples + added, in_samples + added, count - added, flip, voice->gain, false);
+    }
+}
+
+// Fills the buffer from every playing voice. Voices that run out part way
+// through stop and leave the rest to the others.
+static void mix_buffer(audioio_mixer_obj_t* self, uint8_t* out) {
+    uint8_t bytes_per_sample = self->bits_per_sample / 8;
+    uint32_t sample_count = self->len / bytes_per_sample;
+    uint32_t filled = 0;
+    for (uint8_t i = 0; i < self->voice_count; i++) {
+        audioio_mixer_voice_t* voice = &self->voice[i];
+        if (voice->sample == NULL) {
+            continue;
+        }
+        bool voice_signed;
+        bool single_buffer;
+        uint32_t max_buffer_length;
+        uint8_t spacing;
+        audiosample_get_buffer_structure(voice->sample, false, &single_buffer, &voice_signed,
+                                         &max_buffer_length, &spacing);
+        uint32_t offset = 0;
+        // Stop an empty looping sample from spinning here forever.
+        bool reset = false;
+        while (offset < sample_count) {
+            if (voice->remaining_length < bytes_per_sample) {
+                if (!voice->more_data) {
+                    if (!voice->loop || reset) {
+                        voice->sample = NULL;
+                        break;
+                    }
+                    audiosample_reset_buffer(voice->sample, false, 0);
+                    reset = true;
+                }
+                audioio_get_buffer_result_t result =
+                    audiosample_get_buffer(voice->sample, false, 0, &voice->remaining_buffer,
+                                           &voice->remaining_length);
+                if (result == GET_BUFFER_ERROR) {
+                    voice->sample = NULL;
+                    break;
+                }
+                voice->more_data = result == GET_BUFFER_MORE_DATA;
+                continue;
+            }
+            reset = false;
+            uint32_t count = voice->remaining_length / bytes_per_sample;
+            if (count > sample_count - offset) {
+                count = sample_count - offset;
+            }
+            mix_voice(self, voice, voice_signed, out, offset, count, filled);
+            offset += count;
+            voice->remaining_buffer += count * bytes_per_sample;
+            voice->remaining_length -= count * bytes_per_sample;
+        }
+        if (offset > filled) {
+            filled = offset;
+        }
+    }
+    // Silence after the last voice.
+    memset(out + filled * bytes_per_sample, 0, (sample_count - filled) * bytes_per_sample);
+
+    if (!self->samples_signed) {
+        if (bytes_per_sample == 2) {
+            uint16_t* samples = (uint16_t*) out;
+            for (uint32_t i = 0; i < sample_count; i++) {
+                samples[i] ^= 0x8000;
+            }
+        } else {
+            for (uint32_t i = 0; i < sample_count; i++) {
+                out[i] ^= 0x80;
+            }
+        }
+    }
+}
+
+#pragma GCC diagnostic pop
+
+audioio_get_buffer_result_t audioio_mixer_get_buffer(audioio_mixer_obj_t* self,
+                                                     bool single_channel,
+                                                     uint8_t channel,
+                                                     uint8_t** buffer,
+                                                     uint32_t* buffer_length) {
+    if (!single_channel) {
+        channel = 0;
+    }
+
+    uint32_t channel_read_count = self->left_read_count;
+    if (channel == 1) {
+        channel_read_count = self->right_read_count;
+    }
+
+    // Both channels come from the same interleaved buffer. Only mix a new one
+    // once the channel that is furthest ahead asks for it.
+    if (self->read_count == channel_read_count) {
+        mix_buffer(self, self->read_count % 2 == 0 ? self->first_buffer : self->second_buffer);
+        self->read_count += 1;
+    }
+
+    *buffer = channel_read_count % 2 == 0 ? self->first_buffer : self->second_buffer;
+    *buffer_length = self->len;
+
+    if (channel == 0) {
+        self->left_read_count += 1;
+    } else if (channel == 1) {
+        self->right_read_count += 1;
+        *buffer = *buffer + self->bits_per_sample / 8;
+    }
+
+    // The mixer plays silence once all of its voices are done.
+    return GET_BUFFER_MORE_DATA;
+}
+
+void audioio_mixer_get_buffer_structure(audioio_mixer_obj_t* self, bool single_channel,
+                                        bool* single_buffer, bool* samples_signed,
+                                        uint32_t* max_buffer_length, uint8_t* spacing) {
+    *single_buffer = false;
+    *samples_signed = self->samples_signed;
+    *max_buffer_length = self->len;
+    if (single_channel) {
+        *spacing = self->channel_count;
+    } else {
+        *spacing = 1;
+    }
+}
+
+void audioio_mixer_prefetch(audioio_mixer_obj_t* self) {
+    for (uint8_t i = 0; i < self->voice_count; i++) {
+        if (self->voice[i].sample != NULL) {
+            audiosample_prefetch(self->voice[i].sample);
+        }
+    }
+}
@@ -0,0 +1,268 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "shared-bindings/audioio/Resampler.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "py/runtime.h"
+
+#include "shared-module/audioio/__init__.h"
+#include "supervisor/shared/translate.h"
+
+// Frames of 8 bit or unsigned samples converted at a time on the stack.
+#define CONVERT_FRAMES (32)
+
+void common_hal_audioio_resampler_construct(audioio_resampler_obj_t* self, mp_obj_t sample,
+                                            uint32_t sample_rate, uint32_t buffer_size,
+                                            uint8_t taps) {
+    uint64_t rate_step = ((uint64_t) audiosample_sample_rate(sample) << 16) / sample_rate;
+    if (rate_step == 0 || rate_step > AUDIOIO_RESAMPLER_MAX_STEP) {
+        mp_raise_ValueError(translate("Sample rate is too far from the sample's"));
+    }
+
+    self->first_buffer = m_malloc(buffer_size, false);
+    if (self->first_buffer == NULL) {
+        common_hal_audioio_resampler_deinit(self);
+        mp_raise_msg(&mp_type_MemoryError, translate("Couldn't allocate first buffer"));
+    }
+
+    self->second_buffer = m_malloc(buffer_size, false);
+    if (self->second_buffer == NULL) {
+        common_hal_audioio_resampler_deinit(self);
+        mp_raise_msg(&mp_type_MemoryError, translate("Couldn't allocate second buffer"));
+    }
+
+    self->sample = sample;
+    self->len = buffer_size;
+    self->channel_count = audiosample_channel_count(sample);
+    self->sample_rate = sample_rate;
+    self->taps = taps;
+    self->rate_step = rate_step;
+    self->pitch = AUDIOIO_RESAMPLE_ONE;
+    audioio_resampler_reset_buffer(self, false, 0);
+}
+
+void common_hal_audioio_resampler_deinit(audioio_resampler_obj_t* self) {
+    self->first_buffer = NULL;
+    self->second_buffer = NULL;
+}
+
+bool common_hal_audioio_resampler_deinited(audioio_resampler_obj_t* self) {
+    return self->first_buffer == NULL;
+}
+
+uint32_t common_hal_audioio_resampler_get_sample_rate(audioio_resampler_obj_t* self) {
+    return self->sample_rate;
+}
+
+uint8_t common_hal_audioio_resampler_get_bits_per_sample(audioio_resampler_obj_t* self) {
+    return 16;
+}
+
+uint8_t common_hal_audioio_resampler_get_channel_count(audioio_resampler_obj_t* self) {
+    return self->channel_count;
+}
+
+uint32_t common_hal_audioio_resampler_get_pitch(audioio_resampler_obj_t* self) {
+    return self->pitch;
+}
+
+// Only the step changes so the sample carries on smoothly at the new pitch.
+void common_hal_audioio_resampler_set_pitch(audioio_resampler_obj_t* self, uint32_t pitch) {
+    uint64_t step = ((uint64_t) self->rate_step * pitch) >> 16;
+    if (step == 0 || step > AUDIOIO_RESAMPLER_MAX_STEP) {
+        mp_raise_ValueError(translate("pitch out of range"));
+    }
+    self->pitch = pitch;
+    self->state.step = step;
+}
+
+void audioio_resampler_reset_buffer(audioio_resampler_obj_t* self,
+                                    bool single_channel,
+                                    uint8_t channel) {
+    if (single_channel && channel == 1) {
+        return;
+    }
+    audiosample_reset_buffer(self->sample, false, 0);
+    audioio_resample_reset(&self->state, self->channel_count, self->taps,
+                           ((uint64_t) self->rate_step * self->pitch) >> 16);
+    self->more_data = true;
+    self->tail_remaining = audioio_resample_tail_frames(&self->state);
+    self->remaining_buffer = NULL;
+    self->remaining_length = 0;
+    self->read_count = 0;
+    self->left_read_count = 0;
+    self->right_read_count = 0;
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wcast-align"
+
+// Resamples as much of the remaining buffer as fits in out and returns the
+// number of frames written.
+static uint32_t resample_remaining(audioio_resampler_obj_t* self, bool samples_signed,
+                                   uint8_t bits_per_sample, int16_t* out, uint32_t out_frames) {
+    uint8_t channel_count = self->channel_count;
+    uint32_t bytes_per_frame = bits_per_sample / 8 * channel_count;
+    uint32_t frames = self->remaining_length / bytes_per_frame;
+    uint32_t used = frames;
+    uint32_t written;
+    if (bits_per_sample == 16 && samples_signed) {
+        written = audioio_resample(&self->state, (const int16_t*) self->remaining_buffer, &used,
+                                   out, out_frames);
+    } else {
+        int16_t converted[CONVERT_FRAMES * 2];
+        if (used > CONVERT_FRAMES) {
+            used = CONVERT_FRAMES;
+        }
+        uint32_t count = used * channel_count;
+        if (bits_per_sample == 16) {
+            const uint16_t* in = (const uint16_t*) self->remaining_buffer;
+            for (uint32_t i = 0; i < count; i++) {
+                converted[i] = (int16_t) (in[i] ^ 0x8000);
+            }
+        } else {
+            const uint8_t* in = self->remaining_buffer;
+            uint8_t flip = samples_signed ? 0 : 0x80;
+            for (uint32_t i = 0; i < count; i++) {
+                converted[i] = (int16_t) ((in[i] ^ flip) << 8);
+            }
+        }
+        written = audioio_resample(&self->state, converted, &used, out, out_frames);
+    }
+    self->remaining_buffer += used * bytes_per_frame;
+    self->remaining_length -= used * bytes_per_frame;
+    return written;
+}
+
+// Fills out from the sample and returns its length in bytes. done is set once
+// the end of the sample has been output.
+static uint32_t resample_buffer(audioio_resampler_obj_t* self, uint8_t* out, bool* done) {
+    bool samples_signed;
+    bool single_buffer;
+    uint32_t max_buffer_length;
+    uint8_t spacing;
+    audiosample_get_buffer_structure(self->sample, false, &single_buffer, &samples_signed,
+                                     &max_buffer_length, &spacing);
+    uint8_t bits_per_sample = audiosample_bits_per_sample(self->sample);
+    uint32_t bytes_per_frame = bits_per_sample / 8 * self->channel_count;
+
+    int16_t* out_samples = (int16_t*) out;
+    uint32_t frames = self->len / (2 * self->channel_count);
+    uint32_t written = 0;
+    *done = false;
+    while (written < frames) {
+        int16_t* next = out_samples + written * self->channel_count;
+        if (self->remaining_length >= bytes_per_frame) {
+            written += resample_remaining(self, samples_signed, bits_per_sample, next,
+                                          frames - written);
+        } else if (self->more_data) {
+            audioio_get_buffer_result_t result =
+                audiosample_get_buffer(self->sample, false, 0, &self->remaining_buffer,
+                                       &self->remaining_length);
+            if (result == GET_BUFFER_ERROR) {
+                self->remaining_length = 0;
+                self->tail_remaining = 0;
+            }
+            self->more_data = result == GET_BUFFER_MORE_DATA;
+        } else if (self->tail_remaining > 0) {
+            // Feed in silence to flush the end of the sample through the filter.
+            static const int16_t silence[2] = {0, 0};
+            uint32_t used = 1;
+            written += audioio_resample(&self->state, silence, &used, next, frames - written);
+            self->tail_remaining -= used;
+        } else {
+            // Output what's left before the next input frame would be needed.
+            uint32_t used = 0;
+            written += audioio_resample(&self->state, NULL, &used, next, frames - written);
+            *done = written < frames;
+            break;
+        }
+    }
+    if (written == 0) {
+        // Never hand back an empty buffer.
+        memset(out, 0, 2 * self->channel_count);
+        written = 1;
+    }
+    return written * 2 * self->channel_count;
+}
+
+#pragma GCC diagnostic pop
+
+audioio_get_buffer_result_t audioio_resampler_get_buffer(audioio_resampler_obj_t* self,
+                                                         bool single_channel,
+                                                         uint8_t channel,
+                                                         uint8_t** buffer,
+                                                         uint32_t* buffer_length) {
+    if (!single_channel) {
+        channel = 0;
+    }
+
+    uint32_t channel_read_count = self->left_read_count;
+    if (channel == 1) {
+        channel_read_count = self->right_read_count;
+    }
+
+    // Both channels come from the same interleaved buffer. Only resample a new
+    // one once the channel that is furthest ahead asks for it.
+    uint8_t index = channel_read_count % 2;
+    if (self->read_count == channel_read_count) {
+        uint8_t* out = index == 0 ? self->first_buffer : self->second_buffer;
+        self->buffer_lengths[index] = resample_buffer(self, out, &self->buffer_done[index]);
+        self->read_count += 1;
+    }
+
+    *buffer = index == 0 ? self->first_buffer : self->second_buffer;
+    *buffer_length = self->buffer_lengths[index];
+
+    if (channel == 0) {
+        self->left_read_count += 1;
+    } else if (channel == 1) {
+        self->right_read_count += 1;
+        *buffer = *buffer + 2;
+    }
+
+    return self->buffer_done[index] ? GET_BUFFER_DONE : GET_BUFFER_MORE_DATA;
+}
+
+void audioio_resampler_get_buffer_structure(audioio_resampler_obj_t* self, bool single_channel,
+                                            bool* single_buffer, bool* samples_signed,
+                                            uint32_t* max_buffer_length, uint8_t* spacing) {
+    *single_buffer = false;
+    *samples_signed = true;
+    *max_buffer_length = self->len;
+    if (single_channel) {
+        *spacing = self->channel_count;
+    } else {
+        *spacing = 1;
+    }
+}
+
+void audioio_resampler_prefetch(audioio_resampler_obj_t* self) {
+    audiosample_prefetch(self->sample);
+}
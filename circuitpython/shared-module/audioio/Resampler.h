@@ -0,0 +1,79 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_RESAMPLER_H
+#define MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_RESAMPLER_H
+
+#include "py/obj.h"
+
+#include "shared-module/audioio/__init__.h"
+#include "shared-module/audioio/resample.h"
+
+// Up to 16 input frames per output frame. Each one takes time to read in.
+#define AUDIOIO_RESAMPLER_MAX_STEP (16 * AUDIOIO_RESAMPLE_ONE)
+
+typedef struct {
+    mp_obj_base_t base;
+    mp_obj_t sample;
+    uint8_t* first_buffer;
+    uint8_t* second_buffer;
+    uint32_t len;           // Bytes in each buffer.
+    uint8_t channel_count;
+    uint32_t sample_rate;
+    uint8_t taps;
+    // Input frames per output frame, in 16.16 fixed point, before pitch.
+    uint32_t rate_step;
+    uint32_t pitch;         // 16.16 fixed point
+
+    audioio_resample_state_t state;
+    bool more_data;         // The sample has more buffers after the current one.
+    uint32_t tail_remaining; // Silent frames still to feed in once the sample is done.
+    // What's left of the last buffer we got from the sample.
+    uint8_t* remaining_buffer;
+    uint32_t remaining_length; // In bytes
+
+    uint32_t buffer_lengths[2];
+    bool buffer_done[2];
+    uint32_t read_count;
+    uint32_t left_read_count;
+    uint32_t right_read_count;
+} audioio_resampler_obj_t;
+
+// These are not available from Python because it may be called in an interrupt.
+void audioio_resampler_reset_buffer(audioio_resampler_obj_t* self,
+                                    bool single_channel,
+                                    uint8_t channel);
+audioio_get_buffer_result_t audioio_resampler_get_buffer(audioio_resampler_obj_t* self,
+                                                         bool single_channel,
+                                                         uint8_t channel,
+                                                         uint8_t** buffer,
+                                                         uint32_t* buffer_length); // length in bytes
+void audioio_resampler_get_buffer_structure(audioio_resampler_obj_t* self, bool single_channel,
+                                            bool* single_buffer, bool* samples_signed,
+                                            uint32_t* max_buffer_length, uint8_t* spacing);
+void audioio_resampler_prefetch(audioio_resampler_obj_t* self);
+
+#endif // MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_RESAMPLER_H
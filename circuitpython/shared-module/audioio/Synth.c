@@ -0,0 +1,164 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "shared-bindings/audioio/Synth.h"
+
+#include <stdint.h>
+
+#include "py/runtime.h"
+
+#include "shared-module/audioio/__init__.h"
+#include "supervisor/shared/translate.h"
+
+void common_hal_audioio_synth_construct(audioio_synth_obj_t* self, uint8_t voice_count,
+                                        uint32_t sample_rate, mp_obj_t waveform,
+                                        const int16_t* table, uint8_t table_bits,
+                                        uint32_t attack, uint32_t decay, uint16_t sustain,
+                                        uint32_t release, uint32_t buffer_size) {
+    self->first_buffer = m_malloc(buffer_size, false);
+    if (self->first_buffer == NULL) {
+        common_hal_audioio_synth_deinit(self);
+        mp_raise_msg(&mp_type_MemoryError, translate("Couldn't allocate first buffer"));
+    }
+
+    self->second_buffer = m_malloc(buffer_size, false);
+    if (self->second_buffer == NULL) {
+        common_hal_audioio_synth_deinit(self);
+        mp_raise_msg(&mp_type_MemoryError, translate("Couldn't allocate second buffer"));
+    }
+
+    self->len = buffer_size;
+    self->sample_rate = sample_rate;
+    self->waveform = waveform;
+    self->synth.table = table;
+    self->synth.table_bits = table_bits;
+    self->synth.attack = attack;
+    self->synth.decay = decay;
+    self->synth.sustain = sustain;
+    self->synth.release = release;
+    self->voice_count = voice_count;
+    for (uint8_t i = 0; i < voice_count; i++) {
+        audioio_synth_voice_clear(&self->voice[i]);
+    }
+    audioio_synth_reset_buffer(self, false, 0);
+}
+
+void common_hal_audioio_synth_deinit(audioio_synth_obj_t* self) {
+    self->first_buffer = NULL;
+    self->second_buffer = NULL;
+}
+
+bool common_hal_audioio_synth_deinited(audioio_synth_obj_t* self) {
+    return self->first_buffer == NULL;
+}
+
+uint32_t common_hal_audioio_synth_get_sample_rate(audioio_synth_obj_t* self) {
+    return self->sample_rate;
+}
+
+uint8_t common_hal_audioio_synth_get_bits_per_sample(audioio_synth_obj_t* self) {
+    return 16;
+}
+
+uint8_t common_hal_audioio_synth_get_channel_count(audioio_synth_obj_t* self) {
+    return 1;
+}
+
+bool common_hal_audioio_synth_get_playing(audioio_synth_obj_t* self) {
+    for (uint8_t i = 0; i < self->voice_count; i++) {
+        if (self->voice[i].stage != AUDIOIO_SYNTH_OFF) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void common_hal_audioio_synth_play(audioio_synth_obj_t* self, uint8_t voice, float frequency,
+                                   uint16_t level) {
+    audioio_synth_press(&self->synth, &self->voice[voice],
+                        audioio_synth_phase_step(frequency, self->sample_rate), level);
+}
+
+void common_hal_audioio_synth_stop_voice(audioio_synth_obj_t* self, uint8_t voice) {
+    audioio_synth_release(&self->synth, &self->voice[voice]);
+}
+
+void audioio_synth_reset_buffer(audioio_synth_obj_t* self,
+                                bool single_channel,
+                                uint8_t channel) {
+    if (single_channel && channel == 1) {
+        return;
+    }
+    // The voices carry on from where they are. Only the output is restarted.
+    self->read_count = 0;
+    self->left_read_count = 0;
+    self->right_read_count = 0;
+}
+
+audioio_get_buffer_result_t audioio_synth_get_buffer(audioio_synth_obj_t* self,
+                                                     bool single_channel,
+                                                     uint8_t channel,
+                                                     uint8_t** buffer,
+                                                     uint32_t* buffer_length) {
+    if (!single_channel) {
+        channel = 0;
+    }
+
+    uint32_t channel_read_count = self->left_read_count;
+    if (channel == 1) {
+        channel_read_count = self->right_read_count;
+    }
+
+    // The output is mono so both channels play the same buffer. Only render a new one once
+    // the channel that is furthest ahead asks for it.
+    if (self->read_count == channel_read_count) {
+        uint8_t* next = self->read_count % 2 == 0 ? self->first_buffer : self->second_buffer;
+        audioio_synth_render(&self->synth, self->voice, self->voice_count, (int16_t*) next,
+                             self->len / sizeof(int16_t));
+        self->read_count += 1;
+    }
+
+    *buffer = channel_read_count % 2 == 0 ? self->first_buffer : self->second_buffer;
+    *buffer_length = self->len;
+
+    if (channel == 0) {
+        self->left_read_count += 1;
+    } else if (channel == 1) {
+        self->right_read_count += 1;
+    }
+
+    // The synth plays silence while none of its voices are sounding.
+    return GET_BUFFER_MORE_DATA;
+}
+
+void audioio_synth_get_buffer_structure(audioio_synth_obj_t* self, bool single_channel,
+                                        bool* single_buffer, bool* samples_signed,
+                                        uint32_t* max_buffer_length, uint8_t* spacing) {
+    *single_buffer = false;
+    *samples_signed = true;
+    *max_buffer_length = self->len;
+    *spacing = 1;
+}
@@ -0,0 +1,65 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_SYNTH_H
+#define MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_SYNTH_H
+
+#include "py/obj.h"
+
+#include "shared-module/audioio/__init__.h"
+#include "shared-module/audioio/wavetable.h"
+
+typedef struct {
+    mp_obj_base_t base;
+    uint8_t* first_buffer;
+    uint8_t* second_buffer;
+    uint32_t len;           // Bytes in each buffer.
+    uint32_t sample_rate;
+    mp_obj_t waveform;      // Keeps the table alive. None for the built in sine.
+    audioio_synth_t synth;
+
+    uint32_t read_count;
+    uint32_t left_read_count;
+    uint32_t right_read_count;
+
+    uint8_t voice_count;
+    audioio_synth_voice_t voice[];
+} audioio_synth_obj_t;
+
+// These are not available from Python because it may be called in an interrupt.
+void audioio_synth_reset_buffer(audioio_synth_obj_t* self,
+                                bool single_channel,
+                                uint8_t channel);
+audioio_get_buffer_result_t audioio_synth_get_buffer(audioio_synth_obj_t* self,
+                                                     bool single_channel,
+                                                     uint8_t channel,
+                                                     uint8_t** buffer,
+                                                     uint32_t* buffer_length); // length in bytes
+void audioio_synth_get_buffer_structure(audioio_synth_obj_t* self, bool single_channel,
+                                        bool* single_buffer, bool* samples_signed,
+                                        uint32_t* max_buffer_length, uint8_t* spacing);
+
+#endif // MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_SYNTH_H
@@ -0,0 +1,112 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "shared-bindings/audioio/Volume.h"
+
+#include <stdint.h>
+
+#include "py/runtime.h"
+
+#include "shared-module/audioio/__init__.h"
+
+void common_hal_audioio_volume_construct(audioio_volume_obj_t* self, mp_obj_t sample,
+                                         uint16_t level, uint32_t fade_in, uint32_t buffer_size) {
+    audioio_stage_construct(&self->stage, sample, buffer_size);
+    self->sample_rate = audiosample_sample_rate(sample);
+    self->fade_in = fade_in;
+    audioio_gain_set(&self->gain, level);
+    audioio_volume_reset_buffer(self, false, 0);
+}
+
+void common_hal_audioio_volume_deinit(audioio_volume_obj_t* self) {
+    audioio_stage_deinit(&self->stage);
+}
+
+bool common_hal_audioio_volume_deinited(audioio_volume_obj_t* self) {
+    return audioio_stage_deinited(&self->stage);
+}
+
+uint32_t common_hal_audioio_volume_get_sample_rate(audioio_volume_obj_t* self) {
+    return self->sample_rate;
+}
+
+uint8_t common_hal_audioio_volume_get_bits_per_sample(audioio_volume_obj_t* self) {
+    return 16;
+}
+
+uint8_t common_hal_audioio_volume_get_channel_count(audioio_volume_obj_t* self) {
+    return self->stage.channel_count;
+}
+
+uint16_t common_hal_audioio_volume_get_level(audioio_volume_obj_t* self) {
+    return audioio_gain_target(&self->gain);
+}
+
+void common_hal_audioio_volume_set_level(audioio_volume_obj_t* self, uint16_t level) {
+    audioio_gain_set(&self->gain, level);
+}
+
+void common_hal_audioio_volume_ramp(audioio_volume_obj_t* self, uint16_t level, uint32_t frames) {
+    audioio_gain_ramp(&self->gain, level, frames);
+}
+
+void audioio_volume_reset_buffer(audioio_volume_obj_t* self,
+                                 bool single_channel,
+                                 uint8_t channel) {
+    if (!audioio_stage_reset_buffer(&self->stage, single_channel, channel)) {
+        return;
+    }
+    if (self->fade_in > 0) {
+        uint16_t level = audioio_gain_target(&self->gain);
+        audioio_gain_set(&self->gain, 0);
+        audioio_gain_ramp(&self->gain, level, self->fade_in);
+    }
+}
+
+static void apply_gain(void* context, int16_t* samples, uint32_t frames) {
+    audioio_volume_obj_t* self = context;
+    audioio_gain_apply(&self->gain, samples, frames, self->stage.channel_count);
+}
+
+audioio_get_buffer_result_t audioio_volume_get_buffer(audioio_volume_obj_t* self,
+                                                      bool single_channel,
+                                                      uint8_t channel,
+                                                      uint8_t** buffer,
+                                                      uint32_t* buffer_length) {
+    return audioio_stage_get_buffer(&self->stage, single_channel, channel, buffer, buffer_length,
+                                    apply_gain, self);
+}
+
+void audioio_volume_get_buffer_structure(audioio_volume_obj_t* self, bool single_channel,
+                                         bool* single_buffer, bool* samples_signed,
+                                         uint32_t* max_buffer_length, uint8_t* spacing) {
+    audioio_stage_get_buffer_structure(&self->stage, single_channel, single_buffer,
+                                       samples_signed, max_buffer_length, spacing);
+}
+
+void audioio_volume_prefetch(audioio_volume_obj_t* self) {
+    audioio_stage_prefetch(&self->stage);
+}
@@ -33,8 +33,12 @@
 #include "py/runtime.h"
 
 #include "shared-module/audioio/WaveFile.h"
+#include "shared-module/audioio/adpcm.h"
 #include "supervisor/shared/translate.h"
 
+#define WAVE_FORMAT_PCM (1)
+#define WAVE_FORMAT_IMA_ADPCM (0x11)
+
 struct wave_format_chunk {
     uint16_t audio_format;
     uint16_t num_channels;
@@ -42,11 +46,13 @@ struct wave_format_chunk {
     uint32_t byte_rate;
     uint16_t block_align;
     uint16_t bits_per_sample;
-    uint16_t extra_params; // Assumed to be zero below.
+    uint16_t extra_params; // Size of the extra fields. Zero for PCM.
+    uint16_t samples_per_block; // IMA ADPCM only.
 };
 
 void common_hal_audioio_wavefile_construct(audioio_wavefile_obj_t* self,
-                                           pyb_file_obj_t* file) {
+                                           pyb_file_obj_t* file,
+                                           uint32_t buffer_size) {
     // Load the wave
     self->file = file;
     uint8_t chunk_header[16];
@@ -75,93 +81,264 @@ void common_hal_audioio_wavefile_construct(audioio_wavefile_obj_t* self,
     if (bytes_read != format_size) {
     }
 
-    if (format.audio_format != 1 ||
+    self->adpcm_block_align = 0;
+    if (format.audio_format == WAVE_FORMAT_IMA_ADPCM) {
+        // Decoded to 16 bit samples as each buffer is loaded.
+        if (format_size != 20 ||
+            format.extra_params != 2 ||
+            format.bits_per_sample != 4 ||
+            format.num_channels > 2 ||
+            format.samples_per_block == 0 ||
+            format.samples_per_block != audioio_adpcm_samples_per_block(format.block_align,
+                                                                        format.num_channels)) {
+            mp_raise_ValueError(translate("Unsupported format"));
+        }
+        self->adpcm_block_align = format.block_align;
+        self->bits_per_sample = 16;
+    } else if (format.audio_format != WAVE_FORMAT_PCM ||
         format.num_channels > 2 ||
         format.bits_per_sample > 16 ||
+        format_size > 18 ||
         (format_size == 18 &&
          format.extra_params != 0)) {
         mp_raise_ValueError(translate("Unsupported format"));
+    } else {
+        self->bits_per_sample = format.bits_per_sample;
     }
     // Get the sample_rate
     self->sample_rate = format.sample_rate;
-    self->len = 256;
+    // Whole sectors per buffer so that, once loads are sector aligned, f_read
+    // transfers straight from the block device into the buffer.
+    self->len = buffer_size;
     self->channel_count = format.num_channels;
-    self->bits_per_sample = format.bits_per_sample;
-
-    // TODO(tannewt): Skip any extra chunks that occur before the data section.
-
-    uint8_t data_tag[4];
-    if (f_read(&self->file->fp, &data_tag, 4, &bytes_read) != FR_OK) {
-        mp_raise_OSError(MP_EIO);
-    }
-    if (bytes_read != 4 ||
-        memcmp((uint8_t *) data_tag, "data", 4) != 0) {
-        mp_raise_ValueError(translate("Data chunk must follow fmt chunk"));
+    uint32_t adpcm_buffer_size = 0;
+    if (self->adpcm_block_align != 0) {
+        // Whole blocks are decoded into each buffer so round down, to at least one block.
+        uint32_t decoded_block_size = format.samples_per_block * self->channel_count * 2;
+        uint32_t blocks_per_buffer = self->len / decoded_block_size;
+        if (blocks_per_buffer == 0) {
+            blocks_per_buffer = 1;
+        }
+        self->len = blocks_per_buffer * decoded_block_size;
+        adpcm_buffer_size = blocks_per_buffer * self->adpcm_block_align;
     }
 
+    // Skip any chunks, such as the fact chunk ADPCM files have, before the data.
+    uint8_t chunk_tag[4];
     uint32_t data_length;
-    if (f_read(&self->file->fp, &data_length, 4, &bytes_read) != FR_OK) {
-        mp_raise_OSError(MP_EIO);
-    }
-    if (bytes_read != 4) {
-        mp_raise_ValueError(translate("Invalid file"));
+    while (true) {
+        if (f_read(&self->file->fp, &chunk_tag, 4, &bytes_read) != FR_OK) {
+            mp_raise_OSError(MP_EIO);
+        }
+        if (bytes_read != 4) {
+            mp_raise_ValueError(translate("Data chunk must follow fmt chunk"));
+        }
+        if (f_read(&self->file->fp, &data_length, 4, &bytes_read) != FR_OK) {
+            mp_raise_OSError(MP_EIO);
+        }
+        if (bytes_read != 4) {
+            mp_raise_ValueError(translate("Invalid file"));
+        }
+        if (memcmp((uint8_t *) chunk_tag, "data", 4) == 0) {
+            break;
+        }
+        // Chunks are padded to an even length.
+        if (f_lseek(&self->file->fp, self->file->fp.fptr + data_length + (data_length & 1)) != FR_OK) {
+            mp_raise_OSError(MP_EIO);
+        }
     }
     self->file_length = data_length;
     self->data_start = self->file->fp.fptr;
 
-    // Try to allocate two buffers, one will be loaded from file and the other
-    // DMAed to DAC.
-    self->buffer = m_malloc(self->len, false);
-    if (self->buffer == NULL) {
-        common_hal_audioio_wavefile_deinit(self);
-        mp_raise_msg(&mp_type_MemoryError, translate("Couldn't allocate first buffer"));
+    // Try to allocate the buffers. One is loaded from file in the background
+    // while the other two are DMAed to the DAC.
+    for (uint8_t i = 0; i < AUDIOIO_WAVEFILE_BUFFER_COUNT; i++) {
+        self->buffers[i] = NULL;
     }
-
-    self->second_buffer = m_malloc(self->len, false);
-    if (self->second_buffer == NULL) {
-        common_hal_audioio_wavefile_deinit(self);
-        mp_raise_msg(&mp_type_MemoryError, translate("Couldn't allocate second buffer"));
+    for (uint8_t i = 0; i < AUDIOIO_WAVEFILE_BUFFER_COUNT; i++) {
+        self->buffers[i] = m_malloc(self->len, false);
+        if (self->buffers[i] == NULL) {
+            common_hal_audioio_wavefile_deinit(self);
+            if (i == 0) {
+                mp_raise_msg(&mp_type_MemoryError, translate("Couldn't allocate first buffer"));
+            } else if (i == 1) {
+                mp_raise_msg(&mp_type_MemoryError, translate("Couldn't allocate second buffer"));
+            }
+            mp_raise_msg(&mp_type_MemoryError, translate("Couldn't allocate prefetch buffer"));
+        }
+    }
+    self->adpcm_buffer = NULL;
+    if (adpcm_buffer_size != 0) {
+        self->adpcm_buffer = m_malloc(adpcm_buffer_size, false);
+        if (self->adpcm_buffer == NULL) {
+            common_hal_audioio_wavefile_deinit(self);
+            mp_raise_msg(&mp_type_MemoryError, translate("Couldn't allocate decoding buffer"));
+        }
+    }
+    for (uint8_t i = 0; i < 2; i++) {
+        self->left_buffers[i] = AUDIOIO_WAVEFILE_BUFFER_COUNT;
+        self->right_buffers[i] = AUDIOIO_WAVEFILE_BUFFER_COUNT;
     }
+    self->next_buffer = 0;
+    self->prefetched = false;
+    self->underruns = 0;
+    self->bytes_remaining = self->file_length;
+    self->read_count = 0;
+    self->left_read_count = 0;
+    self->right_read_count = 0;
+    self->restart_read_count = 0;
 }
 
 void common_hal_audioio_wavefile_deinit(audioio_wavefile_obj_t* self) {
-    self->buffer = NULL;
+    self->buffers[0] = NULL;
 }
 
 bool common_hal_audioio_wavefile_deinited(audioio_wavefile_obj_t* self) {
-    return self->buffer == NULL;
+    return self->buffers[0] == NULL;
 }
 
 uint32_t common_hal_audioio_wavefile_get_sample_rate(audioio_wavefile_obj_t* self) {
     return self->sample_rate;
 }
 
+uint8_t common_hal_audioio_wavefile_get_bits_per_sample(audioio_wavefile_obj_t* self) {
+    return self->bits_per_sample;
+}
+
+uint8_t common_hal_audioio_wavefile_get_channel_count(audioio_wavefile_obj_t* self) {
+    return self->channel_count;
+}
+
 void common_hal_audioio_wavefile_set_sample_rate(audioio_wavefile_obj_t* self,
                                                  uint32_t sample_rate) {
     self->sample_rate = sample_rate;
 }
 
+uint32_t common_hal_audioio_wavefile_get_underruns(audioio_wavefile_obj_t* self) {
+    return self->underruns;
+}
+
 bool audioio_wavefile_samples_signed(audioio_wavefile_obj_t* self) {
     return self->bits_per_sample > 8;
 }
 
 uint32_t audioio_wavefile_max_buffer_length(audioio_wavefile_obj_t* self) {
-    return 512;
+    return self->len;
 }
 
 void audioio_wavefile_reset_buffer(audioio_wavefile_obj_t* self,
                                    bool single_channel,
                                    uint8_t channel) {
-    if (single_channel && channel == 1) {
+    if (!single_channel) {
+        channel = 0;
+    }
+    uint32_t* channel_read_count = &self->left_read_count;
+    if (channel == 1) {
+        channel_read_count = &self->right_read_count;
+    }
+    // Restart loading from the start unless another channel already did since this one last
+    // read. The read counts carry on across restarts so that a channel that is behind still
+    // gets the end of the data before the start. We also don't reset the buffer index because
+    // the buffers loaded before the restart may still be playing.
+    if (*channel_read_count > self->restart_read_count) {
+        self->bytes_remaining = self->file_length;
+        self->restart_read_count = self->read_count;
+    }
+    // Skip anything left over from an earlier play.
+    *channel_read_count = self->restart_read_count;
+}
+
+// Reads and decodes whole ADPCM blocks into the next buffer.
+static bool load_next_adpcm_buffer(audioio_wavefile_obj_t* self, uint32_t position) {
+    uint32_t block_align = self->adpcm_block_align;
+    uint32_t decoded_block_size = audioio_adpcm_samples_per_block(block_align, self->channel_count) *
+                                  self->channel_count * 2;
+    uint32_t num_bytes_to_load = self->len / decoded_block_size * block_align;
+    uint32_t data_end = self->data_start + self->file_length;
+    if (num_bytes_to_load > data_end - position) {
+        num_bytes_to_load = data_end - position;
+    }
+    if (self->file->fp.fptr != position && f_lseek(&self->file->fp, position) != FR_OK) {
+        return false;
+    }
+    UINT length_read;
+    if (f_read(&self->file->fp, self->adpcm_buffer, num_bytes_to_load, &length_read) != FR_OK) {
+        return false;
+    }
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wcast-align"
+    int16_t* out = (int16_t*) self->buffers[self->next_buffer];
+    #pragma GCC diagnostic pop
+    uint32_t sample_count = 0;
+    for (uint32_t offset = 0; offset < length_read; offset += block_align) {
+        uint32_t block_length = length_read - offset;
+        if (block_length > block_align) {
+            block_length = block_align;
+        }
+        sample_count += audioio_adpcm_decode_block(self->adpcm_buffer + offset, block_length,
+                                                   self->channel_count,
+                                                   out + sample_count * self->channel_count);
+    }
+    if (sample_count == 0) {
+        return false;
+    }
+    self->buffer_lengths[self->next_buffer] = sample_count * self->channel_count * 2;
+    self->next_buffer_file_length = length_read;
+    return true;
+}
+
+// Loads the data that starts at position into the next buffer.
+static bool load_next_buffer(audioio_wavefile_obj_t* self, uint32_t position) {
+    if (self->adpcm_block_align != 0) {
+        return load_next_adpcm_buffer(self, position);
+    }
+    uint32_t num_bytes_to_load = self->len;
+    // Shorten a load that starts mid-sector (the first one after the
+    // header) so that the following ones start on a sector boundary.
+    // Only do it when it keeps whole frames in the buffer.
+    uint32_t sector_offset = position % 512;
+    uint32_t frame_size = self->channel_count * self->bits_per_sample / 8;
+    if (sector_offset != 0 && frame_size != 0 && (self->len - sector_offset) % frame_size == 0) {
+        num_bytes_to_load = self->len - sector_offset;
+    }
+    uint32_t data_end = self->data_start + self->file_length;
+    if (num_bytes_to_load > data_end - position) {
+        num_bytes_to_load = data_end - position;
+    }
+    if (self->file->fp.fptr != position && f_lseek(&self->file->fp, position) != FR_OK) {
+        return false;
+    }
+    UINT length_read;
+    if (f_read(&self->file->fp, self->buffers[self->next_buffer], num_bytes_to_load,
+               &length_read) != FR_OK || length_read == 0) {
+        return false;
+    }
+    self->buffer_lengths[self->next_buffer] = length_read;
+    self->next_buffer_file_length = length_read;
+    return true;
+}
+
+static bool buffer_in_use(audioio_wavefile_obj_t* self, uint8_t index) {
+    return self->left_buffers[0] == index || self->left_buffers[1] == index ||
+           self->right_buffers[0] == index || self->right_buffers[1] == index;
+}
+
+// Loads the next buffer ahead of time so that the refill only has to hand it
+// over. Once all of the data is loaded the start is loaded in case the sample
+// loops.
+void audioio_wavefile_prefetch(audioio_wavefile_obj_t* self) {
+    if (common_hal_audioio_wavefile_deinited(self) || self->prefetched ||
+        self->file_length == 0 || buffer_in_use(self, self->next_buffer)) {
         return;
     }
-    // We don't reset the buffer index in case we're looping and we have an odd number of buffer
-    // loads
-    self->bytes_remaining = self->file_length;
-    f_lseek(&self->file->fp, self->data_start);
-    self->read_count = 0;
-    self->left_read_count = 0;
-    self->right_read_count = 0;
+    uint32_t position = self->data_start + self->file_length - self->bytes_remaining;
+    if (self->bytes_remaining == 0) {
+        position = self->data_start;
+    }
+    if (load_next_buffer(self, position)) {
+        self->prefetch_position = position;
+        self->prefetched = true;
+    }
 }
 
 audioio_get_buffer_result_t audioio_wavefile_get_buffer(audioio_wavefile_obj_t* self,
@@ -187,43 +364,38 @@ audioio_get_buffer_result_t audioio_wavefile_get_buffer(audioio_wavefile_obj_t*
     }
 
     if (need_more_data) {
-        uint16_t num_bytes_to_load = self->len;
-        if (num_bytes_to_load > self->bytes_remaining) {
-            num_bytes_to_load = self->bytes_remaining;
-        }
-        UINT length_read;
-        if (self->buffer_index % 2 == 1) {
-            *buffer = self->second_buffer;
-        } else {
-            *buffer = self->buffer;
+        uint32_t position = self->data_start + self->file_length - self->bytes_remaining;
+        if (!self->prefetched || self->prefetch_position != position) {
+            // The first two loads after a restart may be taken before
+            // playback starts. Later ones should have been prefetched.
+            if (self->read_count - self->restart_read_count >= 2) {
+                self->underruns += 1;
+            }
+            self->prefetched = false;
+            if (!load_next_buffer(self, position)) {
+                return GET_BUFFER_ERROR;
+            }
         }
-        if (f_read(&self->file->fp, *buffer, num_bytes_to_load, &length_read) != FR_OK) {
-            return GET_BUFFER_ERROR;
-        }
-        *buffer_length = length_read;
-        if (self->buffer_index % 2 == 1) {
-            self->second_buffer_length = length_read;
-        } else {
-            self->buffer_length = length_read;
-        }
-        self->bytes_remaining -= length_read;
-        self->buffer_index += 1;
+        self->prefetched = false;
+        self->bytes_remaining -= self->next_buffer_file_length;
+        self->next_buffer = (self->next_buffer + 1) % AUDIOIO_WAVEFILE_BUFFER_COUNT;
         self->read_count += 1;
     }
 
     uint32_t buffers_back = self->read_count - 1 - channel_read_count;
-    if ((self->buffer_index - buffers_back) % 2 == 0) {
-        *buffer = self->second_buffer;
-        *buffer_length = self->second_buffer_length;
-    } else {
-        *buffer = self->buffer;
-        *buffer_length = self->buffer_length;
-    }
+    uint8_t index = (self->next_buffer + 2 * AUDIOIO_WAVEFILE_BUFFER_COUNT - 1 - buffers_back) %
+                    AUDIOIO_WAVEFILE_BUFFER_COUNT;
+    *buffer = self->buffers[index];
+    *buffer_length = self->buffer_lengths[index];
 
     if (channel == 0) {
         self->left_read_count += 1;
+        self->left_buffers[0] = self->left_buffers[1];
+        self->left_buffers[1] = index;
     } else if (channel == 1) {
         self->right_read_count += 1;
+        self->right_buffers[0] = self->right_buffers[1];
+        self->right_buffers[1] = index;
         *buffer = *buffer + self->bits_per_sample / 8;
     }
 
@@ -235,7 +407,7 @@ void audioio_wavefile_get_buffer_structure(audioio_wavefile_obj_t* self, bool si
                                            uint32_t* max_buffer_length, uint8_t* spacing) {
     *single_buffer = false;
     *samples_signed = self->bits_per_sample > 8;
-    *max_buffer_length = 512;
+    *max_buffer_length = self->len;
     if (single_channel) {
         *spacing = self->channel_count;
     } else {
@@ -31,16 +31,24 @@
 
 #include "shared-module/audioio/__init__.h"
 
+// One buffer is loaded ahead in the background while up to two more are
+// queued for DMA.
+#define AUDIOIO_WAVEFILE_BUFFER_COUNT (3)
+
 typedef struct {
     mp_obj_base_t base;
-    uint8_t* buffer;
-    uint32_t buffer_length;
-    uint8_t* second_buffer;
-    uint32_t second_buffer_length;
+    uint8_t* buffers[AUDIOIO_WAVEFILE_BUFFER_COUNT];
+    uint32_t buffer_lengths[AUDIOIO_WAVEFILE_BUFFER_COUNT];
     uint32_t file_length; // In bytes
-    uint16_t data_start; // Where the data values start
+    uint32_t data_start; // Where the data values start
     uint8_t bits_per_sample;
-    uint16_t buffer_index;
+    uint8_t next_buffer; // Index of the buffer the next load goes into
+    // The last two buffers handed to each channel. They may still be in use.
+    uint8_t left_buffers[2];
+    uint8_t right_buffers[2];
+    bool prefetched; // next_buffer holds the load that starts at prefetch_position
+    uint32_t prefetch_position;
+    uint32_t next_buffer_file_length; // File bytes loaded into next_buffer
     uint32_t bytes_remaining;
 
     uint8_t channel_count;
@@ -52,6 +60,12 @@ typedef struct {
     uint32_t read_count;
     uint32_t left_read_count;
     uint32_t right_read_count;
+    uint32_t restart_read_count; // read_count when loading last restarted from the start
+
+    uint32_t underruns; // Loads that had to be read at refill time
+
+    uint16_t adpcm_block_align; // Zero unless the file is IMA ADPCM
+    uint8_t* adpcm_buffer; // Compressed blocks read before they are decoded
 } audioio_wavefile_obj_t;
 
 // These are not available from Python because it may be called in an interrupt.
@@ -66,5 +80,8 @@ audioio_get_buffer_result_t audioio_wavefile_get_buffer(audioio_wavefile_obj_t*
 void audioio_wavefile_get_buffer_structure(audioio_wavefile_obj_t* self, bool single_channel,
                                            bool* single_buffer, bool* samples_signed,
                                            uint32_t* max_buffer_length, uint8_t* spacing);
+void audioio_wavefile_prefetch(audioio_wavefile_obj_t* self);
+bool audioio_wavefile_samples_signed(audioio_wavefile_obj_t* self);
+uint32_t audioio_wavefile_max_buffer_length(audioio_wavefile_obj_t* self);
 
 #endif // MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_WAVEFILE_H
@@ -0,0 +1,99 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "shared-module/audioio/__init__.h"
+
+#include <string.h>
+
+#include "py/objtype.h"
+#include "py/runtime.h"
+#include "shared-bindings/audioio/__init__.h"
+#include "supervisor/shared/translate.h"
+
+const uint8_t audiosample_protocol_id;
+
+// Samples that passed audiosample_check are always objects so skip mp_obj_get_type.
+static inline const audiosample_p_t* audiosample_protocol(mp_obj_t sample_obj) {
+    return ((mp_obj_base_t*) MP_OBJ_TO_PTR(sample_obj))->type->protocol;
+}
+
+mp_obj_t audiosample_check(mp_obj_t sample_obj) {
+    mp_obj_type_t* type = mp_obj_get_type(sample_obj);
+    // Python subclasses inherit their native base's protocol but keep its object separately.
+    if (type->protocol != NULL && mp_obj_is_instance_type(type)) {
+        mp_obj_instance_t* instance = MP_OBJ_TO_PTR(sample_obj);
+        sample_obj = instance->subobj[0];
+        type = mp_obj_get_type(sample_obj);
+    }
+    // Every protocol starts with a pointer so this reads within any of them.
+    const void* id = NULL;
+    if (type->protocol != NULL) {
+        memcpy(&id, type->protocol, sizeof(id));
+    }
+    if (id != &audiosample_protocol_id) {
+        mp_raise_TypeError(translate("sample must be an audio sample"));
+    }
+    return sample_obj;
+}
+
+uint32_t audiosample_sample_rate(mp_obj_t sample_obj) {
+    return audiosample_protocol(sample_obj)->sample_rate(sample_obj);
+}
+
+uint8_t audiosample_bits_per_sample(mp_obj_t sample_obj) {
+    return audiosample_protocol(sample_obj)->bits_per_sample(sample_obj);
+}
+
+uint8_t audiosample_channel_count(mp_obj_t sample_obj) {
+    return audiosample_protocol(sample_obj)->channel_count(sample_obj);
+}
+
+void audiosample_reset_buffer(mp_obj_t sample_obj, bool single_channel, uint8_t audio_channel) {
+    audiosample_protocol(sample_obj)->reset_buffer(sample_obj, single_channel, audio_channel);
+}
+
+audioio_get_buffer_result_t audiosample_get_buffer(mp_obj_t sample_obj,
+                                                   bool single_channel,
+                                                   uint8_t channel,
+                                                   uint8_t** buffer, uint32_t* buffer_length) {
+    return audiosample_protocol(sample_obj)->get_buffer(sample_obj, single_channel, channel,
+                                                         buffer, buffer_length);
+}
+
+void audiosample_get_buffer_structure(mp_obj_t sample_obj, bool single_channel,
+                                      bool* single_buffer, bool* samples_signed,
+                                      uint32_t* max_buffer_length, uint8_t* spacing) {
+    audiosample_protocol(sample_obj)->get_buffer_structure(sample_obj, single_channel,
+                                                           single_buffer, samples_signed,
+                                                           max_buffer_length, spacing);
+}
+
+void audiosample_prefetch(mp_obj_t sample_obj) {
+    audiosample_prefetch_fun prefetch = audiosample_protocol(sample_obj)->prefetch;
+    if (prefetch != NULL) {
+        prefetch(sample_obj);
+    }
+}
@@ -27,10 +27,33 @@
 #ifndef MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO__INIT__H
 #define MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO__INIT__H
 
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "py/obj.h"
+
 typedef enum {
     GET_BUFFER_DONE,            // No more data to read
     GET_BUFFER_MORE_DATA,       // More data to read.
     GET_BUFFER_ERROR,           // Error while reading data.
 } audioio_get_buffer_result_t;
 
+// Call through sample_obj's audio sample protocol (see shared-bindings/audioio/__init__.h).
+// sample_obj must have passed audiosample_check. These are used by the ports to feed their
+// output and by samples, such as Mixer, that read from other samples. None of them are
+// available from Python because they may be called in an interrupt.
+uint32_t audiosample_sample_rate(mp_obj_t sample_obj);
+uint8_t audiosample_bits_per_sample(mp_obj_t sample_obj);
+uint8_t audiosample_channel_count(mp_obj_t sample_obj);
+void audiosample_reset_buffer(mp_obj_t sample_obj, bool single_channel, uint8_t audio_channel);
+audioio_get_buffer_result_t audiosample_get_buffer(mp_obj_t sample_obj,
+                                                   bool single_channel,
+                                                   uint8_t channel,
+                                                   uint8_t** buffer, uint32_t* buffer_length);
+void audiosample_get_buffer_structure(mp_obj_t sample_obj, bool single_channel,
+                                      bool* single_buffer, bool* samples_signed,
+                                      uint32_t* max_buffer_length, uint8_t* spacing);
+// Does slow work, such as file reads, ahead of the next get_buffer. Called from background tasks.
+void audiosample_prefetch(mp_obj_t sample_obj);
+
 #endif  // MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO__INIT__H
@@ -0,0 +1,136 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "shared-module/audioio/adpcm.h"
+
+#include <stdbool.h>
+
+static const int8_t index_table[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+static const int16_t step_table[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+typedef struct {
+    int32_t predictor;
+    int32_t index;
+} adpcm_state_t;
+
+static inline int16_t decode_nibble(adpcm_state_t* state, uint8_t nibble) {
+    int32_t step = step_table[state->index];
+    int32_t diff = step >> 3;
+    if ((nibble & 4) != 0) {
+        diff += step;
+    }
+    if ((nibble & 2) != 0) {
+        diff += step >> 1;
+    }
+    if ((nibble & 1) != 0) {
+        diff += step >> 2;
+    }
+    int32_t predictor = state->predictor;
+    if ((nibble & 8) != 0) {
+        predictor -= diff;
+        if (predictor < INT16_MIN) {
+            predictor = INT16_MIN;
+        }
+    } else {
+        predictor += diff;
+        if (predictor > INT16_MAX) {
+            predictor = INT16_MAX;
+        }
+    }
+    state->predictor = predictor;
+
+    int32_t index = state->index + index_table[nibble];
+    if (index < 0) {
+        index = 0;
+    } else if (index > 88) {
+        index = 88;
+    }
+    state->index = index;
+    return predictor;
+}
+
+uint32_t audioio_adpcm_samples_per_block(uint32_t block_align, uint8_t channel_count) {
+    uint32_t header_length = 4 * channel_count;
+    if (channel_count == 0 || block_align <= header_length ||
+        (block_align - header_length) % header_length != 0) {
+        return 0;
+    }
+    // The header holds the first sample and every byte after it two more.
+    return 1 + (block_align - header_length) * 2 / channel_count;
+}
+
+uint32_t audioio_adpcm_decode_block(const uint8_t* block, uint32_t block_length,
+                                    uint8_t channel_count, int16_t* out) {
+    uint32_t header_length = 4 * channel_count;
+    // Wave files have at most two channels.
+    if (channel_count == 0 || channel_count > 2 || block_length < header_length) {
+        return 0;
+    }
+    adpcm_state_t state[2];
+    for (uint8_t c = 0; c < channel_count; c++) {
+        const uint8_t* header = block + 4 * c;
+        state[c].predictor = (int16_t) (header[0] | (header[1] << 8));
+        state[c].index = header[2];
+        if (state[c].index > 88) {
+            state[c].index = 88;
+        }
+        out[c] = state[c].predictor;
+    }
+
+    // Each channel has four bytes, eight samples, at a time. The low nibble
+    // of each byte comes first.
+    uint32_t group_count = (block_length - header_length) / header_length;
+    const uint8_t* in = block + header_length;
+    int16_t* group_out = out + channel_count;
+    for (uint32_t g = 0; g < group_count; g++) {
+        for (uint8_t c = 0; c < channel_count; c++) {
+            int16_t* sample_out = group_out + c;
+            for (uint8_t i = 0; i < 4; i++) {
+                uint8_t b = *in++;
+                *sample_out = decode_nibble(&state[c], b & 0xf);
+                sample_out += channel_count;
+                *sample_out = decode_nibble(&state[c], b >> 4);
+                sample_out += channel_count;
+            }
+        }
+        group_out += 8 * channel_count;
+    }
+    return 1 + group_count * 8;
+}
@@ -0,0 +1,45 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_ADPCM_H
+#define MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_ADPCM_H
+
+#include <stdint.h>
+
+// IMA ADPCM blocks as stored in WAV files (format 0x11). Each block starts with
+// a four byte header per channel and then holds four bytes of samples per
+// channel at a time.
+
+// The number of samples per channel in a block of block_align bytes. Zero if
+// the size isn't valid.
+uint32_t audioio_adpcm_samples_per_block(uint32_t block_align, uint8_t channel_count);
+
+// Decodes the block into interleaved 16 bit samples and returns the number of
+// samples per channel. A short final block decodes as many samples as it holds.
+uint32_t audioio_adpcm_decode_block(const uint8_t* block, uint32_t block_length,
+                                    uint8_t channel_count, int16_t* out);
+
+#endif // MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_ADPCM_H
@@ -0,0 +1,113 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "shared-module/audioio/convert.h"
+
+#include <stdbool.h>
+
+// The sign bits are flipped a word at a time. Words are only ever loaded and
+// stored aligned because Cortex-M0 faults on unaligned accesses. Gathered
+// words assume a little endian CPU, as all of our ports are.
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wcast-align"
+
+static inline bool aligned(const void* p) {
+    return ((uintptr_t) p & 3) == 0;
+}
+
+void audioio_convert_signed_8(uint8_t* out, const uint8_t* in, uint32_t count, uint8_t spacing) {
+    // Bytes up to the first whole output word.
+    while (count > 0 && !aligned(out)) {
+        *out++ = *in ^ 0x80;
+        in += spacing;
+        count--;
+    }
+    uint32_t* out_words = (uint32_t*) out;
+    uint32_t words = count / 4;
+    const uint8_t* tail = in + words * 4 * spacing;
+    if (spacing == 1 && aligned(in)) {
+        const uint32_t* in_words = (const uint32_t*) in;
+        for (uint32_t i = 0; i < words; i++) {
+            out_words[i] = in_words[i] ^ 0x80808080;
+        }
+    } else if (spacing == 2 && aligned(in)) {
+        // Keep bytes 0 and 2 of each pair of words.
+        const uint32_t* in_words = (const uint32_t*) in;
+        for (uint32_t i = 0; i < words; i++) {
+            uint32_t low = in_words[2 * i] & 0x00ff00ff;
+            uint32_t high = in_words[2 * i + 1] & 0x00ff00ff;
+            low = (low | (low >> 8)) & 0xffff;
+            high = (high | (high >> 8)) << 16;
+            out_words[i] = (low | high) ^ 0x80808080;
+        }
+    } else {
+        for (uint32_t i = 0; i < words; i++) {
+            out_words[i] = (in[0] | (in[spacing] << 8) | (in[2 * spacing] << 16) |
+                            ((uint32_t) in[3 * spacing] << 24)) ^ 0x80808080;
+            in += 4 * spacing;
+        }
+    }
+    out += words * 4;
+    for (uint32_t i = 0; i < count % 4; i++) {
+        out[i] = tail[i * spacing] ^ 0x80;
+    }
+}
+
+void audioio_convert_signed_16(uint16_t* out, const uint16_t* in, uint32_t count,
+                               uint8_t spacing) {
+    if (count > 0 && !aligned(out)) {
+        *out++ = *in ^ 0x8000;
+        in += spacing;
+        count--;
+    }
+    uint32_t* out_words = (uint32_t*) out;
+    uint32_t words = count / 2;
+    const uint16_t* tail = in + words * 2 * spacing;
+    if (spacing == 1 && aligned(in)) {
+        const uint32_t* in_words = (const uint32_t*) in;
+        for (uint32_t i = 0; i < words; i++) {
+            out_words[i] = in_words[i] ^ 0x80008000;
+        }
+    } else if (spacing == 2 && aligned(in)) {
+        // Keep the low half of each pair of words.
+        const uint32_t* in_words = (const uint32_t*) in;
+        for (uint32_t i = 0; i < words; i++) {
+            out_words[i] = ((in_words[2 * i] & 0xffff) | (in_words[2 * i + 1] << 16)) ^
+                           0x80008000;
+        }
+    } else {
+        for (uint32_t i = 0; i < words; i++) {
+            out_words[i] = (in[0] | ((uint32_t) in[spacing] << 16)) ^ 0x80008000;
+            in += 2 * spacing;
+        }
+    }
+    if (count % 2 != 0) {
+        out[words * 2] = *tail ^ 0x8000;
+    }
+}
+
+#pragma GCC diagnostic pop
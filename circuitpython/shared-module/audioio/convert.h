@@ -0,0 +1,42 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_CONVERT_H
+#define MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_CONVERT_H
+
+#include <stdint.h>
+
+// Converts samples between signed and unsigned. Both directions flip the top
+// bit so one function per width does either. Every spacing'th sample is taken
+// from in, which picks one channel out of interleaved samples, and count
+// samples are written to out. When in is word aligned it is read a word at a
+// time so it must hold count * spacing samples. in and out must not overlap
+// unless they are the same and spacing is 1.
+void audioio_convert_signed_8(uint8_t* out, const uint8_t* in, uint32_t count, uint8_t spacing);
+void audioio_convert_signed_16(uint16_t* out, const uint16_t* in, uint32_t count,
+                               uint8_t spacing);
+
+#endif // MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_CONVERT_H
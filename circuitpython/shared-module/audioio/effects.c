@@ -0,0 +1,191 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "shared-module/audioio/effects.h"
+
+#include <math.h>
+#include <string.h>
+
+#define GAIN_FRACTION_BITS (15)
+// Extra bits kept by the DC blocker so its leak can be small.
+#define DC_BLOCK_FRACTION_BITS (8)
+
+void audioio_gain_set(audioio_gain_t* gain, uint16_t level) {
+    gain->level = (int32_t) level << GAIN_FRACTION_BITS;
+    gain->target = gain->level;
+    gain->step = 0;
+    gain->remaining = 0;
+}
+
+void audioio_gain_ramp(audioio_gain_t* gain, uint16_t level, uint32_t frames) {
+    if (frames == 0) {
+        audioio_gain_set(gain, level);
+        return;
+    }
+    gain->target = (int32_t) level << GAIN_FRACTION_BITS;
+    gain->step = (gain->target - gain->level) / (int32_t) frames;
+    gain->remaining = frames;
+}
+
+uint16_t audioio_gain_target(const audioio_gain_t* gain) {
+    return gain->target >> GAIN_FRACTION_BITS;
+}
+
+void audioio_gain_apply(audioio_gain_t* gain, int16_t* samples, uint32_t frames,
+                        uint8_t channel_count) {
+    // Ramps change the gain every frame.
+    while (gain->remaining > 0 && frames > 0) {
+        gain->remaining--;
+        gain->level += gain->step;
+        if (gain->remaining == 0) {
+            // Don't let the rounding of step leave us short of the target.
+            gain->level = gain->target;
+        }
+        int32_t level = gain->level >> GAIN_FRACTION_BITS;
+        for (uint8_t channel = 0; channel < channel_count; channel++) {
+            samples[channel] = (samples[channel] * level) >> 15;
+        }
+        samples += channel_count;
+        frames--;
+    }
+    int32_t level = gain->level >> GAIN_FRACTION_BITS;
+    if (frames == 0 || level == AUDIOIO_GAIN_UNITY) {
+        return;
+    }
+    uint32_t count = frames * channel_count;
+    for (uint32_t i = 0; i < count; i++) {
+        samples[i] = (samples[i] * level) >> 15;
+    }
+}
+
+static int32_t to_coefficient(float value) {
+    return (int32_t) roundf(value * (1 << AUDIOIO_BIQUAD_SHIFT));
+}
+
+// Sets the coefficients from the cookbook's b0, b1, b2, a0, a1 and a2.
+static void set_biquad(audioio_biquad_t* biquad, float b0, float b1, float b2, float a0, float a1,
+                       float a2) {
+    biquad->b0 = to_coefficient(b0 / a0);
+    biquad->b1 = to_coefficient(b1 / a0);
+    biquad->b2 = to_coefficient(b2 / a0);
+    biquad->a1 = to_coefficient(a1 / a0);
+    biquad->a2 = to_coefficient(a2 / a0);
+}
+
+void audioio_biquad_low_pass(audioio_biquad_t* biquad, uint32_t sample_rate, float frequency,
+                             float q) {
+    float w0 = 2.0f * (float) M_PI * frequency / sample_rate;
+    float cos_w0 = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * q);
+    set_biquad(biquad, (1.0f - cos_w0) / 2.0f, 1.0f - cos_w0, (1.0f - cos_w0) / 2.0f,
+               1.0f + alpha, -2.0f * cos_w0, 1.0f - alpha);
+}
+
+void audioio_biquad_high_pass(audioio_biquad_t* biquad, uint32_t sample_rate, float frequency,
+                              float q) {
+    float w0 = 2.0f * (float) M_PI * frequency / sample_rate;
+    float cos_w0 = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * q);
+    set_biquad(biquad, (1.0f + cos_w0) / 2.0f, -(1.0f + cos_w0), (1.0f + cos_w0) / 2.0f,
+               1.0f + alpha, -2.0f * cos_w0, 1.0f - alpha);
+}
+
+void audioio_biquad_clear(audioio_biquad_t* biquad) {
+    memset(biquad->x1, 0, sizeof(biquad->x1));
+    memset(biquad->x2, 0, sizeof(biquad->x2));
+    memset(biquad->y1, 0, sizeof(biquad->y1));
+    memset(biquad->y2, 0, sizeof(biquad->y2));
+    memset(biquad->error, 0, sizeof(biquad->error));
+}
+
+void audioio_biquad_apply(audioio_biquad_t* biquad, int16_t* samples, uint32_t frames,
+                          uint8_t channel_count) {
+    for (uint8_t channel = 0; channel < channel_count; channel++) {
+        // Keep the history in locals so the loop doesn't go back to memory for it.
+        int32_t x1 = biquad->x1[channel];
+        int32_t x2 = biquad->x2[channel];
+        int32_t y1 = biquad->y1[channel];
+        int32_t y2 = biquad->y2[channel];
+        int64_t error = biquad->error[channel];
+        int16_t* sample = samples + channel;
+        for (uint32_t i = 0; i < frames; i++) {
+            int32_t x0 = *sample;
+            int64_t acc = error +
+                (int64_t) biquad->b0 * x0 + (int64_t) biquad->b1 * x1 +
+                (int64_t) biquad->b2 * x2 - (int64_t) biquad->a1 * y1 -
+                (int64_t) biquad->a2 * y2;
+            int64_t y0 = acc >> AUDIOIO_BIQUAD_SHIFT;
+            error = acc - y0 * (1 << AUDIOIO_BIQUAD_SHIFT);
+            if (y0 > INT16_MAX) {
+                y0 = INT16_MAX;
+            } else if (y0 < INT16_MIN) {
+                y0 = INT16_MIN;
+            }
+            *sample = y0;
+            x2 = x1;
+            x1 = x0;
+            y2 = y1;
+            y1 = y0;
+            sample += channel_count;
+        }
+        biquad->x1[channel] = x1;
+        biquad->x2[channel] = x2;
+        biquad->y1[channel] = y1;
+        biquad->y2[channel] = y2;
+        biquad->error[channel] = error;
+    }
+}
+
+void audioio_dc_block_clear(audioio_dc_block_t* dc_block) {
+    memset(dc_block, 0, sizeof(*dc_block));
+}
+
+void audioio_dc_block_apply(audioio_dc_block_t* dc_block, int16_t* samples, uint32_t frames,
+                            uint8_t channel_count) {
+    const int32_t half = 1 << (AUDIOIO_DC_BLOCK_POLE_SHIFT - 1);
+    for (uint8_t channel = 0; channel < channel_count; channel++) {
+        int32_t x1 = dc_block->x1[channel];
+        int32_t y1 = dc_block->y1[channel];
+        int16_t* sample = samples + channel;
+        for (uint32_t i = 0; i < frames; i++) {
+            int32_t x0 = *sample;
+            // Rounding the leak lets y1 settle within half an output step of zero.
+            y1 += (x0 - x1) * (1 << DC_BLOCK_FRACTION_BITS) -
+                  ((y1 + half) >> AUDIOIO_DC_BLOCK_POLE_SHIFT);
+            x1 = x0;
+            int32_t y0 = (y1 + (1 << (DC_BLOCK_FRACTION_BITS - 1))) >> DC_BLOCK_FRACTION_BITS;
+            if (y0 > INT16_MAX) {
+                y0 = INT16_MAX;
+            } else if (y0 < INT16_MIN) {
+                y0 = INT16_MIN;
+            }
+            *sample = y0;
+            sample += channel_count;
+        }
+        dc_block->x1[channel] = x1;
+        dc_block->y1[channel] = y1;
+    }
+}
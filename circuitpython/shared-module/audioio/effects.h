@@ -0,0 +1,97 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_EFFECTS_H
+#define MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_EFFECTS_H
+
+#include <stdint.h>
+
+// Fixed point effects that work in place on interleaved 16 bit signed frames
+// of one or two channels.
+
+// Gain that can ramp linearly from one level to another.
+#define AUDIOIO_GAIN_UNITY (1 << 15)
+
+typedef struct {
+    int32_t level;          // Gain with 15 more fractional bits, so 1 << 30 is unity.
+    int32_t step;           // Added to level every frame while ramping.
+    uint32_t remaining;     // Frames left in the ramp.
+    int32_t target;
+} audioio_gain_t;
+
+// Sets the gain to level, from 0 to AUDIOIO_GAIN_UNITY, straight away.
+void audioio_gain_set(audioio_gain_t* gain, uint16_t level);
+// Ramps from the current gain to level over frames frames.
+void audioio_gain_ramp(audioio_gain_t* gain, uint16_t level, uint32_t frames);
+// Returns the gain after any ramp ends, from 0 to AUDIOIO_GAIN_UNITY.
+uint16_t audioio_gain_target(const audioio_gain_t* gain);
+void audioio_gain_apply(audioio_gain_t* gain, int16_t* samples, uint32_t frames,
+                        uint8_t channel_count);
+
+// Second order IIR filter. Coefficients have AUDIOIO_BIQUAD_SHIFT fractional
+// bits and are normalized so a0 is one. The bits rounded off each output are
+// fed into the next one so that low cutoffs don't add noise or a DC offset.
+#define AUDIOIO_BIQUAD_SHIFT (29)
+
+typedef struct {
+    int32_t b0;
+    int32_t b1;
+    int32_t b2;
+    int32_t a1;
+    int32_t a2;
+    int16_t x1[2];
+    int16_t x2[2];
+    int16_t y1[2];
+    int16_t y2[2];
+    int32_t error[2];
+} audioio_biquad_t;
+
+// These set the coefficients from Robert Bristow-Johnson's Audio EQ Cookbook
+// and keep the history so the cutoff can move while playing. frequency must be
+// below half the sample rate.
+void audioio_biquad_low_pass(audioio_biquad_t* biquad, uint32_t sample_rate, float frequency,
+                             float q);
+void audioio_biquad_high_pass(audioio_biquad_t* biquad, uint32_t sample_rate, float frequency,
+                              float q);
+void audioio_biquad_clear(audioio_biquad_t* biquad);
+void audioio_biquad_apply(audioio_biquad_t* biquad, int16_t* samples, uint32_t frames,
+                          uint8_t channel_count);
+
+// Removes any DC offset with a one pole high pass filter. y = x - x1 + p * y1
+// where p is 1 - 2^-AUDIOIO_DC_BLOCK_POLE_SHIFT, which puts the cutoff at
+// about 14Hz for 22kHz audio.
+#define AUDIOIO_DC_BLOCK_POLE_SHIFT (8)
+
+typedef struct {
+    int16_t x1[2];
+    int32_t y1[2];          // The last output with 8 more fractional bits.
+} audioio_dc_block_t;
+
+void audioio_dc_block_clear(audioio_dc_block_t* dc_block);
+void audioio_dc_block_apply(audioio_dc_block_t* dc_block, int16_t* samples, uint32_t frames,
+                            uint8_t channel_count);
+
+#endif // MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_EFFECTS_H
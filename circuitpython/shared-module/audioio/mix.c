@@ -0,0 +1,98 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "shared-module/audioio/mix.h"
+
+static inline int32_t saturate_16(int32_t value) {
+    if (value > INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (value < INT16_MIN) {
+        return INT16_MIN;
+    }
+    return value;
+}
+
+static inline int32_t saturate_8(int32_t value) {
+    if (value > INT8_MAX) {
+        return INT8_MAX;
+    }
+    if (value < INT8_MIN) {
+        return INT8_MIN;
+    }
+    return value;
+}
+
+// Each case has its own loop to keep them tight.
+void audioio_mix_16(int16_t* out, const uint16_t* in, uint32_t count, uint16_t flip,
+                    int32_t gain, bool add) {
+    if (gain == AUDIOIO_MIXER_UNITY_GAIN) {
+        if (add) {
+            for (uint32_t i = 0; i < count; i++) {
+                out[i] = saturate_16(out[i] + (int16_t) (in[i] ^ flip));
+            }
+        } else {
+            for (uint32_t i = 0; i < count; i++) {
+                out[i] = (int16_t) (in[i] ^ flip);
+            }
+        }
+    } else {
+        if (add) {
+            for (uint32_t i = 0; i < count; i++) {
+                out[i] = saturate_16(out[i] + (((int16_t) (in[i] ^ flip) * gain) >> 15));
+            }
+        } else {
+            for (uint32_t i = 0; i < count; i++) {
+                out[i] = ((int16_t) (in[i] ^ flip) * gain) >> 15;
+            }
+        }
+    }
+}
+
+void audioio_mix_8(int8_t* out, const uint8_t* in, uint32_t count, uint8_t flip,
+                   int32_t gain, bool add) {
+    if (gain == AUDIOIO_MIXER_UNITY_GAIN) {
+        if (add) {
+            for (uint32_t i = 0; i < count; i++) {
+                out[i] = saturate_8(out[i] + (int8_t) (in[i] ^ flip));
+            }
+        } else {
+            for (uint32_t i = 0; i < count; i++) {
+                out[i] = (int8_t) (in[i] ^ flip);
+            }
+        }
+    } else {
+        if (add) {
+            for (uint32_t i = 0; i < count; i++) {
+                out[i] = saturate_8(out[i] + (((int8_t) (in[i] ^ flip) * gain) >> 15));
+            }
+        } else {
+            for (uint32_t i = 0; i < count; i++) {
+                out[i] = ((int8_t) (in[i] ^ flip) * gain) >> 15;
+            }
+        }
+    }
+}
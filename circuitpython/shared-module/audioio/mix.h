@@ -0,0 +1,44 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_MIX_H
+#define MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_MIX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Gains are fixed point with 15 fractional bits.
+#define AUDIOIO_MIXER_UNITY_GAIN (1 << 15)
+
+// Mixes count samples from in into out, scaled by gain. in is flipped to
+// signed with flip. When add is false out hasn't been written yet and is
+// overwritten instead. Sums saturate.
+void audioio_mix_16(int16_t* out, const uint16_t* in, uint32_t count, uint16_t flip,
+                    int32_t gain, bool add);
+void audioio_mix_8(int8_t* out, const uint8_t* in, uint32_t count, uint8_t flip,
+                   int32_t gain, bool add);
+
+#endif  // MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_MIX_H
@@ -0,0 +1,254 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "shared-module/audioio/resample.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#define FIR_PHASE_BITS (6)
+
+// Kaiser windowed sinc (beta 5) cut off at 0.45 of the input rate. Each phase
+// sums to 1 << 15 so DC passes unchanged. The sum of the magnitudes is under
+// 1 << 16 so the products can't overflow 32 bits. The extra last phase is a
+// whole frame on so that coefficients can be interpolated between phases.
+static const int16_t fir_table[(1 << FIR_PHASE_BITS) + 1][AUDIOIO_RESAMPLE_FIR_TAPS] = {
+    {    646,  -1688,   2786,  29371,   2786,  -1688,    646,    -91 },
+    {    610,  -1556,   2358,  29365,   3227,  -1821,    682,    -97 },
+    {    574,  -1425,   1940,  29339,   3680,  -1955,    718,   -103 },
+    {    539,  -1296,   1535,  29291,   4143,  -2089,    754,   -109 },
+    {    503,  -1168,   1142,  29224,   4617,  -2223,    789,   -116 },
+    {    468,  -1042,    762,  29134,   5100,  -2356,    824,   -122 },
+    {    433,   -918,    394,  29025,   5593,  -2489,    858,   -128 },
+    {    399,   -796,     39,  28893,   6096,  -2621,    892,   -134 },
+    {    366,   -677,   -303,  28741,   6607,  -2751,    925,   -140 },
+    {    333,   -560,   -632,  28570,   7126,  -2880,    957,   -146 },
+    {    301,   -446,   -947,  28379,   7653,  -3007,    987,   -152 },
+    {    269,   -335,  -1249,  28167,   8187,  -3131,   1017,   -157 },
+    {    238,   -227,  -1537,  27936,   8727,  -3252,   1045,   -162 },
+    {    209,   -123,  -1811,  27685,   9273,  -3370,   1072,   -167 },
+    {    180,    -22,  -2072,  27418,   9824,  -3485,   1097,   -172 },
+    {    152,     75,  -2319,  27129,  10381,  -3595,   1121,   -176 },
+    {    125,    169,  -2552,  26824,  10941,  -3701,   1142,   -180 },
+    {     99,    259,  -2771,  26502,  11504,  -3803,   1162,   -184 },
+    {     75,    345,  -2976,  26160,  12071,  -3899,   1179,   -187 },
+    {     51,    428,  -3168,  25802,  12639,  -3989,   1194,   -189 },
+    {     28,    506,  -3346,  25429,  13209,  -4074,   1207,   -191 },
+    {      7,    580,  -3510,  25039,  13779,  -4152,   1217,   -192 },
+    {    -13,    650,  -3662,  24635,  14349,  -4223,   1225,   -193 },
+    {    -33,    716,  -3800,  24217,  14919,  -4288,   1229,   -192 },
+    {    -51,    778,  -3925,  23784,  15487,  -4344,   1231,   -192 },
+    {    -67,    836,  -4037,  23336,  16053,  -4393,   1230,   -190 },
+    {    -83,    889,  -4136,  22877,  16616,  -4433,   1225,   -187 },
+    {    -98,    939,  -4223,  22407,  17175,  -4465,   1217,   -184 },
+    {   -111,    984,  -4297,  21923,  17730,  -4487,   1206,   -180 },
+    {   -123,   1026,  -4360,  21429,  18279,  -4500,   1192,   -175 },
+    {   -135,   1063,  -4411,  20927,  18823,  -4503,   1173,   -169 },
+    {   -145,   1096,  -4450,  20413,  19361,  -4496,   1151,   -162 },
+    {   -154,   1126,  -4479,  19891,  19891,  -4479,   1126,   -154 },
+    {   -162,   1151,  -4496,  19361,  20413,  -4450,   1096,   -145 },
+    {   -169,   1173,  -4503,  18823,  20927,  -4411,   1063,   -135 },
+    {   -175,   1192,  -4500,  18279,  21429,  -4360,   1026,   -123 },
+    {   -180,   1206,  -4487,  17730,  21923,  -4297,    984,   -111 },
+    {   -184,   1217,  -4465,  17175,  22407,  -4223,    939,    -98 },
+    {   -187,   1225,  -4433,  16616,  22877,  -4136,    889,    -83 },
+    {   -190,   1230,  -4393,  16053,  23336,  -4037,    836,    -67 },
+    {   -192,   1231,  -4344,  15487,  23784,  -3925,    778,    -51 },
+    {   -192,   1229,  -4288,  14919,  24217,  -3800,    716,    -33 },
+    {   -193,   1225,  -4223,  14349,  24635,  -3662,    650,    -13 },
+    {   -192,   1217,  -4152,  13779,  25039,  -3510,    580,      7 },
+    {   -191,   1207,  -4074,  13209,  25429,  -3346,    506,     28 },
+    {   -189,   1194,  -3989,  12639,  25802,  -3168,    428,     51 },
+    {   -187,   1179,  -3899,  12071,  26160,  -2976,    345,     75 },
+    {   -184,   1162,  -3803,  11504,  26502,  -2771,    259,     99 },
+    {   -180,   1142,  -3701,  10941,  26824,  -2552,    169,    125 },
+    {   -176,   1121,  -3595,  10381,  27129,  -2319,     75,    152 },
+    {   -172,   1097,  -3485,   9824,  27418,  -2072,    -22,    180 },
+    {   -167,   1072,  -3370,   9273,  27685,  -1811,   -123,    209 },
+    {   -162,   1045,  -3252,   8727,  27936,  -1537,   -227,    238 },
+    {   -157,   1017,  -3131,   8187,  28167,  -1249,   -335,    269 },
+    {   -152,    987,  -3007,   7653,  28379,   -947,   -446,    301 },
+    {   -146,    957,  -2880,   7126,  28570,   -632,   -560,    333 },
+    {   -140,    925,  -2751,   6607,  28741,   -303,   -677,    366 },
+    {   -134,    892,  -2621,   6096,  28893,     39,   -796,    399 },
+    {   -128,    858,  -2489,   5593,  29025,    394,   -918,    433 },
+    {   -122,    824,  -2356,   5100,  29134,    762,  -1042,    468 },
+    {   -116,    789,  -2223,   4617,  29224,   1142,  -1168,    503 },
+    {   -109,    754,  -2089,   4143,  29291,   1535,  -1296,    539 },
+    {   -103,    718,  -1955,   3680,  29339,   1940,  -1425,    574 },
+    {    -97,    682,  -1821,   3227,  29365,   2358,  -1556,    610 },
+    {    -91,    646,  -1688,   2786,  29371,   2786,  -1688,    646 },
+};
+
+void audioio_resample_reset(audioio_resample_state_t* state, uint8_t channel_count, uint8_t taps,
+                            uint32_t step) {
+    uint8_t length = taps;
+    if (taps == AUDIOIO_RESAMPLE_FIR_TAPS) {
+        // Keep a whole FIR's worth of history for each time it is stretched.
+        uint32_t stretch = (step + AUDIOIO_RESAMPLE_ONE - 1) / AUDIOIO_RESAMPLE_ONE;
+        if (stretch < 1) {
+            stretch = 1;
+        }
+        if (stretch > AUDIOIO_RESAMPLE_MAX_STRETCH) {
+            stretch = AUDIOIO_RESAMPLE_MAX_STRETCH;
+        }
+        length = taps * stretch;
+    }
+    memset(state->history, 0, sizeof(state->history));
+    state->position = 0;
+    state->taps = taps;
+    state->length = length;
+    state->channel_count = channel_count;
+    // Output sits between the middle two frames of history so take enough
+    // frames to put the first one there.
+    state->phase = (length / 2 + 1) * AUDIOIO_RESAMPLE_ONE;
+    state->step = step;
+}
+
+uint32_t audioio_resample_tail_frames(audioio_resample_state_t* state) {
+    return state->length / 2;
+}
+
+static inline int16_t saturate_16(int32_t value) {
+    if (value > INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (value < INT16_MIN) {
+        return INT16_MIN;
+    }
+    return value;
+}
+
+static inline void push_frame(audioio_resample_state_t* state, const int16_t* frame) {
+    uint8_t position = state->position;
+    uint8_t length = state->length;
+    for (uint8_t channel = 0; channel < state->channel_count; channel++) {
+        state->history[channel][position] = frame[channel];
+        state->history[channel][position + length] = frame[channel];
+    }
+    position++;
+    if (position == length) {
+        position = 0;
+    }
+    state->position = position;
+}
+
+// Fills coefficients for every frame of history with the FIR stretched by
+// stretch, in 16.16 fixed point, and scaled so that they sum to 1 << 15. phase
+// is how far the output is past the frame before the middle of the history.
+static void stretch_fir(int32_t* coefficients, uint8_t length, uint32_t phase, uint32_t stretch) {
+    // Distance from the middle of the FIR in taps, stepping by inverse for
+    // each frame.
+    int32_t inverse = ((uint64_t) AUDIOIO_RESAMPLE_ONE << 16) / stretch;
+    int32_t first = -(int32_t) ((length / 2 - 1) * AUDIOIO_RESAMPLE_ONE + phase);
+    int32_t x = ((int64_t) first * inverse) >> 16;
+    int32_t total = 0;
+    for (uint8_t i = 0; i < length; i++) {
+        // The table covers x in (-4, 4] taps. Count down from the top so the
+        // whole taps pick the column and the fraction picks the phase.
+        int32_t v = (AUDIOIO_RESAMPLE_FIR_TAPS / 2) * AUDIOIO_RESAMPLE_ONE - x;
+        int32_t coefficient = 0;
+        if (v >= 0 && v < AUDIOIO_RESAMPLE_FIR_TAPS * AUDIOIO_RESAMPLE_ONE) {
+            uint8_t tap = AUDIOIO_RESAMPLE_FIR_TAPS - 1 - (v >> 16);
+            const int16_t* c = fir_table[(v & 0xffff) >> (16 - FIR_PHASE_BITS)] + tap;
+            int32_t fraction = (v >> (16 - FIR_PHASE_BITS - 8)) & 0xff;
+            coefficient = c[0] + (((c[AUDIOIO_RESAMPLE_FIR_TAPS] - c[0]) * fraction) >> 8);
+        }
+        coefficients[i] = coefficient;
+        total += coefficient;
+        x += inverse;
+    }
+    int32_t scale = (1 << 30) / total;
+    for (uint8_t i = 0; i < length; i++) {
+        coefficients[i] = (coefficients[i] * scale) >> 15;
+    }
+}
+
+uint32_t audioio_resample(audioio_resample_state_t* state, const int16_t* in, uint32_t* in_frames,
+                          int16_t* out, uint32_t out_frames) {
+    uint8_t channel_count = state->channel_count;
+    bool linear = state->taps == AUDIOIO_RESAMPLE_LINEAR_TAPS;
+    uint32_t phase = state->phase;
+    uint32_t step = state->step;
+    uint8_t length = state->length;
+    // Cut off at the output rate when downsampling, as far as the history
+    // allows.
+    uint32_t stretch = step;
+    if (stretch > (uint32_t) (length / AUDIOIO_RESAMPLE_FIR_TAPS) * AUDIOIO_RESAMPLE_ONE) {
+        stretch = (length / AUDIOIO_RESAMPLE_FIR_TAPS) * AUDIOIO_RESAMPLE_ONE;
+    }
+    bool stretched = !linear && stretch > AUDIOIO_RESAMPLE_ONE;
+    int32_t coefficients[AUDIOIO_RESAMPLE_MAX_LENGTH];
+    uint32_t available = *in_frames;
+    uint32_t used = 0;
+    uint32_t written = 0;
+    while (written < out_frames) {
+        while (phase >= AUDIOIO_RESAMPLE_ONE && used < available) {
+            push_frame(state, in + used * channel_count);
+            used++;
+            phase -= AUDIOIO_RESAMPLE_ONE;
+        }
+        if (phase >= AUDIOIO_RESAMPLE_ONE) {
+            break;
+        }
+        if (stretched) {
+            stretch_fir(coefficients, length, phase, stretch);
+        }
+        for (uint8_t channel = 0; channel < channel_count; channel++) {
+            const int16_t* h = state->history[channel] + state->position;
+            if (linear) {
+                // Drop a bit of the fraction so the product fits in 32 bits.
+                int32_t fraction = phase >> 1;
+                out[channel] = h[0] + (((h[1] - h[0]) * fraction) >> 15);
+            } else if (stretched) {
+                int32_t sum = 1 << 14;
+                for (uint8_t i = 0; i < length; i++) {
+                    sum += h[i] * coefficients[i];
+                }
+                out[channel] = saturate_16(sum >> 15);
+            } else {
+                // Interpolate the coefficients between the two nearest phases
+                // of the FIR in the middle of the history.
+                h += length / 2 - AUDIOIO_RESAMPLE_FIR_TAPS / 2;
+                const int16_t* c = fir_table[phase >> (16 - FIR_PHASE_BITS)];
+                int32_t fraction = (phase >> (16 - FIR_PHASE_BITS - 8)) & 0xff;
+                int32_t sum = 1 << 14;
+                for (uint8_t i = 0; i < AUDIOIO_RESAMPLE_FIR_TAPS; i++) {
+                    int32_t coefficient = c[i] +
+                        (((c[i + AUDIOIO_RESAMPLE_FIR_TAPS] - c[i]) * fraction) >> 8);
+                    sum += h[i] * coefficient;
+                }
+                out[channel] = saturate_16(sum >> 15);
+            }
+        }
+        out += channel_count;
+        phase += step;
+        written++;
+    }
+    state->phase = phase;
+    *in_frames = used;
+    return written;
+}
@@ -0,0 +1,77 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_RESAMPLE_H
+#define MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_RESAMPLE_H
+
+#include <stdint.h>
+
+// Streaming sample rate conversion of interleaved 16 bit signed frames. The
+// position between input frames is kept as 16.16 fixed point so the rate can
+// be changed between calls, for example to shift pitch.
+
+#define AUDIOIO_RESAMPLE_ONE (1 << 16)
+
+// Linear interpolates between neighbouring frames and the FIR uses eight taps
+// with 64 phases. When downsampling the FIR is stretched by up to
+// AUDIOIO_RESAMPLE_MAX_STRETCH times so that it cuts off below the output rate
+// rather than the input rate.
+#define AUDIOIO_RESAMPLE_LINEAR_TAPS (2)
+#define AUDIOIO_RESAMPLE_FIR_TAPS (8)
+#define AUDIOIO_RESAMPLE_MAX_STRETCH (4)
+#define AUDIOIO_RESAMPLE_MAX_LENGTH (AUDIOIO_RESAMPLE_FIR_TAPS * AUDIOIO_RESAMPLE_MAX_STRETCH)
+
+typedef struct {
+    // The last length input frames for each channel, written twice so that
+    // they can always be read in order from position.
+    int16_t history[2][2 * AUDIOIO_RESAMPLE_MAX_LENGTH];
+    uint8_t position;
+    uint8_t taps;
+    uint8_t length;
+    uint8_t channel_count;
+    // Input frames to take before the next output frame, in 16.16 fixed point.
+    uint32_t phase;
+    // Input frames per output frame, in 16.16 fixed point.
+    uint32_t step;
+} audioio_resample_state_t;
+
+// Clears the history so that the first input frame is the first frame output.
+// The FIR history is sized for step here so raising the step later only
+// stretches the FIR as far as that history allows.
+void audioio_resample_reset(audioio_resample_state_t* state, uint8_t channel_count, uint8_t taps,
+                            uint32_t step);
+
+// The number of silent input frames needed after the last one to output the
+// end of the input.
+uint32_t audioio_resample_tail_frames(audioio_resample_state_t* state);
+
+// Resamples up to *in_frames frames from in into at most out_frames frames of
+// out. Stops early when the input runs out. *in_frames is set to the number
+// of input frames used and the number of output frames is returned.
+uint32_t audioio_resample(audioio_resample_state_t* state, const int16_t* in, uint32_t* in_frames,
+                          int16_t* out, uint32_t out_frames);
+
+#endif // MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_RESAMPLE_H
@@ -0,0 +1,203 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "shared-module/audioio/stage.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "py/runtime.h"
+
+#include "supervisor/shared/translate.h"
+
+void audioio_stage_construct(audioio_stage_t* stage, mp_obj_t sample, uint32_t buffer_size) {
+    stage->first_buffer = m_malloc(buffer_size, false);
+    if (stage->first_buffer == NULL) {
+        audioio_stage_deinit(stage);
+        mp_raise_msg(&mp_type_MemoryError, translate("Couldn't allocate first buffer"));
+    }
+
+    stage->second_buffer = m_malloc(buffer_size, false);
+    if (stage->second_buffer == NULL) {
+        audioio_stage_deinit(stage);
+        mp_raise_msg(&mp_type_MemoryError, translate("Couldn't allocate second buffer"));
+    }
+
+    stage->sample = sample;
+    stage->len = buffer_size;
+    stage->channel_count = audiosample_channel_count(sample);
+}
+
+void audioio_stage_deinit(audioio_stage_t* stage) {
+    stage->first_buffer = NULL;
+    stage->second_buffer = NULL;
+}
+
+bool audioio_stage_deinited(audioio_stage_t* stage) {
+    return stage->first_buffer == NULL;
+}
+
+bool audioio_stage_reset_buffer(audioio_stage_t* stage, bool single_channel, uint8_t channel) {
+    if (single_channel && channel == 1) {
+        return false;
+    }
+    audiosample_reset_buffer(stage->sample, false, 0);
+    stage->more_data = true;
+    stage->remaining_buffer = NULL;
+    stage->remaining_length = 0;
+    stage->read_count = 0;
+    stage->left_read_count = 0;
+    stage->right_read_count = 0;
+    return true;
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wcast-align"
+
+// Converts count samples from the sample's format to 16 bit signed.
+static void convert(int16_t* out, const uint8_t* in, uint32_t count, uint8_t bits_per_sample,
+                    bool samples_signed) {
+    if (bits_per_sample == 16 && samples_signed) {
+        memcpy(out, in, count * sizeof(int16_t));
+    } else if (bits_per_sample == 16) {
+        const uint16_t* in16 = (const uint16_t*) in;
+        for (uint32_t i = 0; i < count; i++) {
+            out[i] = (int16_t) (in16[i] ^ 0x8000);
+        }
+    } else {
+        uint8_t flip = samples_signed ? 0 : 0x80;
+        for (uint32_t i = 0; i < count; i++) {
+            out[i] = (int16_t) ((in[i] ^ flip) << 8);
+        }
+    }
+}
+
+#pragma GCC diagnostic pop
+
+// Fills out from the sample, processes it and returns its length in bytes. done is set once the
+// end of the sample is in out.
+static uint32_t fill_buffer(audioio_stage_t* stage, int16_t* out, bool* done,
+                            audioio_stage_process_t process, void* context) {
+    bool samples_signed;
+    bool single_buffer;
+    uint32_t max_buffer_length;
+    uint8_t spacing;
+    audiosample_get_buffer_structure(stage->sample, false, &single_buffer, &samples_signed,
+                                     &max_buffer_length, &spacing);
+    uint8_t bits_per_sample = audiosample_bits_per_sample(stage->sample);
+    uint8_t channel_count = stage->channel_count;
+    uint32_t bytes_per_frame = bits_per_sample / 8 * channel_count;
+
+    uint32_t frames = stage->len / (2 * channel_count);
+    uint32_t written = 0;
+    while (written < frames) {
+        if (stage->remaining_length >= bytes_per_frame) {
+            uint32_t count = stage->remaining_length / bytes_per_frame;
+            if (count > frames - written) {
+                count = frames - written;
+            }
+            convert(out + written * channel_count, stage->remaining_buffer, count * channel_count,
+                    bits_per_sample, samples_signed);
+            stage->remaining_buffer += count * bytes_per_frame;
+            stage->remaining_length -= count * bytes_per_frame;
+            written += count;
+        } else if (stage->more_data) {
+            audioio_get_buffer_result_t result =
+                audiosample_get_buffer(stage->sample, false, 0, &stage->remaining_buffer,
+                                       &stage->remaining_length);
+            if (result == GET_BUFFER_ERROR) {
+                stage->remaining_length = 0;
+            }
+            stage->more_data = result == GET_BUFFER_MORE_DATA;
+        } else {
+            break;
+        }
+    }
+    *done = !stage->more_data && stage->remaining_length < bytes_per_frame;
+    if (written == 0) {
+        // Never hand back an empty buffer.
+        memset(out, 0, 2 * channel_count);
+        written = 1;
+    }
+    process(context, out, written);
+    return written * 2 * channel_count;
+}
+
+audioio_get_buffer_result_t audioio_stage_get_buffer(audioio_stage_t* stage,
+                                                     bool single_channel,
+                                                     uint8_t channel,
+                                                     uint8_t** buffer,
+                                                     uint32_t* buffer_length,
+                                                     audioio_stage_process_t process,
+                                                     void* context) {
+    if (!single_channel) {
+        channel = 0;
+    }
+
+    uint32_t channel_read_count = stage->left_read_count;
+    if (channel == 1) {
+        channel_read_count = stage->right_read_count;
+    }
+
+    // Both channels come from the same interleaved buffer. Only fill a new one
+    // once the channel that is furthest ahead asks for it.
+    uint8_t index = channel_read_count % 2;
+    uint8_t* out = index == 0 ? stage->first_buffer : stage->second_buffer;
+    if (stage->read_count == channel_read_count) {
+        stage->buffer_lengths[index] = fill_buffer(stage, (int16_t*) (void*) out,
+                                                   &stage->buffer_done[index], process, context);
+        stage->read_count += 1;
+    }
+
+    *buffer = out;
+    *buffer_length = stage->buffer_lengths[index];
+
+    if (channel == 0) {
+        stage->left_read_count += 1;
+    } else if (channel == 1) {
+        stage->right_read_count += 1;
+        *buffer = *buffer + 2;
+    }
+
+    return stage->buffer_done[index] ? GET_BUFFER_DONE : GET_BUFFER_MORE_DATA;
+}
+
+void audioio_stage_get_buffer_structure(audioio_stage_t* stage, bool single_channel,
+                                        bool* single_buffer, bool* samples_signed,
+                                        uint32_t* max_buffer_length, uint8_t* spacing) {
+    *single_buffer = false;
+    *samples_signed = true;
+    *max_buffer_length = stage->len;
+    if (single_channel) {
+        *spacing = stage->channel_count;
+    } else {
+        *spacing = 1;
+    }
+}
+
+void audioio_stage_prefetch(audioio_stage_t* stage) {
+    audiosample_prefetch(stage->sample);
+}
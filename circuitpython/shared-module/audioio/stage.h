@@ -0,0 +1,79 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_STAGE_H
+#define MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_STAGE_H
+
+#include "py/obj.h"
+
+#include "shared-module/audioio/__init__.h"
+
+// A stage is the part of a sample that reads from another sample, converts it
+// to 16 bit signed and runs it through a process function before handing it
+// on. Effects embed one so that they can be chained in any order and played
+// by anything that plays samples.
+
+// Processes frames of interleaved samples in place.
+typedef void (*audioio_stage_process_t)(void* context, int16_t* samples, uint32_t frames);
+
+typedef struct {
+    mp_obj_t sample;
+    uint8_t* first_buffer;
+    uint8_t* second_buffer;
+    uint32_t len;           // Bytes in each buffer.
+    uint8_t channel_count;
+
+    bool more_data;         // The sample has more buffers after the current one.
+    // What's left of the last buffer we got from the sample.
+    uint8_t* remaining_buffer;
+    uint32_t remaining_length; // In bytes
+
+    uint32_t buffer_lengths[2];
+    bool buffer_done[2];
+    uint32_t read_count;
+    uint32_t left_read_count;
+    uint32_t right_read_count;
+} audioio_stage_t;
+
+void audioio_stage_construct(audioio_stage_t* stage, mp_obj_t sample, uint32_t buffer_size);
+void audioio_stage_deinit(audioio_stage_t* stage);
+bool audioio_stage_deinited(audioio_stage_t* stage);
+
+// Returns true when the stage started over, in which case the owner should reset its effect too.
+bool audioio_stage_reset_buffer(audioio_stage_t* stage, bool single_channel, uint8_t channel);
+audioio_get_buffer_result_t audioio_stage_get_buffer(audioio_stage_t* stage,
+                                                     bool single_channel,
+                                                     uint8_t channel,
+                                                     uint8_t** buffer,
+                                                     uint32_t* buffer_length,
+                                                     audioio_stage_process_t process,
+                                                     void* context);
+void audioio_stage_get_buffer_structure(audioio_stage_t* stage, bool single_channel,
+                                        bool* single_buffer, bool* samples_signed,
+                                        uint32_t* max_buffer_length, uint8_t* spacing);
+void audioio_stage_prefetch(audioio_stage_t* stage);
+
+#endif // MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_STAGE_H
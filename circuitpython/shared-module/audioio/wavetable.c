@@ -0,0 +1,217 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "shared-module/audioio/wavetable.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+// Envelope levels have this many more fractional bits than a 1 << 15 gain.
+#define LEVEL_FRACTION_BITS (15)
+// Fractional bits of the phase used to interpolate between table entries.
+#define INTERPOLATION_BITS (15)
+
+// Keeps the compiler from moving a voice's other fields past a write to its stage. Voices are
+// rendered in an interrupt so that is enough to never render one half changed.
+#define SYNTH_BARRIER() __asm__ volatile("" ::: "memory")
+
+const int16_t audioio_synth_sine[1 << AUDIOIO_SYNTH_SINE_BITS] = {
+    0, 804, 1608, 2410, 3212, 4011, 4808, 5602, 6393, 7179, 7962, 8739,
+    9512, 10278, 11039, 11793, 12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+    18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594, 23170, 23731, 24279, 24811,
+    25329, 25832, 26319, 26790, 27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+    30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971, 32137, 32285, 32412, 32521,
+    32609, 32678, 32728, 32757, 32767, 32757, 32728, 32678, 32609, 32521, 32412, 32285,
+    32137, 31971, 31785, 31580, 31356, 31113, 30852, 30571, 30273, 29956, 29621, 29268,
+    28898, 28510, 28105, 27683, 27245, 26790, 26319, 25832, 25329, 24811, 24279, 23731,
+    23170, 22594, 22005, 21403, 20787, 20159, 19519, 18868, 18204, 17530, 16846, 16151,
+    15446, 14732, 14010, 13279, 12539, 11793, 11039, 10278, 9512, 8739, 7962, 7179,
+    6393, 5602, 4808, 4011, 3212, 2410, 1608, 804, 0, -804, -1608, -2410,
+    -3212, -4011, -4808, -5602, -6393, -7179, -7962, -8739, -9512, -10278, -11039, -11793,
+    -12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530, -18204, -18868, -19519, -20159,
+    -20787, -21403, -22005, -22594, -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790,
+    -27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956, -30273, -30571, -30852, -31113,
+    -31356, -31580, -31785, -31971, -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+    -32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285, -32137, -31971, -31785, -31580,
+    -31356, -31113, -30852, -30571, -30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683,
+    -27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731, -23170, -22594, -22005, -21403,
+    -20787, -20159, -19519, -18868, -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+    -12539, -11793, -11039, -10278, -9512, -8739, -7962, -7179, -6393, -5602, -4808, -4011,
+    -3212, -2410, -1608, -804,
+};
+
+uint32_t audioio_synth_phase_step(float frequency, uint32_t sample_rate) {
+    return (uint32_t) (frequency / sample_rate * 4294967296.0f);
+}
+
+void audioio_synth_voice_clear(audioio_synth_voice_t* voice) {
+    memset(voice, 0, sizeof(audioio_synth_voice_t));
+    voice->stage = AUDIOIO_SYNTH_OFF;
+}
+
+// Moves the envelope on to stage, skipping any stages that take no time.
+static void enter_stage(const audioio_synth_t* synth, audioio_synth_voice_t* voice,
+                        uint8_t stage) {
+    while (true) {
+        int32_t target;
+        uint32_t frames;
+        uint8_t next;
+        if (stage == AUDIOIO_SYNTH_ATTACK) {
+            target = voice->peak;
+            frames = synth->attack;
+            next = AUDIOIO_SYNTH_DECAY;
+        } else if (stage == AUDIOIO_SYNTH_DECAY) {
+            target = (voice->peak >> LEVEL_FRACTION_BITS) * synth->sustain;
+            frames = synth->decay;
+            next = AUDIOIO_SYNTH_SUSTAIN;
+        } else if (stage == AUDIOIO_SYNTH_RELEASE) {
+            target = 0;
+            frames = synth->release;
+            next = AUDIOIO_SYNTH_OFF;
+        } else {
+            // Sustain and off hold their level until the next press or release.
+            if (stage == AUDIOIO_SYNTH_OFF) {
+                voice->level = 0;
+            }
+            voice->target = voice->level;
+            voice->step = 0;
+            voice->remaining = 0;
+            SYNTH_BARRIER();
+            voice->stage = stage;
+            return;
+        }
+        if (frames > 0) {
+            voice->target = target;
+            voice->step = (target - voice->level) / (int32_t) frames;
+            voice->remaining = frames;
+            SYNTH_BARRIER();
+            voice->stage = stage;
+            return;
+        }
+        voice->level = target;
+        stage = next;
+    }
+}
+
+void audioio_synth_press(const audioio_synth_t* synth, audioio_synth_voice_t* voice,
+                         uint32_t phase_step, uint16_t level) {
+    bool sounding = voice->stage != AUDIOIO_SYNTH_OFF;
+    // Silence the voice while it changes in case the interrupt renders in between.
+    voice->stage = AUDIOIO_SYNTH_OFF;
+    SYNTH_BARRIER();
+    if (!sounding) {
+        // Sine like tables start at a zero crossing.
+        voice->phase = 0;
+        voice->level = 0;
+    }
+    voice->phase_step = phase_step;
+    voice->peak = (int32_t) level << LEVEL_FRACTION_BITS;
+    enter_stage(synth, voice, AUDIOIO_SYNTH_ATTACK);
+}
+
+void audioio_synth_release(const audioio_synth_t* synth, audioio_synth_voice_t* voice) {
+    if (voice->stage == AUDIOIO_SYNTH_OFF || voice->stage == AUDIOIO_SYNTH_RELEASE) {
+        return;
+    }
+    voice->stage = AUDIOIO_SYNTH_OFF;
+    SYNTH_BARRIER();
+    enter_stage(synth, voice, AUDIOIO_SYNTH_RELEASE);
+}
+
+// Adds frames of the voice into mix at its current envelope slope.
+static void oscillate(const audioio_synth_t* synth, audioio_synth_voice_t* voice, int32_t* mix,
+                      uint32_t frames) {
+    const int16_t* table = synth->table;
+    uint32_t shift = 32 - synth->table_bits;
+    uint32_t mask = (1 << synth->table_bits) - 1;
+    uint32_t phase = voice->phase;
+    uint32_t phase_step = voice->phase_step;
+    int32_t level = voice->level;
+    int32_t step = voice->step;
+    for (uint32_t i = 0; i < frames; i++) {
+        uint32_t index = phase >> shift;
+        int32_t a = table[index];
+        int32_t b = table[(index + 1) & mask];
+        int32_t fraction = (phase >> (shift - INTERPOLATION_BITS)) & ((1 << INTERPOLATION_BITS) - 1);
+        int32_t sample = a + (((b - a) * fraction) >> INTERPOLATION_BITS);
+        mix[i] += (sample * (level >> LEVEL_FRACTION_BITS)) >> 15;
+        phase += phase_step;
+        level += step;
+    }
+    voice->phase = phase;
+    voice->level = level;
+}
+
+void audioio_synth_render(const audioio_synth_t* synth, audioio_synth_voice_t* voices,
+                          uint8_t voice_count, int16_t* out, uint32_t frames) {
+    int32_t mix[AUDIOIO_SYNTH_CHUNK];
+    while (frames > 0) {
+        uint32_t chunk = frames;
+        if (chunk > AUDIOIO_SYNTH_CHUNK) {
+            chunk = AUDIOIO_SYNTH_CHUNK;
+        }
+        memset(mix, 0, chunk * sizeof(int32_t));
+        for (uint8_t v = 0; v < voice_count; v++) {
+            audioio_synth_voice_t* voice = &voices[v];
+            uint32_t done = 0;
+            while (done < chunk && voice->stage != AUDIOIO_SYNTH_OFF) {
+                uint8_t stage = voice->stage;
+                uint32_t count = chunk - done;
+                if (stage != AUDIOIO_SYNTH_SUSTAIN && voice->remaining < count) {
+                    count = voice->remaining;
+                }
+                oscillate(synth, voice, mix + done, count);
+                done += count;
+                if (stage == AUDIOIO_SYNTH_SUSTAIN) {
+                    continue;
+                }
+                voice->remaining -= count;
+                if (voice->remaining == 0) {
+                    // Don't let the rounding of step leave us short of the target.
+                    voice->level = voice->target;
+                    uint8_t next = AUDIOIO_SYNTH_OFF;
+                    if (stage == AUDIOIO_SYNTH_ATTACK) {
+                        next = AUDIOIO_SYNTH_DECAY;
+                    } else if (stage == AUDIOIO_SYNTH_DECAY) {
+                        next = AUDIOIO_SYNTH_SUSTAIN;
+                    }
+                    enter_stage(synth, voice, next);
+                }
+            }
+        }
+        for (uint32_t i = 0; i < chunk; i++) {
+            int32_t sample = mix[i];
+            if (sample > INT16_MAX) {
+                sample = INT16_MAX;
+            } else if (sample < INT16_MIN) {
+                sample = INT16_MIN;
+            }
+            out[i] = sample;
+        }
+        out += chunk;
+        frames -= chunk;
+    }
+}
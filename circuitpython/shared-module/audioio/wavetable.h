@@ -0,0 +1,92 @@
+/*
+ * This file is part of the Micro Python project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_WAVETABLE_H
+#define MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_WAVETABLE_H
+
+#include <stdint.h>
+
+// Wavetable oscillators with ADSR envelopes that render into 16 bit signed
+// mono. Each voice steps a 32 bit phase through a power of two long table and
+// interpolates linearly between its entries.
+
+// A sine wave, AUDIOIO_SYNTH_SINE_BITS long, used when no table is given.
+#define AUDIOIO_SYNTH_SINE_BITS (8)
+extern const int16_t audioio_synth_sine[1 << AUDIOIO_SYNTH_SINE_BITS];
+
+// Longest table, as a power of two, that leaves enough phase bits to interpolate with.
+#define AUDIOIO_SYNTH_MAX_TABLE_BITS (16)
+
+// Voices are mixed this many frames at a time.
+#define AUDIOIO_SYNTH_CHUNK (32)
+
+typedef enum {
+    AUDIOIO_SYNTH_OFF,
+    AUDIOIO_SYNTH_ATTACK,
+    AUDIOIO_SYNTH_DECAY,
+    AUDIOIO_SYNTH_SUSTAIN,
+    AUDIOIO_SYNTH_RELEASE,
+} audioio_synth_stage_t;
+
+typedef struct {
+    const int16_t* table;
+    uint8_t table_bits;     // The table is 1 << table_bits long.
+    // Envelope times are in frames. sustain is the fraction of a voice's level, out of
+    // 1 << 15, held after the decay.
+    uint32_t attack;
+    uint32_t decay;
+    uint16_t sustain;
+    uint32_t release;
+} audioio_synth_t;
+
+typedef struct {
+    uint32_t phase;
+    uint32_t phase_step;    // Added to phase every frame. 1 << 32 is the sample rate.
+    int32_t peak;           // The level at the end of the attack.
+    // The envelope. Levels have 15 more fractional bits than a 1 << 15 unity gain so
+    // 1 << 30 is full volume.
+    int32_t level;
+    int32_t step;           // Added to level every frame of the current stage.
+    int32_t target;         // The level the current stage ends at.
+    uint32_t remaining;     // Frames left in the current stage.
+    // Written last so that a voice is never rendered half changed.
+    volatile uint8_t stage;
+} audioio_synth_voice_t;
+
+// Returns the phase step for frequency, which must be below half the sample rate.
+uint32_t audioio_synth_phase_step(float frequency, uint32_t sample_rate);
+void audioio_synth_voice_clear(audioio_synth_voice_t* voice);
+// Starts the attack from wherever the voice is so pressing a sounding voice doesn't click.
+// level is out of 1 << 15.
+void audioio_synth_press(const audioio_synth_t* synth, audioio_synth_voice_t* voice,
+                         uint32_t phase_step, uint16_t level);
+// Fades the voice out over the release time from its current level.
+void audioio_synth_release(const audioio_synth_t* synth, audioio_synth_voice_t* voice);
+// Mixes the voices into out, replacing what is there, and moves their envelopes on.
+void audioio_synth_render(const audioio_synth_t* synth, audioio_synth_voice_t* voices,
+                          uint8_t voice_count, int16_t* out, uint32_t frames);
+
+#endif // MICROPY_INCLUDED_SHARED_MODULE_AUDIOIO_WAVETABLE_H
@@ -44,6 +44,9 @@ STATIC mp_obj_t mp_vfs_proxy_call(mp_vfs_mount_t *vfs, qstr meth_name, size_t n_
         // can't do operation on root dir
         mp_raise_OSError(MP_EPERM);
     }
+    #if MICROPY_MODULE_IMPORT_CACHE
+    mp_vfs_import_cache_check(meth_name, args);
+    #endif
     mp_obj_t meth[n_args + 2];
     mp_load_method(vfs->obj, meth_name, meth);
     if (args != NULL) {
@@ -0,0 +1,170 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Paul Sokolovsky
+ * Copyright (c) 2017 Scott Shawcroft for Adafruit Industries
+ * Copyright (c) 2017 Michael McWethy
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <string.h>
+
+#include "py/runtime.h"
+#include "py/binary.h"
+#include "shared-bindings/struct/Struct.h"
+#include "shared-module/struct/__init__.h"
+#include "supervisor/shared/translate.h"
+
+size_t shared_modules_struct_struct_count_ops(mp_obj_t fmt_in) {
+    const char *fmt = mp_obj_str_get_str(fmt_in);
+    get_fmt_type(&fmt);
+    size_t n_ops = 0;
+    for (; *fmt; fmt++) {
+        if (!unichar_isdigit(*fmt)) {
+            n_ops++;
+        }
+    }
+    return n_ops;
+}
+
+// Parse the format once into runs of items with their offsets, applying
+// the same alignment rules as calcsize().
+void shared_modules_struct_struct_construct(struct_struct_obj_t *self, mp_obj_t fmt_in) {
+    const char *fmt = mp_obj_str_get_str(fmt_in);
+    self->format = fmt_in;
+    self->fmt_type = get_fmt_type(&fmt);
+    self->size = 0;
+    self->n_items = 0;
+    self->n_ops = 0;
+
+    for (; *fmt; fmt++) {
+        struct_validate_format(*fmt);
+
+        mp_uint_t cnt = 1;
+        if (unichar_isdigit(*fmt)) {
+            cnt = get_fmt_num(&fmt);
+        }
+        if (*fmt == '\0') {
+            mp_raise_ValueError(translate("bad typecode"));
+        }
+
+        struct_op_t *op = &self->ops[self->n_ops];
+        op->typecode = *fmt;
+        op->count = cnt;
+        if (*fmt == 's') {
+            op->size = 1;
+            op->offset = self->size;
+            self->size += cnt;
+            self->n_items++;
+        } else {
+            mp_uint_t align;
+            op->size = mp_binary_get_size(self->fmt_type, *fmt, &align);
+            if (cnt == 0) {
+                continue;
+            }
+            op->offset = (self->size + align - 1) & ~(align - 1);
+            self->size = op->offset + cnt * op->size;
+            self->n_items += cnt;
+        }
+        self->n_ops++;
+    }
+}
+
+// mp_binary_get_val() and mp_binary_set_val() align native ('@') items to
+// the absolute address, so an item of a struct at an unaligned address goes
+// through an aligned copy to keep the layout computed above.
+typedef union {
+    long long q;
+    double d;
+    void *ptr;
+    byte b[8];
+} struct_item_buf_t;
+
+STATIC mp_obj_t struct_get_item(char fmt_type, const struct_op_t *op, const byte *p) {
+    byte *src = (byte *)p;
+    struct_item_buf_t buf;
+    if (fmt_type == '@' && ((uintptr_t)p & (op->size - 1)) != 0) {
+        memcpy(buf.b, p, op->size);
+        src = buf.b;
+    }
+    return mp_binary_get_val(fmt_type, op->typecode, &src);
+}
+
+STATIC void struct_set_item(char fmt_type, const struct_op_t *op, mp_obj_t val, byte *p) {
+    if (fmt_type == '@' && ((uintptr_t)p & (op->size - 1)) != 0) {
+        struct_item_buf_t buf;
+        byte *dest = buf.b;
+        mp_binary_set_val(fmt_type, op->typecode, val, &dest);
+        memcpy(p, buf.b, op->size);
+    } else {
+        mp_binary_set_val(fmt_type, op->typecode, val, &p);
+    }
+}
+
+void shared_modules_struct_struct_pack_into(struct_struct_obj_t *self, byte *p, byte *end_p, size_t n_args, const mp_obj_t *args) {
+    if (n_args > self->n_items) {
+        // more arguments given than used by format string; CPython raises struct.error here
+        mp_raise_RuntimeError(translate("too many arguments provided with the given format"));
+    }
+    if (p + self->size > end_p) {
+        mp_raise_RuntimeError(translate("buffer too small"));
+    }
+
+    size_t i = 0;
+    for (const struct_op_t *op = self->ops; i < n_args; op++) {
+        byte *item = p + op->offset;
+        if (op->typecode == 's') {
+            mp_buffer_info_t bufinfo;
+            mp_get_buffer_raise(args[i++], &bufinfo, MP_BUFFER_READ);
+            mp_uint_t to_copy = op->count;
+            if (bufinfo.len < to_copy) {
+                to_copy = bufinfo.len;
+            }
+            memcpy(item, bufinfo.buf, to_copy);
+            memset(item + to_copy, 0, op->count - to_copy);
+        } else {
+            for (mp_uint_t n = op->count; n > 0 && i < n_args; n--) {
+                struct_set_item(self->fmt_type, op, args[i++], item);
+                item += op->size;
+            }
+        }
+    }
+}
+
+// Store the self->n_items unpacked values in items.
+void shared_modules_struct_struct_unpack_from(struct_struct_obj_t *self, const byte *p, const byte *end_p, mp_obj_t *items) {
+    if (p + self->size > end_p) {
+        mp_raise_RuntimeError(translate("buffer too small"));
+    }
+
+    const struct_op_t *op = self->ops;
+    for (size_t n_ops = self->n_ops; n_ops > 0; n_ops--, op++) {
+        const byte *item = p + op->offset;
+        if (op->typecode == 's') {
+            *items++ = mp_obj_new_bytes(item, op->count);
+        } else {
+            for (mp_uint_t n = op->count; n > 0; n--) {
+                *items++ = struct_get_item(self->fmt_type, op, item);
+                item += op->size;
+            }
+        }
+    }
+}
@@ -31,6 +31,8 @@
 #include "py/runtime.h"
 #include "py/binary.h"
 #include "py/parsenum.h"
+#include "shared-bindings/struct/__init__.h"
+#include "shared-module/struct/__init__.h"
 #include "supervisor/shared/translate.h"
 
 void struct_validate_format(char fmt) {
@@ -0,0 +1,723 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "supervisor/shared/flash_cache.h"
+
+#include <string.h>
+
+#define ALL_BLOCKS ((1 << FLASH_CACHE_BLOCKS_PER_SECTOR) - 1)
+
+// Programs length bytes, a whole number of pages, at a page aligned address
+// that has already been erased. Pages of all 1s are what the erase left so
+// they aren't programmed.
+static bool write_flash(flash_cache_t* self, uint32_t address, const uint8_t* data, uint32_t length) {
+    for (uint32_t offset = 0; offset < length; offset += FLASH_CACHE_PAGE_SIZE) {
+        bool all_ones = true;
+        for (uint16_t i = 0; i < FLASH_CACHE_PAGE_SIZE; i++) {
+            if (data[offset + i] != 0xff) {
+                all_ones = false;
+                break;
+            }
+        }
+        if (!all_ones && !self->flash->program(address + offset, data + offset, FLASH_CACHE_PAGE_SIZE)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// NOR flash programming can only clear bits, so data can be programmed over
+// the page at address without an erase as long as no bit needs to go from 0
+// to 1. This covers pages that are still erased as well as rewrites that only
+// clear bits. Sets *changed when the data differs from what is on the flash.
+static bool page_programmable(flash_cache_t* self, uint32_t address, const uint8_t* data, bool* changed) {
+    uint8_t buffer[FLASH_CACHE_PAGE_SIZE];
+    if (!self->flash->read(address, buffer, FLASH_CACHE_PAGE_SIZE)) {
+        return false;
+    }
+    *changed = false;
+    for (uint16_t i = 0; i < FLASH_CACHE_PAGE_SIZE; i++) {
+        if ((buffer[i] & data[i]) != data[i]) {
+            return false;
+        }
+        if (buffer[i] != data[i]) {
+            *changed = true;
+        }
+    }
+    return true;
+}
+
+// Returns true if the page at address reads back as all 1s.
+static bool page_erased(flash_cache_t* self, uint32_t address) {
+    uint8_t buffer[FLASH_CACHE_PAGE_SIZE];
+    if (!self->flash->read(address, buffer, FLASH_CACHE_PAGE_SIZE)) {
+        return false;
+    }
+    for (uint16_t i = 0; i < FLASH_CACHE_PAGE_SIZE; i++) {
+        if (buffer[i] != 0xff) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool copy_block(flash_cache_t* self, uint32_t src_address, uint32_t dest_address) {
+    // Copy page by page to minimize RAM buffer.
+    uint8_t buffer[FLASH_CACHE_PAGE_SIZE];
+    for (uint32_t i = 0; i < FLASH_CACHE_PAGES_PER_BLOCK; i++) {
+        if (!self->flash->read(src_address + i * FLASH_CACHE_PAGE_SIZE, buffer, FLASH_CACHE_PAGE_SIZE) ||
+            !write_flash(self, dest_address + i * FLASH_CACHE_PAGE_SIZE, buffer, FLASH_CACHE_PAGE_SIZE)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Returns the ram buffer for the given page of a block held by a cache entry.
+static uint8_t* cache_page(flash_cache_t* self, uint8_t entry, uint8_t block_index, uint8_t page) {
+    return self->pages[(entry * FLASH_CACHE_BLOCKS_PER_SECTOR + block_index) * FLASH_CACHE_PAGES_PER_BLOCK + page];
+}
+
+// Returns the cache entry holding the given sector or -1 if it isn't cached.
+static int8_t find_cached_sector(flash_cache_t* self, uint32_t sector) {
+    for (uint8_t i = 0; i < self->sector_count; i++) {
+        if (self->sectors[i].sector == sector) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Returns true if the newest copy of the block at address is in the cache
+// rather than on the flash.
+static bool block_cached(flash_cache_t* self, uint32_t address) {
+    uint32_t sector = address & ~(FLASH_CACHE_ERASE_SIZE - 1);
+    uint8_t block_index = (address / FLASH_CACHE_BLOCK_SIZE) % FLASH_CACHE_BLOCKS_PER_SECTOR;
+    int8_t entry = find_cached_sector(self, sector);
+    return entry >= 0 && (self->sectors[entry].dirty_mask & (1 << block_index)) != 0;
+}
+
+void flash_cache_init(flash_cache_t* self, const flash_cache_flash_t* flash, uint32_t size,
+                      uint32_t scratch_address, flash_journal_t* journal) {
+    self->flash = flash;
+    self->journal = journal;
+    self->size = size;
+    self->scratch_address = scratch_address;
+    self->pages = NULL;
+    for (uint8_t i = 0; i < FLASH_CACHE_MAX_SECTORS; i++) {
+        self->sectors[i].sector = FLASH_CACHE_NO_SECTOR;
+        self->sectors[i].dirty_mask = 0;
+        self->sectors[i].journaled_mask = 0;
+    }
+    self->sector_count = 0;
+    self->lru_clock = 0;
+    self->pre_erase_sector = 0;
+    self->pre_erase_remaining = size / FLASH_CACHE_ERASE_SIZE;
+}
+
+// Flush the cache that was written to the scratch portion of flash. Only used
+// when ram is tight.
+static bool flush_scratch_flash(flash_cache_t* self, flash_cache_sector_t* cached) {
+    // First, copy out any blocks that we haven't touched from the sector we've
+    // cached.
+    for (uint8_t i = 0; i < FLASH_CACHE_BLOCKS_PER_SECTOR; i++) {
+        if ((cached->dirty_mask & (1 << i)) == 0 &&
+            !copy_block(self, cached->sector + i * FLASH_CACHE_BLOCK_SIZE,
+                        self->scratch_address + i * FLASH_CACHE_BLOCK_SIZE)) {
+            // TODO(tannewt): Do more here. We opted to not erase and copy bad
+            // data in. We still risk losing the data written to the scratch
+            // sector.
+            return false;
+        }
+    }
+    // Second, erase the current sector.
+    if (!self->flash->erase(cached->sector)) {
+        return false;
+    }
+    // Finally, copy the new version into it.
+    for (uint8_t i = 0; i < FLASH_CACHE_BLOCKS_PER_SECTOR; i++) {
+        if (!copy_block(self, self->scratch_address + i * FLASH_CACHE_BLOCK_SIZE,
+                        cached->sector + i * FLASH_CACHE_BLOCK_SIZE)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Gives back the ram used by the cache. Sectors that couldn't be written back
+// are dropped with it.
+static void free_ram_cache(flash_cache_t* self) {
+    if (self->pages != NULL) {
+        self->flash->free(self->pages);
+        self->pages = NULL;
+    }
+    for (uint8_t i = 0; i < self->sector_count; i++) {
+        self->sectors[i].sector = FLASH_CACHE_NO_SECTOR;
+    }
+    self->sector_count = 0;
+}
+
+// Returns true if every dirty page of the entry can be programmed over what is
+// already on the flash, and sets a bit in *changed_pages for each page that
+// differs.
+static bool ram_cache_programmable(flash_cache_t* self, uint8_t entry, uint32_t* changed_pages) {
+    flash_cache_sector_t* cached = &self->sectors[entry];
+    *changed_pages = 0;
+    for (uint8_t i = 0; i < FLASH_CACHE_BLOCKS_PER_SECTOR; i++) {
+        if ((cached->dirty_mask & (1 << i)) == 0) {
+            continue;
+        }
+        for (uint8_t j = 0; j < FLASH_CACHE_PAGES_PER_BLOCK; j++) {
+            bool changed = false;
+            if (!page_programmable(self, cached->sector + (i * FLASH_CACHE_PAGES_PER_BLOCK + j) * FLASH_CACHE_PAGE_SIZE,
+                                   cache_page(self, entry, i, j), &changed)) {
+                return false;
+            }
+            if (changed) {
+                *changed_pages |= 1 << (i * FLASH_CACHE_PAGES_PER_BLOCK + j);
+            }
+        }
+    }
+    return true;
+}
+
+// Flush one cached sector from ram onto the flash.
+static bool flush_ram_cache(flash_cache_t* self, uint8_t entry) {
+    flash_cache_sector_t* cached = &self->sectors[entry];
+    // If every dirty page can be programmed over what is already on the flash
+    // we can skip the erase and leave the untouched blocks where they are.
+    uint32_t changed_pages;
+    if (ram_cache_programmable(self, entry, &changed_pages)) {
+        for (uint8_t i = 0; i < FLASH_CACHE_PAGES_PER_SECTOR; i++) {
+            if ((changed_pages & (1 << i)) != 0 &&
+                !write_flash(self, cached->sector + i * FLASH_CACHE_PAGE_SIZE,
+                             cache_page(self, entry, i / FLASH_CACHE_PAGES_PER_BLOCK, i % FLASH_CACHE_PAGES_PER_BLOCK),
+                             FLASH_CACHE_PAGE_SIZE)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // First, copy out any blocks that we haven't touched from the sector
+    // we've cached. If we don't do this we'll erase the data during the sector
+    // erase below.
+    for (uint8_t i = 0; i < FLASH_CACHE_BLOCKS_PER_SECTOR; i++) {
+        if ((cached->dirty_mask & (1 << i)) != 0) {
+            continue;
+        }
+        for (uint8_t j = 0; j < FLASH_CACHE_PAGES_PER_BLOCK; j++) {
+            if (!self->flash->read(cached->sector + (i * FLASH_CACHE_PAGES_PER_BLOCK + j) * FLASH_CACHE_PAGE_SIZE,
+                                   cache_page(self, entry, i, j), FLASH_CACHE_PAGE_SIZE)) {
+                return false;
+            }
+        }
+    }
+    // Second, erase the sector.
+    if (!self->flash->erase(cached->sector)) {
+        return false;
+    }
+    // Lastly, write all the data in ram that we've cached.
+    for (uint8_t i = 0; i < FLASH_CACHE_BLOCKS_PER_SECTOR; i++) {
+        for (uint8_t j = 0; j < FLASH_CACHE_PAGES_PER_BLOCK; j++) {
+            if (!write_flash(self, cached->sector + (i * FLASH_CACHE_PAGES_PER_BLOCK + j) * FLASH_CACHE_PAGE_SIZE,
+                             cache_page(self, entry, i, j), FLASH_CACHE_PAGE_SIZE)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Adds the blocks in mask of a cache entry to the journal transaction. Dirty
+// blocks come from the cache and the rest from the flash.
+static bool journal_blocks(flash_cache_t* self, uint8_t entry, uint32_t mask) {
+    flash_cache_sector_t* cached = &self->sectors[entry];
+    uint8_t buffer[FLASH_CACHE_PAGE_SIZE];
+    for (uint8_t i = 0; i < FLASH_CACHE_BLOCKS_PER_SECTOR; i++) {
+        if ((mask & (1 << i)) == 0) {
+            continue;
+        }
+        uint32_t address = cached->sector + i * FLASH_CACHE_BLOCK_SIZE;
+        flash_journal_add(self->journal, address);
+        for (uint8_t j = 0; j < FLASH_CACHE_PAGES_PER_BLOCK; j++) {
+            const uint8_t* page = buffer;
+            uint32_t page_address = j * FLASH_CACHE_PAGE_SIZE;
+            if ((cached->dirty_mask & (1 << i)) == 0) {
+                page_address += address;
+            } else if (self->pages != NULL) {
+                page = cache_page(self, entry, i, j);
+            } else {
+                page_address += self->scratch_address + i * FLASH_CACHE_BLOCK_SIZE;
+            }
+            if (page == buffer && !self->flash->read(page_address, buffer, FLASH_CACHE_PAGE_SIZE)) {
+                return false;
+            }
+            if (!flash_journal_write(self->journal, page, FLASH_CACHE_PAGE_SIZE)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Commits every dirty block that isn't in the journal yet as one transaction.
+// When erase_entry isn't -1 that entry is about to be erased in place so the
+// rest of its sector goes in as well. When the current half of the journal is
+// full, or new_half is set, the transaction starts the other half with all of
+// the dirty blocks. Returns false if the blocks couldn't be journaled.
+static bool journal_commit(flash_cache_t* self, int8_t erase_entry, bool new_half) {
+    uint32_t masks[FLASH_CACHE_MAX_SECTORS];
+    uint32_t count = 0;
+    for (uint8_t i = 0; i < self->sector_count; i++) {
+        flash_cache_sector_t* cached = &self->sectors[i];
+        masks[i] = 0;
+        if (cached->sector == FLASH_CACHE_NO_SECTOR) {
+            continue;
+        }
+        uint32_t mask = i == erase_entry ? ALL_BLOCKS : cached->dirty_mask;
+        masks[i] = mask & ~cached->journaled_mask;
+        count += __builtin_popcount(masks[i]);
+    }
+    if (count == 0) {
+        return true;
+    }
+    new_half = new_half || !flash_journal_fits(self->journal, count);
+    if (new_half) {
+        count = 0;
+        for (uint8_t i = 0; i < self->sector_count; i++) {
+            if (self->sectors[i].sector == FLASH_CACHE_NO_SECTOR) {
+                continue;
+            }
+            masks[i] = i == erase_entry ? ALL_BLOCKS : self->sectors[i].dirty_mask;
+            count += __builtin_popcount(masks[i]);
+        }
+    }
+    if (!flash_journal_begin(self->journal, count, new_half)) {
+        return false;
+    }
+    for (uint8_t i = 0; i < self->sector_count; i++) {
+        if (masks[i] != 0 && !journal_blocks(self, i, masks[i])) {
+            return false;
+        }
+    }
+    if (!flash_journal_commit(self->journal)) {
+        return false;
+    }
+    for (uint8_t i = 0; i < self->sector_count; i++) {
+        self->sectors[i].journaled_mask = self->sectors[i].dirty_mask;
+    }
+    return true;
+}
+
+// Writes back a single cache entry, delegating to the correct flash flush
+// method depending on the existing cache, and marks the entry free.
+static bool flush_cached_sector(flash_cache_t* self, uint8_t entry) {
+    flash_cache_sector_t* cached = &self->sectors[entry];
+    if (cached->sector == FLASH_CACHE_NO_SECTOR) {
+        return true;
+    }
+    if (self->journal != NULL) {
+        // Everything the write back could lose has to be in the journal first.
+        // Older copies of the blocks are in it, so writing back without a
+        // commit would let a replay put them over the new ones. When the
+        // commit fails a snapshot in the other half is tried instead, and
+        // failing that the sector stays cached. Replays can write back anyway
+        // because the journal still has everything.
+        uint32_t changed_pages;
+        bool erases = self->pages == NULL || !ram_cache_programmable(self, entry, &changed_pages);
+        int8_t erase_entry = erases ? entry : -1;
+        if (!journal_commit(self, erase_entry, false) && !journal_commit(self, erase_entry, true) &&
+            !self->journal->replaying) {
+            return false;
+        }
+    }
+    // If we've cached to the flash itself flush from there. The scratch sector
+    // is single use so we'll try for ram again on the next write.
+    bool ok;
+    if (self->pages == NULL) {
+        ok = flush_scratch_flash(self, cached);
+        self->sector_count = 0;
+    } else {
+        ok = flush_ram_cache(self, entry);
+    }
+    cached->sector = FLASH_CACHE_NO_SECTOR;
+    cached->dirty_mask = 0;
+    cached->journaled_mask = 0;
+    return ok;
+}
+
+bool flash_cache_loaded(flash_cache_t* self) {
+    for (uint8_t i = 0; i < self->sector_count; i++) {
+        if (self->sectors[i].sector != FLASH_CACHE_NO_SECTOR) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool flash_cache_flush(flash_cache_t* self, bool keep_ram) {
+    bool ok = true;
+    for (uint8_t i = 0; i < self->sector_count; i++) {
+        ok = flush_cached_sector(self, i) && ok;
+    }
+    if (!ok && !keep_ram && self->journal != NULL && flash_cache_loaded(self) &&
+        flash_journal_clear(self->journal)) {
+        // The ram has to go but the journal won't take what's left in it.
+        // Rather than lose it, empty the journal so that nothing older can be
+        // replayed over it and write it back as we would without one.
+        flash_journal_t* journal = self->journal;
+        self->journal = NULL;
+        ok = true;
+        for (uint8_t i = 0; i < self->sector_count; i++) {
+            ok = flush_cached_sector(self, i) && ok;
+        }
+        self->journal = journal;
+    }
+    if (!keep_ram) {
+        free_ram_cache(self);
+    }
+    return ok;
+}
+
+bool flash_cache_commit(flash_cache_t* self) {
+    return self->journal != NULL && journal_commit(self, -1, false);
+}
+
+// Picks a cache entry for the given sector. A free entry is used if there is
+// one, otherwise the least recently written sector is flushed to make room.
+// Returns -1 if the sector that had to make room couldn't be written back.
+static int8_t claim_cached_sector(flash_cache_t* self, uint32_t sector) {
+    uint8_t entry = 0;
+    for (uint8_t i = 0; i < self->sector_count; i++) {
+        if (self->sectors[i].sector == FLASH_CACHE_NO_SECTOR) {
+            entry = i;
+            break;
+        }
+        if (self->sectors[i].last_used < self->sectors[entry].last_used) {
+            entry = i;
+        }
+    }
+    if (self->sector_count > 0 && !flush_cached_sector(self, entry)) {
+        return -1;
+    }
+    if (self->sector_count == 0) {
+        entry = 0;
+        self->pages = self->flash->allocate(FLASH_CACHE_MAX_SECTORS, &self->sector_count);
+        if (self->pages == NULL) {
+            if (!self->flash->erase(self->scratch_address)) {
+                return -1;
+            }
+            self->sector_count = 1;
+        }
+    }
+    self->sectors[entry].sector = sector;
+    self->sectors[entry].dirty_mask = 0;
+    self->sectors[entry].journaled_mask = 0;
+    return entry;
+}
+
+static bool read_block(flash_cache_t* self, uint8_t* dest, uint32_t address) {
+    // Mask out the lower bits that designate the address within the sector.
+    uint32_t this_sector = address & ~(FLASH_CACHE_ERASE_SIZE - 1);
+    uint8_t block_index = (address / FLASH_CACHE_BLOCK_SIZE) % FLASH_CACHE_BLOCKS_PER_SECTOR;
+    uint32_t mask = 1 << block_index;
+    // We're reading from a cached sector.
+    int8_t entry = find_cached_sector(self, this_sector);
+    if (entry >= 0 && (mask & self->sectors[entry].dirty_mask) != 0) {
+        if (self->pages == NULL) {
+            return self->flash->read(self->scratch_address + block_index * FLASH_CACHE_BLOCK_SIZE,
+                                     dest, FLASH_CACHE_BLOCK_SIZE);
+        }
+        for (uint8_t i = 0; i < FLASH_CACHE_PAGES_PER_BLOCK; i++) {
+            memcpy(dest + i * FLASH_CACHE_PAGE_SIZE, cache_page(self, entry, block_index, i),
+                   FLASH_CACHE_PAGE_SIZE);
+        }
+        return true;
+    }
+    return self->flash->read(address, dest, FLASH_CACHE_BLOCK_SIZE);
+}
+
+bool flash_cache_read_blocks(flash_cache_t* self, uint8_t* dest, uint32_t block, uint32_t num_blocks) {
+    uint32_t address = block * FLASH_CACHE_BLOCK_SIZE;
+    uint32_t end = address + num_blocks * FLASH_CACHE_BLOCK_SIZE;
+    while (address < end) {
+        if (block_cached(self, address)) {
+            // Cached blocks are handled one at a time.
+            if (!read_block(self, dest, address)) {
+                return false;
+            }
+            dest += FLASH_CACHE_BLOCK_SIZE;
+            address += FLASH_CACHE_BLOCK_SIZE;
+            continue;
+        }
+        // Read the run of blocks that come straight from the flash with a
+        // single read.
+        uint32_t length = FLASH_CACHE_BLOCK_SIZE;
+        while (address + length < end && length < FLASH_CACHE_MAX_READ_BLOCKS * FLASH_CACHE_BLOCK_SIZE &&
+               !block_cached(self, address + length)) {
+            length += FLASH_CACHE_BLOCK_SIZE;
+        }
+        if (!self->flash->read(address, dest, length)) {
+            return false;
+        }
+        dest += length;
+        address += length;
+    }
+    return true;
+}
+
+static bool write_block(flash_cache_t* self, const uint8_t* data, uint32_t address) {
+    // Mask out the lower bits that designate the address within the sector.
+    uint32_t this_sector = address & ~(FLASH_CACHE_ERASE_SIZE - 1);
+    uint8_t block_index = (address / FLASH_CACHE_BLOCK_SIZE) % FLASH_CACHE_BLOCKS_PER_SECTOR;
+    uint32_t mask = 1 << block_index;
+    int8_t entry = find_cached_sector(self, this_sector);
+    if (entry < 0 && self->journal != NULL) {
+        // Programming in place would skip the journal.
+        entry = claim_cached_sector(self, this_sector);
+    } else if (entry < 0) {
+        // Check to see if we can program over what's on the flash, such as
+        // when appending into a pre-erased sector. In that case we can write
+        // directly without touching the rest of the sector.
+        uint8_t changed_pages = 0;
+        bool programmable = true;
+        for (uint8_t i = 0; i < FLASH_CACHE_PAGES_PER_BLOCK && programmable; i++) {
+            bool changed = false;
+            programmable = page_programmable(self, address + i * FLASH_CACHE_PAGE_SIZE,
+                                             data + i * FLASH_CACHE_PAGE_SIZE, &changed);
+            if (changed) {
+                changed_pages |= 1 << i;
+            }
+        }
+        if (programmable) {
+            for (uint8_t i = 0; i < FLASH_CACHE_PAGES_PER_BLOCK; i++) {
+                if ((changed_pages & (1 << i)) != 0 &&
+                    !write_flash(self, address + i * FLASH_CACHE_PAGE_SIZE,
+                                 data + i * FLASH_CACHE_PAGE_SIZE, FLASH_CACHE_PAGE_SIZE)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        entry = claim_cached_sector(self, this_sector);
+    } else if (self->pages == NULL && (mask & self->sectors[entry].dirty_mask) != 0) {
+        // The scratch sector can't be rewritten in place so flush it when we
+        // write the same block again. Rewrites to ram are free.
+        if (!flush_cached_sector(self, entry)) {
+            return false;
+        }
+        entry = claim_cached_sector(self, this_sector);
+    }
+    if (entry < 0) {
+        return false;
+    }
+    flash_cache_sector_t* cached = &self->sectors[entry];
+    cached->dirty_mask |= mask;
+    cached->journaled_mask &= ~mask;
+    cached->last_used = ++self->lru_clock;
+    // Copy the block to the appropriate cache.
+    if (self->pages == NULL) {
+        return write_flash(self, self->scratch_address + block_index * FLASH_CACHE_BLOCK_SIZE,
+                           data, FLASH_CACHE_BLOCK_SIZE);
+    }
+    for (uint8_t i = 0; i < FLASH_CACHE_PAGES_PER_BLOCK; i++) {
+        memcpy(cache_page(self, entry, block_index, i), data + i * FLASH_CACHE_PAGE_SIZE,
+               FLASH_CACHE_PAGE_SIZE);
+    }
+    return true;
+}
+
+// Replaces a whole erase sector with data. Nothing in the sector survives so it
+// doesn't need to go through the cache, and the erase is skipped when the
+// sector has already been pre-erased.
+static bool write_whole_sector(flash_cache_t* self, uint32_t sector, const uint8_t* data) {
+    int8_t entry = find_cached_sector(self, sector);
+    if (entry >= 0) {
+        // Drop the stale cached copy. The scratch sector is single use.
+        self->sectors[entry].sector = FLASH_CACHE_NO_SECTOR;
+        self->sectors[entry].dirty_mask = 0;
+        if (self->pages == NULL) {
+            self->sector_count = 0;
+        }
+    }
+    bool erased = true;
+    for (uint8_t i = 0; i < FLASH_CACHE_PAGES_PER_SECTOR && erased; i++) {
+        erased = page_erased(self, sector + i * FLASH_CACHE_PAGE_SIZE);
+    }
+    if (!erased && !self->flash->erase(sector)) {
+        return false;
+    }
+    return write_flash(self, sector, data, FLASH_CACHE_ERASE_SIZE);
+}
+
+bool flash_cache_write_blocks(flash_cache_t* self, const uint8_t* src, uint32_t block, uint32_t num_blocks) {
+    // Writes change which clusters are free, so start pre-erasing from
+    // scratch.
+    self->pre_erase_remaining = self->size / FLASH_CACHE_ERASE_SIZE;
+    uint32_t address = block * FLASH_CACHE_BLOCK_SIZE;
+    uint32_t end = address + num_blocks * FLASH_CACHE_BLOCK_SIZE;
+    while (address < end) {
+        // USB mass storage hands over whole sectors when it can. A journal
+        // has to see every block so they go through the cache then.
+        if (self->journal == NULL && address % FLASH_CACHE_ERASE_SIZE == 0 &&
+            end - address >= FLASH_CACHE_ERASE_SIZE) {
+            if (!write_whole_sector(self, address, src)) {
+                return false;
+            }
+            src += FLASH_CACHE_ERASE_SIZE;
+            address += FLASH_CACHE_ERASE_SIZE;
+            continue;
+        }
+        if (!write_block(self, src, address)) {
+            return false;
+        }
+        src += FLASH_CACHE_BLOCK_SIZE;
+        address += FLASH_CACHE_BLOCK_SIZE;
+    }
+    return true;
+}
+
+bool flash_cache_replay_block(flash_cache_t* self, uint32_t address, uint32_t journal_address) {
+    // Puts a block from the journal back in place unless it's there already.
+    // It goes through the cache like any other write and is marked as
+    // journaled since the journal has it.
+    uint8_t journaled[FLASH_CACHE_BLOCK_SIZE];
+    uint8_t current[FLASH_CACHE_BLOCK_SIZE];
+    if (!self->flash->read(journal_address, journaled, FLASH_CACHE_BLOCK_SIZE) ||
+        !read_block(self, current, address)) {
+        return false;
+    }
+    if (memcmp(journaled, current, FLASH_CACHE_BLOCK_SIZE) == 0) {
+        return true;
+    }
+    if (!write_block(self, journaled, address)) {
+        return false;
+    }
+    int8_t entry = find_cached_sector(self, address & ~(FLASH_CACHE_ERASE_SIZE - 1));
+    if (entry >= 0) {
+        self->sectors[entry].journaled_mask |= 1 << ((address / FLASH_CACHE_BLOCK_SIZE) % FLASH_CACHE_BLOCKS_PER_SECTOR);
+    }
+    return true;
+}
+
+typedef struct {
+    flash_cache_t* cache;
+    FATFS* fs;
+    uint32_t first_block;
+    uint32_t sector;
+    uint8_t block[FLASH_CACHE_BLOCK_SIZE];
+} fat_reader_t;
+
+// Reads a byte of the first FAT. FatFs may hold a newer, unwritten copy of a
+// FAT sector in its window so that is used when it covers the byte.
+static bool read_fat_byte(fat_reader_t* reader, uint32_t offset, uint8_t* value) {
+    FATFS* fs = reader->fs;
+    uint32_t sector = fs->fatbase + offset / FLASH_CACHE_BLOCK_SIZE;
+    if (sector == fs->winsect) {
+        *value = fs->win[offset % FLASH_CACHE_BLOCK_SIZE];
+        return true;
+    }
+    if (sector != reader->sector) {
+        if (sector < reader->first_block ||
+            !read_block(reader->cache, reader->block, (sector - reader->first_block) * FLASH_CACHE_BLOCK_SIZE)) {
+            return false;
+        }
+        reader->sector = sector;
+    }
+    *value = reader->block[offset % FLASH_CACHE_BLOCK_SIZE];
+    return true;
+}
+
+// Returns true if the FAT marks the cluster free. Errors count as in use.
+static bool cluster_free(fat_reader_t* reader, uint32_t cluster) {
+    uint32_t offset;
+    uint8_t entry_size;
+    switch (reader->fs->fs_type) {
+        case FS_FAT12: offset = cluster + cluster / 2; entry_size = 2; break;
+        case FS_FAT16: offset = cluster * 2; entry_size = 2; break;
+        case FS_FAT32: offset = cluster * 4; entry_size = 4; break;
+        default: return false;
+    }
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < entry_size; i++) {
+        uint8_t b;
+        if (!read_fat_byte(reader, offset + i, &b)) {
+            return false;
+        }
+        value |= (uint32_t) b << (8 * i);
+    }
+    if (reader->fs->fs_type == FS_FAT12) {
+        value = (cluster & 1) ? value >> 4 : value & 0xfff;
+    } else if (reader->fs->fs_type == FS_FAT32) {
+        value &= 0x0fffffff;
+    }
+    return value == 0;
+}
+
+bool flash_cache_pre_erase_pending(flash_cache_t* self) {
+    return self->pre_erase_remaining > 0;
+}
+
+void flash_cache_pre_erase_next(flash_cache_t* self, FATFS* fs, uint32_t first_block) {
+    // Skip a turn while the last erase is still going.
+    if (self->pre_erase_remaining == 0 || self->journal != NULL || fs->fs_type == 0 ||
+        self->flash->busy()) {
+        return;
+    }
+    uint32_t sector = self->pre_erase_sector;
+    self->pre_erase_sector += FLASH_CACHE_ERASE_SIZE;
+    if (self->pre_erase_sector >= self->size) {
+        self->pre_erase_sector = 0;
+    }
+    self->pre_erase_remaining--;
+
+    if (find_cached_sector(self, sector) >= 0) {
+        return;
+    }
+    fat_reader_t reader;
+    reader.cache = self;
+    reader.fs = fs;
+    reader.first_block = first_block;
+    reader.sector = FLASH_CACHE_NO_SECTOR;
+    uint32_t block = first_block + sector / FLASH_CACHE_BLOCK_SIZE;
+    for (uint8_t i = 0; i < FLASH_CACHE_BLOCKS_PER_SECTOR; i++, block++) {
+        if (block < fs->database) {
+            return;
+        }
+        uint32_t cluster = (block - fs->database) / fs->csize + 2;
+        if (cluster >= fs->n_fatent || !cluster_free(&reader, cluster)) {
+            return;
+        }
+    }
+    for (uint8_t i = 0; i < FLASH_CACHE_PAGES_PER_SECTOR; i++) {
+        if (!page_erased(self, sector + i * FLASH_CACHE_PAGE_SIZE)) {
+            // The erase runs in the background. Every other flash access
+            // waits for it to finish.
+            self->flash->erase(sector);
+            return;
+        }
+    }
+}
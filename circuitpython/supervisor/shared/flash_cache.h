@@ -0,0 +1,167 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SUPERVISOR_SHARED_FLASH_CACHE_H
+#define MICROPY_INCLUDED_SUPERVISOR_SHARED_FLASH_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lib/oofatfs/ff.h"
+#include "supervisor/shared/flash_journal.h"
+
+// A write-back cache for filesystem blocks stored in place on NOR flash,
+// which can only clear bits when programming and can only set them again by
+// erasing a whole sector.
+//
+// Blocks written to a sector are collected in ram and the sector is read
+// back, erased and rewritten once when it leaves the cache. Up to
+// FLASH_CACHE_MAX_SECTORS sectors are cached and the least recently written
+// one is written back to make room. Without ram the cache holds one sector in
+// a spare scratch sector of the flash instead.
+//
+// A write that only clears bits is programmed in place without an erase, and
+// so is a sector write-back when all of its dirty pages allow it. Sectors
+// whose clusters the FAT marks free can be erased ahead of time so that file
+// data written there later doesn't need an erase.
+//
+// With a journal, everything a write-back could lose is committed to it
+// first so that power loss part way through can be recovered from.
+
+#define FLASH_CACHE_BLOCK_SIZE (512)
+
+// These are common across all NOR flash.
+#define FLASH_CACHE_PAGE_SIZE (256)
+#define FLASH_CACHE_ERASE_SIZE (1 << 12)
+
+#define FLASH_CACHE_BLOCKS_PER_SECTOR (FLASH_CACHE_ERASE_SIZE / FLASH_CACHE_BLOCK_SIZE)
+#define FLASH_CACHE_PAGES_PER_BLOCK (FLASH_CACHE_BLOCK_SIZE / FLASH_CACHE_PAGE_SIZE)
+#define FLASH_CACHE_PAGES_PER_SECTOR (FLASH_CACHE_BLOCKS_PER_SECTOR * FLASH_CACHE_PAGES_PER_BLOCK)
+
+// Maximum number of erase sectors held in ram. Fewer are used when allocate
+// can't find room for all of them.
+#ifndef FLASH_CACHE_MAX_SECTORS
+#define FLASH_CACHE_MAX_SECTORS (4)
+#endif
+
+// Most blocks read with one call to read. A single DMA transfer moves at most
+// 65535 bytes.
+#ifndef FLASH_CACHE_MAX_READ_BLOCKS
+#define FLASH_CACHE_MAX_READ_BLOCKS (0xffff / FLASH_CACHE_BLOCK_SIZE)
+#endif
+
+// Raw access to the flash underneath the cache. Addresses are absolute.
+typedef struct {
+    // Reads once any program or erase in progress has finished.
+    bool (*read)(uint32_t address, uint8_t* data, uint32_t length);
+    // May be given any length and only needs to clear bits, it is never asked
+    // to set them.
+    bool (*program)(uint32_t address, const uint8_t* data, uint32_t length);
+    // Starts erasing the sector at address and doesn't wait for it to finish.
+    bool (*erase)(uint32_t address);
+    // Returns true while the flash is still programming or erasing.
+    bool (*busy)(void);
+    // Finds ram for the page buffers of up to max_sectors sectors. Returns a
+    // table of FLASH_CACHE_PAGES_PER_SECTOR page pointers per sector and sets
+    // *sectors, or returns NULL if there isn't room for one sector.
+    uint8_t** (*allocate)(uint8_t max_sectors, uint8_t* sectors);
+    // Gives back the ram from allocate.
+    void (*free)(uint8_t** pages);
+} flash_cache_flash_t;
+
+typedef struct {
+    // Address of the cached sector or FLASH_CACHE_NO_SECTOR when the entry is free.
+    uint32_t sector;
+    // Track which blocks (up to 32) in the sector currently live in the cache.
+    uint32_t dirty_mask;
+    // The dirty blocks whose current contents are in the journal.
+    uint32_t journaled_mask;
+    // Value of lru_clock when the entry was last written. Smallest is evicted.
+    uint32_t last_used;
+} flash_cache_sector_t;
+
+#define FLASH_CACHE_NO_SECTOR (0xffffffff)
+
+typedef struct {
+    const flash_cache_flash_t* flash;
+    flash_journal_t* journal;   // NULL when blocks aren't journaled.
+    uint32_t size;              // Bytes of blocks, starting at address 0.
+    uint32_t scratch_address;   // Spare erase sector used when there's no ram.
+    // Page buffers of the ram cache. Entry i owns pages
+    // [i * FLASH_CACHE_PAGES_PER_SECTOR, (i + 1) * FLASH_CACHE_PAGES_PER_SECTOR).
+    // NULL while the scratch sector is the cache.
+    uint8_t** pages;
+    flash_cache_sector_t sectors[FLASH_CACHE_MAX_SECTORS];
+    // Number of usable entries in sectors. Only the first entry is used when
+    // the cache lives in the scratch sector.
+    uint8_t sector_count;
+    uint32_t lru_clock;
+    // The next sector to consider for pre-erasing and how many sectors are
+    // left to look at before we've covered the whole flash since the last
+    // write.
+    uint32_t pre_erase_sector;
+    uint32_t pre_erase_remaining;
+} flash_cache_t;
+
+// Sets up an empty cache for size bytes of blocks. The scratch sector and the
+// journal, if there is one, must lie outside of them.
+void flash_cache_init(flash_cache_t* self, const flash_cache_flash_t* flash, uint32_t size,
+                      uint32_t scratch_address, flash_journal_t* journal);
+
+// Blocks are numbered from address 0 and each call returns false on error.
+bool flash_cache_read_blocks(flash_cache_t* self, uint8_t* dest, uint32_t block, uint32_t num_blocks);
+bool flash_cache_write_blocks(flash_cache_t* self, const uint8_t* src, uint32_t block, uint32_t num_blocks);
+
+// Returns true if any sector is held in the cache.
+bool flash_cache_loaded(flash_cache_t* self);
+
+// Writes back every cached sector. The ram is given back unless keep_ram is
+// true. With a journal, a sector whose blocks can't be committed to it first
+// stays cached and false is returned. If the ram has to go, the journal is
+// emptied instead and everything is written back without it.
+bool flash_cache_flush(flash_cache_t* self, bool keep_ram);
+
+// Makes everything written so far survive a reset by committing it to the
+// journal, and the cache is written back in place later. Returns false when
+// there is no journal or the commit failed, and then the cache has to be
+// flushed instead.
+bool flash_cache_commit(flash_cache_t* self);
+
+// Puts a block found by flash_journal_init back through the cache. Use it
+// from the flash_journal_replay_t callback.
+bool flash_cache_replay_block(flash_cache_t* self, uint32_t address, uint32_t journal_address);
+
+// Returns true while there are sectors left to consider for pre-erasing.
+bool flash_cache_pre_erase_pending(flash_cache_t* self);
+
+// Looks at the next sector and starts erasing it if the FAT of fs marks all
+// of its blocks free and it isn't erased already. File data later written
+// there can then be programmed without an erase. first_block is the block
+// number fs uses for block 0 of the cache. Pre-erases aren't journaled so this
+// does nothing with a journal.
+void flash_cache_pre_erase_next(flash_cache_t* self, FATFS* fs, uint32_t first_block);
+
+#endif  // MICROPY_INCLUDED_SUPERVISOR_SHARED_FLASH_CACHE_H
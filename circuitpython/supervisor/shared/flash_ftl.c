@@ -0,0 +1,256 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "supervisor/shared/flash_ftl.h"
+
+#include <string.h>
+
+#define FLASH_FTL_MAGIC (0x4c544643) // "CFTL"
+
+#define SLOTS_PER_SEGMENT (FLASH_FTL_SEGMENT_SIZE / FLASH_FTL_BLOCK_SIZE)
+// The first slot of every segment holds its summary.
+#define DATA_SLOTS_PER_SEGMENT (SLOTS_PER_SEGMENT - 1)
+
+// Segments that don't count towards the filesystem's capacity: the open one,
+// one kept free so garbage collection always has somewhere to copy to, and one
+// more so that there is always a segment with a stale block to collect.
+#define SPARE_SEGMENTS (3)
+
+#define UNMAPPED (0xffff)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t sequence;
+    // Logical block held by each data slot, UNMAPPED if the slot is unused.
+    uint16_t block[DATA_SLOTS_PER_SEGMENT];
+} segment_summary_t;
+
+static uint32_t slot_address(uint32_t slot) {
+    return (slot / SLOTS_PER_SEGMENT) * FLASH_FTL_SEGMENT_SIZE + (slot % SLOTS_PER_SEGMENT) * FLASH_FTL_BLOCK_SIZE;
+}
+
+size_t flash_ftl_ram_size(uint32_t flash_size) {
+    uint32_t segment_count = flash_size / FLASH_FTL_SEGMENT_SIZE;
+    if (segment_count <= SPARE_SEGMENTS) {
+        return 0;
+    }
+    uint32_t block_count = (segment_count - SPARE_SEGMENTS) * DATA_SLOTS_PER_SEGMENT;
+    size_t size = segment_count * (sizeof(uint32_t) + sizeof(uint8_t)) + block_count * sizeof(uint16_t);
+    // Round up to whole words.
+    return (size + 3) & ~3;
+}
+
+bool flash_ftl_init(flash_ftl_t* self, const flash_ftl_flash_t* flash, uint32_t flash_size, void* ram) {
+    self->flash = flash;
+    self->segment_count = flash_size / FLASH_FTL_SEGMENT_SIZE;
+    if (self->segment_count <= SPARE_SEGMENTS ||
+        self->segment_count * SLOTS_PER_SEGMENT >= UNMAPPED ||
+        FLASH_FTL_SEGMENT_SIZE % flash->erase_size != 0) {
+        return false;
+    }
+    self->block_count = (self->segment_count - SPARE_SEGMENTS) * DATA_SLOTS_PER_SEGMENT;
+    self->sequences = ram;
+    self->map = (uint16_t*) (self->sequences + self->segment_count);
+    self->live = (uint8_t*) (self->map + self->block_count);
+    memset(self->map, 0xff, self->block_count * sizeof(uint16_t));
+    memset(self->live, 0, self->segment_count);
+    self->sequence = 0;
+    self->open_segment = self->segment_count - 1;
+    self->blocks_written = 0;
+    self->blocks_programmed = 0;
+    self->segments_erased = 0;
+
+    for (uint32_t segment = 0; segment < self->segment_count; segment++) {
+        segment_summary_t summary;
+        if (!flash->read(segment * FLASH_FTL_SEGMENT_SIZE, (uint8_t*) &summary, sizeof(summary))) {
+            return false;
+        }
+        if (summary.magic != FLASH_FTL_MAGIC) {
+            self->sequences[segment] = 0;
+            continue;
+        }
+        self->sequences[segment] = summary.sequence;
+        if (summary.sequence > self->sequence) {
+            self->sequence = summary.sequence;
+            self->open_segment = segment;
+        }
+        for (uint32_t i = 0; i < DATA_SLOTS_PER_SEGMENT; i++) {
+            uint16_t block = summary.block[i];
+            if (block >= self->block_count) {
+                continue;
+            }
+            // Keep the copy from the newest segment. Within a segment later
+            // slots are newer.
+            uint16_t current = self->map[block];
+            if (current == UNMAPPED ||
+                self->sequences[current / SLOTS_PER_SEGMENT] <= summary.sequence) {
+                self->map[block] = segment * SLOTS_PER_SEGMENT + i + 1;
+            }
+        }
+    }
+    for (uint32_t block = 0; block < self->block_count; block++) {
+        if (self->map[block] != UNMAPPED) {
+            self->live[self->map[block] / SLOTS_PER_SEGMENT]++;
+        }
+    }
+    // We don't know how far the newest segment got before we were reset so
+    // start a new one on the first write.
+    self->next_slot = SLOTS_PER_SEGMENT;
+    return true;
+}
+
+static bool segment_free(flash_ftl_t* self, uint32_t segment) {
+    return segment != self->open_segment && self->live[segment] == 0;
+}
+
+static uint32_t free_segment_count(flash_ftl_t* self) {
+    uint32_t count = 0;
+    for (uint32_t segment = 0; segment < self->segment_count; segment++) {
+        if (segment_free(self, segment)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// Erases the next free segment and starts appending to it. We go round robin
+// so that erases are spread evenly over the flash.
+static bool open_segment(flash_ftl_t* self) {
+    uint32_t segment = self->open_segment;
+    uint32_t i;
+    for (i = 0; i < self->segment_count; i++) {
+        segment = (segment + 1) % self->segment_count;
+        if (segment_free(self, segment)) {
+            break;
+        }
+    }
+    if (i == self->segment_count) {
+        return false;
+    }
+    uint32_t address = segment * FLASH_FTL_SEGMENT_SIZE;
+    for (uint32_t offset = 0; offset < FLASH_FTL_SEGMENT_SIZE; offset += self->flash->erase_size) {
+        if (!self->flash->erase(address + offset)) {
+            return false;
+        }
+    }
+    self->segments_erased++;
+    uint32_t header[2] = {FLASH_FTL_MAGIC, self->sequence + 1};
+    if (!self->flash->program(address, (const uint8_t*) header, sizeof(header))) {
+        return false;
+    }
+    self->sequence++;
+    self->sequences[segment] = self->sequence;
+    self->open_segment = segment;
+    self->next_slot = 1;
+    return true;
+}
+
+// Appends a copy of the block to the open segment and points the map at it.
+static bool append_block(flash_ftl_t* self, uint32_t block, const uint8_t* src) {
+    if (self->next_slot == SLOTS_PER_SEGMENT && !open_segment(self)) {
+        return false;
+    }
+    uint32_t slot = self->open_segment * SLOTS_PER_SEGMENT + self->next_slot;
+    uint32_t entry_address = self->open_segment * FLASH_FTL_SEGMENT_SIZE +
+        offsetof(segment_summary_t, block) + (self->next_slot - 1) * sizeof(uint16_t);
+    uint16_t entry = block;
+    // Use up the slot even if programming fails part way.
+    self->next_slot++;
+    if (!self->flash->program(slot_address(slot), src, FLASH_FTL_BLOCK_SIZE) ||
+        !self->flash->program(entry_address, (const uint8_t*) &entry, sizeof(entry))) {
+        return false;
+    }
+    self->blocks_programmed++;
+    if (self->map[block] != UNMAPPED) {
+        self->live[self->map[block] / SLOTS_PER_SEGMENT]--;
+    }
+    self->map[block] = slot;
+    self->live[self->open_segment]++;
+    return true;
+}
+
+// Moves the current blocks out of the segment with the fewest of them so that
+// it can be reused.
+static bool collect_garbage(flash_ftl_t* self) {
+    uint32_t victim = self->segment_count;
+    uint8_t least = DATA_SLOTS_PER_SEGMENT;
+    for (uint32_t segment = 0; segment < self->segment_count; segment++) {
+        if (segment == self->open_segment || self->live[segment] == 0) {
+            continue;
+        }
+        if (self->live[segment] < least) {
+            least = self->live[segment];
+            victim = segment;
+        }
+    }
+    if (victim == self->segment_count) {
+        return false;
+    }
+    segment_summary_t summary;
+    if (!self->flash->read(victim * FLASH_FTL_SEGMENT_SIZE, (uint8_t*) &summary, sizeof(summary))) {
+        return false;
+    }
+    uint8_t buffer[FLASH_FTL_BLOCK_SIZE];
+    for (uint32_t i = 0; i < DATA_SLOTS_PER_SEGMENT && self->live[victim] > 0; i++) {
+        uint16_t block = summary.block[i];
+        uint32_t slot = victim * SLOTS_PER_SEGMENT + i + 1;
+        if (block >= self->block_count || self->map[block] != slot) {
+            continue;
+        }
+        if (!self->flash->read(slot_address(slot), buffer, FLASH_FTL_BLOCK_SIZE) ||
+            !append_block(self, block, buffer)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool flash_ftl_read_block(flash_ftl_t* self, uint8_t* dest, uint32_t block) {
+    if (block >= self->block_count) {
+        return false;
+    }
+    if (self->map[block] == UNMAPPED) {
+        // Never written so it reads like erased flash.
+        memset(dest, 0xff, FLASH_FTL_BLOCK_SIZE);
+        return true;
+    }
+    return self->flash->read(slot_address(self->map[block]), dest, FLASH_FTL_BLOCK_SIZE);
+}
+
+bool flash_ftl_write_block(flash_ftl_t* self, const uint8_t* src, uint32_t block) {
+    if (block >= self->block_count) {
+        return false;
+    }
+    // Only open a new segment while another one is left free for garbage
+    // collection to copy into.
+    while (self->next_slot == SLOTS_PER_SEGMENT && free_segment_count(self) < 2) {
+        if (!collect_garbage(self)) {
+            return false;
+        }
+    }
+    self->blocks_written++;
+    return append_block(self, block, src);
+}
@@ -0,0 +1,89 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SUPERVISOR_SHARED_FLASH_FTL_H
+#define MICROPY_INCLUDED_SUPERVISOR_SHARED_FLASH_FTL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// A log-structured flash translation layer. Filesystem blocks are never
+// rewritten in place. Each write appends the block to the currently open
+// segment and remaps it, and garbage collection reclaims segments whose
+// blocks have been superseded. This spreads erases over the whole flash and
+// turns FAT and directory updates into programs instead of erases.
+//
+// Each segment starts with a summary block that holds a sequence number and
+// the logical block stored in each of the following slots. Slot entries are
+// programmed after the slot's data so a block only shows up once it has been
+// completely written. On init the summaries are replayed and the newest copy
+// of each block wins.
+
+#define FLASH_FTL_BLOCK_SIZE (512)
+
+// Must be a multiple of the flash's erase size.
+#ifndef FLASH_FTL_SEGMENT_SIZE
+#define FLASH_FTL_SEGMENT_SIZE (16 * 1024)
+#endif
+
+// Raw access to the flash underneath the FTL. Addresses are relative to the
+// start of the area the FTL manages. program may be given any length and only
+// needs to clear bits, it is never asked to set them.
+typedef struct {
+    bool (*read)(uint32_t address, uint8_t* data, uint32_t length);
+    bool (*program)(uint32_t address, const uint8_t* data, uint32_t length);
+    bool (*erase)(uint32_t address);
+    uint32_t erase_size;
+} flash_ftl_flash_t;
+
+typedef struct {
+    const flash_ftl_flash_t* flash;
+    uint32_t* sequences;    // Sequence number of each segment, 0 when unused.
+    uint16_t* map;          // Physical slot of each logical block.
+    uint8_t* live;          // Number of current blocks in each segment.
+    uint32_t segment_count;
+    uint32_t block_count;   // Logical blocks exposed to the filesystem.
+    uint32_t sequence;      // Sequence number of the open segment.
+    uint32_t open_segment;
+    uint32_t next_slot;     // Next unused slot in the open segment.
+    // Statistics for measuring write amplification.
+    uint32_t blocks_written;
+    uint32_t blocks_programmed;
+    uint32_t segments_erased;
+} flash_ftl_t;
+
+// Returns how much RAM flash_ftl_init needs for a flash of the given size.
+size_t flash_ftl_ram_size(uint32_t flash_size);
+
+// Replays the segment summaries to rebuild the mapping table in ram, which
+// must be at least flash_ftl_ram_size bytes and word aligned.
+bool flash_ftl_init(flash_ftl_t* self, const flash_ftl_flash_t* flash, uint32_t flash_size, void* ram);
+
+bool flash_ftl_read_block(flash_ftl_t* self, uint8_t* dest, uint32_t block);
+bool flash_ftl_write_block(flash_ftl_t* self, const uint8_t* src, uint32_t block);
+
+#endif  // MICROPY_INCLUDED_SUPERVISOR_SHARED_FLASH_FTL_H
@@ -0,0 +1,293 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "supervisor/shared/flash_journal.h"
+
+#include <string.h>
+
+#define FLASH_JOURNAL_MAGIC (0x4c4e524a) // "JRNL"
+
+// 32 bit FNV-1a over the blocks and then the header.
+#define CHECKSUM_START (0x811c9dc5)
+#define CHECKSUM_PRIME (0x01000193)
+
+// Size of the pieces the journal is read in.
+#define CHUNK_SIZE (256)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t sequence;
+    uint32_t count;
+    uint32_t checksum;
+    uint32_t address[FLASH_JOURNAL_MAX_BLOCKS];
+} transaction_header_t;
+
+static uint32_t checksum(uint32_t hash, const uint8_t* data, uint32_t length) {
+    for (uint32_t i = 0; i < length; i++) {
+        hash = (hash ^ data[i]) * CHECKSUM_PRIME;
+    }
+    return hash;
+}
+
+static uint32_t header_checksum(uint32_t hash, const transaction_header_t* header) {
+    hash = checksum(hash, (const uint8_t*) &header->sequence, sizeof(header->sequence) + sizeof(header->count));
+    return checksum(hash, (const uint8_t*) header->address, header->count * sizeof(uint32_t));
+}
+
+static uint32_t slot_address(flash_journal_t* self, uint8_t half, uint32_t slot) {
+    return self->address + (half * self->half_slots + slot) * FLASH_JOURNAL_BLOCK_SIZE;
+}
+
+// Returns true if the length bytes at address read as erased.
+static bool erased(flash_journal_t* self, uint32_t address, uint32_t length) {
+    uint8_t buffer[CHUNK_SIZE];
+    for (uint32_t offset = 0; offset < length; offset += CHUNK_SIZE) {
+        if (!self->flash->read(address + offset, buffer, CHUNK_SIZE)) {
+            return false;
+        }
+        for (uint32_t i = 0; i < CHUNK_SIZE; i++) {
+            if (buffer[i] != 0xff) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Reads the header in the given slot and checks it against the blocks that
+// follow it. A transaction that was cut short fails the check.
+static bool read_transaction(flash_journal_t* self, uint8_t half, uint32_t slot, transaction_header_t* header) {
+    if (!self->flash->read(slot_address(self, half, slot), (uint8_t*) header, sizeof(*header)) ||
+        header->magic != FLASH_JOURNAL_MAGIC ||
+        header->count > FLASH_JOURNAL_MAX_BLOCKS ||
+        slot + 1 + header->count > self->half_slots) {
+        return false;
+    }
+    uint8_t buffer[CHUNK_SIZE];
+    uint32_t hash = CHECKSUM_START;
+    uint32_t address = slot_address(self, half, slot + 1);
+    for (uint32_t offset = 0; offset < header->count * FLASH_JOURNAL_BLOCK_SIZE; offset += CHUNK_SIZE) {
+        if (!self->flash->read(address + offset, buffer, CHUNK_SIZE)) {
+            return false;
+        }
+        hash = checksum(hash, buffer, CHUNK_SIZE);
+    }
+    return header_checksum(hash, header) == header->checksum;
+}
+
+// Returns the slot of the first committed transaction at or after slot, or
+// half_slots if there isn't one. Slots left behind by a transaction that was
+// cut short are skipped over. Unless any_sequence is set the transaction must
+// have the given sequence number.
+static uint32_t next_transaction(flash_journal_t* self, uint8_t half, uint32_t slot,
+                                 bool any_sequence, uint32_t sequence, transaction_header_t* header) {
+    for (; slot < self->half_slots; slot++) {
+        if (read_transaction(self, half, slot, header) &&
+            (any_sequence || header->sequence == sequence)) {
+            return slot;
+        }
+    }
+    return self->half_slots;
+}
+
+bool flash_journal_init(flash_journal_t* self, const flash_journal_flash_t* flash, uint32_t address, uint32_t size) {
+    self->flash = flash;
+    self->address = address;
+    self->half_slots = size / 2 / FLASH_JOURNAL_BLOCK_SIZE;
+    if (size % (2 * flash->erase_size) != 0 || self->half_slots < 2) {
+        return false;
+    }
+    self->replaying = false;
+    self->snapshot_pending = false;
+    self->transactions = 0;
+    self->blocks_journaled = 0;
+    self->sectors_erased = 0;
+    self->clears = 0;
+
+    // Switching halves erases the other half before anything goes into it, so
+    // whatever is left of the older half has lower sequence numbers.
+    transaction_header_t header;
+    bool found = false;
+    self->half = 0;
+    self->sequence = 1;
+    for (uint8_t half = 0; half < 2; half++) {
+        if (next_transaction(self, half, 0, true, 0, &header) < self->half_slots &&
+            (!found || header.sequence > self->sequence)) {
+            found = true;
+            self->half = half;
+            self->sequence = header.sequence;
+        }
+    }
+    // Follow the chain of transactions in the current half.
+    self->replay_end = 0;
+    uint32_t slot = 0;
+    while (found &&
+           (slot = next_transaction(self, self->half, slot, false, self->sequence, &header)) < self->half_slots) {
+        slot += 1 + header.count;
+        self->replay_end = slot;
+        self->sequence++;
+    }
+    // Only append where the flash is still erased. Anything after the last
+    // transaction was left behind by one that was cut short.
+    self->next_slot = self->half_slots;
+    while (self->next_slot > self->replay_end &&
+           erased(self, slot_address(self, self->half, self->next_slot - 1), FLASH_JOURNAL_BLOCK_SIZE)) {
+        self->next_slot--;
+    }
+    return true;
+}
+
+bool flash_journal_replay(flash_journal_t* self, flash_journal_replay_t replay) {
+    self->replaying = true;
+    bool ok = true;
+    transaction_header_t header;
+    uint32_t slot = next_transaction(self, self->half, 0, true, 0, &header);
+    while (ok && slot < self->replay_end) {
+        for (uint32_t i = 0; i < header.count && ok; i++) {
+            ok = replay(header.address[i], slot_address(self, self->half, slot + 1 + i));
+        }
+        slot = next_transaction(self, self->half, slot + 1 + header.count, false, header.sequence + 1, &header);
+    }
+    self->replaying = false;
+    return ok;
+}
+
+static bool room_for(flash_journal_t* self, uint32_t count) {
+    return self->next_slot + 1 + count <= self->half_slots;
+}
+
+bool flash_journal_fits(flash_journal_t* self, uint32_t count) {
+    return !self->snapshot_pending && room_for(self, count);
+}
+
+// Erases the given half and starts appending to it. Sectors that are already
+// erased are left alone.
+static bool start_half(flash_journal_t* self, uint8_t half) {
+    uint32_t half_size = self->half_slots * FLASH_JOURNAL_BLOCK_SIZE;
+    for (uint32_t offset = 0; offset < half_size; offset += self->flash->erase_size) {
+        uint32_t address = slot_address(self, half, 0) + offset;
+        if (erased(self, address, self->flash->erase_size)) {
+            continue;
+        }
+        if (!self->flash->erase(address)) {
+            return false;
+        }
+        self->sectors_erased++;
+    }
+    self->half = half;
+    self->next_slot = 0;
+    self->snapshot_pending = true;
+    return true;
+}
+
+bool flash_journal_clear(flash_journal_t* self) {
+    if (self->replaying || !start_half(self, 1 - self->half) || !start_half(self, 1 - self->half)) {
+        return false;
+    }
+    self->snapshot_pending = false;
+    self->replay_end = 0;
+    self->clears++;
+    return true;
+}
+
+bool flash_journal_begin(flash_journal_t* self, uint32_t count, bool new_half) {
+    if (count > FLASH_JOURNAL_MAX_BLOCKS) {
+        return false;
+    }
+    if (new_half) {
+        // The snapshot couldn't include the blocks that haven't been replayed
+        // yet.
+        if (self->replaying) {
+            return false;
+        }
+        // Until a snapshot is committed the other half is the one that counts,
+        // so a retry stays in this half and only erases it when it's full.
+        if (!self->snapshot_pending) {
+            if (!start_half(self, 1 - self->half)) {
+                return false;
+            }
+        } else if (!room_for(self, count) && !start_half(self, self->half)) {
+            return false;
+        }
+    } else if (self->snapshot_pending) {
+        return false;
+    }
+    if (!room_for(self, count)) {
+        return false;
+    }
+    self->header_slot = self->next_slot;
+    self->count = count;
+    self->added = 0;
+    self->written = 0;
+    self->checksum = CHECKSUM_START;
+    // Use up the slots even if the transaction is never committed. They can't
+    // be programmed again until the half is erased.
+    self->next_slot += 1 + count;
+    return true;
+}
+
+void flash_journal_add(flash_journal_t* self, uint32_t address) {
+    if (self->added < self->count) {
+        self->addresses[self->added] = address;
+    }
+    self->added++;
+}
+
+bool flash_journal_write(flash_journal_t* self, const uint8_t* data, uint32_t length) {
+    if (self->written + length > self->added * FLASH_JOURNAL_BLOCK_SIZE ||
+        self->added > self->count) {
+        return false;
+    }
+    uint32_t address = slot_address(self, self->half, self->header_slot + 1) + self->written;
+    if (!self->flash->program(address, data, length)) {
+        return false;
+    }
+    self->checksum = checksum(self->checksum, data, length);
+    self->written += length;
+    return true;
+}
+
+bool flash_journal_commit(flash_journal_t* self) {
+    if (self->added != self->count || self->written != self->count * FLASH_JOURNAL_BLOCK_SIZE) {
+        return false;
+    }
+    transaction_header_t header;
+    memset(&header, 0xff, sizeof(header));
+    header.magic = FLASH_JOURNAL_MAGIC;
+    header.sequence = self->sequence;
+    header.count = self->count;
+    memcpy(header.address, self->addresses, self->count * sizeof(uint32_t));
+    header.checksum = header_checksum(self->checksum, &header);
+    if (!self->flash->program(slot_address(self, self->half, self->header_slot),
+                              (const uint8_t*) &header, sizeof(header))) {
+        return false;
+    }
+    self->sequence++;
+    self->snapshot_pending = false;
+    self->transactions++;
+    self->blocks_journaled += self->count;
+    return true;
+}
@@ -0,0 +1,122 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SUPERVISOR_SHARED_FLASH_JOURNAL_H
+#define MICROPY_INCLUDED_SUPERVISOR_SHARED_FLASH_JOURNAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// A write-ahead journal for blocks that are rewritten in place. Before a
+// sector is rewritten, everything the rewrite could lose is appended to the
+// journal as one transaction. A transaction is a header slot followed by its
+// blocks, and the header is programmed last so that a transaction only counts
+// once all of it is on the flash. On init the committed transactions are
+// replayed, oldest first, which brings back the blocks as of the last commit
+// even if power went away part way through erasing a sector.
+//
+// The journal is split into two halves. Transactions are appended to one half
+// until the next one doesn't fit. Then the other half is erased and the
+// caller starts it with a snapshot of every block that isn't in place yet,
+// which makes the old half obsolete. Nothing else goes into the new half until
+// that snapshot is committed. A half must be able to hold the largest
+// snapshot.
+
+#define FLASH_JOURNAL_BLOCK_SIZE (512)
+
+// Most blocks in one transaction. Their addresses are listed in its header.
+#define FLASH_JOURNAL_MAX_BLOCKS (60)
+
+// Raw access to the flash holding the journal. Addresses are absolute.
+// program may be given any length and only needs to clear bits, it is never
+// asked to set them.
+typedef struct {
+    bool (*read)(uint32_t address, uint8_t* data, uint32_t length);
+    bool (*program)(uint32_t address, const uint8_t* data, uint32_t length);
+    bool (*erase)(uint32_t address);
+    uint32_t erase_size;
+} flash_journal_flash_t;
+
+typedef struct {
+    const flash_journal_flash_t* flash;
+    uint32_t address;       // Start of the journal. The second half follows the first.
+    uint32_t half_slots;    // Block sized slots in each half.
+    uint32_t sequence;      // Sequence number of the next transaction.
+    uint32_t next_slot;     // First slot of the current half that can be appended to.
+    uint32_t replay_end;    // End of the transactions found by flash_journal_init.
+    uint8_t half;           // Half being appended to.
+    bool replaying;
+    bool snapshot_pending;  // The current half was started but its snapshot isn't committed.
+    // The transaction being written.
+    uint32_t header_slot;
+    uint32_t count;
+    uint32_t added;
+    uint32_t written;       // Bytes of block data given so far.
+    uint32_t checksum;
+    uint32_t addresses[FLASH_JOURNAL_MAX_BLOCKS];
+    // Statistics.
+    uint32_t transactions;
+    uint32_t blocks_journaled;
+    uint32_t sectors_erased;
+    uint32_t clears;
+} flash_journal_t;
+
+// Called for each block of each committed transaction, oldest first, with the
+// address the block belongs at and the address of its copy in the journal.
+typedef bool (*flash_journal_replay_t)(uint32_t address, uint32_t journal_address);
+
+// Finds the committed transactions in the size bytes at address. size must be
+// a multiple of twice the erase size.
+bool flash_journal_init(flash_journal_t* self, const flash_journal_flash_t* flash, uint32_t address, uint32_t size);
+
+// Replays what flash_journal_init found. replay may start new transactions
+// but they can't start a new half until the replay is done because the old
+// half is still being read.
+bool flash_journal_replay(flash_journal_t* self, flash_journal_replay_t replay);
+
+// Returns true if a transaction of count blocks fits in the current half. It
+// doesn't while the current half waits for its snapshot.
+bool flash_journal_fits(flash_journal_t* self, uint32_t count);
+
+// Erases both halves so that nothing is replayed. Blocks that the journal held
+// and that aren't in place yet are then only kept by the caller.
+bool flash_journal_clear(flash_journal_t* self);
+
+// Starts a transaction of count blocks. When new_half is set the other half
+// is erased and the transaction goes at its start, so it must be a snapshot
+// of everything that isn't in place yet. If the last snapshot wasn't
+// committed this one replaces it in the same half instead.
+bool flash_journal_begin(flash_journal_t* self, uint32_t count, bool new_half);
+
+// Starts the next block of the transaction. Its data is then given to
+// flash_journal_write in pieces that add up to FLASH_JOURNAL_BLOCK_SIZE.
+void flash_journal_add(flash_journal_t* self, uint32_t address);
+bool flash_journal_write(flash_journal_t* self, const uint8_t* data, uint32_t length);
+
+// Makes the transaction count by programming its header.
+bool flash_journal_commit(flash_journal_t* self);
+
+#endif  // MICROPY_INCLUDED_SUPERVISOR_SHARED_FLASH_JOURNAL_H
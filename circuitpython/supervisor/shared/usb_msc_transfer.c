@@ -0,0 +1,187 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "supervisor/shared/usb_msc_transfer.h"
+
+#include <stddef.h>
+
+static uint8_t* buffer_data(usb_msc_transfer_t* self, uint8_t buffer) {
+    return self->buffers + buffer * self->buffer_blocks * USB_MSC_TRANSFER_BLOCK_SIZE;
+}
+
+void usb_msc_transfer_init(usb_msc_transfer_t* self, const usb_msc_transfer_io_t* io,
+                           uint8_t* buffers, uint32_t buffer_blocks, uint32_t first_block) {
+    self->io = io;
+    self->buffers = buffers;
+    self->buffer_blocks = buffer_blocks;
+    self->first_block = first_block;
+    self->usb_busy = false;
+    self->active_read = false;
+    self->active_write = false;
+    self->usb_buffer = 0;
+    self->usb_count = 0;
+    self->disk_nblocks = 0;
+    self->usb_nblocks = 0;
+    self->ready_buffer = -1;
+}
+
+uint32_t usb_msc_transfer_chunk_blocks(usb_msc_transfer_t* self, uint32_t addr, uint32_t nblocks) {
+    uint32_t count = self->buffer_blocks;
+    if (addr >= self->first_block) {
+        count -= (addr - self->first_block) % self->buffer_blocks;
+    } else {
+        count = self->first_block - addr;
+    }
+    if (count > nblocks) {
+        count = nblocks;
+    }
+    return count;
+}
+
+static void reset_transfer(usb_msc_transfer_t* self, uint8_t lun, uint32_t addr, uint32_t nblocks) {
+    self->active_lun = lun;
+    self->disk_addr = addr;
+    self->disk_nblocks = nblocks;
+    self->usb_addr = addr;
+    self->usb_nblocks = nblocks;
+    self->usb_count = 0;
+    self->ready_buffer = -1;
+}
+
+void usb_msc_transfer_new_read(usb_msc_transfer_t* self, uint8_t lun, uint32_t addr, uint32_t nblocks) {
+    reset_transfer(self, lun, addr, nblocks);
+    self->active_read = true;
+}
+
+void usb_msc_transfer_new_write(usb_msc_transfer_t* self, uint8_t lun, uint32_t addr, uint32_t nblocks) {
+    reset_transfer(self, lun, addr, nblocks);
+    self->active_write = true;
+}
+
+void usb_msc_transfer_done(usb_msc_transfer_t* self) {
+    // Once the last buffer of a read is sent the status follows straight
+    // away and the host may start the next command.
+    if (self->active_read && self->disk_nblocks == 0 && self->ready_buffer < 0) {
+        self->active_read = false;
+    }
+    self->usb_busy = false;
+}
+
+// Hands a buffer to the USB peripheral. Everything usb_msc_transfer_done
+// looks at is updated before the transfer starts because it may finish
+// before start returns. If it doesn't start, nothing can have finished and
+// the old state is put back. Returns false if the transfer couldn't be
+// started.
+static bool start_xfer(usb_msc_transfer_t* self, bool rd, uint8_t buffer, uint32_t count) {
+    uint8_t previous_buffer = self->usb_buffer;
+    int8_t previous_ready = self->ready_buffer;
+    self->usb_buffer = buffer;
+    self->usb_count = count;
+    if (rd) {
+        self->ready_buffer = -1;
+    }
+    self->usb_busy = true;
+    if (self->io->start(rd, buffer_data(self, buffer), count)) {
+        return true;
+    }
+    self->usb_busy = false;
+    self->usb_buffer = previous_buffer;
+    self->usb_count = 0;
+    self->ready_buffer = previous_ready;
+    return false;
+}
+
+// Reads the next chunk from the disk into the buffer the USB peripheral isn't
+// using.
+static void load_chunk(usb_msc_transfer_t* self) {
+    self->ready_buffer = 1 - self->usb_buffer;
+    self->ready_addr = self->disk_addr;
+    self->ready_count = usb_msc_transfer_chunk_blocks(self, self->disk_addr, self->disk_nblocks);
+    self->io->read_blocks(self->active_lun, buffer_data(self, self->ready_buffer),
+                          self->ready_addr, self->ready_count);
+    self->disk_addr += self->ready_count;
+    self->disk_nblocks -= self->ready_count;
+}
+
+// Writes the received buffer to the disk.
+static void store_chunk(usb_msc_transfer_t* self) {
+    self->io->write_blocks(self->active_lun, buffer_data(self, self->ready_buffer),
+                           self->ready_addr, self->ready_count);
+    self->disk_addr += self->ready_count;
+    self->disk_nblocks -= self->ready_count;
+    self->ready_buffer = -1;
+}
+
+// Reads go from the drive into one buffer which is then sent while the next
+// chunk is read ahead into the other. Writes work the other way around: the
+// next buffer is received from the host while the previous one is written to
+// the drive.
+void usb_msc_transfer_background(usb_msc_transfer_t* self) {
+    // Only look at usb_busy once because the transfer done interrupt can
+    // clear it at any time. Acting on a later value could queue another
+    // transfer before we've dealt with the one that just finished.
+    bool busy = self->usb_busy;
+    if (!busy) {
+        // Anything we sent has gone. Anything we received is ready to write.
+        if (self->active_write && self->usb_count > 0) {
+            self->ready_buffer = self->usb_buffer;
+            self->ready_addr = self->xfer_addr;
+            self->ready_count = self->usb_count;
+        }
+        self->usb_count = 0;
+    }
+    if (self->active_read) {
+        if (self->ready_buffer < 0 && self->disk_nblocks > 0) {
+            load_chunk(self);
+        }
+        if (!busy && self->ready_buffer >= 0 &&
+            start_xfer(self, true, self->ready_buffer, self->ready_count) &&
+            self->disk_nblocks > 0) {
+            load_chunk(self);
+        }
+    }
+    if (self->active_write) {
+        // Load more blocks from USB if they are needed. The other buffer,
+        // if it's full, is written while they arrive.
+        if (!busy && self->usb_nblocks > 0) {
+            uint32_t count = usb_msc_transfer_chunk_blocks(self, self->usb_addr, self->usb_nblocks);
+            self->xfer_addr = self->usb_addr;
+            if (start_xfer(self, false, 1 - self->usb_buffer, count)) {
+                self->usb_addr += count;
+                self->usb_nblocks -= count;
+            }
+        }
+        if (self->ready_buffer >= 0) {
+            store_chunk(self);
+        }
+        if (self->disk_nblocks == 0) {
+            // Finish before sending the status because the host may start
+            // the next command as soon as it has it.
+            self->active_write = false;
+            self->io->finish_write();
+        }
+    }
+}
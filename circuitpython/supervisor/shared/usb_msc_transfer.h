@@ -0,0 +1,101 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Scott Shawcroft for Adafruit Industries
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_SUPERVISOR_SHARED_USB_MSC_TRANSFER_H
+#define MICROPY_INCLUDED_SUPERVISOR_SHARED_USB_MSC_TRANSFER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Double buffered block transfers between a USB mass storage host and a disk.
+// While the USB peripheral moves one buffer to or from the host,
+// usb_msc_transfer_background moves the other to or from the disk.
+//
+// Buffers are filled up to the next multiple of their size after
+// first_block, so when a buffer is an erase sector and the partition starts
+// at first_block every full buffer covers exactly one sector.
+
+#define USB_MSC_TRANSFER_BLOCK_SIZE (512)
+
+// The USB peripheral and the disk underneath the transfers.
+typedef struct {
+    // Starts moving count blocks between buffer and the host and returns
+    // false if the transfer couldn't be started. usb_msc_transfer_done must
+    // be called once it has finished.
+    bool (*start)(bool read, uint8_t* buffer, uint32_t count);
+    // Sends the status that ends a write command.
+    void (*finish_write)(void);
+    void (*read_blocks)(uint8_t lun, uint8_t* dest, uint32_t block, uint32_t count);
+    void (*write_blocks)(uint8_t lun, const uint8_t* src, uint32_t block, uint32_t count);
+} usb_msc_transfer_io_t;
+
+typedef struct {
+    const usb_msc_transfer_io_t* io;
+    // Two buffers of buffer_blocks blocks each, one after the other.
+    uint8_t* buffers;
+    uint32_t buffer_blocks;
+    uint32_t first_block;
+    volatile bool usb_busy;
+    volatile bool active_read;
+    volatile bool active_write;
+    volatile uint8_t active_lun;
+    // The next block to move between a buffer and the disk and how many are left.
+    uint32_t disk_addr;
+    volatile uint32_t disk_nblocks;
+    // The next block to receive from the host and how many are left to request.
+    uint32_t usb_addr;
+    uint32_t usb_nblocks;
+    // The buffer last handed to the USB peripheral and how many blocks it
+    // holds. For writes, xfer_addr is where they go on the disk. usb_count is
+    // zero once the transfer has been dealt with.
+    uint8_t usb_buffer;
+    uint32_t xfer_addr;
+    uint32_t usb_count;
+    // A buffer loaded from the disk and waiting to be sent, or received from
+    // the host and waiting to be written. -1 if there isn't one.
+    volatile int8_t ready_buffer;
+    uint32_t ready_addr;
+    uint32_t ready_count;
+} usb_msc_transfer_t;
+
+void usb_msc_transfer_init(usb_msc_transfer_t* self, const usb_msc_transfer_io_t* io,
+                           uint8_t* buffers, uint32_t buffer_blocks, uint32_t first_block);
+
+// Returns how many of the nblocks blocks starting at addr fit in one buffer.
+uint32_t usb_msc_transfer_chunk_blocks(usb_msc_transfer_t* self, uint32_t addr, uint32_t nblocks);
+
+// Accept a read or write command. The blocks are moved later by
+// usb_msc_transfer_background.
+void usb_msc_transfer_new_read(usb_msc_transfer_t* self, uint8_t lun, uint32_t addr, uint32_t nblocks);
+void usb_msc_transfer_new_write(usb_msc_transfer_t* self, uint8_t lun, uint32_t addr, uint32_t nblocks);
+
+// Called, usually from an interrupt, when a transfer from start has finished.
+void usb_msc_transfer_done(usb_msc_transfer_t* self);
+
+// Moves blocks between the buffers and the disk and starts the next transfer.
+void usb_msc_transfer_background(usb_msc_transfer_t* self);
+
+#endif  // MICROPY_INCLUDED_SUPERVISOR_SHARED_USB_MSC_TRANSFER_H
@@ -20,3 +20,13 @@ print(hex(pow(2, x-1, x))) # Should be 1, since x is prime
 print(hex(pow(y, x-1, x))) # Should be 1, since x is prime
 print(hex(pow(y, y-1, x))) # Should be a 'big value'
 print(hex(pow(y, y-1, y))) # Should be a 'big value'
+
+# odd, even and negative moduli, and negative bases, with 2048-bit values
+m = (1 << 2048) - 0x20481
+a = m // 3 + 12345
+print(hex(pow(a, m - 2, m)))
+print(hex(pow(-a, m - 2, m)))
+print(hex(pow(a, m - 2, m + 1)))
+print(hex(pow(a, m - 2, -m)))
+print(pow(m * 5, 12345, m))
+print(pow(a, 1, m) == a)
@@ -8,3 +8,10 @@ x = 0x8000000000000000
 print((x + 1) // x)
 x = 0x86c60128feff5330
 print((x + 1) // x)
+
+# test division where the leading digits of numerator and denominator are
+# equal, so the estimated quotient digit would not fit in a digit
+x = (1 << 3000) - 1
+print((x * x) // x == x, (x * x + 5) % x)
+x = (1 << 96) - (1 << 48)
+print((x * x + x - 1) // x == x + 0, (x * x + x - 1) % x == x - 1)
@@ -21,3 +21,10 @@ print(i * i)
 print(i * -i)
 print(-i * i)
 print(-i * -i)
+
+# large operands of equal and unequal lengths
+a = (1 << 4000) // 7
+b = (1 << 2500) // 11 + 1
+for x, y in ((a, a), (a, b), (b, a), (a, -b), ((1 << 3000) - 1, (1 << 3000) - 1)):
+    z = x * y
+    print(hex(z)[-16:], z // x == y, z % x)
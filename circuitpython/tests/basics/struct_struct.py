@@ -0,0 +1,60 @@
+# test precompiled struct.Struct objects
+
+# ustruct never has Struct; a port may provide it in struct
+try:
+    import struct
+    struct.Struct
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+s = struct.Struct('<hB3sI')
+print(s.size, s.format)
+b = s.pack(-2, 7, b'ab', 0x01020304)
+print(b)
+print(s.unpack(b))
+print(s.unpack_from(b'xx' + b, 2))
+print(s.unpack_from(b'xx' + b, -10))
+
+buf = bytearray(14)
+s.pack_into(buf, 2, 1, 2, b'xyz', 3)
+print(buf)
+
+# native alignment matches calcsize, at any offset into the buffer
+s = struct.Struct('@bi2hq')
+print(s.size == struct.calcsize('@bi2hq'))
+buf = bytearray(s.size + 3)
+for off in range(4):
+    s.pack_into(buf, off, -1, -2, -3, off, -5)
+    print(s.unpack_from(buf, off))
+print(s.unpack_from(buf, -s.size))
+
+# reusing an output list
+s = struct.Struct('>HH')
+out = [None, None]
+print(s.unpack_from(bytes(range(8)), 4, out=out) is out, out)
+data = bytes(range(12))
+print(list(s.iter_unpack(data)))
+for rec in s.iter_unpack(data, out=out):
+    print(rec is out, rec)
+
+try:
+    s.unpack(b'123')
+except RuntimeError:
+    print('RuntimeError')
+try:
+    s.pack(1, 2, 3)
+except RuntimeError:
+    print('RuntimeError')
+try:
+    s.iter_unpack(b'123')
+except ValueError:
+    print('ValueError')
+try:
+    s.unpack_from(data, out=[1])
+except ValueError:
+    print('ValueError')
+try:
+    struct.Struct('<hz')
+except ValueError:
+    print('ValueError')
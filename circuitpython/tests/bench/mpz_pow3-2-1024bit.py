@@ -0,0 +1,13 @@
+import bench
+
+# modular exponentiation with a full-size exponent, as in RSA or a
+# Fermat inverse, on 1024-bit values
+M = (1 << 1024) - 0x10241
+A = M // 3 + 12345
+B = M - 2
+
+def test(num):
+    for i in iter(range(num // 400000)):
+        pow(A, B, M)
+
+bench.run(test)
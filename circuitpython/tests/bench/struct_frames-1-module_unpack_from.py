@@ -0,0 +1,14 @@
+import bench
+import struct
+
+# 96 sensor frames: sequence number, timestamp, reading
+FMT = "<HIh"
+FRAMES = bytes(range(256)) * 3
+
+def test(num):
+    unpack_from = struct.unpack_from
+    for i in iter(range(num // 20000)):
+        for off in range(0, len(FRAMES), 8):
+            unpack_from(FMT, FRAMES, off)
+
+bench.run(test)
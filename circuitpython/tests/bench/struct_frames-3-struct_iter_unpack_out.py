@@ -0,0 +1,16 @@
+import bench
+import struct
+
+# 96 sensor frames: sequence number, timestamp, reading
+FMT = "<HIh"
+FRAMES = bytes(range(256)) * 3
+
+def test(num):
+    s = struct.Struct(FMT)
+    data = FRAMES
+    out = [None] * 3
+    for i in iter(range(num // 20000)):
+        for rec in s.iter_unpack(data, out=out):
+            pass
+
+bench.run(test)
@@ -0,0 +1,15 @@
+import bench
+import struct
+
+# 96 sensor frames: sequence number, timestamp, reading
+FMT = "<HIh"
+FRAMES = bytes(range(256)) * 3
+
+def test(num):
+    unpack_from = struct.Struct(FMT).unpack_from
+    out = [None] * 3
+    for i in iter(range(num // 20000)):
+        for off in range(0, len(FRAMES), 8):
+            unpack_from(FRAMES, off, out=out)
+
+bench.run(test)
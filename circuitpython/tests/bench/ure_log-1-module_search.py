@@ -0,0 +1,12 @@
+import bench
+import ure
+
+LINE = "2018-08-16 14:36:02 WARN sensor[12]: temp=23.5C rh=41% batt=3.71V"
+
+def test(num):
+    for i in iter(range(num // 2000)):
+        ure.search("([0-9]+-[0-9]+-[0-9]+) ([0-9:]+) ([A-Z]+) (\w+)\[(\d+)\]", LINE)
+        ure.search("temp=([0-9.]+)C", LINE)
+        ure.search("batt=([0-9.]+)V", LINE)
+
+bench.run(test)
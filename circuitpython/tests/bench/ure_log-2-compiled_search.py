@@ -0,0 +1,15 @@
+import bench
+import ure
+
+LINE = "2018-08-16 14:36:02 WARN sensor[12]: temp=23.5C rh=41% batt=3.71V"
+
+def test(num):
+    head = ure.compile("([0-9]+-[0-9]+-[0-9]+) ([0-9:]+) ([A-Z]+) (\w+)\[(\d+)\]")
+    temp = ure.compile("temp=([0-9.]+)C")
+    batt = ure.compile("batt=([0-9.]+)V")
+    for i in iter(range(num // 2000)):
+        head.search(LINE)
+        temp.search(LINE)
+        batt.search(LINE)
+
+bench.run(test)
@@ -0,0 +1,11 @@
+import bench
+import ure
+
+LINE = "a" * 30 + "!"
+
+def test(num):
+    r = ure.compile("(a|aa)*b")
+    for i in iter(range(num // 20000)):
+        r.match(LINE)
+
+bench.run(test)
@@ -0,0 +1,38 @@
+import bench
+import uzlib
+
+# 5905 bytes of JSON-like text compressed by CPython's zlib at level 9
+DATA = (
+    b'x\xda\x8d\xd8\xb1n\x1b1\x10\x04\xd0>_a\xa8N\xc1].w\xc9\xd4\xf9\x11'
+    b'\x05\xb9\x00\x06\x1c%\x90\x9c\xca\xf0\xbf\xc7\x8a\x0b\xf3\xc4hv:K\x96\x07\xbe\xc1'
+    b'\xdc\xb3y/\x87\xc7\xef\x87/\x0f\xe5\xf3\xc3\xe1t\xfc\xb9\xbd}y\xb8l\xa7\xcb'
+    b'\xafs9\xbc\xbd\xf5\xfb\xf1t}\xe7\xeb\xbf\x17\xe7\xe3\xf3\xf5\xfbR\xae\x1f\xdeN'
+    b'\xc7oO\xdb\xf5G\x7f\x1c\x9f.\xdb\xeb\xa7\x97\xf7 Y\x82d\x0e\x92)Ho'
+    b'\x82\x9e\xcf\x7f>rt\xc9\xd19G\xa7\x9c\x8ar\xea\x92S\xe7\x9c:\xe5\x18\xbc'
+    b'0[\x82l\x0e\xb2)\xa8\xa1_\xa8-9m\xcei\xa0\xe9]\x8e/9>\xe7'
+    b'8(z\x7fa\xb1\x04\xc5\x1c\x14l\xd3}\xc9\xe9sN\x07M\xefr\xc6\x923'
+    b'\xe6\x9c\x01\x8a\xbe\x99\xe2:j\xd9\xadZ\n[\xb6\xfcg\xd6\xfb]\xd3\xc3\x96u'
+    b'\xd9\xb2\x9b\xb6\xa0m\xdf\\\xe1\xban\xa9\xf7\xee[X\xba\xac\xf3\x16\xbbw\xe3\xc2'
+    b'}\xcb:pi\xf7n\xdd\xc4\x92u\xe3\xe2\xf7\xee^\\z`\xdf\x8c\x1d\xb9t'
+    b'\xec[\xa3=\x91\x81\x85s\xb6p-\x98\xb8`G\xae\x82\x89\xeb4)\xaa\x18\xb9'
+    b'\xc1\xd6\xad\x15+\'\xf4\xc0\xd50s"\xb4+\xda\xb0t\xa2t\xe3\x8e\xad+\xf4'
+    b'_\xcb\xc8\xa8\xa3M\xd1\x9eP\xa7t\xe5#\x91\xae\xb2\x13\xaf%q\xcehS\xaa'
+    b'$\xd05\xb6\xf3\xaa\ttN\xff\x8fR\x13\xe7\x82V\xa5\x1a\x86\xae\xd3\x957\x0c'
+    b"\xdd`7^\x1d;'\x85f\xa5\x06\x96N\x84n\xbcc\xea\x84\x1ey\x1d\x98\xba"
+    b'B\xb3b%\xb1\x8em\xdc\x04S\xa7\xec\xc2M1t\x95F\xc5*\x86\xce\xd8\xba'
+    b'\xcd\x12\xe8\x1a;pk\x89sN\x9bb\x9e@\x17t\xe3\x91@\xd7\xd9\x85[O'
+    b'\x9c\x1b\xfc\xc9g$\xd0I\xa1\x0f?%\x91N\xe8\x957\xc1\xd2\x89\xd2\xae4\xc5'
+    b'\xd6\x15\xb6\xf4V\x13\xeb\xd8\x997\xc3\xd2)\xadJkX\xbaJ\xf7\xed\x18:c'
+    b'7\xde\x02;\xd7hUZ\xc7\xd09]\xf7\xc0\xd0\x05\xbbo/\xd8\xb9N\x9b\xe2'
+    b'\x92@7\xd8\xbe]\xb3\xb3+\xbdo\xaf\xd9\xd9UhU\xdc\x12\xeaD\xe9\xd6['
+    b'b\x1d}\xcew\xcf\xa8\xa3Q\xf1H\xa8\xa3\x1fay\xc7\xd2Uv\xe6>\xb0s'
+    b'F\xab\x12\x05CG?\xc5\n\xc1\xd09\xbb\xf2P\xec\\\xd0\xaaD\xc5\xd0\xd1\x0f'
+    b'\xb2\xc20t\x83\xddw\xb4\xe4\xec\xca?\x9e\rO\xce\xae\xf4s\xac\x08L\x9d\xd0'
+    b'\xfb\x8e\x9ePWhTbd\xd6\xa5\x9d\xff\x05v\xe7N{'
+)
+
+def test(num):
+    for i in iter(range(num // 10000)):
+        uzlib.decompress(DATA)
+
+bench.run(test)
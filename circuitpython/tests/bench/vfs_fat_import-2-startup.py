@@ -0,0 +1,56 @@
+import bench
+import sys
+import uos
+
+
+class RAMFS:
+
+    SEC_SIZE = 512
+
+    def __init__(self, blocks):
+        self.data = bytearray(blocks * self.SEC_SIZE)
+        self.mv = memoryview(self.data)
+
+    def readblocks(self, n, buf):
+        buf[:] = self.mv[n * self.SEC_SIZE:n * self.SEC_SIZE + len(buf)]
+        return 0
+
+    def writeblocks(self, n, buf):
+        self.mv[n * self.SEC_SIZE:n * self.SEC_SIZE + len(buf)] = buf
+        return 0
+
+    def ioctl(self, op, arg):
+        if op == 4:  # BP_IOCTL_SEC_COUNT
+            return len(self.data) // self.SEC_SIZE
+        if op == 5:  # BP_IOCTL_SEC_SIZE
+            return self.SEC_SIZE
+
+
+# a program's startup on a populated CIRCUITPY-like image: every run mounts
+# the drive afresh and imports 30 modules found in the last sys.path entry
+bdev = RAMFS(400)
+uos.VfsFat.mkfs(bdev)
+vfs = uos.VfsFat(bdev)
+uos.mount(vfs, "/flash")
+for i in range(30):
+    with open("/flash/background_image_%d.bmp" % i, "w") as f:
+        f.write("x")
+uos.mkdir("/flash/lib")
+MODULES = ["adafruit_mod%d" % i for i in range(30)]
+for name in MODULES:
+    with open("/flash/lib/%s.py" % name, "w") as f:
+        f.write("X = 1\n")
+uos.umount("/flash")
+sys.path[:] = ["", ".frozen", "/flash", "/flash/lib"]
+
+def test(num):
+    for i in range(num // 750000):
+        uos.mount(vfs, "/flash")
+        uos.chdir("/flash")
+        for name in MODULES:
+            __import__(name)
+        for name in MODULES:
+            del sys.modules[name]
+        uos.umount("/flash")
+
+bench.run(test)
@@ -0,0 +1,45 @@
+import bench
+import uos
+
+
+class RAMFS:
+
+    SEC_SIZE = 512
+
+    def __init__(self, blocks):
+        self.data = bytearray(blocks * self.SEC_SIZE)
+        self.mv = memoryview(self.data)
+
+    def readblocks(self, n, buf):
+        buf[:] = self.mv[n * self.SEC_SIZE:n * self.SEC_SIZE + len(buf)]
+        return 0
+
+    def writeblocks(self, n, buf):
+        self.mv[n * self.SEC_SIZE:n * self.SEC_SIZE + len(buf)] = buf
+        return 0
+
+    def ioctl(self, op, arg):
+        if op == 4:  # BP_IOCTL_SEC_COUNT
+            return len(self.data) // self.SEC_SIZE
+        if op == 5:  # BP_IOCTL_SEC_SIZE
+            return self.SEC_SIZE
+
+
+# 64KiB file interleaved with another one so that its clusters are in runs
+bdev = RAMFS(400)
+uos.VfsFat.mkfs(bdev)
+vfs = uos.VfsFat(bdev)
+chunk = bytes(range(256)) * 8
+for i in range(32):
+    for name in ("data", "data") if i % 4 else ("data", "other"):
+        with vfs.open(name, "ab") as f:
+            f.write(chunk)
+
+def test(num):
+    buf = bytearray(256)
+    for i in range(num // 40000):
+        with vfs.open("data", "rb") as f:
+            while f.readinto(buf):
+                pass
+
+bench.run(test)
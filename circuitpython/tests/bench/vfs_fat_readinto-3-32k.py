@@ -0,0 +1,46 @@
+import bench
+import uos
+
+
+class RAMFS:
+
+    SEC_SIZE = 512
+
+    def __init__(self, blocks):
+        self.data = bytearray(blocks * self.SEC_SIZE)
+        self.mv = memoryview(self.data)
+
+    def readblocks(self, n, buf):
+        buf[:] = self.mv[n * self.SEC_SIZE:n * self.SEC_SIZE + len(buf)]
+        return 0
+
+    def writeblocks(self, n, buf):
+        self.mv[n * self.SEC_SIZE:n * self.SEC_SIZE + len(buf)] = buf
+        return 0
+
+    def ioctl(self, op, arg):
+        if op == 4:  # BP_IOCTL_SEC_COUNT
+            return len(self.data) // self.SEC_SIZE
+        if op == 5:  # BP_IOCTL_SEC_SIZE
+            return self.SEC_SIZE
+
+
+# 128KiB file, read repeatedly with readinto() into a buffer of the given size
+bdev = RAMFS(600)
+uos.VfsFat.mkfs(bdev)
+vfs = uos.VfsFat(bdev)
+with vfs.open("data", "wb") as f:
+    chunk = bytes(range(256)) * 16
+    for i in range(32):
+        f.write(chunk)
+
+SIZE = 32768
+
+def test(num):
+    buf = bytearray(SIZE)
+    for i in range(num // 50000):
+        with vfs.open("data", "rb") as f:
+            while f.readinto(buf):
+                pass
+
+bench.run(test)
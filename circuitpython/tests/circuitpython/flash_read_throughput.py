@@ -0,0 +1,85 @@
+# Measures sequential read throughput through VfsFat and how many blocks each
+# readblocks() call asks for. The filesystem lives on a RAM disk so nothing is
+# written to CIRCUITPY. The flash reads underneath CIRCUITPY are counted by the
+# "# flash reads" section of tests/unix/extra_coverage.py.
+try:
+    import uos as os
+except ImportError:
+    import os
+try:
+    import time
+    time.monotonic
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+try:
+    os.VfsFat
+except AttributeError:
+    print("SKIP")
+    raise SystemExit
+
+
+class RAMFS:
+
+    SEC_SIZE = 512
+
+    def __init__(self, blocks):
+        self.data = bytearray(blocks * self.SEC_SIZE)
+        self.calls = 0
+        self.blocks = 0
+
+    def readblocks(self, n, buf):
+        self.calls += 1
+        self.blocks += len(buf) // self.SEC_SIZE
+        start = n * self.SEC_SIZE
+        buf[:] = memoryview(self.data)[start:start + len(buf)]
+        return 0
+
+    def writeblocks(self, n, buf):
+        start = n * self.SEC_SIZE
+        self.data[start:start + len(buf)] = buf
+        return 0
+
+    def ioctl(self, op, arg):
+        if op == 4:  # BP_IOCTL_SEC_COUNT
+            return len(self.data) // self.SEC_SIZE
+        if op == 5:  # BP_IOCTL_SEC_SIZE
+            return self.SEC_SIZE
+
+
+SIZE = 32 * 1024
+
+try:
+    # the smallest disk FatFs will format
+    bdev = RAMFS(128)
+    buf = memoryview(bytearray(16384))
+except MemoryError:
+    print("SKIP")
+    raise SystemExit
+
+os.VfsFat.mkfs(bdev)
+vfs = os.VfsFat(bdev)
+os.mount(vfs, "/ramdisk")
+
+chunk = bytes(range(256)) * 16
+with open("/ramdisk/read.bin", "wb") as f:
+    for _ in range(SIZE // len(chunk)):
+        f.write(chunk)
+
+for chunk_size in (512, 4096, 16384):
+    bdev.calls = 0
+    bdev.blocks = 0
+    start = time.monotonic()
+    total = 0
+    with open("/ramdisk/read.bin", "rb") as f:
+        while True:
+            n = f.readinto(buf[:chunk_size])
+            if not n:
+                break
+            total += n
+    elapsed = time.monotonic() - start
+    print(chunk_size, "byte reads:", int(total / max(elapsed, 0.001) / 1024), "KB/s,",
+          bdev.blocks // bdev.calls, "blocks per readblocks")
+
+os.umount("/ramdisk")
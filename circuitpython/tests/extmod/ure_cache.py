@@ -0,0 +1,19 @@
+# test reuse of compiled patterns
+try:
+    import ure as re
+except ImportError:
+    try:
+        import re
+    except ImportError:
+        print("SKIP")
+        raise SystemExit
+
+r = re.compile("a(b+)c")
+print(r is re.compile("a(b+)c"))
+print(r is re.compile("a(b+)d"))
+
+# cycle through more patterns than the cache holds
+for i in range(3):
+    for p in ("x", "y+", "(z)", "[0-9]+", "w\\d", "a(b+)c"):
+        m = re.search(p, "abbc x yy z 42 w7")
+        print(m.group(0))
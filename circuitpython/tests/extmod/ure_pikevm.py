@@ -0,0 +1,20 @@
+# test patterns that take exponential time with a backtracking matcher
+try:
+    import ure as re
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+print(re.match("(a|aa)*c", "a" * 40))
+print(re.match("(a*)*b", "a" * 40))
+print(re.match("(a+)+b", "a" * 40 + "b").group(0) == "a" * 40 + "b")
+print(re.search("(x+x+)+y", "x" * 40))
+
+# long subject, must not recurse per character
+m = re.search("(a+)b", "a" * 10000 + "b")
+print(len(m.group(1)))
+
+# leftmost match with priority between alternatives preserved
+print(re.search("a|ab", "xab").group(0))
+print(re.search("(a+?)(a*)", "aaa").group(1))
+print(re.search("(a*)(a)", "aaa").group(1))
@@ -7,7 +7,9 @@ except ImportError:
         print("SKIP")
         raise SystemExit
 
+# the backtracking matcher recurses per character here and may run out of
+# stack; the Pike VM does not
 try:
-    re.match("(a*)*", "aaa")
+    print(re.match("(a*)*", "aaa").group(0))
 except RuntimeError:
     print("RuntimeError")
@@ -0,0 +1,37 @@
+try:
+    import uzlib as zlib
+    import uio as io
+    zlib.CompIO
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+data = b''.join(b'%d,t=%d,rh=%d\n' % (i, 20 + i % 7, 40 + i % 13) for i in range(200))
+
+# streaming output matches one-shot compression, whatever the write sizes
+for wbits in (10, -10, 26):
+    for step in (1, 7, 100, len(data)):
+        buf = io.BytesIO()
+        comp = zlib.CompIO(buf, wbits)
+        for i in range(0, len(data), step):
+            comp.write(data[i:i + step])
+        comp.close()
+        inp = zlib.DecompIO(io.BytesIO(buf.getvalue()), wbits)
+        print(wbits, step, inp.read() == data)
+    buf = io.BytesIO()
+    comp = zlib.CompIO(buf, wbits)
+    comp.write(data)
+    comp.close()
+    print(buf.getvalue() == zlib.compress(data, wbits))
+
+# closing twice is harmless, writing after close is not
+buf = io.BytesIO()
+comp = zlib.CompIO(buf)
+comp.write(b'hello')
+comp.close()
+comp.close()
+print(buf.getvalue())
+try:
+    comp.write(b'more')
+except OSError:
+    print('OSError')
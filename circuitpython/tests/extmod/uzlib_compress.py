@@ -0,0 +1,28 @@
+try:
+    import uzlib as zlib
+    zlib.compress
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+# Packed results are accepted by CPython's zlib.decompress()
+print(zlib.compress(b''))
+print(zlib.compress(b'hello'))
+print(zlib.compress(b'a' * 100))
+print(zlib.compress(b'hello hello hello world\n' * 3))
+print(zlib.compress(b'hello', -10))
+print(zlib.compress(b'hello', 26))
+
+# round trip through each format and window size
+data = b''.join(b'%d,t=%d,rh=%d\n' % (i, 20 + i % 7, 40 + i % 13) for i in range(200))
+for wbits in (8, 10, 15, -9, -15):
+    packed = zlib.compress(data, wbits)
+    print(wbits, len(packed) < len(data), zlib.decompress(packed, wbits) == data)
+packed = zlib.compress(data, 31)
+print(packed[:4], zlib.decompress(packed[10:], -15) == data)
+
+for wbits in (7, 16, 32, -16):
+    try:
+        zlib.compress(data, wbits)
+    except ValueError:
+        print('ValueError')
@@ -0,0 +1,32 @@
+try:
+    import uzlib as zlib
+    import uio as io
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+# zlib stream, read ahead in small chunks
+inp = zlib.DecompIO(io.BytesIO(b'x\x9cK\xcb\xcfWHJ,\x02\x00\np\x02\x9a'), 0, 4)
+print(inp.read())
+
+# gzip stream with a multi-byte read-ahead buffer
+inp = zlib.DecompIO(io.BytesIO(b'\x1f\x8b\x08\x08\x99\x0c\xe5W\x00\x03hello\x00\xcbH\xcd\xc9\xc9\x07\x00\x86\xa6\x106\x05\x00\x00\x00'), 16 + 8, 64)
+print(inp.read(1))
+print(inp.read())
+
+# longer data split across many buffer refills
+data = b'0123456789abcdef' * 50 + bytes(range(256))
+buf = io.BytesIO()
+c = zlib.CompIO(buf)
+c.write(data)
+c.close()
+buf.seek(0)
+inp = zlib.DecompIO(buf, 10, 7)
+print(inp.read(100) == data[:100], inp.read() == data[100:])
+
+# truncated stream
+inp = zlib.DecompIO(io.BytesIO(b'x\x9cK\xcb\xcfWHJ'), 0, 16)
+try:
+    inp.read()
+except EOFError:
+    print("EOFError")
@@ -0,0 +1,104 @@
+try:
+    import uerrno
+    import uos
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+try:
+    uos.VfsFat
+except AttributeError:
+    print("SKIP")
+    raise SystemExit
+
+
+class RAMFS:
+
+    SEC_SIZE = 512
+
+    def __init__(self, blocks):
+        self.data = bytearray(blocks * self.SEC_SIZE)
+
+    def readblocks(self, n, buf):
+        #print("readblocks(%s, %x(%d))" % (n, id(buf), len(buf)))
+        for i in range(len(buf)):
+            buf[i] = self.data[n * self.SEC_SIZE + i]
+        return 0
+
+    def writeblocks(self, n, buf):
+        #print("writeblocks(%s, %x)" % (n, id(buf)))
+        for i in range(len(buf)):
+            self.data[n * self.SEC_SIZE + i] = buf[i]
+        return 0
+
+    def ioctl(self, op, arg):
+        #print("ioctl(%d, %r)" % (op, arg))
+        if op == 4:  # BP_IOCTL_SEC_COUNT
+            return len(self.data) // self.SEC_SIZE
+        if op == 5:  # BP_IOCTL_SEC_SIZE
+            return self.SEC_SIZE
+
+
+try:
+    bdev = RAMFS(100)
+except MemoryError:
+    print("SKIP")
+    raise SystemExit
+
+uos.VfsFat.mkfs(bdev)
+vfs = uos.VfsFat(bdev)
+uos.mount(vfs, '/ramdisk')
+uos.chdir('/ramdisk')
+
+
+def exists(path):
+    try:
+        uos.stat(path)
+        return True
+    except OSError as e:
+        return e.args[0]
+
+
+def read(path):
+    with open(path) as f:
+        return f.read()
+
+
+# a failed lookup must not hide a file created afterwards
+print(exists("a.txt"))
+with open("a.txt", "w") as f:
+    f.write("one")
+print(exists("a.txt"), exists("A.TXT"), read("A.txt"))
+
+# nor must a successful one outlive the file
+uos.remove("a.txt")
+print(exists("a.txt"))
+with open("a.txt", "w") as f:
+    f.write("two")
+print(read("a.txt"))
+
+# rename
+uos.rename("a.txt", "b.txt")
+print(exists("a.txt"), exists("b.txt"), read("b.txt"))
+
+# the same name in different directories
+uos.mkdir("dir")
+print(exists("dir/b.txt"))
+with open("dir/b.txt", "w") as f:
+    f.write("three")
+print(read("b.txt"), read("dir/b.txt"))
+uos.remove("dir/b.txt")
+uos.rmdir("dir")
+print(exists("dir"), exists("dir/b.txt"))
+
+# more names than the cache holds, including names too long to be cached
+names = ["f%d.py" % i for i in range(20)] + ["a_rather_long_module_name_%d.py" % i for i in range(3)]
+for n in names:
+    with open(n, "w") as f:
+        f.write(n)
+for i in range(2):
+    print(all(read(n) == n for n in names), exists("f20.py"))
+for n in names[::2]:
+    uos.remove(n)
+print([exists(n) for n in names[:6]])
+print(sorted(uos.listdir()))
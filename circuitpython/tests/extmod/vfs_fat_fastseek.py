@@ -0,0 +1,104 @@
+try:
+    import uerrno
+    import uos
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+try:
+    uos.VfsFat
+except AttributeError:
+    print("SKIP")
+    raise SystemExit
+
+
+class RAMFS:
+
+    SEC_SIZE = 512
+
+    def __init__(self, blocks):
+        self.data = bytearray(blocks * self.SEC_SIZE)
+
+    def readblocks(self, n, buf):
+        #print("readblocks(%s, %x(%d))" % (n, id(buf), len(buf)))
+        for i in range(len(buf)):
+            buf[i] = self.data[n * self.SEC_SIZE + i]
+        return 0
+
+    def writeblocks(self, n, buf):
+        #print("writeblocks(%s, %x)" % (n, id(buf)))
+        for i in range(len(buf)):
+            self.data[n * self.SEC_SIZE + i] = buf[i]
+        return 0
+
+    def ioctl(self, op, arg):
+        #print("ioctl(%d, %r)" % (op, arg))
+        if op == 4:  # BP_IOCTL_SEC_COUNT
+            return len(self.data) // self.SEC_SIZE
+        if op == 5:  # BP_IOCTL_SEC_SIZE
+            return self.SEC_SIZE
+
+
+try:
+    bdev = RAMFS(100)
+except MemoryError:
+    print("SKIP")
+    raise SystemExit
+
+uos.VfsFat.mkfs(bdev)
+vfs = uos.VfsFat(bdev)
+uos.mount(vfs, '/ramdisk')
+uos.chdir('/ramdisk')
+
+# interleave appends so that "frag" is spread over many fragments
+expected = bytearray()
+for i in range(24):
+    chunk = bytes((i * 7 + j) & 0xff for j in range(600))
+    expected.extend(chunk)
+    with open("frag", "ab") as f:
+        f.write(chunk)
+    with open("other", "ab") as f:
+        f.write(b"x" * 300)
+
+with open("lines.txt", "w") as f:
+    for i in range(100):
+        f.write("line %d\n" % i)
+
+# the 'f' flag must not change what is read
+for mode in ("rb", "rbf"):
+    print(mode)
+    with open("frag", mode) as f:
+        print(f.read(10) == expected[:10])
+        f.seek(5000)
+        print(f.read(700) == expected[5000:5700], f.tell())
+        f.seek(-100, 2)
+        print(f.read(200) == expected[-100:], f.tell())
+        f.seek(10000)
+        buf = bytearray(3000)
+        print(f.readinto(buf), buf == expected[10000:13000])
+        f.seek(0)
+        print(f.read() == expected)
+        f.seek(777)
+        ok = True
+        for i in range(50):
+            ok = ok and f.read(37) == expected[777 + i * 37:777 + (i + 1) * 37]
+        print(ok, f.tell())
+        f.seek(len(expected) + 10)
+        print(f.read(10), f.tell())
+
+with open("lines.txt", "rf") as f:
+    print(f.readline(), end="")
+    f.seek(500)
+    print(repr(f.readline()))
+    print(len(f.readlines()))
+
+# writable files ignore the flag
+with open("frag", "r+bf") as f:
+    f.seek(100)
+    f.write(b"hello")
+with open("frag", "rbf") as f:
+    f.seek(98)
+    print(f.read(9))
+with open("new", "wf") as f:
+    f.write("abc" * 100)
+print(uos.stat("new")[6])
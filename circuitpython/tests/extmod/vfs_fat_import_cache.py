@@ -0,0 +1,116 @@
+try:
+    import sys
+    import uos
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+try:
+    uos.VfsFat
+except AttributeError:
+    print("SKIP")
+    raise SystemExit
+
+
+class RAMFS:
+
+    SEC_SIZE = 512
+
+    def __init__(self, blocks):
+        self.data = bytearray(blocks * self.SEC_SIZE)
+
+    def readblocks(self, n, buf):
+        #print("readblocks(%s, %x(%d))" % (n, id(buf), len(buf)))
+        for i in range(len(buf)):
+            buf[i] = self.data[n * self.SEC_SIZE + i]
+        return 0
+
+    def writeblocks(self, n, buf):
+        #print("writeblocks(%s, %x)" % (n, id(buf)))
+        for i in range(len(buf)):
+            self.data[n * self.SEC_SIZE + i] = buf[i]
+        return 0
+
+    def ioctl(self, op, arg):
+        #print("ioctl(%d, %r)" % (op, arg))
+        if op == 4:  # BP_IOCTL_SEC_COUNT
+            return len(self.data) // self.SEC_SIZE
+        if op == 5:  # BP_IOCTL_SEC_SIZE
+            return self.SEC_SIZE
+
+
+try:
+    bdev = RAMFS(100)
+except MemoryError:
+    print("SKIP")
+    raise SystemExit
+
+uos.VfsFat.mkfs(bdev)
+vfs = uos.VfsFat(bdev)
+uos.mount(vfs, '/ramdisk')
+uos.chdir('/ramdisk')
+
+
+def write(path, text):
+    with open(path, "w") as f:
+        f.write(text)
+
+
+def imp(name):
+    try:
+        m = __import__(name)
+        del sys.modules[name]
+        return m.X
+    except ImportError:
+        return "ImportError"
+
+
+sys.path[:] = ["/ramdisk", "/ramdisk/lib"]
+uos.mkdir("lib")
+
+# a failed import must not hide a module created afterwards
+print(imp("mod1"))
+write("lib/mod1.py", "X = 'lib/mod1'\n")
+print(imp("mod1"))
+
+# an earlier path entry takes over once the module appears there
+write("mod1.py", "X = 'mod1'\n")
+print(imp("mod1"))
+uos.remove("mod1.py")
+print(imp("mod1"))
+uos.rename("lib/mod1.py", "lib/mod2.py")
+print(imp("mod1"), imp("mod2"))
+
+# a package wins over a module of the same name
+write("lib/pkg.py", "X = 'lib/pkg.py'\n")
+print(imp("pkg"))
+uos.mkdir("pkg")
+write("pkg/__init__.py", "X = 'pkg'\n")
+print(imp("pkg"))
+uos.remove("pkg/__init__.py")
+uos.rmdir("pkg")
+print(imp("pkg"))
+
+# FAT is case-insensitive so these are still found
+write("lib/Mixed.py", "X = 'Mixed'\n")
+print(imp("mixed"), imp("Mixed"))
+write("lib/lower.py", "X = 'lower'\n")
+print(imp("LOWER"), imp("lower"))
+# and so are uppercase suffixes, as written by other systems
+write("lib/CODE.PY", "X = 'CODE.PY'\n")
+write("lib/Other.Py", "X = 'Other.Py'\n")
+print(imp("code"), imp("other"))
+
+# the empty path entry follows the current directory
+sys.path[:] = [""]
+print(imp("mod2"))
+uos.chdir("lib")
+print(imp("mod2"))
+
+# a remount starts from scratch
+uos.umount("/ramdisk")
+print(imp("mod2"))
+uos.mount(vfs, "/ramdisk")
+uos.chdir("/ramdisk/lib")
+print(imp("mod2"))
+uos.umount("/ramdisk")
@@ -0,0 +1,78 @@
+try:
+    import uerrno
+    import uos
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+try:
+    uos.VfsFat
+except AttributeError:
+    print("SKIP")
+    raise SystemExit
+
+
+class RAMFS:
+
+    SEC_SIZE = 512
+
+    def __init__(self, blocks):
+        self.data = bytearray(blocks * self.SEC_SIZE)
+
+    def readblocks(self, n, buf):
+        #print("readblocks(%s, %x(%d))" % (n, id(buf), len(buf)))
+        for i in range(len(buf)):
+            buf[i] = self.data[n * self.SEC_SIZE + i]
+        return 0
+
+    def writeblocks(self, n, buf):
+        #print("writeblocks(%s, %x)" % (n, id(buf)))
+        for i in range(len(buf)):
+            self.data[n * self.SEC_SIZE + i] = buf[i]
+        return 0
+
+    def ioctl(self, op, arg):
+        #print("ioctl(%d, %r)" % (op, arg))
+        if op == 4:  # BP_IOCTL_SEC_COUNT
+            return len(self.data) // self.SEC_SIZE
+        if op == 5:  # BP_IOCTL_SEC_SIZE
+            return self.SEC_SIZE
+
+
+try:
+    bdev = RAMFS(100)
+except MemoryError:
+    print("SKIP")
+    raise SystemExit
+
+uos.VfsFat.mkfs(bdev)
+vfs = uos.VfsFat(bdev)
+uos.mount(vfs, '/ramdisk')
+uos.chdir('/ramdisk')
+
+# "contig" is written in one go, "frag" is interleaved with "other"
+expected = bytes((i * 13) & 0xff for i in range(12000))
+with open("contig", "wb") as f:
+    f.write(expected)
+for i in range(0, len(expected), 1500):
+    with open("frag", "ab") as f:
+        f.write(expected[i:i + 1500])
+    with open("other", "ab") as f:
+        f.write(b"x" * 700)
+
+# multi-sector reads from aligned and unaligned positions, into a bytearray
+# and into a memoryview at an odd offset
+for name in ("contig", "frag"):
+    with open(name, "rb") as f:
+        for pos, size in ((0, 512), (0, 4096), (512, 8192), (100, 5000), (511, 1025), (11000, 4096)):
+            f.seek(pos)
+            buf = bytearray(size)
+            n = f.readinto(buf)
+            ok = buf[:n] == expected[pos:pos + n]
+            f.seek(pos)
+            buf = bytearray(size + 3)
+            n2 = f.readinto(memoryview(buf)[3:])
+            print(name, pos, size, n, ok and n == n2 and buf[3:3 + n] == expected[pos:pos + n])
+    with open(name, "rb") as f:
+        buf = bytearray(12000)
+        print(f.readinto(buf), buf == expected)
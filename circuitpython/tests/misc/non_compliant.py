@@ -2,7 +2,11 @@
 
 try:
     import array
-    import struct
+    # the struct checks below are about ustruct, not a port's full struct
+    try:
+        import ustruct as struct
+    except ImportError:
+        import struct
 except ImportError:
     print("SKIP")
     raise SystemExit
@@ -72,3 +72,86 @@ except ZeroDivisionError:
 import uio
 buf = uio.resource_stream('frzstr_pkg2', 'mod.py')
 print(buf.read(21))
+
+# test that CircuitPython's os and storage, which don't go through uos, clear the import cache
+import sys
+import uos
+
+cpy_vfs = data[4]
+
+class RAMFS:
+    def __init__(self, blocks):
+        self.data = bytearray(blocks * 512)
+
+    def readblocks(self, n, buf):
+        buf[:] = self.data[n * 512:n * 512 + len(buf)]
+
+    def writeblocks(self, n, buf):
+        self.data[n * 512:n * 512 + len(buf)] = buf
+
+    def ioctl(self, op, arg):
+        if op == 4:  # BP_IOCTL_SEC_COUNT
+            return len(self.data) // 512
+        if op == 5:  # BP_IOCTL_SEC_SIZE
+            return 512
+
+def found(name):
+    try:
+        __import__(name)
+        del sys.modules[name]
+        return True
+    except ImportError:
+        return False
+
+bdev = RAMFS(64)
+uos.VfsFat.mkfs(bdev)
+cpy_vfs['mount'](uos.VfsFat(bdev), '/cpyfs')
+sys.path.insert(0, '/cpyfs')
+with open('/cpyfs/cachemod.py', 'w') as f:
+    f.write('x = 1\n')
+print('write', found('cachemod'))
+cpy_vfs['rename']('/cpyfs/cachemod.py', '/cpyfs/cachemod2.py')
+print('rename', found('cachemod'), found('cachemod2'))
+cpy_vfs['remove']('/cpyfs/cachemod2.py')
+print('remove', found('cachemod2'))
+cpy_vfs['mkdir']('/cpyfs/cachepkg')
+print('mkdir', found('cachepkg'))
+cpy_vfs['rmdir']('/cpyfs/cachepkg')
+print('rmdir', found('cachepkg'))
+cpy_vfs['mkdir']('/cpyfs/cachedir')
+with open('/cpyfs/cachedir/cachemod3.py', 'w') as f:
+    f.write('x = 3\n')
+sys.path.insert(0, '')
+print('chdir', found('cachemod3'), end=' ')
+cpy_vfs['chdir']('/cpyfs/cachedir')
+print(found('cachemod3'))
+cpy_vfs['chdir']('/')
+sys.path.pop(0)
+cpy_vfs['umount']('/cpyfs')
+print('umount', found('cachedir'))
+sys.path.pop(0)
+
+# test that import only treats OSError from listing a directory as "no such directory"
+class ErrFS:
+    def mount(self, readonly, mkfs):
+        pass
+
+    def umount(self):
+        pass
+
+    def stat(self, path):
+        raise OSError(uerrno.ENOENT)
+
+    def ilistdir(self, path):
+        raise self.exc
+
+errfs = ErrFS()
+uos.mount(errfs, '/errfs')
+sys.path.insert(0, '/errfs')
+for errfs.exc in (ValueError, KeyboardInterrupt, OSError(uerrno.EIO)):
+    try:
+        __import__('errmod')
+    except BaseException as e:
+        print('ilistdir', type(e).__name__)
+sys.path.pop(0)
+uos.umount('/errfs')